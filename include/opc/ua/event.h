@@ -1,6 +1,7 @@
 
 #pragma once
 
+#include <opc/common/class_pointers.h>
 #include <opc/ua/node.h>
 #include <opc/ua/protocol/nodeid.h>
 #include <opc/ua/protocol/string_utils.h>
@@ -17,6 +18,36 @@ namespace OpcUa
 typedef std::map<std::vector<QualifiedName>, Variant> PathMap;
 typedef std::map<AttributeId, Variant> AttributeMap;
 
+//Field layout of an event type
+//Every variable of the type and of its supertypes (up to BaseEventType,
+//whose fields are members of Event) gets a slot.
+//Events created with a layout keep these fields in a flat array indexed by slot.
+class EventLayout
+{
+public:
+  DEFINE_CLASS_POINTERS(EventLayout)
+
+  EventLayout(const NodeId & type, const std::vector<std::vector<QualifiedName>> & fields);
+
+  //Build the layout by browsing the type and its supertypes
+  static SharedPtr Create(const Node & type);
+
+  const NodeId & GetEventType() const { return EventType; }
+  const std::vector<std::vector<QualifiedName>> & GetFields() const { return Fields; }
+  std::size_t Size() const { return Fields.size(); }
+
+  //Slot of the field identified by its relative path, -1 if the type has no such field
+  //Lookups search a map and the string overload parses and allocates the path:
+  //resolve slots once and keep them, do not call these per event
+  int32_t GetSlot(const std::vector<QualifiedName> & path) const;
+  int32_t GetSlot(const std::string & qualifiedname) const;
+
+private:
+  NodeId EventType;
+  std::vector<std::vector<QualifiedName>> Fields;
+  std::map<std::vector<QualifiedName>, uint32_t> Slots;
+};
+
 class Event
 {
 
@@ -31,6 +62,8 @@ public:
   Event(const Node & type);
   Event(const NodeId & type);
   Event();
+  //Event whose fields declared by the layout are stored by slot
+  explicit Event(const EventLayout::SharedPtr & layout);
 
   //Attributes of an BaseEventType
   ByteString EventId;     //unique id
@@ -47,6 +80,8 @@ public:
   //Set value of a variable(or object)
   //This value will be used when the event is fired
   //You can set arbitrary data, but clients will not be able to discover them thus subscribe to them
+  //Path overloads are the slow path: fields of the layout are looked up by path on every call,
+  //use SetSlotValue with slots resolved once for events fired often
   void SetValue(const std::vector<QualifiedName> & path, Variant value);
   void SetValue(AttributeId attribute, Variant value);
   void SetValue(const QualifiedName & path, Variant value);
@@ -55,15 +90,24 @@ public:
   //Return value og variable identified by its relative path
   //or value of attribute identified by its Id
   //returns null variant if no match
+  //Path overloads look the field up on every call, GetSlotValue is the fast path
   Variant GetValue(const std::vector<QualifiedName> & path) const;
   Variant GetValue(AttributeId attribute) const;
   Variant GetValue(const QualifiedName & path) const;
   Variant GetValue(const std::string & qualifiedname) const; //helper method for the most common case
 
+  //Set or get value of a field by its slot in the layout of the event,
+  //slots are obtained once with EventLayout::GetSlot
+  void SetSlotValue(uint32_t slot, Variant value) { SlotValues[slot] = std::move(value); }
+  const Variant & GetSlotValue(uint32_t slot) const { return SlotValues[slot]; }
+  const EventLayout::SharedPtr & GetLayout() const { return Layout; }
+
   //Get the list of available values in this event
   std::vector<std::vector<QualifiedName>> GetValueKeys();
 
 protected:
+  EventLayout::SharedPtr Layout;
+  std::vector<Variant> SlotValues;
   PathMap PathValues;
   AttributeMap AttributeValues;
 };
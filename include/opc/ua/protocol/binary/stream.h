@@ -16,6 +16,7 @@
 #include <opc/ua/protocol/channel.h>
 #include <opc/ua/protocol/binary/common.h>
 
+#include <cstring>
 #include <memory>
 #include <vector>
 
@@ -30,6 +31,8 @@ class DataSerializer
 {
 public:
   explicit DataSerializer(std::size_t defBufferSize = OPCUA_DEFAULT_BUFFER_SIZE)
+    : MessageStart(0)
+    , SizePending(false)
   {
     Buffer.reserve(defBufferSize);
   }
@@ -44,15 +47,34 @@ public:
   template <typename Acceptor>
   void Flush(Acceptor & aceptor)
   {
+    if (SizePending)
+      {
+        PatchMessageSize();
+      }
+
     aceptor.Send(&Buffer[0], Buffer.size());
     Buffer.clear();
   }
 
+  /// @brief Message header will be serialized next.
+  /// Size field of the header is filled with the real size of the message on flush,
+  /// so the message doesn't need to be measured with RawSize() before serialization.
+  void BeginMessage()
+  {
+    MessageStart = Buffer.size();
+    SizePending = true;
+  }
+
   template<typename T>
   void Serialize(const T & value);
 
+private:
+  void PatchMessageSize();
+
 private:
   std::vector<char> Buffer;
+  std::size_t MessageStart;
+  bool SizePending;
 };
 
 class DataSupplier
@@ -65,7 +87,18 @@ class DataDeserializer
 {
 public:
   DataDeserializer(DataSupplier & supplier)
-    : In(supplier)
+    : In(&supplier)
+    , Cursor(nullptr)
+    , End(nullptr)
+  {
+  }
+
+  /// @brief Decode directly from a contiguous memory block.
+  /// Data is not copied, the block must outlive the deserializer.
+  DataDeserializer(const char * data, std::size_t size)
+    : In(nullptr)
+    , Cursor(data)
+    , End(data + size)
   {
   }
 
@@ -83,8 +116,46 @@ public:
   template <typename T>
   void Deserialize(T &);
 
+  /// @brief Number of bytes of the memory block which were not decoded yet.
+  std::size_t GetRemainSize() const
+  {
+    return static_cast<std::size_t>(End - Cursor);
+  }
+
+private:
+  void GetData(char * data, std::size_t size)
+  {
+    if (In)
+      {
+        ReadFromSupplier(data, size);
+        return;
+      }
+
+    if (size > GetRemainSize())
+      {
+        ThrowNotEnoughData(size, GetRemainSize());
+      }
+
+    std::memcpy(data, Cursor, size);
+    Cursor += size;
+  }
+
+  /// @brief Throw before allocating size bytes which the memory block cannot hold.
+  void CheckRemainSize(std::size_t size) const
+  {
+    if (!In && size > GetRemainSize())
+      {
+        ThrowNotEnoughData(size, GetRemainSize());
+      }
+  }
+
+  void ReadFromSupplier(char * data, std::size_t size);
+  static void ThrowNotEnoughData(std::size_t expected, std::size_t received);
+
 private:
-  DataSupplier & In;
+  DataSupplier * In;
+  const char * Cursor;
+  const char * End;
 };
 
 
@@ -137,6 +208,11 @@ public:
     Serializer.Flush(Out);
   }
 
+  void BeginMessage()
+  {
+    Serializer.BeginMessage();
+  }
+
 private:
   OutputChannelType & Out;
   std::shared_ptr<OutputChannelType> Holder;
@@ -150,6 +226,15 @@ inline OStream<ChannelType> & flush(OStream<ChannelType> & os)
   return os;
 }
 
+/// @brief Following header gets size of the whole message when it is flushed.
+/// os << begin_message << header << body << flush
+template <typename ChannelType>
+inline OStream<ChannelType> & begin_message(OStream<ChannelType> & os)
+{
+  os.BeginMessage();
+  return os;
+}
+
 struct RawBuffer
 {
   char * Data;
@@ -168,18 +253,26 @@ class IStream : private DataSupplier
 {
 public:
   explicit IStream(std::shared_ptr<InputChannelType> channel)
-    : In(*channel)
+    : In(channel.get())
     , Holder(channel)
     , Deserializer(*this)
   {
   }
 
   explicit IStream(InputChannelType & channel)
-    : In(channel)
+    : In(&channel)
     , Deserializer(*this)
   {
   }
 
+  /// @brief Stream over an already received message.
+  /// Data is decoded in place without calls to the channel.
+  IStream(const char * data, std::size_t size)
+    : In(nullptr)
+    , Deserializer(data, size)
+  {
+  }
+
   virtual ~IStream()
   {
   }
@@ -191,14 +284,19 @@ public:
     return *this;
   }
 
+  std::size_t GetRemainSize() const
+  {
+    return Deserializer.GetRemainSize();
+  }
+
 private:
   virtual size_t Read(char * buffer, size_t size)
   {
-    return In.Receive(buffer, size);
+    return In->Receive(buffer, size);
   }
 
 private:
-  InputChannelType & In;
+  InputChannelType * In;
   std::shared_ptr<InputChannelType> Holder;
   DataDeserializer Deserializer;
 };
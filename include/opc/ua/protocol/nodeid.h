@@ -19,6 +19,7 @@
 #include <sstream>
 #include <stdint.h>
 #include <string>
+#include <utility>
 #include <vector>
 
 namespace OpcUa
@@ -41,86 +42,42 @@ enum NodeIdEncoding : uint8_t
 
 struct ExpandedNodeId;
 
+/// @brief Node Id.
+/// Numeric identifiers share one 8 byte union. String, binary and guid
+/// identifiers as well as the namespace uri and server index of expanded
+/// node ids are allocated only when they are used.
 struct NodeId
 {
-  NodeIdEncoding Encoding;
-  std::string NamespaceURI;
-  uint32_t ServerIndex;
-
   struct TwoByteDataType
   {
     uint8_t Identifier;
-
-    TwoByteDataType()
-      : Identifier(0)
-    {
-    }
-
-  } TwoByteData;
+  };
 
   struct FourByteDataType
   {
     uint8_t NamespaceIndex;
     uint16_t Identifier;
-
-    FourByteDataType()
-      : NamespaceIndex(0)
-      , Identifier(0)
-    {
-    }
-  } FourByteData;
+  };
 
   struct NumericDataType
   {
     uint16_t NamespaceIndex;
     uint32_t Identifier;
+  };
 
-    NumericDataType()
-      : NamespaceIndex(0)
-      , Identifier(0)
-    {
-    }
-  } NumericData;
-
-
-  struct StringDataType
-  {
-    uint16_t NamespaceIndex;
-    std::string Identifier;
-
-    StringDataType()
-      : NamespaceIndex(0)
-    {
-    }
-
-  } StringData;
-
-  struct BinaryDataType
-  {
-    uint16_t NamespaceIndex;
-    std::vector<uint8_t> Identifier;
-
-    BinaryDataType()
-      : NamespaceIndex(0)
-    {
-    }
-
-  } BinaryData;
+  NodeIdEncoding Encoding;
 
-  struct GuidDataType
+  // Active member is selected by Encoding.
+  union
   {
-    uint16_t NamespaceIndex;
-    Guid Identifier;
-
-    GuidDataType()
-      : NamespaceIndex(0)
-    {
-    }
-
-  } GuidData;
+    TwoByteDataType TwoByteData;
+    FourByteDataType FourByteData;
+    NumericDataType NumericData;
+  };
 
   NodeId();
   NodeId(const NodeId & node);
+  NodeId(NodeId && node);
   NodeId(const ExpandedNodeId & node);
   NodeId(MessageId messageId);
   NodeId(ReferenceId referenceId);
@@ -128,8 +85,12 @@ struct NodeId
   NodeId(ExpandedObjectId objectId);
   NodeId(uint32_t integerId, uint16_t index);
   NodeId(std::string stringId, uint16_t index);
+  NodeId(std::vector<uint8_t> binaryId, uint16_t index);
+  NodeId(const Guid & guidId, uint16_t index);
+  ~NodeId();
 
   NodeId & operator= (const NodeId & node);
+  NodeId & operator= (NodeId && node);
   NodeId & operator= (const ExpandedNodeId & node);
 
   explicit operator ExpandedNodeId();
@@ -182,6 +143,9 @@ struct NodeId
   void SetServerIndex(uint32_t index);
   void SetNamespaceIndex(uint32_t ns);
 
+  const std::string & GetNamespaceURI() const;
+  uint32_t GetServerIndex() const;
+
   bool IsInteger() const;
   bool IsString() const;
   bool IsBinary() const;
@@ -190,12 +154,38 @@ struct NodeId
   uint32_t GetNamespaceIndex() const;
 
   uint32_t GetIntegerIdentifier() const;
-  std::string GetStringIdentifier() const;
-  std::vector<uint8_t> GetBinaryIdentifier() const;
+  const std::string & GetStringIdentifier() const;
+  const std::vector<uint8_t> & GetBinaryIdentifier() const;
   Guid GetGuidIdentifier() const;
 
 protected:
   void CopyNodeId(const NodeId & node);
+  void MoveNodeId(NodeId & node);
+
+private:
+  struct ExpandedData
+  {
+    std::string NamespaceURI;
+    uint32_t ServerIndex = 0;
+  };
+
+  void CopyNumericData(const NodeId & node);
+  void FreeIdentifier();
+  ExpandedData & GetExpandedData();
+
+private:
+  // Which member of Identifier is allocated: EV_STRING, EV_BYTE_STRING, EV_GUId or EV_TWO_BYTE for none.
+  // For these encodings the namespace index is kept in NumericData.
+  NodeIdEncoding AllocatedEncoding;
+
+  union
+  {
+    std::string * String;
+    std::vector<uint8_t> * Binary;
+    Guid * GuidId;
+  } Identifier;
+
+  ExpandedData * Expanded;
 };
 
 inline NodeId TwoByteNodeId(uint8_t value)
@@ -217,38 +207,22 @@ inline NodeId FourByteNodeId(uint16_t value, uint8_t namespaceIndex = 0)
 
 inline NodeId NumericNodeId(uint32_t value, uint16_t namespaceIndex = 0)
 {
-  NodeId id;
-  id.Encoding = EV_NUMERIC;
-  id.NumericData.Identifier = value;
-  id.NumericData.NamespaceIndex = namespaceIndex;
-  return id;
+  return NodeId(value, namespaceIndex);
 }
 
 inline NodeId StringNodeId(std::string value, uint16_t namespaceIndex = 0)
 {
-  NodeId id;
-  id.Encoding = EV_STRING;
-  id.StringData.Identifier = value;
-  id.StringData.NamespaceIndex = namespaceIndex;
-  return id;
+  return NodeId(std::move(value), namespaceIndex);
 }
 
 inline NodeId BinaryNodeId(std::vector<uint8_t> value, uint16_t namespaceIndex = 0)
 {
-  NodeId id;
-  id.Encoding = EV_BYTE_STRING;
-  id.BinaryData.Identifier = value;
-  id.BinaryData.NamespaceIndex = namespaceIndex;
-  return id;
+  return NodeId(std::move(value), namespaceIndex);
 }
 
 inline NodeId GuidNodeId(Guid value, uint16_t namespaceIndex = 0)
 {
-  NodeId id;
-  id.Encoding = EV_GUId;
-  id.GuidData.Identifier = value;
-  id.GuidData.NamespaceIndex = namespaceIndex;
-  return id;
+  return NodeId(value, namespaceIndex);
 }
 
 struct ExpandedNodeId : public NodeId
@@ -256,6 +230,7 @@ struct ExpandedNodeId : public NodeId
   ExpandedNodeId();
   ExpandedNodeId(const NodeId & node);
   ExpandedNodeId(const ExpandedNodeId & node);
+  ExpandedNodeId(ExpandedNodeId && node);
   ExpandedNodeId(MessageId messageId);
   ExpandedNodeId(ReferenceId referenceId);
   ExpandedNodeId(ObjectId objectId);
@@ -263,10 +238,31 @@ struct ExpandedNodeId : public NodeId
   ExpandedNodeId(uint32_t integerId, uint16_t index);
   ExpandedNodeId(std::string stringId, uint16_t index);
 
+  ExpandedNodeId & operator= (const ExpandedNodeId & node);
+  ExpandedNodeId & operator= (ExpandedNodeId && node);
+
   //using NodeId::NodeId;
   //using base::base;
 };
 
 } // namespace OpcUa
 
+namespace std
+{
+
+/// @brief Hash of node id consistent with NodeId::operator==:
+/// numeric ids hash the same regardless of their encoding.
+template <>
+struct hash<OpcUa::NodeId>
+{
+  std::size_t operator()(const OpcUa::NodeId & id) const;
+};
+
+template <>
+struct hash<OpcUa::ExpandedNodeId> : hash<OpcUa::NodeId>
+{
+};
+
+} // namespace std
+
 
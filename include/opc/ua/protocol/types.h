@@ -20,6 +20,7 @@
 #include <opc/ua/protocol/status_codes.h>
 #include <opc/ua/protocol/reference_ids.h>
 
+#include <functional>
 #include <memory>
 #include <stdint.h>
 #include <string>
@@ -292,5 +293,19 @@ struct ExtensionObjectHeader
 
 } // namespace OpcUa
 
+namespace std
+{
+
+template <>
+struct hash<OpcUa::QualifiedName>
+{
+  std::size_t operator()(const OpcUa::QualifiedName & name) const
+  {
+    return std::hash<std::string>()(name.Name) ^ (static_cast<std::size_t>(name.NamespaceIndex) << 1);
+  }
+};
+
+} // namespace std
+
 #endif // __OPC_UA_MAPPING_TYPES_H__
 
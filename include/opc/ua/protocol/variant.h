@@ -15,8 +15,11 @@
 #include <opc/ua/protocol/types.h>
 #include <opc/ua/protocol/status_codes.h>
 
-#include <boost/any.hpp>
+#include <new>
 #include <string>
+#include <type_traits>
+#include <typeinfo>
+#include <utility>
 
 #include <stdexcept>
 
@@ -101,6 +104,67 @@ struct is_container_not_string<std::string> : std::integral_constant<bool, false
 
 
 class Variant;
+struct ExtensionObject;
+
+
+/// @brief C++ types which can be stored in Variant and their variant types.
+template <typename T>
+struct VariantTraits
+{
+  static const bool IsSupported = false;
+};
+
+template <VariantType type, bool isArray>
+struct VariantTypeTraits
+{
+  static const bool IsSupported = true;
+  static const VariantType Type = type;
+  static const bool IsArray = isArray;
+};
+
+template <> struct VariantTraits<bool> : VariantTypeTraits<VariantType::BOOLEAN, false> {};
+template <> struct VariantTraits<std::vector<bool>> : VariantTypeTraits<VariantType::BOOLEAN, true> {};
+template <> struct VariantTraits<int8_t> : VariantTypeTraits<VariantType::SBYTE, false> {};
+template <> struct VariantTraits<std::vector<int8_t>> : VariantTypeTraits<VariantType::SBYTE, true> {};
+template <> struct VariantTraits<uint8_t> : VariantTypeTraits<VariantType::BYTE, false> {};
+template <> struct VariantTraits<std::vector<uint8_t>> : VariantTypeTraits<VariantType::BYTE, true> {};
+template <> struct VariantTraits<int16_t> : VariantTypeTraits<VariantType::INT16, false> {};
+template <> struct VariantTraits<std::vector<int16_t>> : VariantTypeTraits<VariantType::INT16, true> {};
+template <> struct VariantTraits<uint16_t> : VariantTypeTraits<VariantType::UINT16, false> {};
+template <> struct VariantTraits<std::vector<uint16_t>> : VariantTypeTraits<VariantType::UINT16, true> {};
+template <> struct VariantTraits<int32_t> : VariantTypeTraits<VariantType::INT32, false> {};
+template <> struct VariantTraits<std::vector<int32_t>> : VariantTypeTraits<VariantType::INT32, true> {};
+template <> struct VariantTraits<uint32_t> : VariantTypeTraits<VariantType::UINT32, false> {};
+template <> struct VariantTraits<std::vector<uint32_t>> : VariantTypeTraits<VariantType::UINT32, true> {};
+template <> struct VariantTraits<int64_t> : VariantTypeTraits<VariantType::INT64, false> {};
+template <> struct VariantTraits<std::vector<int64_t>> : VariantTypeTraits<VariantType::INT64, true> {};
+template <> struct VariantTraits<uint64_t> : VariantTypeTraits<VariantType::UINT64, false> {};
+template <> struct VariantTraits<std::vector<uint64_t>> : VariantTypeTraits<VariantType::UINT64, true> {};
+template <> struct VariantTraits<float> : VariantTypeTraits<VariantType::FLOAT, false> {};
+template <> struct VariantTraits<std::vector<float>> : VariantTypeTraits<VariantType::FLOAT, true> {};
+template <> struct VariantTraits<double> : VariantTypeTraits<VariantType::DOUBLE, false> {};
+template <> struct VariantTraits<std::vector<double>> : VariantTypeTraits<VariantType::DOUBLE, true> {};
+template <> struct VariantTraits<std::string> : VariantTypeTraits<VariantType::STRING, false> {};
+template <> struct VariantTraits<std::vector<std::string>> : VariantTypeTraits<VariantType::STRING, true> {};
+template <> struct VariantTraits<DateTime> : VariantTypeTraits<VariantType::DATE_TIME, false> {};
+template <> struct VariantTraits<std::vector<DateTime>> : VariantTypeTraits<VariantType::DATE_TIME, true> {};
+template <> struct VariantTraits<Guid> : VariantTypeTraits<VariantType::GUId, false> {};
+template <> struct VariantTraits<std::vector<Guid>> : VariantTypeTraits<VariantType::GUId, true> {};
+template <> struct VariantTraits<ByteString> : VariantTypeTraits<VariantType::BYTE_STRING, false> {};
+template <> struct VariantTraits<std::vector<ByteString>> : VariantTypeTraits<VariantType::BYTE_STRING, true> {};
+template <> struct VariantTraits<NodeId> : VariantTypeTraits<VariantType::NODE_Id, false> {};
+template <> struct VariantTraits<std::vector<NodeId>> : VariantTypeTraits<VariantType::NODE_Id, true> {};
+template <> struct VariantTraits<StatusCode> : VariantTypeTraits<VariantType::STATUS_CODE, false> {};
+template <> struct VariantTraits<std::vector<StatusCode>> : VariantTypeTraits<VariantType::STATUS_CODE, true> {};
+template <> struct VariantTraits<QualifiedName> : VariantTypeTraits<VariantType::QUALIFIED_NAME, false> {};
+template <> struct VariantTraits<std::vector<QualifiedName>> : VariantTypeTraits<VariantType::QUALIFIED_NAME, true> {};
+template <> struct VariantTraits<LocalizedText> : VariantTypeTraits<VariantType::LOCALIZED_TEXT, false> {};
+template <> struct VariantTraits<std::vector<LocalizedText>> : VariantTypeTraits<VariantType::LOCALIZED_TEXT, true> {};
+template <> struct VariantTraits<ExtensionObject> : VariantTypeTraits<VariantType::EXTENSION_OBJECT, false> {};
+template <> struct VariantTraits<std::vector<ExtensionObject>> : VariantTypeTraits<VariantType::EXTENSION_OBJECT, true> {};
+template <> struct VariantTraits<std::vector<Variant>> : VariantTypeTraits<VariantType::VARIANT, true> {};
+template <> struct VariantTraits<DiagnosticInfo> : VariantTypeTraits<VariantType::DIAGNOSTIC_INFO, false> {};
+template <> struct VariantTraits<std::vector<DiagnosticInfo>> : VariantTypeTraits<VariantType::DIAGNOSTIC_INFO, true> {};
 
 
 // Such monster due to msvs.
@@ -154,23 +218,166 @@ public:
   virtual void Visit(const std::vector<DiagnosticInfo> & val) = 0;
 };
 
+template <typename T>
+inline void VisitVariantValue(VariantVisitor & visitor, const T & value)
+{
+  visitor.Visit(value);
+}
+
+// Extension objects are stored after decoding but cannot be visited or compared.
+void VisitVariantValue(VariantVisitor & visitor, const ExtensionObject & value);
+void VisitVariantValue(VariantVisitor & visitor, const std::vector<ExtensionObject> & value);
+
+template <typename T>
+inline bool CompareVariantValues(const T & lhs, const T & rhs)
+{
+  return lhs == rhs;
+}
+
+bool CompareVariantValues(const ExtensionObject & lhs, const ExtensionObject & rhs);
+bool CompareVariantValues(const std::vector<ExtensionObject> & lhs, const std::vector<ExtensionObject> & rhs);
+
+
+/// @brief Memory of a variant value.
+/// Values which fit into it (numbers, DateTime, Guid, strings and arrays)
+/// are constructed in place, larger ones are allocated on the heap.
+union VariantStorage
+{
+  void * Pointer;
+  int64_t Number;
+  double Real;
+  char Data[4 * sizeof(void *)];
+};
+
+template <typename T>
+struct IsStoredInVariant : std::integral_constant < bool,
+  sizeof(T) <= sizeof(VariantStorage) &&
+  alignof(VariantStorage) % alignof(T) == 0 &&
+  std::is_nothrow_move_constructible<T>::value >
+{
+};
+
+/// @brief Operations over a stored value of one concrete type.
+struct VariantValueHandler
+{
+  VariantType Type;
+  bool IsArray;
+  void (*Destroy)(VariantStorage & storage);
+  void (*Copy)(const VariantStorage & from, VariantStorage & to);
+  void (*Move)(VariantStorage & from, VariantStorage & to);
+  bool (*Equal)(const VariantStorage & lhs, const VariantStorage & rhs);
+  void (*Visit)(const VariantStorage & storage, VariantVisitor & visitor);
+};
+
+template <typename T, bool isInline = IsStoredInVariant<T>::value>
+struct VariantValueAccess
+{
+  static T * Get(VariantStorage & storage) { return reinterpret_cast<T *>(storage.Data); }
+  static const T * Get(const VariantStorage & storage) { return reinterpret_cast<const T *>(storage.Data); }
+
+  template <typename Value>
+  static void Create(VariantStorage & storage, Value && value) { new (storage.Data) T(std::forward<Value>(value)); }
+
+  static void Destroy(VariantStorage & storage) { Get(storage)->~T(); }
+  static void Copy(const VariantStorage & from, VariantStorage & to) { new (to.Data) T(*Get(from)); }
+
+  static void Move(VariantStorage & from, VariantStorage & to)
+  {
+    new (to.Data) T(std::move(*Get(from)));
+    Destroy(from);
+  }
+};
+
+template <typename T>
+struct VariantValueAccess<T, false>
+{
+  static T * Get(VariantStorage & storage) { return static_cast<T *>(storage.Pointer); }
+  static const T * Get(const VariantStorage & storage) { return static_cast<const T *>(storage.Pointer); }
+
+  template <typename Value>
+  static void Create(VariantStorage & storage, Value && value) { storage.Pointer = new T(std::forward<Value>(value)); }
+
+  static void Destroy(VariantStorage & storage) { delete Get(storage); }
+  static void Copy(const VariantStorage & from, VariantStorage & to) { to.Pointer = new T(*Get(from)); }
+
+  static void Move(VariantStorage & from, VariantStorage & to)
+  {
+    to.Pointer = from.Pointer;
+    from.Pointer = nullptr;
+  }
+};
+
+template <typename T>
+struct VariantTypedHandler : VariantValueAccess<T>
+{
+  typedef VariantValueAccess<T> Access;
+
+  static bool Equal(const VariantStorage & lhs, const VariantStorage & rhs)
+  {
+    return CompareVariantValues(*Access::Get(lhs), *Access::Get(rhs));
+  }
+
+  static void Visit(const VariantStorage & storage, VariantVisitor & visitor)
+  {
+    VisitVariantValue(visitor, *Access::Get(storage));
+  }
+
+  static const VariantValueHandler Instance;
+};
+
+template <typename T>
+const VariantValueHandler VariantTypedHandler<T>::Instance =
+{
+  VariantTraits<T>::Type,
+  VariantTraits<T>::IsArray,
+  &VariantTypedHandler<T>::Destroy,
+  &VariantTypedHandler<T>::Copy,
+  &VariantTypedHandler<T>::Move,
+  &VariantTypedHandler<T>::Equal,
+  &VariantTypedHandler<T>::Visit
+};
+
 
+/// @brief Value of any OPC UA built-in type.
+/// The value is kept in a tagged union: type is known without RTTI
+/// and scalars are stored without heap allocation.
 class Variant
 {
-  boost::any Value;
+  VariantStorage Value;
+  const VariantValueHandler * Handler;
+
+  template <typename T>
+  using EnableIfValue = typename std::enable_if < !std::is_same<typename std::decay<T>::type, Variant>::value >::type;
 
 public:
   std::vector<uint32_t> Dimensions;
 
-  Variant() {}
+  Variant()
+    : Handler(nullptr)
+  {
+  }
+
   Variant(const Variant & var)
-    : Value(var.Value)
+    : Handler(nullptr)
     , Dimensions(var.Dimensions)
   {
+    CopyValue(var);
+  }
+
+  Variant(Variant && var)
+    : Handler(nullptr)
+    , Dimensions(std::move(var.Dimensions))
+  {
+    MoveValue(var);
+  }
+
+  template <typename T, typename = EnableIfValue<T>>
+  Variant(T && value)
+    : Handler(nullptr)
+  {
+    SetValue(std::forward<T>(value));
   }
 
-  template <typename T>
-  Variant(const T & value) : Value(value) {}
   Variant(const char * value) : Variant(std::string(value)) {}
   Variant(MessageId id) : Variant(NodeId(id)) {}
   Variant(ReferenceId id) : Variant(NodeId(id)) {}
@@ -178,48 +385,68 @@ public:
   Variant(ExpandedObjectId id) : Variant(NodeId(id)) {}
   explicit Variant(VariantType);
 
+  ~Variant()
+  {
+    Reset();
+  }
+
   Variant & operator= (const Variant & variant)
   {
-    this->Value = variant.Value;
-    this->Dimensions = variant.Dimensions;
+    if (this != &variant)
+      {
+        Reset();
+        CopyValue(variant);
+        Dimensions = variant.Dimensions;
+      }
+
     return *this;
   }
 
-  template <typename T>
-  Variant & operator=(const T & value)
+  Variant & operator= (Variant && variant)
   {
-    Value = value;
+    if (this != &variant)
+      {
+        Reset();
+        MoveValue(variant);
+        Dimensions = std::move(variant.Dimensions);
+      }
+
     return *this;
   }
 
-  Variant & operator=(const char * value)
+  template <typename T, typename = EnableIfValue<T>>
+  Variant & operator=(T && value)
   {
-    Value = std::string(value);
+    // value may belong to this variant, so it is taken before reset.
+    Variant tmp(std::forward<T>(value));
+    Reset();
+    MoveValue(tmp);
     return *this;
   }
 
+  Variant & operator=(const char * value)
+  {
+    return *this = std::string(value);
+  }
+
   Variant & operator=(MessageId value)
   {
-    Value = NodeId(value);
-    return *this;
+    return *this = NodeId(value);
   }
 
   Variant & operator=(ReferenceId value)
   {
-    Value = NodeId(value);
-    return *this;
+    return *this = NodeId(value);
   }
 
   Variant & operator=(ObjectId value)
   {
-    Value = NodeId(value);
-    return *this;
+    return *this = NodeId(value);
   }
 
   Variant & operator=(ExpandedObjectId value)
   {
-    Value = NodeId(value);
-    return *this;
+    return *this = NodeId(value);
   }
 
 
@@ -228,7 +455,7 @@ public:
   template <typename T>
   bool operator==(const T & value) const
   {
-    return boost::any_cast<T>(Value) == value;
+    return Get<T>() == value;
   }
 
   bool operator==(const char * value) const
@@ -270,7 +497,14 @@ public:
   template <typename T>
   T As() const
   {
-    return boost::any_cast<T>(Value);
+    return Get<T>();
+  }
+
+  /// @brief Stored value without copying it, throws std::bad_cast for other types.
+  template <typename T>
+  const T & AsRef() const
+  {
+    return Get<T>();
   }
 
   template <typename T>
@@ -282,6 +516,58 @@ public:
   VariantType Type() const;
   void Visit(VariantVisitor & visitor) const;
   std::string ToString() const;
+
+private:
+  template <typename T>
+  const T & Get() const
+  {
+    static_assert(VariantTraits<T>::IsSupported, "Type cannot be stored in Variant.");
+
+    if (!Handler || Handler->Type != VariantTraits<T>::Type || Handler->IsArray != VariantTraits<T>::IsArray)
+      {
+        throw std::bad_cast();
+      }
+
+    return *VariantValueAccess<T>::Get(Value);
+  }
+
+  template <typename T>
+  void SetValue(T && value)
+  {
+    typedef typename std::decay<T>::type ValueType;
+    static_assert(VariantTraits<ValueType>::IsSupported, "Type cannot be stored in Variant.");
+
+    VariantValueAccess<ValueType>::Create(Value, std::forward<T>(value));
+    Handler = &VariantTypedHandler<ValueType>::Instance;
+  }
+
+  void CopyValue(const Variant & var)
+  {
+    if (var.Handler)
+      {
+        var.Handler->Copy(var.Value, Value);
+        Handler = var.Handler;
+      }
+  }
+
+  void MoveValue(Variant & var)
+  {
+    if (var.Handler)
+      {
+        var.Handler->Move(var.Value, Value);
+        Handler = var.Handler;
+        var.Handler = nullptr;
+      }
+  }
+
+  void Reset()
+  {
+    if (Handler)
+      {
+        Handler->Destroy(Value);
+        Handler = nullptr;
+      }
+  }
 };
 
 ObjectId VariantTypeToDataType(VariantType vt);
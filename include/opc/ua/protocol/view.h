@@ -99,6 +99,14 @@ struct BrowseResponse
 // BrowseNext
 //---------------------------------------------------
 
+struct BrowseNextParameters
+{
+  bool ReleaseContinuationPoints;
+  std::vector<std::vector<uint8_t>> ContinuationPoints;
+
+  BrowseNextParameters();
+};
+
 struct BrowseNextRequest
 {
   NodeId TypeId;
@@ -22,6 +22,7 @@
 #include <opc/common/addons_core/addon_manager.h>
 #include <opc/ua/protocol/types.h>
 #include <opc/ua/protocol/protocol.h>
+#include <opc/ua/server/address_space.h>
 
 namespace OpcUa
 {
@@ -39,6 +40,10 @@ struct Parameters
   EndpointDescription Endpoint;
   unsigned ThreadsCount = 1;
   bool Debug = false;
+  /// @brief Limits of Browse and BrowseNext services.
+  BrowseLimits Browse;
+  /// @brief Longest wait of reads for data sources in milliseconds, late items are read as BadTimeout.
+  uint32_t DataSourceTimeout = DefaultDataSourceTimeout;
 };
 
 /// @brief parameters of server.
@@ -17,6 +17,9 @@
 #include <opc/ua/services/view.h>
 #include <opc/ua/services/subscriptions.h>
 
+#include <functional>
+#include <vector>
+
 
 namespace OpcUa
 {
@@ -25,6 +28,34 @@ namespace Server
 
 typedef void DataChangeCallback(const NodeId & node, AttributeId attribute, DataValue);
 
+/// @brief Provider of attribute values kept outside of the address space, a device driver for example.
+/// All items of one Read served by the same provider are handed over in a single call.
+class DataSource : private Common::Interface
+{
+public:
+  DEFINE_CLASS_POINTERS(DataSource)
+
+  typedef std::function<void (std::vector<DataValue>)> ReadCallback;
+
+  /// @brief Read values of items and call done once with one value per item in the same order.
+  /// done can be called from any thread, before or after Read returns.
+  /// Items of a source which throws are read as BadInternalError.
+  virtual void Read(const std::vector<ReadValueId> & items, ReadCallback done) = 0;
+};
+
+/// @brief Limits of browsing the address space.
+struct BrowseLimits
+{
+  /// @brief Maximum number of continuation points kept by the address space for one session at the same time.
+  uint32_t MaxContinuationPoints = 100;
+  /// @brief Maximum number of references returned for one node in a single Browse or BrowseNext result.
+  /// Client value of RequestedMaxReferencesPerNode is used when it is smaller. 0 means no limit.
+  uint32_t MaxReferencesPerNode = 1000;
+};
+
+/// @brief Longest wait of Read and ReadAsync for data sources in milliseconds, unless configured otherwise.
+const uint32_t DefaultDataSourceTimeout = 10000;
+
 class AddressSpace
   : public ViewServices
   , public AttributeServices
@@ -34,15 +65,44 @@ class AddressSpace
 public:
   DEFINE_CLASS_POINTERS(AddressSpace)
 
+  using ViewServices::Browse;
+  using ViewServices::BrowseNext;
+
+  /// @brief Browse on behalf of session: continuation points of results are counted against
+  /// the limit of the session and can be continued or released only by the same session.
+  /// Browse without session uses continuation points of the null session.
+  virtual std::vector<BrowseResult> Browse(const NodeId & session, const NodesQuery & query) const = 0;
+  virtual std::vector<BrowseResult> BrowseNext(const NodeId & session, const BrowseNextParameters & params) const = 0;
+  /// @brief Release every continuation point of session, when the session is closed.
+  virtual void ReleaseContinuationPoints(const NodeId & session) const = 0;
+
   //Server side methods
+  /// @brief Call callback after each write of the attribute, once locks of the address space are released.
+  /// Callbacks of a node are called one at a time in order of its writes and Write returns once callbacks of its values have run.
+  /// A callback writing its own node returns before the callbacks of that write, which run after the callback returns.
+  /// Callbacks must not wait on another thread writing their node.
   virtual uint32_t AddDataChangeCallback(const NodeId & node, AttributeId attribute, std::function<DataChangeCallback> callback) = 0;
   virtual void DeleteDataChangeCallback(uint32_t clienthandle) = 0;
   virtual StatusCode SetValueCallback(const NodeId & node, AttributeId attribute, std::function<DataValue(void)> callback) = 0;
+  /// @brief Values read by a callback or a data source do not report their changes and have to be sampled.
+  virtual bool HasValueCallback(const NodeId & node, AttributeId attribute) const = 0;
+  /// @brief Values of attribute are read from source instead of the address space.
+  virtual StatusCode SetDataSource(const NodeId & node, AttributeId attribute, DataSource::SharedPtr source) = 0;
+  /// @brief Read without waiting for data sources.
+  /// done is called once with all values, by the data source completing last or before returning.
+  /// Items whose data sources do not complete within the data source timeout are read as BadTimeout,
+  /// as they are by Read, and done is then called by the thread expiring the read.
+  virtual void ReadAsync(const ReadParameters & params, DataSource::ReadCallback done) const = 0;
+  /// @brief Type and all types derived from it through HasSubtype references.
+  virtual std::vector<NodeId> GetSubtypes(const NodeId & type) const = 0;
   virtual void SetMethod(const NodeId & node, std::function<std::vector<OpcUa::Variant> (NodeId context, std::vector<OpcUa::Variant> arguments)> callback) = 0;
   //FIXME : SHould we also expose SetValue and GetValue on server side? then we need to lock them ...
 };
 
 AddressSpace::UniquePtr CreateAddressSpace(const Common::Logger::SharedPtr & logger);
+AddressSpace::UniquePtr CreateAddressSpace(const Common::Logger::SharedPtr & logger, const BrowseLimits & limits);
+/// @param dataSourceTimeout longest wait of Read and ReadAsync for data sources in milliseconds.
+AddressSpace::UniquePtr CreateAddressSpace(const Common::Logger::SharedPtr & logger, const BrowseLimits & limits, uint32_t dataSourceTimeout);
 
 } // namespace UaServer
 } // nmespace OpcUa
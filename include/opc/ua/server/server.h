@@ -10,6 +10,9 @@
 #include <opc/ua/subscription.h>
 #include <opc/ua/server_operations.h>
 
+#include <map>
+#include <mutex>
+
 namespace OpcUa
 {
 class UaServer
@@ -80,6 +83,17 @@ public:
   // most servers only send events from Server node
   void TriggerEvent(Event event);
 
+  /// @brief Trigger several events from Server node at once
+  /// Cheaper than triggering them one by one when events come in bursts.
+  /// The batch is moved down to the subscription service, pass it as an rvalue to avoid a copy.
+  void TriggerEvents(std::vector<Event> events);
+
+  /// @brief Get field layout of an event type
+  /// The layout is built from the address space on first call and shared afterwards.
+  /// Events created with it store fields of the type by slot:
+  /// Event ev(server.RegisterEventType(type));
+  EventLayout::SharedPtr RegisterEventType(const NodeId & type);
+
   /// @brief Create a subscription objects
   // returned object can then be used to subscribe to
   // datachange or custom events on server side
@@ -103,6 +117,9 @@ protected:
   Common::AddonsManager::SharedPtr Addons;
   Server::ServicesRegistry::SharedPtr Registry;
   Server::SubscriptionService::SharedPtr SubscriptionService;
+
+  std::mutex EventLayoutsMutex;
+  std::map<NodeId, EventLayout::SharedPtr> EventLayouts;
 };
 
 }
@@ -14,17 +14,60 @@
 #include <opc/ua/server/address_space.h>
 #include <opc/ua/services/subscriptions.h>
 
+#include <functional>
+#include <memory>
+#include <vector>
+
 namespace OpcUa
 {
 namespace Server
 {
 
+/// @brief Binary encoded NotificationMessage.
+/// It is encoded once and shared by the publish response and the retransmission queue.
+typedef std::shared_ptr<const std::vector<char>> EncodedNotificationMessage;
+
+/// @brief PublishResult with already encoded NotificationMessage.
+struct EncodedPublishResult
+{
+  uint32_t SubscriptionId = 0;
+  std::vector<uint32_t> AvailableSequenceNumbers;
+  bool MoreNotifications = false;
+  EncodedNotificationMessage NotificationMessage;
+  std::vector<StatusCode> Results;
+};
+
 class SubscriptionService : public SubscriptionServices
 {
 public:
   DEFINE_CLASS_POINTERS(SubscriptionService)
 
+  /// @brief Create subscription which publishes encoded notification messages.
+  /// Used by the binary protocol to send messages without encoding them again.
+  virtual SubscriptionData CreateEncodedSubscription(const CreateSubscriptionRequest & request, std::function<void (const EncodedPublishResult &)> callback) = 0;
+
+  using SubscriptionServices::Republish;
+
+  /// @brief Get a not acknowledged notification message of a subscription of the session.
+  /// Republish without a session serves in-process clients, their subscriptions are created without authentication token.
+  /// @return BadSubscriptionIdInvalid in the response header if the session has no such subscription.
+  virtual RepublishResponse Republish(const NodeId & session, const RepublishParameters & params) = 0;
+
+  /// @brief Get a not acknowledged notification message of a subscription of the session as it was sent.
+  /// @return BadSubscriptionIdInvalid if the session has no such subscription,
+  /// BadMessageNotAvailable if the message is not kept any more.
+  virtual StatusCode RepublishEncoded(const NodeId & session, const RepublishParameters & params, EncodedNotificationMessage & message) = 0;
+
+  /// @brief Limit size of not acknowledged notification messages kept by each subscription.
+  /// Oldest messages are dropped first, the latest one is always kept.
+  virtual void SetRetransmissionBudget(std::size_t bytes) = 0;
+
+  /// @brief Trigger event of the node.
+  /// Items monitoring the node or a notifier above it through HasEventSource or HasNotifier references receive it.
   virtual void TriggerEvent(NodeId node, Event event) = 0;
+  /// @brief Trigger several events of the same node at once.
+  /// Every subscription is locked once for the whole batch.
+  virtual void TriggerEvents(NodeId node, std::vector<Event> events) = 0;
 };
 
   SubscriptionService::UniquePtr CreateSubscriptionService(std::shared_ptr<AddressSpace> addressspace, boost::asio::io_service & io, const Common::Logger::SharedPtr & logger);
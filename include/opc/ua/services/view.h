@@ -28,7 +28,7 @@ public:
 
 public:
   virtual std::vector<BrowseResult> Browse(const OpcUa::NodesQuery & query) const = 0;
-  virtual std::vector<BrowseResult> BrowseNext() const = 0;
+  virtual std::vector<BrowseResult> BrowseNext(const BrowseNextParameters & params) const = 0;
   virtual std::vector<BrowsePathResult> TranslateBrowsePathsToNodeIds(const TranslateBrowsePathsParameters & params) const = 0;
   virtual std::vector<NodeId> RegisterNodes(const std::vector<NodeId> & params) const = 0;
   virtual void UnregisterNodes(const std::vector<NodeId> & params) const = 0;
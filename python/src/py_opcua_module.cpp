@@ -169,6 +169,9 @@ struct PythonStringToLocalizedTextConverter
 static std::shared_ptr<NodeId> NodeId_constructor(const std::string & encodedNodeId)
 { return std::shared_ptr<NodeId>(new NodeId(ToNodeId(encodedNodeId))); }
 
+static std::string NodeId_GetNamespaceURI(const NodeId & self)
+{ return self.GetNamespaceURI(); }
+
 static object NodeId_GetIdentifier(const NodeId & self)
 {
   if (self.IsInteger())
@@ -324,7 +327,7 @@ BOOST_PYTHON_MODULE(opcua)
                                          .add_property("is_binary", &NodeId::IsBinary)
                                          .add_property("is_guid", &NodeId::IsGuid)
                                          .add_property("is_string", &NodeId::IsString)
-                                         .def_readonly("namespace_uri", &NodeId::NamespaceURI)
+                                         .add_property("namespace_uri", &NodeId_GetNamespaceURI)
                                          .def(str(self))
                                          .def(repr(self))
                                          .def(self == self)
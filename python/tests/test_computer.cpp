@@ -134,8 +134,8 @@ public:
     const OpcUa::WriteValue & value = data[0];
     Assert(value.Attribute == OpcUa::AttributeId::Value, "Invalid id of attribute.");
     Assert(value.Node.Encoding == NodeIdEncoding::EV_STRING, "Invalid encoding of node.");
-    Assert(value.Node.StringData.NamespaceIndex == 1, "Invalid namespace of node.");
-    Assert(value.Node.StringData.Identifier == "node", "Invalid identifier of node.");
+    Assert(value.Node.GetNamespaceIndex() == 1, "Invalid namespace of node.");
+    Assert(value.Node.GetStringIdentifier() == "node", "Invalid identifier of node.");
     Assert(value.NumericRange == "1:2", "Invalid numeric range.");
     Assert(value.Data.ServerPicoseconds == 1, "Invalid ServerPicoseconds.");
     Assert(value.Data.ServerTimestamp.Value == 2, "Invalid ServerTimeStamp.");
@@ -170,9 +170,7 @@ public:
     ref.BrowseName.NamespaceIndex = 1;
     ref.DisplayName.Text = "Text";
     ref.IsForward = true;
-    ref.ReferenceTypeId.Encoding = OpcUa::NodeIdEncoding::EV_STRING;
-    ref.ReferenceTypeId.StringData.NamespaceIndex = 2;
-    ref.ReferenceTypeId.StringData.Identifier = "Identifier";
+    ref.ReferenceTypeId = OpcUa::StringNodeId("Identifier", 2);
     ref.TargetNodeClass = OpcUa::NodeClass::Variable;
     ref.TargetNodeId.Encoding = OpcUa::NodeIdEncoding::EV_FOUR_BYTE;
     ref.TargetNodeId.FourByteData.NamespaceIndex = 3;
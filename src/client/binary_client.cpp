@@ -37,46 +37,6 @@ using namespace OpcUa::Binary;
 
 typedef std::map<uint32_t, std::function<void (PublishResult)>> SubscriptionCallbackMap;
 
-class BufferInputChannel : public OpcUa::InputChannel
-{
-public:
-  BufferInputChannel(const std::vector<char> & buffer)
-    : Buffer(buffer)
-    , Pos(0)
-  {
-    Reset();
-  }
-
-  virtual std::size_t Receive(char * data, std::size_t size)
-  {
-    if (Pos >= Buffer.size())
-      {
-        return 0;
-      }
-
-    size = std::min(size, Buffer.size() - Pos);
-    std::vector<char>::const_iterator begin = Buffer.begin() + Pos;
-    std::vector<char>::const_iterator end = begin + size;
-    std::copy(begin, end, data);
-    Pos += size;
-    return size;
-  }
-
-  void Reset()
-  {
-    Pos = 0;
-  }
-
-  virtual void Stop()
-  {
-  }
-
-private:
-  const std::vector<char> & Buffer;
-  std::size_t Pos;
-};
-
-
 template <typename T>
 class RequestCallback
 {
@@ -110,8 +70,7 @@ public:
 
     else
       {
-        BufferInputChannel bufferInput(Data);
-        IStreamBinary in(bufferInput);
+        IStreamBinary in(Data.data(), Data.size());
         in >> result;
       }
 
@@ -603,8 +562,7 @@ public:
 
       else
         {
-          BufferInputChannel bufferInput(buffer);
-          IStreamBinary in(bufferInput);
+          IStreamBinary in(buffer.data(), buffer.size());
           in >> response;
         }
 
@@ -708,46 +666,21 @@ public:
     request.Header = CreateRequestHeader();
     request.Query = query;
     const BrowseResponse response = Send<BrowseResponse>(request);
-    ContinuationPoints.clear();
-
-    for (BrowseResult result : response.Results)
-      {
-        if (!result.ContinuationPoint.empty())
-          {
-            ContinuationPoints.push_back(result.ContinuationPoint);
-          }
-      }
 
     LOG_DEBUG(Logger, "binary_client         | Browse <--");
 
     return  response.Results;
   }
 
-  virtual std::vector<BrowseResult> BrowseNext() const override
+  virtual std::vector<BrowseResult> BrowseNext(const BrowseNextParameters & params) const override
   {
     LOG_DEBUG(Logger, "binary_client         | BrowseNext -->");
 
-    //FIXME: fix method interface so we do not need to decice arbitriraly if we need to send BrowseNext or not...
-    if (ContinuationPoints.empty())
-      {
-        LOG_DEBUG(Logger, "binary_client         | BrowseNext <-- no Continuation point, no need to send browse next request");
-
-        return std::vector<BrowseResult>();
-      }
-
     BrowseNextRequest request;
-    request.ReleaseContinuationPoints = ContinuationPoints.empty() ? true : false;
-    request.ContinuationPoints = ContinuationPoints;
+    request.Header = CreateRequestHeader();
+    request.ReleaseContinuationPoints = params.ReleaseContinuationPoints;
+    request.ContinuationPoints = params.ContinuationPoints;
     const BrowseNextResponse response = Send<BrowseNextResponse>(request);
-    ContinuationPoints.clear();
-
-    for (auto result : response.Results)
-      {
-        if (!result.ContinuationPoint.empty())
-          {
-            ContinuationPoints.push_back(result.ContinuationPoint);
-          }
-      }
 
     LOG_DEBUG(Logger, "binary_client         | BrowseNext <--");
 
@@ -805,16 +738,6 @@ public:
     LOG_DEBUG(Logger, "binary_client         | UnregisterNodes <--");
   }
 
-private:
-  //FIXME: this method should be removed, better add realease option to BrowseNext
-  void Release() const
-  {
-    ContinuationPoints.clear();
-    BrowseNext();
-  }
-
-public:
-
   ////////////////////////////////////////////////////////////////
   /// SecureChannel Services
   ////////////////////////////////////////////////////////////////
@@ -1002,14 +925,13 @@ private:
   void parseMessage(std::size_t & dataSize, NodeId & id)
   {
     std::vector<char> buffer(dataSize);
-    BufferInputChannel bufferInput(buffer);
     Binary::RawBuffer raw(&buffer[0], dataSize);
     Stream >> raw;
     LOG_TRACE(Logger, "binary_client         | received message data: {}", ToHexDump(buffer));
 
     if (!firstMsgParsed)
       {
-        IStreamBinary in(bufferInput);
+        IStreamBinary in(buffer.data(), buffer.size());
         in >> id;
         in >> header;
 
@@ -1112,7 +1034,6 @@ private:
   mutable std::atomic<uint32_t> RequestNumber;
   ExpandedNodeId AuthenticationToken;
   mutable std::atomic<uint32_t> RequestHandle;
-  mutable std::vector<std::vector<uint8_t>> ContinuationPoints;
   mutable CallbackMap Callbacks;
   Common::Logger::SharedPtr Logger;
   bool Finished = false;
@@ -228,18 +228,18 @@ void Print(const OpcUa::NodeId & nodeId, const Tabs & tabs)
     case OpcUa::NodeIdEncoding::EV_STRING:
     {
       std::cout << tabs << "String: " << std::endl;
-      std::cout << dataTabs << "NamespaceIndex: " << (unsigned)nodeId.StringData.NamespaceIndex << std::endl;
-      std::cout << dataTabs << "Identifier: " <<  nodeId.StringData.Identifier << std::endl;
+      std::cout << dataTabs << "NamespaceIndex: " << (unsigned)nodeId.GetNamespaceIndex() << std::endl;
+      std::cout << dataTabs << "Identifier: " <<  nodeId.GetStringIdentifier() << std::endl;
       break;
     }
 
     case OpcUa::NodeIdEncoding::EV_BYTE_STRING:
     {
       std::cout << tabs << "Binary: " << std::endl;
-      std::cout << dataTabs << "NamespaceIndex: " << (unsigned)nodeId.BinaryData.NamespaceIndex << std::endl;
+      std::cout << dataTabs << "NamespaceIndex: " << (unsigned)nodeId.GetNamespaceIndex() << std::endl;
       std::cout << dataTabs << "Identifier: ";
 
-      for (auto val : nodeId.BinaryData.Identifier) {std::cout << (unsigned)val; }
+      for (auto val : nodeId.GetBinaryIdentifier()) {std::cout << (unsigned)val; }
 
       std::cout << std::endl;
       break;
@@ -248,8 +248,8 @@ void Print(const OpcUa::NodeId & nodeId, const Tabs & tabs)
     case OpcUa::NodeIdEncoding::EV_GUId:
     {
       std::cout << tabs << "Guid: " << std::endl;
-      std::cout << dataTabs << "Namespace Index: " << (unsigned)nodeId.GuidData.NamespaceIndex << std::endl;
-      const OpcUa::Guid & guid = nodeId.GuidData.Identifier;
+      std::cout << dataTabs << "Namespace Index: " << (unsigned)nodeId.GetNamespaceIndex() << std::endl;
+      const OpcUa::Guid & guid = nodeId.GetGuidIdentifier();
       std::cout << dataTabs << "Identifier: " << std::hex << guid.Data1 << "-" << guid.Data2 << "-" << guid.Data3;
 
       for (auto val : guid.Data4) {std::cout << (unsigned)val; }
@@ -266,12 +266,12 @@ void Print(const OpcUa::NodeId & nodeId, const Tabs & tabs)
 
   if (nodeId.Encoding & OpcUa::NodeIdEncoding::EV_NAMESPACE_URI_FLAG)
     {
-      std::cout << tabs << "Namespace URI: " << nodeId.NamespaceURI << std::endl;
+      std::cout << tabs << "Namespace URI: " << nodeId.GetNamespaceURI() << std::endl;
     }
 
   if (nodeId.Encoding & OpcUa::NodeIdEncoding::EV_Server_INDEX_FLAG)
     {
-      std::cout << tabs << "Server index: " << nodeId.ServerIndex << std::endl;
+      std::cout << tabs << "Server index: " << nodeId.GetServerIndex() << std::endl;
     }
 }
 
@@ -413,7 +413,14 @@ void Browse(OpcUa::ViewServices & view, OpcUa::NodeId nodeId)
           std::cout << std::endl;
         }
 
-      results = view.BrowseNext();
+      if (results[0].ContinuationPoint.empty())
+        {
+          break;
+        }
+
+      OpcUa::BrowseNextParameters next;
+      next.ContinuationPoints.push_back(results[0].ContinuationPoint);
+      results = view.BrowseNext(next);
     }
 }
 
@@ -1,12 +1,82 @@
 
-#include <iostream> //Debug
-
 #include <opc/ua/event.h>
 #include <opc/ua/protocol/string_utils.h>
 
+namespace
+{
+using namespace OpcUa;
+
+void AddVariables(const Node & node, const std::vector<QualifiedName> & prefix, std::vector<std::vector<QualifiedName>> & fields)
+{
+  std::vector<Node> children = node.GetChildren(ReferenceId::HasProperty);
+  std::vector<Node> components = node.GetChildren(ReferenceId::HasComponent);
+  children.insert(children.end(), components.begin(), components.end());
+
+  for (const Node & child : children)
+    {
+      if (child.GetNodeClass() != NodeClass::Variable)
+        {
+          continue;
+        }
+
+      std::vector<QualifiedName> path = prefix;
+      path.push_back(child.GetBrowseName());
+      fields.push_back(path);
+      // properties of variables, like Id of a state variable, are fields too
+      AddVariables(child, path, fields);
+    }
+}
+}
+
 namespace OpcUa
 {
 
+EventLayout::EventLayout(const NodeId & type, const std::vector<std::vector<QualifiedName>> & fields)
+  : EventType(type)
+{
+  for (const std::vector<QualifiedName> & field : fields)
+    {
+      if (Slots.insert(std::make_pair(field, Fields.size())).second)
+        {
+          Fields.push_back(field);
+        }
+    }
+}
+
+EventLayout::SharedPtr EventLayout::Create(const Node & type)
+{
+  // BaseEventType is not walked: its fields are members of Event
+  std::vector<Node> types;
+  Node current = type;
+
+  while (!current.GetId().IsNull() && current.GetId() != ObjectId::BaseEventType && current.GetNodeClass() == NodeClass::ObjectType)
+    {
+      types.push_back(current);
+      current = current.GetParent();
+    }
+
+  // fields of supertypes come first, redefinitions in subtypes keep their slot
+  std::vector<std::vector<QualifiedName>> fields;
+
+  for (auto it = types.rbegin(); it != types.rend(); ++it)
+    {
+      AddVariables(*it, std::vector<QualifiedName>(), fields);
+    }
+
+  return std::make_shared<EventLayout>(type.GetId(), fields);
+}
+
+int32_t EventLayout::GetSlot(const std::vector<QualifiedName> & path) const
+{
+  auto it = Slots.find(path);
+  return it == Slots.end() ? -1 : static_cast<int32_t>(it->second);
+}
+
+int32_t EventLayout::GetSlot(const std::string & qualifiedname) const
+{
+  return GetSlot(std::vector<QualifiedName>({ToQualifiedName(qualifiedname)}));
+}
+
 Event::Event() : EventType(ObjectId::BaseEventType)
 {
 }
@@ -15,10 +85,25 @@ Event::Event(const NodeId & type) : EventType(type) {}
 
 Event::Event(const Node & type) : EventType(type.GetId()) {}
 
+Event::Event(const EventLayout::SharedPtr & layout)
+  : EventType(layout->GetEventType())
+  , Layout(layout)
+  , SlotValues(layout->Size())
+{
+}
+
 std::vector<std::vector<QualifiedName>> Event::GetValueKeys()
 {
   std::vector<std::vector<QualifiedName>> qns;
 
+  for (std::size_t slot = 0; slot < SlotValues.size(); ++slot)
+    {
+      if (!SlotValues[slot].IsNul())
+        {
+          qns.push_back(Layout->GetFields()[slot]);
+        }
+    }
+
   for (auto qn : PathValues)
     {
       qns.push_back(qn.first);
@@ -34,6 +119,14 @@ void Event::SetValue(const QualifiedName & path, Variant value)
 
 void Event::SetValue(const std::vector<QualifiedName> & path, Variant value)
 {
+  int32_t slot = Layout ? Layout->GetSlot(path) : -1;
+
+  if (slot >= 0)
+    {
+      SlotValues[slot] = value;
+      return;
+    }
+
   PathValues[path] = value;
 }
 
@@ -56,25 +149,22 @@ Variant Event::GetValue(const QualifiedName & path) const
 
 Variant Event::GetValue(const std::vector<QualifiedName> & path) const
 {
-  PathMap::const_iterator it = PathValues.find(path);
-  std::cout << "Looking for Event value: ";
+  int32_t slot = Layout ? Layout->GetSlot(path) : -1;
 
-  for (auto qn : path)
+  if (slot >= 0)
     {
-      std::cout << qn ;
+      return SlotValues[slot];
     }
 
-  std::cout << std::endl;
+  PathMap::const_iterator it = PathValues.find(path);
 
   if (it == PathValues.end())
     {
-      std::cout << "Bad Not found " << std::endl;
       return Variant();
     }
 
   else
     {
-      std::cout << "ok" << std::endl;
       return it->second;
     }
 }
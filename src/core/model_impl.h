@@ -21,6 +21,8 @@
 
 #include <opc/ua/model.h>
 
+#include <algorithm>
+
 namespace OpcUa
 {
 namespace Model
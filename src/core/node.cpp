@@ -158,25 +158,25 @@ void Node::_GetChildren(const ReferenceId & refid, std::vector<Node>& nodes) con
   query.MaxReferenciesPerNode = 100;
   std::vector<BrowseResult> results = Server->Views()->Browse(query);
 
-  if (results.empty())
+  // Server returns references page by page, every next page is requested
+  // with continuation point of the previous one until it is exhausted.
+  while (!results.empty())
     {
-      return;
-    }
+      const BrowseResult & result = results[0];
 
-  while (!results[0].Referencies.empty())
-    {
-      for (auto refIt : results[0].Referencies)
+      for (const ReferenceDescription & ref : result.Referencies)
         {
-          Node node(Server, refIt.TargetNodeId);
-          nodes.push_back(node);
+          nodes.push_back(Node(Server, ref.TargetNodeId));
         }
 
-      results = Server->Views()->BrowseNext();
-
-      if (results.empty())
+      if (result.ContinuationPoint.empty())
         {
           return;
         }
+
+      BrowseNextParameters next;
+      next.ContinuationPoints.push_back(result.ContinuationPoint);
+      results = Server->Views()->BrowseNext(next);
     }
 }
 
@@ -195,13 +195,22 @@ Node Node::GetParent() const
 
   NodesQuery query;
   query.NodesToBrowse.push_back(description);
-  query.MaxReferenciesPerNode = 100;
+  query.MaxReferenciesPerNode = 1;
   std::vector<BrowseResult> results = Server->Views()->Browse(query);
 
   if (results.empty())
     {
       return Node();
     }
+
+  if (!results[0].ContinuationPoint.empty())
+    {
+      BrowseNextParameters release;
+      release.ReleaseContinuationPoints = true;
+      release.ContinuationPoints.push_back(results[0].ContinuationPoint);
+      Server->Views()->BrowseNext(release);
+    }
+
   if (!results[0].Referencies.empty())
     {
       for (auto refIt : results[0].Referencies)
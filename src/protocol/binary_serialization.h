@@ -11,12 +11,37 @@
 #ifndef __OPC_UA_BINARY_SERIALIZATION_TOOLS_H__
 #define __OPC_UA_BINARY_SERIALIZATION_TOOLS_H__
 
+#include <opc/ua/protocol/binary/stream.h>
+
 #include <algorithm>
 #include <stdint.h>
+#include <type_traits>
+#include <vector>
 
 
 namespace OpcUa
 {
+
+/// @brief Numbers which are stored in memory of little endian host exactly as on the wire.
+template <typename T>
+struct is_wire_number : std::integral_constant < bool,
+  std::is_arithmetic<T>::value && !std::is_same<T, bool>::value >
+{
+};
+
+template <typename T>
+inline void ByteSwap(T & value)
+{
+  char * bytes = reinterpret_cast<char *>(&value);
+  std::reverse(bytes, bytes + sizeof(T));
+}
+
+inline bool IsBigEndianHost()
+{
+  const uint16_t word = 1;
+  return *reinterpret_cast<const uint8_t *>(&word) == 0;
+}
+
 template<class Stream, class Container>
 inline void SerializeContainer(Stream & out, const Container & c, uint32_t emptySizeValue = ~uint32_t())
 {
@@ -32,6 +57,29 @@ inline void SerializeContainer(Stream & out, const Container & c, uint32_t empty
     }
 }
 
+/// @brief Arrays of numbers are copied with a single memcpy.
+template<class Stream, class T>
+inline typename std::enable_if<is_wire_number<T>::value>::type SerializeContainer(Stream & out, const std::vector<T> & c, uint32_t emptySizeValue = ~uint32_t())
+{
+  if (c.empty())
+    {
+      out.Serialize(emptySizeValue);
+      return;
+    }
+
+  out.Serialize(static_cast<uint32_t>(c.size()));
+
+  if (sizeof(T) > 1 && IsBigEndianHost())
+    {
+      std::vector<T> swapped(c);
+      std::for_each(swapped.begin(), swapped.end(), ByteSwap<T>);
+      out.Serialize(Binary::RawMessage(reinterpret_cast<const char *>(swapped.data()), swapped.size() * sizeof(T)));
+      return;
+    }
+
+  out.Serialize(Binary::RawMessage(reinterpret_cast<const char *>(c.data()), c.size() * sizeof(T)));
+}
+
 template<class Stream, class Container>
 inline void DeserializeContainer(Stream & in, Container & c)
 {
@@ -52,6 +100,39 @@ inline void DeserializeContainer(Stream & in, Container & c)
       c.push_back(val);
     }
 }
+
+/// @brief Arrays of numbers are read directly into the vector storage.
+/// Storage grows by blocks as data arrives, so a corrupted array size cannot allocate huge memory at once.
+template<class Stream, class T>
+inline typename std::enable_if<is_wire_number<T>::value>::type DeserializeContainer(Stream & in, std::vector<T> & c)
+{
+  uint32_t size = 0;
+  in.Deserialize(size);
+
+  c.clear();
+
+  if (!size || size == ~uint32_t())
+    {
+      return;
+    }
+
+  const std::size_t blockSize = 65536 / sizeof(T);
+  std::size_t received = 0;
+
+  while (received < size)
+    {
+      const std::size_t count = std::min<std::size_t>(size - received, blockSize);
+      c.resize(received + count);
+      Binary::RawBuffer raw(reinterpret_cast<char *>(&c[received]), count * sizeof(T));
+      in.Deserialize(raw);
+      received += count;
+    }
+
+  if (sizeof(T) > 1 && IsBigEndianHost())
+    {
+      std::for_each(c.begin(), c.end(), ByteSwap<T>);
+    }
+}
 }
 
 #endif // __OPC_UA_BINARY_SERIALIZATION_TOOLS_H__
@@ -15,8 +15,8 @@
 #include <opc/ua/protocol/binary/stream.h>
 
 #include <algorithm>
-#include <iostream>
 #include <stdexcept>
+#include <string>
 
 #ifdef _WIN32
 #include <WinSock2.h>
@@ -31,7 +31,6 @@ namespace
  * not used
  *
 float float_htonl(float value){
-  std::cout << "sizez: " << sizeof(float) << "  " << sizeof(uint32_t) << std::endl;
   union v {
       float       f;
       uint32_t    i;
@@ -126,25 +125,6 @@ const char MESSAGE_TYPE_MESSAGE[MESSAGE_TYPE_SIZE]     = {'M', 'S', 'G'};
 const char MESSAGE_TYPE_OPEN[MESSAGE_TYPE_SIZE]        = {'O', 'P', 'N'};
 const char MESSAGE_TYPE_CLOSE[MESSAGE_TYPE_SIZE]       = {'C', 'L', 'O'};
 
-inline void ThrowReceivedNotEnoughData()
-{
-  throw std::logic_error("Not enough data was received from channel.");
-}
-
-
-template <typename ChannelType>
-inline void GetData(ChannelType & channel, char * data, std::size_t size)
-{
-  size_t recv = channel.Read(data, size);
-
-  if (recv != size)
-    {
-      std::cout << "expecting " << size << "  received: " << recv << std::endl;
-      ThrowReceivedNotEnoughData();
-    }
-}
-
-
 } // namespace
 
 
@@ -212,6 +192,39 @@ IntegerId::operator uint32_t() const
 namespace Binary
 {
 
+void DataSerializer::PatchMessageSize()
+{
+  // Size field follows message type and chunk type in both Header and SecureHeader.
+  const std::size_t sizePos = MessageStart + MESSAGE_TYPE_SIZE + 1;
+
+  if (Buffer.size() < sizePos + sizeof(uint32_t))
+    {
+      throw std::logic_error("Message header was not serialized.");
+    }
+
+  const uint32_t size = static_cast<uint32_t>(Buffer.size() - MessageStart);
+  Buffer[sizePos]     = LoByte(LoWord(size));
+  Buffer[sizePos + 1] = HiByte(LoWord(size));
+  Buffer[sizePos + 2] = LoByte(HiWord(size));
+  Buffer[sizePos + 3] = HiByte(HiWord(size));
+  SizePending = false;
+}
+
+void DataDeserializer::ReadFromSupplier(char * data, std::size_t size)
+{
+  const std::size_t recv = In->Read(data, size);
+
+  if (recv != size)
+    {
+      ThrowNotEnoughData(size, recv);
+    }
+}
+
+void DataDeserializer::ThrowNotEnoughData(std::size_t expected, std::size_t received)
+{
+  throw std::logic_error("Not enough data was received from channel: expecting " + std::to_string(expected) + " bytes, received " + std::to_string(received) + ".");
+}
+
 template<>
 void DataSerializer::Serialize<int8_t>(const int8_t & value)
 {
@@ -234,7 +247,7 @@ template<>
 void DataDeserializer::Deserialize<uint8_t>(uint8_t & value)
 {
   char data = 0;
-  GetData(In, &data, 1);
+  GetData(&data, 1);
   value = static_cast<uint8_t>(data);
 }
 
@@ -242,7 +255,7 @@ template<>
 void DataDeserializer::Deserialize<int8_t>(int8_t & value)
 {
   char data = 0;
-  GetData(In, &data, 1);
+  GetData(&data, 1);
   value = data;
 }
 
@@ -271,7 +284,7 @@ template<>
 void DataDeserializer::Deserialize<uint16_t>(uint16_t & value)
 {
   char data[2] = {0};
-  GetData(In, data, 2);
+  GetData(data, 2);
   value = MakeWord<uint16_t>(data[0], data[1]);
 }
 
@@ -279,7 +292,7 @@ template<>
 void DataDeserializer::Deserialize<int16_t>(int16_t & value)
 {
   char data[2] = {0};
-  GetData(In, data, 2);
+  GetData(data, 2);
   value = MakeWord<int16_t>(data[0], data[1]);
 }
 
@@ -301,7 +314,7 @@ template<>
 void DataDeserializer::Deserialize<uint32_t>(uint32_t & value)
 {
   char data[4] = {0};
-  GetData(In, data, 4);
+  GetData(data, 4);
   value = MakeNumber<uint32_t>(data);
 }
 
@@ -309,7 +322,7 @@ template<>
 void DataDeserializer::Deserialize<int32_t>(int32_t & value)
 {
   char data[4] = {0};
-  GetData(In, data, 4);
+  GetData(data, 4);
   value = MakeNumber<int32_t>(data);
 }
 
@@ -331,7 +344,7 @@ template<>
 void DataDeserializer::Deserialize<uint64_t>(uint64_t & value)
 {
   char data[8] = {0};
-  GetData(In, data, 8);
+  GetData(data, 8);
   value = MakeNumber<uint64_t>(data);
 }
 
@@ -339,7 +352,7 @@ template<>
 void DataDeserializer::Deserialize<int64_t>(int64_t & value)
 {
   char data[8] = {0};
-  GetData(In, data, 8);
+  GetData(data, 8);
   value = MakeNumber<int64_t>(data);
 }
 
@@ -385,15 +398,7 @@ void DataSerializer::Serialize<float>(const float & value)
 template<>
 void DataDeserializer::Deserialize<float>(float & value)
 {
-  //float network_value = float_htonl(value);
-  uint8_t data[4] = {0};
-
-  for (int i = 0; i < 4; ++i)
-    {
-      *this >> data[i];
-    }
-
-  value = *reinterpret_cast<const float *>(data); // FIXME: probably broken on ARM
+  GetData(reinterpret_cast<char *>(&value), sizeof(value));
 }
 
 template<>
@@ -410,14 +415,7 @@ void DataSerializer::Serialize<double>(const double & value)
 template<>
 void DataDeserializer::Deserialize<double>(double & value)
 {
-  uint8_t data[8] = {0};
-
-  for (int i = 0; i < 8; ++i)
-    {
-      *this >> data[i];
-    }
-
-  value = *reinterpret_cast<const double *>(data); //FIXME: probably broken on ARM
+  GetData(reinterpret_cast<char *>(&value), sizeof(value));
 }
 
 template<>
@@ -432,7 +430,7 @@ void DataDeserializer::Deserialize<OpcUa::Guid>(OpcUa::Guid & value)
 {
   *this >> value.Data1 >> value.Data2 >> value.Data3;
   char data[8] = {0};
-  GetData(In, data, 8);
+  GetData(data, 8);
   std::copy(data, data + 8, value.Data4);
 }
 
@@ -455,10 +453,11 @@ void DataDeserializer::Deserialize<std::string>(std::string & value)
   uint32_t stringSize = 0;
   *this >> stringSize;
 
-  if (stringSize != ~uint32_t())
+  if (stringSize != ~uint32_t() && stringSize != 0)
     {
+      CheckRemainSize(stringSize);
       value.resize(stringSize);
-      GetData(In, &value[0], stringSize);
+      GetData(&value[0], stringSize);
       return;
     }
 
@@ -523,10 +522,11 @@ void DataDeserializer::Deserialize<ByteString>(ByteString & value)
   uint32_t stringSize = 0;
   *this >> stringSize;
 
-  if (stringSize != ~uint32_t())
+  if (stringSize != ~uint32_t() && stringSize != 0)
     {
+      CheckRemainSize(stringSize);
       value.Data.resize(stringSize);
-      GetData(In, reinterpret_cast<char *>(&value.Data[0]), stringSize);
+      GetData(reinterpret_cast<char *>(&value.Data[0]), stringSize);
       return;
     }
 
@@ -749,7 +749,7 @@ template<>
 void DataDeserializer::Deserialize<OpcUa::Binary::MessageType>(OpcUa::Binary::MessageType & value)
 {
   char data[MESSAGE_TYPE_SIZE] = {0};
-  GetData(In, data, MESSAGE_TYPE_SIZE);
+  GetData(data, MESSAGE_TYPE_SIZE);
 
   if (std::equal(data, data + MESSAGE_TYPE_SIZE, MESSAGE_TYPE_HELLO))
     {
@@ -816,7 +816,7 @@ template<>
 void DataDeserializer::Deserialize<OpcUa::Binary::ChunkType>(OpcUa::Binary::ChunkType & value)
 {
   char data = 0;
-  GetData(In, &data, 1);
+  GetData(&data, 1);
 
   switch (data)
     {
@@ -1225,7 +1225,7 @@ void DataSerializer::Serialize<OpcUa::Binary::RawMessage>(const OpcUa::Binary::R
 template<>
 void DataDeserializer::Deserialize<OpcUa::Binary::RawBuffer>(OpcUa::Binary::RawBuffer & raw)
 {
-  GetData(In, raw.Data, raw.Size);
+  GetData(raw.Data, raw.Size);
 }
 
 template<>
@@ -182,11 +182,6 @@ struct VariantDeserializer
   }
 };
 
-template<typename T>
-bool Compare(const Variant & lhs, const Variant & rhs)
-{
-  return lhs.As<T>() == rhs.As<T>();
-}
 }
 
 namespace OpcUa
@@ -197,157 +192,18 @@ namespace OpcUa
 
 bool Variant::operator== (const Variant & var) const
 {
-  if (Value.empty() ^ var.Value.empty())
+  // a template handler may have an instance in every shared object, so compare what it describes
+  if (Type() != var.Type() || IsArray() != var.IsArray())
     {
       return false;
     }
 
-  if (Value.empty() && var.Value.empty())
+  if (!Handler)
     {
       return true;
     }
 
-  if (Value.type() != var.Value.type())
-    {
-      return false;
-    }
-
-  using namespace boost;
-  const std::type_info & t = Value.type();
-
-  if (t == typeid(bool))
-    { return Compare<bool>(*this, var); }
-
-  else if (t == typeid(std::vector<bool>))
-    { return Compare<std::vector<bool>>(*this, var); }
-
-  else if (t == typeid(int8_t))
-    { return Compare<int8_t>(*this, var); }
-
-  else if (t == typeid(std::vector<int8_t>))
-    { return Compare<std::vector<int8_t>>(*this, var); }
-
-  else if (t == typeid(uint8_t))
-    { return Compare<uint8_t>(*this, var); }
-
-  else if (t == typeid(std::vector<uint8_t>))
-    { return Compare<std::vector<uint8_t>>(*this, var); }
-
-  else if (t == typeid(int16_t))
-    { return Compare<int16_t>(*this, var); }
-
-  else if (t == typeid(std::vector<int16_t>))
-    { return Compare<std::vector<int16_t>>(*this, var); }
-
-  else if (t == typeid(uint16_t))
-    { return Compare<uint16_t>(*this, var); }
-
-  else if (t == typeid(std::vector<uint16_t>))
-    { return Compare<std::vector<uint16_t>>(*this, var); }
-
-  else if (t == typeid(int32_t))
-    { return Compare<int32_t>(*this, var); }
-
-  else if (t == typeid(std::vector<int32_t>))
-    { return Compare<std::vector<int32_t>>(*this, var); }
-
-  else if (t == typeid(uint32_t))
-    { return Compare<uint32_t>(*this, var); }
-
-  else if (t == typeid(std::vector<uint32_t>))
-    { return Compare<std::vector<uint32_t>>(*this, var); }
-
-  else if (t == typeid(int64_t))
-    { return Compare<int64_t>(*this, var); }
-
-  else if (t == typeid(std::vector<int64_t>))
-    { return Compare<std::vector<int64_t>>(*this, var); }
-
-  else if (t == typeid(uint64_t))
-    { return Compare<uint64_t>(*this, var); }
-
-  else if (t == typeid(std::vector<uint64_t>))
-    { return Compare<std::vector<uint64_t>>(*this, var); }
-
-  else if (t == typeid(float))
-    { return Compare<float>(*this, var); }
-
-  else if (t == typeid(std::vector<float>))
-    { return Compare<std::vector<float>>(*this, var); }
-
-  else if (t == typeid(double))
-    { return Compare<double>(*this, var); }
-
-  else if (t == typeid(std::vector<double>))
-    { return Compare<std::vector<double>>(*this, var); }
-
-  else if (t == typeid(std::string))
-    { return Compare<std::string>(*this, var); }
-
-  else if (t == typeid(std::vector<std::string>))
-    { return Compare<std::vector<std::string>>(*this, var); }
-
-  else if (t == typeid(DateTime))
-    { return Compare<DateTime>(*this, var); }
-
-  else if (t == typeid(std::vector<DateTime>))
-    { return Compare<std::vector<DateTime>>(*this, var); }
-
-  else if (t == typeid(Guid))
-    { return Compare<Guid>(*this, var); }
-
-  else if (t == typeid(std::vector<Guid>))
-    { return Compare<std::vector<Guid>>(*this, var); }
-
-  else if (t == typeid(ByteString))
-    { return Compare<ByteString>(*this, var); }
-
-  else if (t == typeid(std::vector<ByteString>))
-    { return Compare<std::vector<ByteString>>(*this, var); }
-
-  else if (t == typeid(NodeId))
-    { return Compare<NodeId>(*this, var); }
-
-  else if (t == typeid(std::vector<NodeId>))
-    { return Compare<std::vector<NodeId>>(*this, var); }
-
-  else if (t == typeid(StatusCode))
-    { return Compare<StatusCode>(*this, var); }
-
-  else if (t == typeid(std::vector<StatusCode>))
-    { return Compare<std::vector<StatusCode>>(*this, var); }
-
-  else if (t == typeid(LocalizedText))
-    { return Compare<LocalizedText>(*this, var); }
-
-  else if (t == typeid(std::vector<LocalizedText>))
-    { return Compare<std::vector<LocalizedText>>(*this, var); }
-
-  else if (t == typeid(QualifiedName))
-    { return Compare<QualifiedName>(*this, var); }
-
-  else if (t == typeid(std::vector<QualifiedName>))
-    { return Compare<std::vector<QualifiedName>>(*this, var); }
-
-  /*
-      else if (t == typeid(DataValue))
-        return Compare<DataValue>(*this, Value);
-      else if (t == typeid(std::vector<DataValue>))
-        return Compare<std::vector<DataValue>>(*this, var);
-  */
-  else if (t == typeid(Variant))
-    { return Compare<Variant>(*this, var); }
-
-  else if (t == typeid(std::vector<Variant>))
-    { return Compare<std::vector<Variant>>(*this, var); }
-
-  else if (t == typeid(DiagnosticInfo))
-    { return Compare<DiagnosticInfo>(*this, var); }
-
-  else if (t == typeid(std::vector<DiagnosticInfo>))
-    { return Compare<std::vector<DiagnosticInfo>>(*this, var); }
-
-  throw std::logic_error(std::string("Unknown variant type '") + t.name() + std::string("'."));
+  return Handler->Equal(Value, var.Value);
 }
 
 bool Variant::IsScalar() const
@@ -357,254 +213,47 @@ bool Variant::IsScalar() const
 
 bool Variant::IsNul() const
 {
-  return Value.empty();
+  return Handler == nullptr;
 }
 
 bool Variant::IsArray() const
 {
-  const std::type_info & t = Value.type();
-  return
-    (t == typeid(std::vector<bool>))       ||
-    (t == typeid(std::vector<int8_t>))     ||
-    (t == typeid(std::vector<uint8_t>))    ||
-    (t == typeid(std::vector<int16_t>))    ||
-    (t == typeid(std::vector<uint16_t>))   ||
-    (t == typeid(std::vector<int32_t>))    ||
-    (t == typeid(std::vector<uint32_t>))   ||
-    (t == typeid(std::vector<int64_t>))    ||
-    (t == typeid(std::vector<uint64_t>))   ||
-    (t == typeid(std::vector<float>))      ||
-    (t == typeid(std::vector<double>))     ||
-    (t == typeid(std::vector<std::string>)) ||
-    (t == typeid(std::vector<DateTime>))   ||
-    (t == typeid(std::vector<Guid>))       ||
-    (t == typeid(std::vector<ByteString>)) ||
-    (t == typeid(std::vector<NodeId>))     ||
-    (t == typeid(std::vector<StatusCode>)) ||
-    (t == typeid(std::vector<LocalizedText>)) ||
-    (t == typeid(std::vector<QualifiedName>)) ||
-//    (t == typeid(std::vector<DataValue>))  ||
-    (t == typeid(std::vector<Variant>))    ||
-    (t == typeid(std::vector<DiagnosticInfo>));
+  return Handler && Handler->IsArray;
 }
 
 VariantType Variant::Type() const
 {
-  if (Value.empty())
-    { return VariantType::NUL; }
-
-  const std::type_info & t = Value.type();
-
-  if (t == typeid(bool) || t == typeid(std::vector<bool>))
-    { return VariantType::BOOLEAN; }
-
-  else if (t == typeid(int8_t) || t == typeid(std::vector<int8_t>))
-    { return VariantType::SBYTE; }
-
-  else if (t == typeid(uint8_t) || t == typeid(std::vector<uint8_t>))
-    { return VariantType::BYTE; }
-
-  else if (t == typeid(int16_t) || t == typeid(std::vector<int16_t>))
-    { return VariantType::INT16; }
-
-  else if (t == typeid(uint16_t) || t == typeid(std::vector<uint16_t>))
-    { return VariantType::UINT16; }
-
-  else if (t == typeid(int32_t) || t == typeid(std::vector<int32_t>))
-    { return VariantType::INT32; }
-
-  else if (t == typeid(uint32_t) || t == typeid(std::vector<uint32_t>))
-    { return VariantType::UINT32; }
-
-  else if (t == typeid(int64_t) || t == typeid(std::vector<int64_t>))
-    { return VariantType::INT64; }
-
-  else if (t == typeid(uint64_t) || t == typeid(std::vector<uint64_t>))
-    { return VariantType::UINT64; }
-
-  else if (t == typeid(float) || t == typeid(std::vector<float>))
-    { return VariantType::FLOAT; }
-
-  else if (t == typeid(double) || t == typeid(std::vector<double>))
-    { return VariantType::DOUBLE; }
-
-  else if (t == typeid(std::string) || t == typeid(std::vector<std::string>))
-    { return VariantType::STRING; }
-
-  else if (t == typeid(DateTime) || t == typeid(std::vector<DateTime>))
-    { return VariantType::DATE_TIME; }
-
-  else if (t == typeid(Guid) || t == typeid(std::vector<Guid>))
-    { return VariantType::GUId; }
-
-  else if (t == typeid(ByteString) || t == typeid(std::vector<ByteString>))
-    { return VariantType::BYTE_STRING; }
-
-  else if (t == typeid(NodeId) || t == typeid(std::vector<NodeId>))
-    { return VariantType::NODE_Id; }
-
-  else if (t == typeid(StatusCode) || t == typeid(std::vector<StatusCode>))
-    { return VariantType::STATUS_CODE; }
-
-  else if (t == typeid(LocalizedText) || t == typeid(std::vector<LocalizedText>))
-    { return VariantType::LOCALIZED_TEXT; }
-
-  else if (t == typeid(QualifiedName) || t == typeid(std::vector<QualifiedName>))
-    { return VariantType::QUALIFIED_NAME; }
-
-  /*
-      else if (t == typeid(DataValue) || t == typeid(std::vector<DataValue>))
-        return VariantType::DATA_VALUE;
-  */
-  else if (t == typeid(Variant) || t == typeid(std::vector<Variant>))
-    { return VariantType::VARIANT; }
-
-  else if (t == typeid(DiagnosticInfo) || t == typeid(std::vector<DiagnosticInfo>))
-    { return VariantType::DIAGNOSTIC_INFO; }
-
-  throw std::runtime_error(std::string("Unknown variant type '") + t.name() + "'.");
+  return Handler ? Handler->Type : VariantType::NUL;
 }
 
-
 void Variant::Visit(VariantVisitor & visitor) const
 {
-  using namespace boost;
-  const std::type_info & t = Value.type();
-
-  if (t == typeid(bool))
-    { visitor.Visit(any_cast<bool>(Value)); }
-
-  else if (t == typeid(std::vector<bool>))
-    { visitor.Visit(any_cast<std::vector<bool>>(Value)); }
-
-  else if (t == typeid(int8_t))
-    { visitor.Visit(any_cast<int8_t>(Value)); }
-
-  else if (t == typeid(std::vector<int8_t>))
-    { visitor.Visit(any_cast<std::vector<int8_t>>(Value)); }
-
-  else if (t == typeid(uint8_t))
-    { visitor.Visit(any_cast<uint8_t>(Value)); }
-
-  else if (t == typeid(std::vector<uint8_t>))
-    { visitor.Visit(any_cast<std::vector<uint8_t>>(Value)); }
-
-  else if (t == typeid(int16_t))
-    { visitor.Visit(any_cast<int16_t>(Value)); }
-
-  else if (t == typeid(std::vector<int16_t>))
-    { visitor.Visit(any_cast<std::vector<int16_t>>(Value)); }
-
-  else if (t == typeid(uint16_t))
-    { visitor.Visit(any_cast<uint16_t>(Value)); }
-
-  else if (t == typeid(std::vector<uint16_t>))
-    { visitor.Visit(any_cast<std::vector<uint16_t>>(Value)); }
-
-  else if (t == typeid(int32_t))
-    { visitor.Visit(any_cast<int32_t>(Value)); }
-
-  else if (t == typeid(std::vector<int32_t>))
-    { visitor.Visit(any_cast<std::vector<int32_t>>(Value)); }
-
-  else if (t == typeid(uint32_t))
-    { visitor.Visit(any_cast<uint32_t>(Value)); }
-
-  else if (t == typeid(std::vector<uint32_t>))
-    { visitor.Visit(any_cast<std::vector<uint32_t>>(Value)); }
-
-  else if (t == typeid(int64_t))
-    { visitor.Visit(any_cast<int64_t>(Value)); }
-
-  else if (t == typeid(std::vector<int64_t>))
-    { visitor.Visit(any_cast<std::vector<int64_t>>(Value)); }
-
-  else if (t == typeid(uint64_t))
-    { visitor.Visit(any_cast<uint64_t>(Value)); }
-
-  else if (t == typeid(std::vector<uint64_t>))
-    { visitor.Visit(any_cast<std::vector<uint64_t>>(Value)); }
-
-  else if (t == typeid(float))
-    { visitor.Visit(any_cast<float>(Value)); }
-
-  else if (t == typeid(std::vector<float>))
-    { visitor.Visit(any_cast<std::vector<float>>(Value)); }
-
-  else if (t == typeid(double))
-    { visitor.Visit(any_cast<double>(Value)); }
-
-  else if (t == typeid(std::vector<double>))
-    { visitor.Visit(any_cast<std::vector<double>>(Value)); }
-
-  else if (t == typeid(std::string))
-    { visitor.Visit(any_cast<std::string>(Value)); }
-
-  else if (t == typeid(std::vector<std::string>))
-    { visitor.Visit(any_cast<std::vector<std::string>>(Value)); }
-
-  else if (t == typeid(DateTime))
-    { visitor.Visit(any_cast<DateTime>(Value)); }
-
-  else if (t == typeid(std::vector<DateTime>))
-    { visitor.Visit(any_cast<std::vector<DateTime>>(Value)); }
-
-  else if (t == typeid(Guid))
-    { visitor.Visit(any_cast<Guid>(Value)); }
-
-  else if (t == typeid(std::vector<Guid>))
-    { visitor.Visit(any_cast<std::vector<Guid>>(Value)); }
-
-  else if (t == typeid(ByteString))
-    { visitor.Visit(any_cast<ByteString>(Value)); }
-
-  else if (t == typeid(std::vector<ByteString>))
-    { visitor.Visit(any_cast<std::vector<ByteString>>(Value)); }
-
-  else if (t == typeid(NodeId))
-    { visitor.Visit(any_cast<NodeId>(Value)); }
-
-  else if (t == typeid(std::vector<NodeId>))
-    { visitor.Visit(any_cast<std::vector<NodeId>>(Value)); }
-
-  else if (t == typeid(StatusCode))
-    { visitor.Visit(any_cast<StatusCode>(Value)); }
-
-  else if (t == typeid(std::vector<StatusCode>))
-    { visitor.Visit(any_cast<std::vector<StatusCode>>(Value)); }
-
-  else if (t == typeid(LocalizedText))
-    { visitor.Visit(any_cast<LocalizedText>(Value)); }
-
-  else if (t == typeid(std::vector<LocalizedText>))
-    { visitor.Visit(any_cast<std::vector<LocalizedText>>(Value)); }
-
-  else if (t == typeid(QualifiedName))
-    { visitor.Visit(any_cast<QualifiedName>(Value)); }
+  if (!Handler)
+    {
+      throw std::runtime_error("Cannot visit empty variant.");
+    }
 
-  else if (t == typeid(std::vector<QualifiedName>))
-    { visitor.Visit(any_cast<std::vector<QualifiedName>>(Value)); }
+  Handler->Visit(Value, visitor);
+}
 
-  /*
-      else if (t == typeid(DataValue))
-        visitor.Visit(any_cast<DataValue>(Value));
-      else if (t == typeid(std::vector<DataValue>))
-        visitor.Visit(any_cast<std::vector<DataValue>>(Value));
-        //Variant of variant is not allowed but variant of an array of variant is OK
-      else if (t == typeid(Variant))
-        visitor.Visit(any_cast<Variant>(Value));
-  */
-  else if (t == typeid(std::vector<Variant>))
-    { visitor.Visit(any_cast<std::vector<Variant>>(Value)); }
+void VisitVariantValue(VariantVisitor &, const ExtensionObject &)
+{
+  throw std::runtime_error("Unknown variant type 'ExtensionObject'.");
+}
 
-  else if (t == typeid(DiagnosticInfo))
-    { visitor.Visit(any_cast<DiagnosticInfo>(Value)); }
+void VisitVariantValue(VariantVisitor &, const std::vector<ExtensionObject> &)
+{
+  throw std::runtime_error("Unknown variant type 'std::vector<ExtensionObject>'.");
+}
 
-  else if (t == typeid(std::vector<DiagnosticInfo>))
-    { visitor.Visit(any_cast<std::vector<DiagnosticInfo>>(Value)); }
+bool CompareVariantValues(const ExtensionObject &, const ExtensionObject &)
+{
+  throw std::logic_error("Extension objects cannot be compared.");
+}
 
-  else
-    { throw std::runtime_error(std::string("Unknown variant type '") + t.name() + "'."); }
+bool CompareVariantValues(const std::vector<ExtensionObject> &, const std::vector<ExtensionObject> &)
+{
+  throw std::logic_error("Extension objects cannot be compared.");
 }
 
 ObjectId VariantTypeToDataType(VariantType vt)
@@ -794,55 +443,55 @@ std::string Variant::ToString() const
       switch (Type())
         {
         case VariantType::DATE_TIME:
-          str << OpcUa::ToString(boost::any_cast<DateTime> (Value)); //As<DateTime>());
+          str << OpcUa::ToString(As<DateTime>());
           break;
 
         case VariantType::STRING:
-          str << boost::any_cast<std::string> (Value);
+          str << As<std::string>();
           break;
 
         case VariantType::BOOLEAN:
-          str << ((boost::any_cast<bool> (Value)) ? "true" : "false");
+          str << ((As<bool>()) ? "true" : "false");
           break;
 
         case VariantType::BYTE:
-          str << boost::any_cast<unsigned char> (Value);
+          str << As<uint8_t>();
           break;
 
         case VariantType::SBYTE:
-          str << boost::any_cast<char> (Value);
+          str << As<int8_t>();
           break;
 
         case VariantType::DOUBLE:
-          str << boost::any_cast<double> (Value);
+          str << As<double>();
           break;
 
         case VariantType::FLOAT:
-          str << boost::any_cast<float> (Value);
+          str << As<float>();
           break;
 
         case VariantType::INT16:
-          str << boost::any_cast<int16_t> (Value);
+          str << As<int16_t>();
           break;
 
         case VariantType::INT32:
-          str << boost::any_cast<int32_t> (Value);
+          str << As<int32_t>();
           break;
 
         case VariantType::INT64:
-          str << boost::any_cast<int64_t> (Value);
+          str << As<int64_t>();
           break;
 
         case VariantType::UINT16:
-          str << boost::any_cast<uint16_t> (Value);
+          str << As<uint16_t>();
           break;
 
         case VariantType::UINT32:
-          str << boost::any_cast<uint32_t> (Value);
+          str << As<uint32_t>();
           break;
 
         case VariantType::UINT64:
-          str << boost::any_cast<uint64_t> (Value);
+          str << As<uint64_t>();
           break;
 
         default:
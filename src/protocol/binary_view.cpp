@@ -94,6 +94,11 @@ BrowseResponse::BrowseResponse()
 {
 }
 
+BrowseNextParameters::BrowseNextParameters()
+  : ReleaseContinuationPoints(false)
+{
+}
+
 BrowseNextRequest::BrowseNextRequest()
   : TypeId(BROWSE_NEXT_REQUEST)
   , ReleaseContinuationPoints(false)
@@ -339,6 +344,31 @@ void DataDeserializer::Deserialize<BrowseResponse>(BrowseResponse & response)
   DeserializeContainer(*this, response.Diagnostics);
 }
 
+//---------------------------------------------------
+// BrowseNextParameters
+//---------------------------------------------------
+
+template<>
+std::size_t RawSize<BrowseNextParameters>(const BrowseNextParameters & params)
+{
+  return RawSize(params.ReleaseContinuationPoints) +
+         RawSize(params.ContinuationPoints);
+}
+
+template<>
+void DataSerializer::Serialize<BrowseNextParameters>(const BrowseNextParameters & params)
+{
+  *this << params.ReleaseContinuationPoints;
+  SerializeContainer(*this, params.ContinuationPoints);
+}
+
+template<>
+void DataDeserializer::Deserialize<BrowseNextParameters>(BrowseNextParameters & params)
+{
+  *this >> params.ReleaseContinuationPoints;
+  DeserializeContainer(*this, params.ContinuationPoints);
+}
+
 //---------------------------------------------------
 // BrowseNextRequest
 //---------------------------------------------------
@@ -14,6 +14,7 @@
 #include <opc/ua/protocol/nodeid.h>
 
 #include <algorithm>
+#include <cstring>
 #include <stdexcept>
 #include <iostream>
 
@@ -21,7 +22,23 @@ namespace OpcUa
 {
 
 
+namespace
+{
+const std::string EmptyString;
+const std::vector<uint8_t> EmptyBinary;
+}
+
+NodeId::NodeId()
+  : Encoding(EV_TWO_BYTE)
+  , NumericData()
+  , AllocatedEncoding(EV_TWO_BYTE)
+  , Expanded(nullptr)
+{
+  Identifier.String = nullptr;
+}
+
 NodeId::NodeId(uint32_t integerId, uint16_t index)
+  : NodeId()
 {
   Encoding = EV_NUMERIC;
   NumericData.Identifier = integerId;
@@ -29,10 +46,70 @@ NodeId::NodeId(uint32_t integerId, uint16_t index)
 }
 
 NodeId::NodeId(std::string stringId, uint16_t index)
+  : NodeId()
 {
   Encoding = EV_STRING;
-  StringData.Identifier = stringId;
-  StringData.NamespaceIndex = index;
+  AllocatedEncoding = EV_STRING;
+  Identifier.String = new std::string(std::move(stringId));
+  NumericData.NamespaceIndex = index;
+}
+
+NodeId::NodeId(std::vector<uint8_t> binaryId, uint16_t index)
+  : NodeId()
+{
+  Encoding = EV_BYTE_STRING;
+  AllocatedEncoding = EV_BYTE_STRING;
+  Identifier.Binary = new std::vector<uint8_t>(std::move(binaryId));
+  NumericData.NamespaceIndex = index;
+}
+
+NodeId::NodeId(const Guid & guidId, uint16_t index)
+  : NodeId()
+{
+  Encoding = EV_GUId;
+  AllocatedEncoding = EV_GUId;
+  Identifier.GuidId = new Guid(guidId);
+  NumericData.NamespaceIndex = index;
+}
+
+NodeId::~NodeId()
+{
+  FreeIdentifier();
+  delete Expanded;
+}
+
+void NodeId::FreeIdentifier()
+{
+  switch (AllocatedEncoding)
+    {
+    case EV_STRING:
+      delete Identifier.String;
+      break;
+
+    case EV_BYTE_STRING:
+      delete Identifier.Binary;
+      break;
+
+    case EV_GUId:
+      delete Identifier.GuidId;
+      break;
+
+    default:
+      break;
+    }
+
+  AllocatedEncoding = EV_TWO_BYTE;
+  Identifier.String = nullptr;
+}
+
+NodeId::ExpandedData & NodeId::GetExpandedData()
+{
+  if (!Expanded)
+    {
+      Expanded = new ExpandedData();
+    }
+
+  return *Expanded;
 }
 
 bool NodeId::IsInteger() const
@@ -59,21 +136,21 @@ bool NodeId::IsGuid() const
   return enc == EV_GUId;
 }
 
-std::string NodeId::GetStringIdentifier() const
+const std::string & NodeId::GetStringIdentifier() const
 {
   if (IsString())
     {
-      return StringData.Identifier;
+      return AllocatedEncoding == EV_STRING ? *Identifier.String : EmptyString;
     }
 
   throw std::logic_error("Node id is not in String format.");
 }
 
-std::vector<uint8_t> NodeId::GetBinaryIdentifier() const
+const std::vector<uint8_t> & NodeId::GetBinaryIdentifier() const
 {
   if (IsBinary())
     {
-      return BinaryData.Identifier;
+      return AllocatedEncoding == EV_BYTE_STRING ? *Identifier.Binary : EmptyBinary;
     }
 
   throw std::logic_error("Node id is not in String format.");
@@ -83,7 +160,7 @@ Guid NodeId::GetGuidIdentifier() const
 {
   if (IsGuid())
     {
-      return GuidData.Identifier;
+      return AllocatedEncoding == EV_GUId ? *Identifier.GuidId : Guid();
     }
 
   throw std::logic_error("Node id is not in String format.");
@@ -123,16 +200,10 @@ uint32_t NodeId::GetNamespaceIndex() const
       return FourByteData.NamespaceIndex;
 
     case EV_NUMERIC:
-      return NumericData.NamespaceIndex;
-
     case EV_STRING:
-      return StringData.NamespaceIndex;
-
     case EV_GUId:
-      return GuidData.NamespaceIndex;
-
     case EV_BYTE_STRING:
-      return BinaryData.NamespaceIndex;
+      return NumericData.NamespaceIndex;
 
     default:
       return 0;
@@ -148,19 +219,10 @@ void NodeId::SetNamespaceIndex(uint32_t ns)
       return;
 
     case EV_NUMERIC:
-      NumericData.NamespaceIndex = ns;
-      return;
-
     case EV_STRING:
-      StringData.NamespaceIndex = ns;
-      return;
-
     case EV_GUId:
-      GuidData.NamespaceIndex = ns;
-      return;
-
     case EV_BYTE_STRING:
-      BinaryData.NamespaceIndex = ns;
+      NumericData.NamespaceIndex = ns;
       return;
 
     default:
@@ -168,84 +230,91 @@ void NodeId::SetNamespaceIndex(uint32_t ns)
     }
 }
 
-NodeId::NodeId()
-  : Encoding(EV_TWO_BYTE)
-  , ServerIndex(0)
-{
-}
-
 void NodeId::CopyNodeId(const NodeId & node)
 {
-  Encoding = node.Encoding;
-  const NodeIdEncoding enc = node.GetEncodingValue();
-
-  switch (enc)
+  if (this == &node)
     {
-    case EV_TWO_BYTE:
-    {
-      TwoByteData.Identifier = node.TwoByteData.Identifier;
-      break;
+      return;
     }
 
-    case EV_FOUR_BYTE:
-    {
-      FourByteData.NamespaceIndex = node.FourByteData.NamespaceIndex;
-      FourByteData.Identifier = node.FourByteData.Identifier;
-      break;
-    }
+  FreeIdentifier();
+  Encoding = node.Encoding;
+  CopyNumericData(node);
 
-    case EV_NUMERIC:
+  switch (node.AllocatedEncoding)
     {
-      NumericData.NamespaceIndex = node.NumericData.NamespaceIndex;
-      NumericData.Identifier = node.NumericData.Identifier;
+    case EV_STRING:
+      Identifier.String = new std::string(*node.Identifier.String);
       break;
-    }
 
-    case EV_STRING:
-    {
-      StringData.NamespaceIndex = node.StringData.NamespaceIndex;
-      StringData.Identifier = node.StringData.Identifier;
+    case EV_BYTE_STRING:
+      Identifier.Binary = new std::vector<uint8_t>(*node.Identifier.Binary);
       break;
-    }
 
     case EV_GUId:
-    {
-      GuidData.NamespaceIndex = node.GuidData.NamespaceIndex;
-      GuidData.Identifier = node.GuidData.Identifier;
+      Identifier.GuidId = new Guid(*node.Identifier.GuidId);
       break;
-    }
 
-    case EV_BYTE_STRING:
-    {
-      BinaryData.NamespaceIndex = node.BinaryData.NamespaceIndex;
-      BinaryData.Identifier = node.BinaryData.Identifier;
+    default:
       break;
     }
 
-    default:
+  AllocatedEncoding = node.AllocatedEncoding;
+
+  if (node.Expanded)
     {
-      throw std::logic_error("Invalid Node Id encoding value.");
-    }
+      GetExpandedData() = *node.Expanded;
     }
 
-  if (node.HasServerIndex())
+  else
     {
-      ServerIndex = node.ServerIndex;
+      delete Expanded;
+      Expanded = nullptr;
     }
+}
 
-  if (node.HasNamespaceURI())
+void NodeId::CopyNumericData(const NodeId & node)
+{
+  // Members of the numeric union have different layouts, copy it as a whole.
+  static_assert(sizeof(NumericData) == sizeof(uint64_t), "Numeric node id data should fit into 8 bytes.");
+  std::memcpy(&NumericData, &node.NumericData, sizeof(NumericData));
+}
+
+void NodeId::MoveNodeId(NodeId & node)
+{
+  if (this == &node)
     {
-      NamespaceURI = node.NamespaceURI;
+      return;
     }
 
+  FreeIdentifier();
+  delete Expanded;
+
+  Encoding = node.Encoding;
+  CopyNumericData(node);
+  AllocatedEncoding = node.AllocatedEncoding;
+  Identifier = node.Identifier;
+  Expanded = node.Expanded;
+
+  node.AllocatedEncoding = EV_TWO_BYTE;
+  node.Identifier.String = nullptr;
+  node.Expanded = nullptr;
 }
 
 NodeId::NodeId(const NodeId & node)
+  : NodeId()
 {
   CopyNodeId(node);
 }
 
+NodeId::NodeId(NodeId && node)
+  : NodeId()
+{
+  MoveNodeId(node);
+}
+
 NodeId::NodeId(const ExpandedNodeId & node)
+  : NodeId()
 {
   CopyNodeId(node);
 }
@@ -264,6 +333,12 @@ NodeId & NodeId::operator=(const NodeId & node)
   return *this;
 }
 
+NodeId & NodeId::operator=(NodeId && node)
+{
+  MoveNodeId(node);
+  return *this;
+}
+
 NodeId & NodeId::operator=(const ExpandedNodeId & node)
 {
   CopyNodeId(node);
@@ -271,30 +346,30 @@ NodeId & NodeId::operator=(const ExpandedNodeId & node)
 }
 
 NodeId::NodeId(MessageId messageId)
-  : Encoding(EV_FOUR_BYTE)
-  , ServerIndex(0)
+  : NodeId()
 {
+  Encoding = EV_FOUR_BYTE;
   FourByteData.Identifier = messageId;
 }
 
 NodeId::NodeId(ReferenceId referenceId)
-  : Encoding(EV_NUMERIC)
-  , ServerIndex(0)
+  : NodeId()
 {
+  Encoding = EV_NUMERIC;
   NumericData.Identifier = static_cast<uint32_t>(referenceId);
 }
 
 NodeId::NodeId(ObjectId objectId)
-  : Encoding(EV_NUMERIC)
-  , ServerIndex(0)
+  : NodeId()
 {
+  Encoding = EV_NUMERIC;
   NumericData.Identifier = static_cast<uint32_t>(objectId);
 }
 
 NodeId::NodeId(ExpandedObjectId objectId)
-  : Encoding(EV_FOUR_BYTE)
-  , ServerIndex(0)
+  : NodeId()
 {
+  Encoding = EV_FOUR_BYTE;
   FourByteData.Identifier = static_cast<uint32_t>(objectId);
 }
 
@@ -377,34 +452,12 @@ bool NodeId::IsNull() const
   switch (GetEncodingValue())
     {
     case EV_TWO_BYTE:
-      break;
-
     case EV_FOUR_BYTE:
-      if (FourByteData.NamespaceIndex != 0)
-        { return false; }
-
-      break;
-
     case EV_NUMERIC:
-      if (NumericData.NamespaceIndex != 0)
-        { return false; }
-
-      break;
-
     case EV_STRING:
-      if (StringData.NamespaceIndex != 0)
-        { return false; }
-
-      break;
-
     case EV_GUId:
-      if (GuidData.NamespaceIndex != 0)
-        { return false; }
-
-      break;
-
     case EV_BYTE_STRING:
-      if (BinaryData.NamespaceIndex != 0)
+      if (GetNamespaceIndex() != 0)
         { return false; }
 
       break;
@@ -423,37 +476,27 @@ bool NodeId::HasNullIdentifier() const
   switch (GetEncodingValue())
     {
     case EV_TWO_BYTE:
-      if (TwoByteData.Identifier != 0)
-        { return false; }
-
-      break;
-
     case EV_FOUR_BYTE:
-      if (FourByteData.Identifier != 0)
-        { return false; }
-
-      break;
-
     case EV_NUMERIC:
-      if (NumericData.Identifier != 0)
+      if (GetIntegerIdentifier() != 0)
         { return false; }
 
       break;
 
     case EV_STRING:
-      if (! StringData.Identifier.empty())
+      if (! GetStringIdentifier().empty())
         { return false; }
 
       break;
 
     case EV_GUId:
-      if (!(GuidData.Identifier == Guid()))
+      if (!(GetGuidIdentifier() == Guid()))
         { return false; }
 
       break;
 
     case EV_BYTE_STRING:
-      if (! BinaryData.Identifier.empty())
+      if (! GetBinaryIdentifier().empty())
         { return false; }
 
       break;
@@ -480,13 +523,23 @@ bool NodeId::HasServerIndex() const
 void NodeId::SetNamespaceURI(const std::string & uri)
 {
   Encoding = static_cast<NodeIdEncoding>(Encoding | EV_NAMESPACE_URI_FLAG);
-  NamespaceURI = uri;
+  GetExpandedData().NamespaceURI = uri;
 }
 
 void NodeId::SetServerIndex(uint32_t index)
 {
   Encoding = static_cast<NodeIdEncoding>(Encoding | EV_Server_INDEX_FLAG);
-  ServerIndex = index;
+  GetExpandedData().ServerIndex = index;
+}
+
+const std::string & NodeId::GetNamespaceURI() const
+{
+  return Expanded ? Expanded->NamespaceURI : EmptyString;
+}
+
+uint32_t NodeId::GetServerIndex() const
+{
+  return Expanded ? Expanded->ServerIndex : 0;
 }
 
 bool NodeId::operator!= (const NodeId & node) const
@@ -540,63 +593,72 @@ bool NodeId::operator== (ExpandedObjectId messageId) const
 ///ExpandednNdeId
 ExpandedNodeId::ExpandedNodeId()
 {
-  Encoding = EV_TWO_BYTE;
-  ServerIndex = 0;
 }
 
 ExpandedNodeId::ExpandedNodeId(uint32_t integerId, uint16_t index)
+  : NodeId(integerId, index)
 {
-  Encoding = EV_NUMERIC;
-  NumericData.Identifier = integerId;
-  NumericData.NamespaceIndex = index;
 }
 
 ExpandedNodeId::ExpandedNodeId(std::string stringId, uint16_t index)
+  : NodeId(std::move(stringId), index)
 {
-  Encoding = EV_STRING;
-  StringData.Identifier = stringId;
-  StringData.NamespaceIndex = index;
 }
 
 ExpandedNodeId::ExpandedNodeId(const NodeId & node)
+  : NodeId(node)
 {
-  CopyNodeId(node);
 }
 
 ExpandedNodeId::ExpandedNodeId(const ExpandedNodeId & node)
+  : NodeId(static_cast<const NodeId &>(node))
+{
+}
+
+ExpandedNodeId::ExpandedNodeId(ExpandedNodeId && node)
+  : NodeId(static_cast<NodeId &&>(node))
+{
+}
+
+ExpandedNodeId & ExpandedNodeId::operator= (const ExpandedNodeId & node)
 {
   CopyNodeId(node);
+  return *this;
 }
 
+ExpandedNodeId & ExpandedNodeId::operator= (ExpandedNodeId && node)
+{
+  MoveNodeId(node);
+  return *this;
+}
 
 ExpandedNodeId::ExpandedNodeId(MessageId messageId)
+  : NodeId(messageId)
 {
-  Encoding = EV_FOUR_BYTE;
-  ServerIndex = 0;
-  FourByteData.Identifier = messageId;
 }
 
 ExpandedNodeId::ExpandedNodeId(ReferenceId referenceId)
+  : NodeId(referenceId)
 {
-  Encoding = EV_NUMERIC;
-  ServerIndex = 0;
-  NumericData.Identifier = static_cast<uint32_t>(referenceId);
 }
 
 ExpandedNodeId::ExpandedNodeId(ObjectId objectId)
+  : NodeId(objectId)
 {
-  Encoding = EV_NUMERIC;
-  ServerIndex = 0;
-  NumericData.Identifier = static_cast<uint32_t>(objectId);
 }
 
 ExpandedNodeId::ExpandedNodeId(ExpandedObjectId objectId)
+  : NodeId(objectId)
 {
-  Encoding = EV_FOUR_BYTE;
-  ServerIndex = 0;
-  FourByteData.Identifier = static_cast<uint32_t>(objectId);
 }
 
+namespace
+{
+inline void CombineHash(std::size_t & seed, std::size_t value)
+{
+  seed ^= value + 0x9e3779b9 + (seed << 6) + (seed >> 2);
+}
+}
 
 namespace Binary
 {
@@ -653,7 +715,7 @@ std::size_t RawSize<NodeId>(const NodeId & id)
       const std::size_t sizeofEncoding = 1;
       const std::size_t sizeofSize = 4;
       const std::size_t sizeofNamespace = 2;
-      size = sizeofEncoding + sizeofNamespace + sizeofSize + id.StringData.Identifier.size();
+      size = sizeofEncoding + sizeofNamespace + sizeofSize + id.GetStringIdentifier().size();
       break;
     }
 
@@ -662,7 +724,7 @@ std::size_t RawSize<NodeId>(const NodeId & id)
       const std::size_t sizeofEncoding = 1;
       const std::size_t sizeofSize = 4;
       const std::size_t sizeofNamespace = 2;
-      size = sizeofEncoding + sizeofNamespace + sizeofSize + id.BinaryData.Identifier.size();
+      size = sizeofEncoding + sizeofNamespace + sizeofSize + id.GetBinaryIdentifier().size();
       break;
     }
 
@@ -716,22 +778,22 @@ void DataSerializer::Serialize<OpcUa::NodeId>(const OpcUa::NodeId & id)
 
     case EV_STRING:
     {
-      *this << id.StringData.NamespaceIndex;
-      *this << id.StringData.Identifier;
+      *this << static_cast<uint16_t>(id.GetNamespaceIndex());
+      *this << id.GetStringIdentifier();
       break;
     }
 
     case EV_BYTE_STRING:
     {
-      *this << id.BinaryData.NamespaceIndex;
-      *this << id.BinaryData.Identifier;
+      *this << static_cast<uint16_t>(id.GetNamespaceIndex());
+      *this << id.GetBinaryIdentifier();
       break;
     }
 
     case EV_GUId:
     {
-      *this << id.GuidData.NamespaceIndex;
-      *this << id.GuidData.Identifier;
+      *this << static_cast<uint16_t>(id.GetNamespaceIndex());
+      *this << id.GetGuidIdentifier();
       break;
     }
 
@@ -744,48 +806,66 @@ void DataSerializer::Serialize<OpcUa::NodeId>(const OpcUa::NodeId & id)
 template<>
 void DataDeserializer::Deserialize<OpcUa::NodeId>(OpcUa::NodeId & id)
 {
-  *this >> id.Encoding;
+  NodeIdEncoding encoding = EV_TWO_BYTE;
+  *this >> encoding;
 
-  switch (id.GetEncodingValue())
+  switch (static_cast<NodeIdEncoding>(encoding & EV_VALUE_MASK))
     {
     case EV_TWO_BYTE:
     {
-      *this >> id.TwoByteData.Identifier;
+      uint8_t identifier = 0;
+      *this >> identifier;
+      id = TwoByteNodeId(identifier);
       break;
     }
 
     case EV_FOUR_BYTE:
     {
-      *this >> id.FourByteData.NamespaceIndex;
-      *this >> id.FourByteData.Identifier;
+      uint8_t namespaceIndex = 0;
+      uint16_t identifier = 0;
+      *this >> namespaceIndex;
+      *this >> identifier;
+      id = FourByteNodeId(identifier, namespaceIndex);
       break;
     }
 
     case EV_NUMERIC:
     {
-      *this >> id.NumericData.NamespaceIndex;
-      *this >> id.NumericData.Identifier;
+      uint16_t namespaceIndex = 0;
+      uint32_t identifier = 0;
+      *this >> namespaceIndex;
+      *this >> identifier;
+      id = NumericNodeId(identifier, namespaceIndex);
       break;
     }
 
     case EV_STRING:
     {
-      *this >> id.StringData.NamespaceIndex;
-      *this >> id.StringData.Identifier;
+      uint16_t namespaceIndex = 0;
+      std::string identifier;
+      *this >> namespaceIndex;
+      *this >> identifier;
+      id = StringNodeId(std::move(identifier), namespaceIndex);
       break;
     }
 
     case EV_BYTE_STRING:
     {
-      *this >> id.BinaryData.NamespaceIndex;
-      *this >> id.BinaryData.Identifier;
+      uint16_t namespaceIndex = 0;
+      std::vector<uint8_t> identifier;
+      *this >> namespaceIndex;
+      *this >> identifier;
+      id = BinaryNodeId(std::move(identifier), namespaceIndex);
       break;
     }
 
     case EV_GUId:
     {
-      *this >> id.GuidData.NamespaceIndex;
-      *this >> id.GuidData.Identifier;
+      uint16_t namespaceIndex = 0;
+      Guid identifier;
+      *this >> namespaceIndex;
+      *this >> identifier;
+      id = GuidNodeId(identifier, namespaceIndex);
       break;
     }
 
@@ -795,14 +875,18 @@ void DataDeserializer::Deserialize<OpcUa::NodeId>(OpcUa::NodeId & id)
     }
     };
 
-  if (id.HasNamespaceURI())
+  if (encoding & EV_NAMESPACE_URI_FLAG)
     {
-      *this >> id.NamespaceURI;
+      std::string uri;
+      *this >> uri;
+      id.SetNamespaceURI(uri);
     }
 
-  if (id.HasServerIndex())
+  if (encoding & EV_Server_INDEX_FLAG)
     {
-      *this >> id.ServerIndex;
+      uint32_t index = 0;
+      *this >> index;
+      id.SetServerIndex(index);
     }
 }
 
@@ -814,7 +898,7 @@ std::size_t RawSize<ExpandedNodeId>(const ExpandedNodeId & id)
   if (id.HasNamespaceURI())
     {
       const std::size_t sizeofSize = 4;
-      size += sizeofSize + id.NamespaceURI.size();
+      size += sizeofSize + id.GetNamespaceURI().size();
     }
 
   if (id.HasServerIndex())
@@ -855,22 +939,22 @@ void DataSerializer::Serialize<OpcUa::ExpandedNodeId>(const OpcUa::ExpandedNodeI
 
     case EV_STRING:
     {
-      *this << id.StringData.NamespaceIndex;
-      *this << id.StringData.Identifier;
+      *this << static_cast<uint16_t>(id.GetNamespaceIndex());
+      *this << id.GetStringIdentifier();
       break;
     }
 
     case EV_BYTE_STRING:
     {
-      *this << id.BinaryData.NamespaceIndex;
-      *this << id.BinaryData.Identifier;
+      *this << static_cast<uint16_t>(id.GetNamespaceIndex());
+      *this << id.GetBinaryIdentifier();
       break;
     }
 
     case EV_GUId:
     {
-      *this << id.GuidData.NamespaceIndex;
-      *this << id.GuidData.Identifier;
+      *this << static_cast<uint16_t>(id.GetNamespaceIndex());
+      *this << id.GetGuidIdentifier();
       break;
     }
 
@@ -880,12 +964,12 @@ void DataSerializer::Serialize<OpcUa::ExpandedNodeId>(const OpcUa::ExpandedNodeI
 
   if (id.HasNamespaceURI())
     {
-      *this << id.NamespaceURI;
+      *this << id.GetNamespaceURI();
     }
 
   if (id.HasServerIndex())
     {
-      *this << id.ServerIndex;
+      *this << id.GetServerIndex();
     }
 }
 
@@ -899,3 +983,56 @@ void DataDeserializer::Deserialize<OpcUa::ExpandedNodeId>(OpcUa::ExpandedNodeId
 } // namespace Binary
 } // namespace OpcUa
 
+namespace std
+{
+
+std::size_t hash<OpcUa::NodeId>::operator()(const OpcUa::NodeId & id) const
+{
+  using namespace OpcUa;
+
+  std::size_t seed = std::hash<uint32_t>()(id.GetNamespaceIndex());
+
+  switch (id.GetEncodingValue())
+    {
+    case EV_TWO_BYTE:
+    case EV_FOUR_BYTE:
+    case EV_NUMERIC:
+      CombineHash(seed, std::hash<uint32_t>()(id.GetIntegerIdentifier()));
+      break;
+
+    case EV_STRING:
+      CombineHash(seed, std::hash<std::string>()(id.GetStringIdentifier()));
+      break;
+
+    case EV_BYTE_STRING:
+      for (uint8_t byte : id.GetBinaryIdentifier())
+        {
+          CombineHash(seed, byte);
+        }
+
+      break;
+
+    case EV_GUId:
+    {
+      const Guid guid = id.GetGuidIdentifier();
+      CombineHash(seed, guid.Data1);
+      CombineHash(seed, guid.Data2);
+      CombineHash(seed, guid.Data3);
+
+      for (uint8_t byte : guid.Data4)
+        {
+          CombineHash(seed, byte);
+        }
+
+      break;
+    }
+
+    default:
+      break;
+    }
+
+  return seed;
+}
+
+} // namespace std
+
@@ -612,12 +612,12 @@ std::ostream & OpcUa::ToStream(std::ostream & os, const OpcUa::NodeId & value, b
 {
   if (value.HasServerIndex())
     {
-      os << "srv=" << value.ServerIndex << ";";
+      os << "srv=" << value.GetServerIndex() << ";";
     }
 
   if (value.HasNamespaceURI())
     {
-      os << "nsu=" << value.NamespaceURI << ";";
+      os << "nsu=" << value.GetNamespaceURI() << ";";
     }
 
   os << "ns=" << value.GetNamespaceIndex() << ";";
@@ -32,7 +32,29 @@ AddressSpaceAddon::~AddressSpaceAddon()
 void AddressSpaceAddon::Initialize(Common::AddonsManager & addons, const Common::AddonParameters & params)
 {
   Logger = addons.GetLogger();
-  Registry = Server::CreateAddressSpace(Logger);
+
+  Server::BrowseLimits limits;
+  uint32_t dataSourceTimeout = Server::DefaultDataSourceTimeout;
+
+  for (const Common::Parameter & param : params.Parameters)
+    {
+      if (param.Name == "max_continuation_points")
+        {
+          limits.MaxContinuationPoints = std::stoul(param.Value);
+        }
+
+      else if (param.Name == "max_references_per_node")
+        {
+          limits.MaxReferencesPerNode = std::stoul(param.Value);
+        }
+
+      else if (param.Name == "data_source_timeout")
+        {
+          dataSourceTimeout = std::stoul(param.Value);
+        }
+    }
+
+  Registry = Server::CreateAddressSpace(Logger, limits, dataSourceTimeout);
   InternalServer = addons.GetAddon<OpcUa::Server::ServicesRegistry>(OpcUa::Server::ServicesRegistryAddonId);
   InternalServer->RegisterViewServices(Registry);
   InternalServer->RegisterAttributeServices(Registry);
@@ -64,9 +86,24 @@ std::vector<BrowseResult> AddressSpaceAddon::Browse(const OpcUa::NodesQuery & qu
 {
   return Registry->Browse(query);
 }
-std::vector<BrowseResult> AddressSpaceAddon::BrowseNext() const
+std::vector<BrowseResult> AddressSpaceAddon::BrowseNext(const BrowseNextParameters & params) const
+{
+  return Registry->BrowseNext(params);
+}
+
+std::vector<BrowseResult> AddressSpaceAddon::Browse(const NodeId & session, const OpcUa::NodesQuery & query) const
+{
+  return Registry->Browse(session, query);
+}
+
+std::vector<BrowseResult> AddressSpaceAddon::BrowseNext(const NodeId & session, const BrowseNextParameters & params) const
+{
+  return Registry->BrowseNext(session, params);
+}
+
+void AddressSpaceAddon::ReleaseContinuationPoints(const NodeId & session) const
 {
-  return Registry->BrowseNext();
+  Registry->ReleaseContinuationPoints(session);
 }
 
 std::vector<BrowsePathResult> AddressSpaceAddon::TranslateBrowsePathsToNodeIds(const TranslateBrowsePathsParameters & params) const
@@ -109,6 +146,26 @@ StatusCode AddressSpaceAddon::SetValueCallback(const NodeId & node, AttributeId
   return Registry->SetValueCallback(node, attribute, callback);
 }
 
+bool AddressSpaceAddon::HasValueCallback(const NodeId & node, AttributeId attribute) const
+{
+  return Registry->HasValueCallback(node, attribute);
+}
+
+StatusCode AddressSpaceAddon::SetDataSource(const NodeId & node, AttributeId attribute, Server::DataSource::SharedPtr source)
+{
+  return Registry->SetDataSource(node, attribute, source);
+}
+
+void AddressSpaceAddon::ReadAsync(const ReadParameters & params, Server::DataSource::ReadCallback done) const
+{
+  Registry->ReadAsync(params, done);
+}
+
+std::vector<NodeId> AddressSpaceAddon::GetSubtypes(const NodeId & type) const
+{
+  return Registry->GetSubtypes(type);
+}
+
 void AddressSpaceAddon::SetMethod(const NodeId & node, std::function<std::vector<OpcUa::Variant> (NodeId context, std::vector<OpcUa::Variant> arguments)> callback)
 {
   Registry->SetMethod(node, callback);
@@ -43,7 +43,10 @@ public: // NodeManagementServices
 
 public: // ViewServices
   virtual std::vector<BrowseResult> Browse(const OpcUa::NodesQuery & query) const;
-  virtual std::vector<BrowseResult> BrowseNext() const;
+  virtual std::vector<BrowseResult> BrowseNext(const BrowseNextParameters & params) const;
+  virtual std::vector<BrowseResult> Browse(const NodeId & session, const OpcUa::NodesQuery & query) const;
+  virtual std::vector<BrowseResult> BrowseNext(const NodeId & session, const BrowseNextParameters & params) const;
+  virtual void ReleaseContinuationPoints(const NodeId & session) const;
   virtual std::vector<BrowsePathResult> TranslateBrowsePathsToNodeIds(const TranslateBrowsePathsParameters & params) const;
   virtual std::vector<NodeId> RegisterNodes(const std::vector<NodeId> & params) const;
   virtual void UnregisterNodes(const std::vector<NodeId> & params) const;
@@ -59,6 +62,10 @@ public: // Server internal methods
   virtual uint32_t AddDataChangeCallback(const NodeId & node, AttributeId attribute, std::function<Server::DataChangeCallback> callback);
   virtual void DeleteDataChangeCallback(uint32_t clienthandle);
   virtual StatusCode SetValueCallback(const NodeId & node, AttributeId attribute, std::function<DataValue(void)> callback);
+  virtual bool HasValueCallback(const NodeId & node, AttributeId attribute) const;
+  virtual StatusCode SetDataSource(const NodeId & node, AttributeId attribute, Server::DataSource::SharedPtr source);
+  virtual void ReadAsync(const ReadParameters & params, Server::DataSource::ReadCallback done) const;
+  virtual std::vector<NodeId> GetSubtypes(const NodeId & type) const;
   virtual void SetMethod(const NodeId & node, std::function<std::vector<OpcUa::Variant> (NodeId context, std::vector<OpcUa::Variant> arguments)> callback);
 
 private:
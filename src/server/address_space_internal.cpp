@@ -10,7 +10,6 @@
 
 #include "address_space_internal.h"
 
-
 namespace OpcUa
 {
 namespace Internal
@@ -25,8 +24,336 @@ struct AttSubscription
   MonitoringParameters Parameters;
 };
 
+void TypeHierarchy::AddSubtype(const NodeId & type, const NodeId & subtype)
+{
+  std::vector<NodeId> & subtypes = Subtypes[type];
+
+  if (std::find(subtypes.begin(), subtypes.end(), subtype) != subtypes.end())
+    {
+      return;
+    }
+
+  subtypes.push_back(subtype);
+
+  std::unordered_set<NodeId> inherited;
+  inherited.insert(type);
+  const auto typeIt = Supertypes.find(type);
+
+  if (typeIt != Supertypes.end())
+    {
+      inherited.insert(typeIt->second.begin(), typeIt->second.end());
+    }
+
+  // subtype and all its descendants derive from the new ancestors
+  std::vector<NodeId> pending(1, subtype);
+
+  while (!pending.empty())
+    {
+      const NodeId current = pending.back();
+      pending.pop_back();
+
+      std::unordered_set<NodeId> & supertypes = Supertypes[current];
+      const std::size_t oldSize = supertypes.size();
+      supertypes.insert(inherited.begin(), inherited.end());
+
+      if (supertypes.size() == oldSize)
+        {
+          continue;
+        }
+
+      const auto subIt = Subtypes.find(current);
+
+      if (subIt != Subtypes.end())
+        {
+          pending.insert(pending.end(), subIt->second.begin(), subIt->second.end());
+        }
+    }
+}
+
+bool TypeHierarchy::IsSubtypeOf(const NodeId & type, const NodeId & baseType) const
+{
+  if (type == baseType)
+    {
+      return true;
+    }
+
+  const auto it = Supertypes.find(type);
+  return it != Supertypes.end() && it->second.count(baseType) != 0;
+}
+
+std::vector<NodeId> TypeHierarchy::GetSubtypes(const NodeId & type) const
+{
+  std::vector<NodeId> subtypes(1, type);
+  std::unordered_set<NodeId> visited(subtypes.begin(), subtypes.end());
+
+  for (std::size_t index = 0; index < subtypes.size(); ++index)
+    {
+      const auto it = Subtypes.find(subtypes[index]);
+
+      if (it == Subtypes.end())
+        {
+          continue;
+        }
+
+      for (const NodeId & subtype : it->second)
+        {
+          if (visited.insert(subtype).second)
+            {
+              subtypes.push_back(subtype);
+            }
+        }
+    }
+
+  return subtypes;
+}
+
+void NodeReferences::Add(const ReferenceDescription & reference)
+{
+  const uint32_t index = static_cast<uint32_t>(References.size());
+  References.push_back(reference);
+
+  auto groupIt = std::find_if(ReferenceGroups.begin(), ReferenceGroups.end(), [&reference](const Group & group)
+  {
+    return group.IsForward == reference.IsForward && group.ReferenceTypeId == reference.ReferenceTypeId;
+  });
+
+  if (groupIt == ReferenceGroups.end())
+    {
+      Group group;
+      group.ReferenceTypeId = reference.ReferenceTypeId;
+      group.IsForward = reference.IsForward;
+      ReferenceGroups.push_back(group);
+      groupIt = ReferenceGroups.end() - 1;
+    }
+
+  groupIt->Indexes.push_back(index);
+
+  if (!BrowseNames.empty())
+    {
+      IndexBrowseName(index);
+    }
+
+  else if (References.size() == BrowseNameIndexThreshold)
+    {
+      for (uint32_t i = 0; i < References.size(); ++i)
+        {
+          IndexBrowseName(i);
+        }
+    }
+}
+
+void NodeReferences::IndexBrowseName(uint32_t index)
+{
+  // first reference with a name wins, like in linear search
+  BrowseNames.emplace(References[index].BrowseName, index);
+}
+
+const ReferenceDescription * NodeReferences::FindByBrowseName(const QualifiedName & name) const
+{
+  if (!BrowseNames.empty())
+    {
+      const auto it = BrowseNames.find(name);
+      return it == BrowseNames.end() ? nullptr : &References[it->second];
+    }
+
+  for (const ReferenceDescription & reference : References)
+    {
+      if (reference.BrowseName == name)
+        {
+          return &reference;
+        }
+    }
+
+  return nullptr;
+}
+
+DataChangeDispatcher::DataChangeDispatcher(const Common::Logger::SharedPtr & logger)
+  : Logger(logger)
+{
+}
+
+void DataChangeDispatcher::Push(NodeHandle node, DataChangeNotification && notification)
+{
+  std::lock_guard<std::mutex> lock(Mutex);
+  std::shared_ptr<NodeQueue> & queue = Queues[node];
+
+  if (!queue)
+    {
+      queue = std::make_shared<NodeQueue>();
+    }
+
+  queue->Notifications.push_back(std::move(notification));
+  ++queue->PushedCount;
+}
+
+void DataChangeDispatcher::Dispatch(const std::vector<NodeHandle> & nodes)
+{
+  for (NodeHandle node : nodes)
+    {
+      Flush(node);
+    }
+}
+
+void DataChangeDispatcher::Flush(NodeHandle node)
+{
+  std::unique_lock<std::mutex> lock(Mutex);
+  const auto it = Queues.find(node);
+
+  if (it == Queues.end())
+    {
+      return;
+    }
+
+  const std::shared_ptr<NodeQueue> queue = it->second;
+
+  if (queue->Dispatching && queue->DispatchingThread == std::this_thread::get_id())
+    {
+      queue->NestedCount = queue->PushedCount;
+      return;
+    }
+
+  const uint64_t target = queue->PushedCount;
+
+  while (queue->DeliveredCount < target)
+    {
+      if (queue->Dispatching)
+        {
+          Delivered.wait(lock);
+          continue;
+        }
+
+      Deliver(lock, node, queue, target);
+    }
+}
+
+void DataChangeDispatcher::Deliver(std::unique_lock<std::mutex> & lock, NodeHandle node, const std::shared_ptr<NodeQueue> & queue, uint64_t target)
+{
+  queue->Dispatching = true;
+  queue->DispatchingThread = std::this_thread::get_id();
+  queue->NestedCount = 0;
+
+  // later notifications are left to their own writers
+  while (queue->TakenCount < target)
+    {
+      std::deque<DataChangeNotification> notifications;
+      const std::size_t count = static_cast<std::size_t>(std::min<uint64_t>(target - queue->TakenCount, queue->Notifications.size()));
+      notifications.insert(notifications.end(), std::make_move_iterator(queue->Notifications.begin()), std::make_move_iterator(queue->Notifications.begin() + count));
+      queue->Notifications.erase(queue->Notifications.begin(), queue->Notifications.begin() + count);
+      queue->TakenCount += count;
+      lock.unlock();
+
+      for (const DataChangeNotification & notification : notifications)
+        {
+          for (const auto & callback : *notification.Callbacks)
+            {
+              try
+                {
+                  callback.second.Callback(notification.Node, notification.Attribute, *notification.Value);
+                }
+
+              catch (const std::exception & exc)
+                {
+                  LOG_ERROR(Logger, "address_space_internal| data change callback of node {} failed: {}", notification.Node, exc.what());
+                }
+
+              catch (...)
+                {
+                  LOG_ERROR(Logger, "address_space_internal| data change callback of node {} failed", notification.Node);
+                }
+            }
+        }
+
+      lock.lock();
+      queue->DeliveredCount += count;
+      target = std::max(target, queue->NestedCount);
+    }
+
+  queue->Dispatching = false;
+  queue->DispatchingThread = std::thread::id();
+
+  const auto it = Queues.find(node);
+
+  if (queue->Notifications.empty() && it != Queues.end() && it->second == queue)
+    {
+      Queues.erase(it);
+    }
+
+  Delivered.notify_all();
+}
+
+ReadTimeouts::~ReadTimeouts()
+{
+  {
+    std::lock_guard<std::mutex> lock(Mutex);
+    Stopping = true;
+  }
+
+  Changed.notify_all();
+
+  if (Thread.joinable())
+    {
+      Thread.join();
+    }
+}
+
+void ReadTimeouts::Add(std::chrono::steady_clock::time_point deadline, std::function<void ()> expire)
+{
+  std::lock_guard<std::mutex> lock(Mutex);
+  Deadlines.insert(std::make_pair(deadline, std::move(expire)));
+
+  if (!Thread.joinable())
+    {
+      Thread = std::thread(&ReadTimeouts::Run, this);
+    }
+
+  Changed.notify_one();
+}
+
+void ReadTimeouts::Run()
+{
+  std::unique_lock<std::mutex> lock(Mutex);
+
+  while (!Stopping)
+    {
+      if (Deadlines.empty())
+        {
+          Changed.wait(lock);
+          continue;
+        }
+
+      const auto first = Deadlines.begin();
+
+      if (std::chrono::steady_clock::now() < first->first)
+        {
+          Changed.wait_until(lock, first->first);
+          continue;
+        }
+
+      std::function<void ()> expire = std::move(first->second);
+      Deadlines.erase(first);
+
+      // expiration completes the read, which calls back the reader
+      lock.unlock();
+      expire();
+      lock.lock();
+    }
+}
+
 AddressSpaceInMemory::AddressSpaceInMemory(const Common::Logger::SharedPtr & logger)
+  : AddressSpaceInMemory(logger, Server::BrowseLimits())
+{
+}
+
+AddressSpaceInMemory::AddressSpaceInMemory(const Common::Logger::SharedPtr & logger, const Server::BrowseLimits & limits)
+  : AddressSpaceInMemory(logger, limits, Server::DefaultDataSourceTimeout)
+{
+}
+
+AddressSpaceInMemory::AddressSpaceInMemory(const Common::Logger::SharedPtr & logger, const Server::BrowseLimits & limits, uint32_t dataSourceTimeout)
   : Logger(logger)
+  , Limits(limits)
+  , DataSourceTimeout(dataSourceTimeout)
+  , Dispatcher(logger)
   , DataChangeCallbackHandle(0)
 {
   /*
@@ -92,12 +419,18 @@ std::vector<BrowsePathResult> AddressSpaceInMemory::TranslateBrowsePathsToNodeId
 }
 
 std::vector<BrowseResult> AddressSpaceInMemory::Browse(const OpcUa::NodesQuery & query) const
+{
+  return Browse(NodeId(), query);
+}
+
+std::vector<BrowseResult> AddressSpaceInMemory::Browse(const NodeId & session, const OpcUa::NodesQuery & query) const
 {
   boost::shared_lock<boost::shared_mutex> lock(DbMutex);
 
   LOG_TRACE(Logger, "address_space_internal| browse");
 
   std::vector<BrowseResult> results;
+  const uint32_t maxReferences = GetMaxReferencesPerNode(query.MaxReferenciesPerNode);
 
   for (BrowseDescription browseDescription : query.NodesToBrowse)
     {
@@ -113,92 +446,484 @@ std::vector<BrowseResult> AddressSpaceInMemory::Browse(const OpcUa::NodesQuery &
           Logger->trace("  ResultMask:  {:#x}", (unsigned)browseDescription.ResultMask);
         }
 
-      NodesMap::const_iterator node_it = Nodes.find(browseDescription.NodeToBrowse);
+      const NodeStruct * node = Nodes.Find(browseDescription.NodeToBrowse);
 
-      if (node_it == Nodes.end())
+      if (!node)
         {
           LOG_WARN(Logger, "address_space_internal| Node '{}' not found in the address space", OpcUa::ToString(browseDescription.NodeToBrowse));
 
           continue;
         }
 
-      std::copy_if(node_it->second.References.begin(), node_it->second.References.end(), std::back_inserter(result.Referencies),
-                   std::bind(&AddressSpaceInMemory::IsSuitableReference, this, std::cref(browseDescription), std::placeholders::_1)
-                  );
+      BrowseContinuation position;
+      position.Description = browseDescription;
+      position.Indexes = GetSuitableReferences(*node, browseDescription);
+      position.MaxReferencesPerNode = maxReferences;
+
+      if (BrowseReferences(*node, position, result))
+        {
+          KeepContinuationPoint(session, position, result);
+        }
+
       results.push_back(result);
     }
 
   return results;
 }
 
-std::vector<BrowseResult> AddressSpaceInMemory::BrowseNext() const
+std::vector<BrowseResult> AddressSpaceInMemory::BrowseNext(const BrowseNextParameters & params) const
+{
+  return BrowseNext(NodeId(), params);
+}
+
+std::vector<BrowseResult> AddressSpaceInMemory::BrowseNext(const NodeId & session, const BrowseNextParameters & params) const
 {
+  // Continuation points keep references selected by Browse, next pages only copy them.
   boost::shared_lock<boost::shared_mutex> lock(DbMutex);
 
-  return std::vector<BrowseResult>();
+  std::vector<BrowseResult> results(params.ContinuationPoints.size());
+
+  for (std::size_t i = 0; i < params.ContinuationPoints.size(); ++i)
+    {
+      ContinueBrowse(session, params.ContinuationPoints[i], params.ReleaseContinuationPoints, results[i]);
+    }
+
+  return results;
+}
+
+uint32_t AddressSpaceInMemory::GetMaxReferencesPerNode(uint32_t requested) const
+{
+  if (requested == 0)
+    {
+      return Limits.MaxReferencesPerNode;
+    }
+
+  if (Limits.MaxReferencesPerNode == 0)
+    {
+      return requested;
+    }
+
+  return std::min(requested, Limits.MaxReferencesPerNode);
+}
+
+std::vector<uint32_t> AddressSpaceInMemory::GetSuitableReferences(const NodeStruct & node, const BrowseDescription & desc) const
+{
+  const std::vector<ReferenceDescription> & references = node.References.All();
+  std::vector<uint32_t> indexes;
+
+  if (desc.ReferenceTypeId == ObjectId::Null)
+    {
+      for (uint32_t index = 0; index < references.size(); ++index)
+        {
+          if (IsSuitableReference(desc, references[index]))
+            {
+              indexes.push_back(index);
+            }
+        }
+
+      return indexes;
+    }
+
+  // Only groups of suitable type and direction are visited.
+  std::size_t groupsCount = 0;
+
+  for (const NodeReferences::Group & group : node.References.Groups())
+    {
+      if (IsSuitableGroup(desc, group))
+        {
+          for (uint32_t index : group.Indexes)
+            {
+              if (desc.NodeClasses == NodeClass::Unspecified || (desc.NodeClasses & references[index].TargetNodeClass) != NodeClass::Unspecified)
+                {
+                  indexes.push_back(index);
+                }
+            }
+
+          ++groupsCount;
+        }
+    }
+
+  if (groupsCount > 1)
+    {
+      // keep references in the order they were added
+      std::sort(indexes.begin(), indexes.end());
+    }
+
+  return indexes;
+}
+
+bool AddressSpaceInMemory::BrowseReferences(const NodeStruct & node, BrowseContinuation & position, BrowseResult & result) const
+{
+  const std::vector<ReferenceDescription> & references = node.References.All();
+
+  for (; position.Next < position.Indexes.size(); ++position.Next)
+    {
+      if (position.MaxReferencesPerNode != 0 && result.Referencies.size() == position.MaxReferencesPerNode)
+        {
+          return true;
+        }
+
+      // references are only appended, indexes stay valid
+      result.Referencies.push_back(references[position.Indexes[position.Next]]);
+    }
+
+  return false;
+}
+
+void AddressSpaceInMemory::KeepContinuationPoint(const NodeId & session, BrowseContinuation & position, BrowseResult & result) const
+{
+  std::lock_guard<std::mutex> lock(ContinuationPointsMutex);
+
+  SessionContinuationPoints & points = ContinuationPoints[session];
+
+  if (points.size() >= Limits.MaxContinuationPoints)
+    {
+      LOG_WARN(Logger, "address_space_internal| unable to allocate continuation point for session: {}: limit of {} points reached", session, Limits.MaxContinuationPoints);
+
+      if (points.empty())
+        {
+          ContinuationPoints.erase(session);
+        }
+
+      result.Status = StatusCode::BadNoContinuationPoints;
+      return;
+    }
+
+  uint64_t id = 0;
+
+  while (id == 0 || points.count(id))
+    {
+      id = static_cast<uint64_t>(ContinuationPointIds()) << 32 | ContinuationPointIds();
+    }
+
+  points.insert(std::make_pair(id, std::move(position)));
+
+  result.ContinuationPoint.resize(sizeof(id));
+
+  for (std::size_t i = 0; i < sizeof(id); ++i)
+    {
+      result.ContinuationPoint[i] = static_cast<uint8_t>(id >> (8 * i));
+    }
+}
+
+void AddressSpaceInMemory::ContinueBrowse(const NodeId & session, const std::vector<uint8_t> & continuationPoint, bool release, BrowseResult & result) const
+{
+  uint64_t id = 0;
+
+  for (std::size_t i = 0; i < continuationPoint.size() && i < sizeof(id); ++i)
+    {
+      id |= static_cast<uint64_t>(continuationPoint[i]) << (8 * i);
+    }
+
+  std::lock_guard<std::mutex> lock(ContinuationPointsMutex);
+
+  // points of other sessions are not visible
+  const auto session_it = ContinuationPoints.find(session);
+
+  if (session_it == ContinuationPoints.end() || continuationPoint.size() != sizeof(id) || !session_it->second.count(id))
+    {
+      LOG_DEBUG(Logger, "address_space_internal| continuation point not found for session: {}", session);
+
+      result.Status = StatusCode::BadContinuationPointInvalid;
+      return;
+    }
+
+  SessionContinuationPoints & points = session_it->second;
+  const auto it = points.find(id);
+  bool more = false;
+
+  if (!release)
+    {
+      const NodeStruct * node = Nodes.Find(it->second.Description.NodeToBrowse);
+
+      if (node)
+        {
+          more = BrowseReferences(*node, it->second, result);
+        }
+
+      else
+        {
+          result.Status = StatusCode::BadNodeIdUnknown;
+        }
+    }
+
+  if (more)
+    {
+      // the same point continues with the next page
+      result.ContinuationPoint = continuationPoint;
+      return;
+    }
+
+  points.erase(it);
+
+  if (points.empty())
+    {
+      ContinuationPoints.erase(session_it);
+    }
+}
+
+void AddressSpaceInMemory::ReleaseContinuationPoints(const NodeId & session) const
+{
+  std::lock_guard<std::mutex> lock(ContinuationPointsMutex);
+
+  const auto session_it = ContinuationPoints.find(session);
+
+  if (session_it != ContinuationPoints.end())
+    {
+      LOG_DEBUG(Logger, "address_space_internal| releasing {} continuation points of session: {}", session_it->second.size(), session);
+      ContinuationPoints.erase(session_it);
+    }
 }
 
 std::vector<NodeId> AddressSpaceInMemory::RegisterNodes(const std::vector<NodeId> & params) const
 {
-  boost::unique_lock<boost::shared_mutex> lock(DbMutex);
+  boost::shared_lock<boost::shared_mutex> lock(DbMutex);
 
   return params;
 }
 
 void AddressSpaceInMemory::UnregisterNodes(const std::vector<NodeId> & params) const
 {
-  boost::unique_lock<boost::shared_mutex> lock(DbMutex);
+  boost::shared_lock<boost::shared_mutex> lock(DbMutex);
 
   return;
 }
 
 std::vector<DataValue> AddressSpaceInMemory::Read(const ReadParameters & params) const
+{
+  std::vector<SourceBatch> batches;
+  std::vector<DataValue> values = ReadValues(params, batches);
+
+  if (batches.empty())
+    {
+      return values;
+    }
+
+  std::shared_ptr<std::promise<std::vector<DataValue>>> read = std::make_shared<std::promise<std::vector<DataValue>>>();
+  std::future<std::vector<DataValue>> result = read->get_future();
+  std::shared_ptr<PendingRead> pending = ReadSources(std::move(values), batches, [read](std::vector<DataValue> values)
+  {
+    read->set_value(std::move(values));
+  });
+
+  if (result.wait_for(DataSourceTimeout) == std::future_status::timeout)
+    {
+      LOG_WARN(Logger, "address_space_internal| data sources did not complete read in {} ms", DataSourceTimeout.count());
+
+      // late values of the sources are dropped
+      ExpireRead(pending, StatusCode::BadTimeout);
+    }
+
+  return result.get();
+}
+
+void AddressSpaceInMemory::ReadAsync(const ReadParameters & params, Server::DataSource::ReadCallback done) const
+{
+  std::vector<SourceBatch> batches;
+  std::vector<DataValue> values = ReadValues(params, batches);
+
+  if (batches.empty())
+    {
+      done(std::move(values));
+      return;
+    }
+
+  std::shared_ptr<PendingRead> pending = ReadSources(std::move(values), batches, done);
+  const Common::Logger::SharedPtr logger = Logger;
+  const std::chrono::milliseconds timeout = DataSourceTimeout;
+
+  // bounded as Read, late values of the sources are dropped;
+  // the read is kept until expiration, sources may drop done without calling it
+  ExpiringReads.Add(std::chrono::steady_clock::now() + timeout, [pending, logger, timeout]()
+  {
+    try
+      {
+        if (ExpireRead(pending, StatusCode::BadTimeout))
+          {
+            LOG_WARN(logger, "address_space_internal| data sources did not complete read in {} ms", timeout.count());
+          }
+      }
+
+    catch (const std::exception & exc)
+      {
+        LOG_ERROR(logger, "address_space_internal| read callback failed: {}", exc.what());
+      }
+  });
+}
+
+std::vector<DataValue> AddressSpaceInMemory::ReadValues(const ReadParameters & params, std::vector<SourceBatch> & batches) const
 {
   boost::shared_lock<boost::shared_mutex> lock(DbMutex);
 
   std::vector<DataValue> values;
+  values.reserve(params.AttributesToRead.size());
 
   for (const ReadValueId & attribute : params.AttributesToRead)
     {
-      values.push_back(GetValue(attribute.NodeId, attribute.AttributeId));
+      const AttributeValue * attrValue = FindAttribute(attribute.NodeId, attribute.AttributeId);
+
+      if (attrValue && attrValue->Source)
+        {
+          auto batch = std::find_if(batches.begin(), batches.end(), [attrValue](const SourceBatch & batch)
+          {
+            return batch.Source == attrValue->Source;
+          });
+
+          if (batch == batches.end())
+            {
+              batches.push_back(SourceBatch());
+              batch = batches.end() - 1;
+              batch->Source = attrValue->Source;
+            }
+
+          // read by the data source once the lock is released
+          batch->Items.push_back(attribute);
+          batch->Indexes.push_back(values.size());
+          values.push_back(DataValue());
+          continue;
+        }
+
+      values.push_back(GetValue(attrValue));
     }
 
   return values;
 }
 
-std::vector<StatusCode> AddressSpaceInMemory::Write(const std::vector<OpcUa::WriteValue> & values)
+std::shared_ptr<AddressSpaceInMemory::PendingRead> AddressSpaceInMemory::ReadSources(std::vector<DataValue> values, const std::vector<SourceBatch> & batches, Server::DataSource::ReadCallback done) const
 {
-  boost::unique_lock<boost::shared_mutex> lock(DbMutex);
+  std::shared_ptr<PendingRead> pending = std::make_shared<PendingRead>();
+  pending->Values = std::move(values);
+  pending->Remaining = batches.size();
+  pending->Done = done;
 
-  std::vector<StatusCode> statuses;
+  for (const SourceBatch & batch : batches)
+    {
+      pending->Indexes.push_back(batch.Indexes);
+    }
 
-  for (WriteValue value : values)
+  for (std::size_t batch = 0; batch < batches.size(); ++batch)
     {
-      if (value.Value.Encoding & DATA_VALUE)
+      try
         {
-          statuses.push_back(SetValue(value.NodeId, value.AttributeId, value.Value));
-          continue;
+          batches[batch].Source->Read(batches[batch].Items, [pending, batch](std::vector<DataValue> read)
+          {
+            CompleteBatch(pending, batch, std::move(read), StatusCode::BadInternalError);
+          });
+        }
+
+      catch (const std::exception & exc)
+        {
+          LOG_ERROR(Logger, "address_space_internal| data source failed to read {} items: {}", batches[batch].Items.size(), exc.what());
+
+          // batches already handed over to other sources still complete the read
+          CompleteBatch(pending, batch, std::vector<DataValue>(), StatusCode::BadInternalError);
         }
 
-      statuses.push_back(StatusCode::BadNotWritable);
+      catch (...)
+        {
+          LOG_ERROR(Logger, "address_space_internal| data source failed to read {} items", batches[batch].Items.size());
+
+          CompleteBatch(pending, batch, std::vector<DataValue>(), StatusCode::BadInternalError);
+        }
+    }
+
+  return pending;
+}
+
+bool AddressSpaceInMemory::CompleteBatch(const std::shared_ptr<PendingRead> & pending, std::size_t batch, std::vector<DataValue> read, StatusCode missing)
+{
+  Server::DataSource::ReadCallback done;
+  std::vector<DataValue> values;
+  {
+    std::lock_guard<std::mutex> lock(pending->Mutex);
+    std::vector<std::size_t> & indexes = pending->Indexes[batch];
+
+    // completed already, by a source calling done twice or by expiration
+    if (indexes.empty())
+      {
+        return false;
+      }
+
+    // every batch fills its own values
+    for (std::size_t i = 0; i < indexes.size(); ++i)
+      {
+        DataValue & value = pending->Values[indexes[i]];
+
+        if (i < read.size())
+          {
+            value = std::move(read[i]);
+          }
+
+        else
+          {
+            value.Encoding = DATA_VALUE_STATUS_CODE;
+            value.Status = missing;
+          }
+      }
+
+    indexes.clear();
+
+    if (--pending->Remaining != 0)
+      {
+        return true;
+      }
+
+    done.swap(pending->Done);
+    values = std::move(pending->Values);
+  }
+
+  done(std::move(values));
+  return true;
+}
+
+bool AddressSpaceInMemory::ExpireRead(const std::shared_ptr<PendingRead> & pending, StatusCode status)
+{
+  bool expired = false;
+
+  for (std::size_t batch = 0; batch < pending->Indexes.size(); ++batch)
+    {
+      expired |= CompleteBatch(pending, batch, std::vector<DataValue>(), status);
     }
 
+  return expired;
+}
+
+std::vector<StatusCode> AddressSpaceInMemory::Write(const std::vector<OpcUa::WriteValue> & values)
+{
+  std::vector<StatusCode> statuses;
+  std::vector<NodeHandle> notified;
+
+  {
+    // values are written under locks of their nodes
+    boost::shared_lock<boost::shared_mutex> lock(DbMutex);
+
+    for (const WriteValue & value : values)
+      {
+        if (value.Value.Encoding & DATA_VALUE)
+          {
+            statuses.push_back(SetValue(value.NodeId, value.AttributeId, value.Value, notified));
+            continue;
+          }
+
+        statuses.push_back(StatusCode::BadNotWritable);
+      }
+  }
+
+  Dispatcher.Dispatch(notified);
   return statuses;
 }
 
 std::tuple<bool, NodeId> AddressSpaceInMemory::FindElementInNode(const NodeId & nodeid, const RelativePathElement & element) const
 {
-  NodesMap::const_iterator nodeit = Nodes.find(nodeid);
+  const NodeStruct * node = Nodes.Find(nodeid);
 
-  if (nodeit != Nodes.end())
+  if (node)
     {
-      for (auto reference : nodeit->second.References)
+      const ReferenceDescription * reference = node->References.FindByBrowseName(element.TargetName);
+
+      if (reference)
         {
-          //if (reference.first == current) { std::cout <<   reference.second.BrowseName.NamespaceIndex << reference.second.BrowseName.Name << " to " << element.TargetName.NamespaceIndex << element.TargetName.Name <<std::endl; }
-          if (reference.BrowseName == element.TargetName)
-            {
-              return std::make_tuple(true, reference.TargetNodeId);
-            }
+          return std::make_tuple(true, reference->TargetNodeId);
         }
     }
 
@@ -233,37 +958,44 @@ BrowsePathResult AddressSpaceInMemory::TranslateBrowsePath(const BrowsePath & br
   return result;
 }
 
-DataValue AddressSpaceInMemory::GetValue(const NodeId & node, AttributeId attribute) const
+boost::shared_mutex & AddressSpaceInMemory::GetNodeMutex(NodeHandle node) const
+{
+  return NodeMutexes[node % NodeMutexes.size()];
+}
+
+const AttributeValue * AddressSpaceInMemory::FindAttribute(const NodeId & node, AttributeId attribute) const
 {
-  NodesMap::const_iterator nodeit = Nodes.find(node);
+  const NodeHandle nodeHandle = Nodes.FindHandle(node);
 
-  if (nodeit == Nodes.end())
+  if (nodeHandle == InvalidNodeHandle)
     {
 //      LOG_DEBUG(Logger, "address_space_internal| node not found: {}", node);
+      return nullptr;
     }
 
-  else
-    {
-      AttributesMap::const_iterator attrit = nodeit->second.Attributes.find(attribute);
+  return Nodes.Get(nodeHandle).Attributes.Find(attribute);
+}
 
-      if (attrit == nodeit->second.Attributes.end())
-        {
-//          LOG_DEBUG(Logger, "address_space_internal| node: {} has no attribute: {}", node, ToString(attribute));
-        }
+DataValue AddressSpaceInMemory::GetValue(const NodeId & node, AttributeId attribute) const
+{
+  return GetValue(FindAttribute(node, attribute));
+}
 
-      else
+DataValue AddressSpaceInMemory::GetValue(const AttributeValue * attrValue) const
+{
+  if (attrValue)
+    {
+      if (attrValue->GetValueCallback)
         {
-          if (attrit->second.GetValueCallback)
-            {
-              LOG_DEBUG(Logger, "address_space_internal| invoke registered callback");
+          LOG_DEBUG(Logger, "address_space_internal| invoke registered callback");
 
-              return attrit->second.GetValueCallback();
-            }
+          return attrValue->GetValueCallback();
+        }
 
-//          LOG_TRACE(Logger, "address_space_internal| no callback registered, returning stored value");
+//      LOG_TRACE(Logger, "address_space_internal| no callback registered, returning stored value");
 
-          return attrit->second.Value;
-        }
+      const std::shared_ptr<const DataValue> value = attrValue->Load();
+      return value ? *value : DataValue();
     }
 
   DataValue value;
@@ -274,61 +1006,86 @@ DataValue AddressSpaceInMemory::GetValue(const NodeId & node, AttributeId attrib
 
 uint32_t AddressSpaceInMemory::AddDataChangeCallback(const NodeId & node, AttributeId attribute, std::function<Server::DataChangeCallback> callback)
 {
-  boost::unique_lock<boost::shared_mutex> lock(DbMutex);
+  boost::shared_lock<boost::shared_mutex> lock(DbMutex);
 
   LOG_DEBUG(Logger, "address_space_internal| set data changes callback for node {} and attribute {}", node, (unsigned)attribute);
 
-  NodesMap::iterator it = Nodes.find(node);
+  const NodeHandle nodeHandle = Nodes.FindHandle(node);
 
-  if (it == Nodes.end())
+  if (nodeHandle == InvalidNodeHandle)
     {
       LOG_ERROR(Logger, "address_space_internal| Node: '{}' not found", node);
       throw std::runtime_error("address_space_internal| NodeId not found");
     }
 
-  AttributesMap::iterator ait = it->second.Attributes.find(attribute);
-
-  if (ait == it->second.Attributes.end())
-    {
-      LOG_ERROR(Logger, "address_space_internal| Attribute: {} of node: ‘{}‘ not found", (unsigned)attribute, node);
-      throw std::runtime_error("Attribute not found");
-    }
-
   uint32_t handle = ++DataChangeCallbackHandle;
-  DataChangeCallbackData data;
-  data.Callback = callback;
-  ait->second.DataChangeCallbacks[handle] = data;
-  ClientIdToAttributeMap[handle] = NodeAttribute(node, attribute);
+
+  {
+    boost::unique_lock<boost::shared_mutex> nodeLock(GetNodeMutex(nodeHandle));
+    AttributeValue * attrValue = Nodes.Get(nodeHandle).Attributes.Find(attribute);
+
+    if (!attrValue)
+      {
+        LOG_ERROR(Logger, "address_space_internal| Attribute: {} of node: ‘{}‘ not found", (unsigned)attribute, node);
+        throw std::runtime_error("Attribute not found");
+      }
+
+    std::shared_ptr<DataChangeCallbackMap> callbacks = attrValue->DataChangeCallbacks ? std::make_shared<DataChangeCallbackMap>(*attrValue->DataChangeCallbacks) : std::make_shared<DataChangeCallbackMap>();
+    DataChangeCallbackData data;
+    data.Callback = callback;
+    (*callbacks)[handle] = data;
+    attrValue->DataChangeCallbacks = callbacks;
+  }
+
+  std::lock_guard<std::mutex> callbacksLock(CallbacksMutex);
+  ClientIdToAttributeMap[handle] = NodeAttribute(nodeHandle, attribute);
   return handle;
 }
 
 void AddressSpaceInMemory::DeleteDataChangeCallback(uint32_t serverhandle)
 {
-  boost::unique_lock<boost::shared_mutex> lock(DbMutex);
+  boost::shared_lock<boost::shared_mutex> lock(DbMutex);
 
   LOG_DEBUG(Logger, "address_space_internal| deleting callback with client id: {}", serverhandle);
 
-  ClientIdToAttributeMapType::iterator it = ClientIdToAttributeMap.find(serverhandle);
+  NodeAttribute nodeAttribute;
+  {
+    std::lock_guard<std::mutex> callbacksLock(CallbacksMutex);
+    ClientIdToAttributeMapType::iterator it = ClientIdToAttributeMap.find(serverhandle);
 
-  if (it == ClientIdToAttributeMap.end())
-    {
-      LOG_WARN(Logger, "address_space_internal| request to delete a callback using unknown handle: {1}", serverhandle);
-      return;
-    }
+    if (it == ClientIdToAttributeMap.end())
+      {
+        LOG_WARN(Logger, "address_space_internal| request to delete a callback using unknown handle: {}", serverhandle);
+        return;
+      }
 
-  NodesMap::iterator nodeit = Nodes.find(it->second.Node);
+    nodeAttribute = it->second;
+    ClientIdToAttributeMap.erase(it);
+  }
 
-  if (nodeit != Nodes.end())
+  if (nodeAttribute.Node != InvalidNodeHandle)
     {
-      AttributesMap::iterator ait = nodeit->second.Attributes.find(it->second.Attribute);
+      boost::unique_lock<boost::shared_mutex> nodeLock(GetNodeMutex(nodeAttribute.Node));
+      AttributeValue * attrValue = Nodes.Get(nodeAttribute.Node).Attributes.Find(nodeAttribute.Attribute);
 
-      if (ait != nodeit->second.Attributes.end())
+      if (attrValue)
         {
-          size_t nb = ait->second.DataChangeCallbacks.erase(serverhandle);
+          std::shared_ptr<DataChangeCallbackMap> callbacks = std::make_shared<DataChangeCallbackMap>();
+
+          if (attrValue->DataChangeCallbacks)
+            {
+              *callbacks = *attrValue->DataChangeCallbacks;
+            }
+
+          size_t nb = callbacks->erase(serverhandle);
+          attrValue->DataChangeCallbacks = callbacks;
+          nodeLock.unlock();
+          lock.unlock();
 
           LOG_DEBUG(Logger, "address_space_internal| deleted {} callbacks", nb);
 
-          ClientIdToAttributeMap.erase(serverhandle);
+          // queued notifications may still refer to the deleted callback
+          Dispatcher.Flush(nodeAttribute.Node);
           return;
         }
     }
@@ -338,17 +1095,18 @@ void AddressSpaceInMemory::DeleteDataChangeCallback(uint32_t serverhandle)
 
 StatusCode AddressSpaceInMemory::SetValueCallback(const NodeId & node, AttributeId attribute, std::function<DataValue(void)> callback)
 {
+  // readers call value callbacks without node locks
   boost::unique_lock<boost::shared_mutex> lock(DbMutex);
 
-  NodesMap::iterator it = Nodes.find(node);
+  NodeStruct * nodeStruct = Nodes.Find(node);
 
-  if (it != Nodes.end())
+  if (nodeStruct)
     {
-      AttributesMap::iterator ait = it->second.Attributes.find(attribute);
+      AttributeValue * attrValue = nodeStruct->Attributes.Find(attribute);
 
-      if (ait != it->second.Attributes.end())
+      if (attrValue)
         {
-          ait->second.GetValueCallback = callback;
+          attrValue->GetValueCallback = callback;
           return StatusCode::Good;
         }
     }
@@ -356,15 +1114,56 @@ StatusCode AddressSpaceInMemory::SetValueCallback(const NodeId & node, Attribute
   return StatusCode::BadAttributeIdInvalid;
 }
 
+bool AddressSpaceInMemory::HasValueCallback(const NodeId & node, AttributeId attribute) const
+{
+  boost::shared_lock<boost::shared_mutex> lock(DbMutex);
+
+  const NodeStruct * nodeStruct = Nodes.Find(node);
+
+  if (!nodeStruct)
+    {
+      return false;
+    }
+
+  const AttributeValue * attrValue = nodeStruct->Attributes.Find(attribute);
+  return attrValue && (attrValue->GetValueCallback || attrValue->Source);
+}
+
+StatusCode AddressSpaceInMemory::SetDataSource(const NodeId & node, AttributeId attribute, Server::DataSource::SharedPtr source)
+{
+  boost::unique_lock<boost::shared_mutex> lock(DbMutex);
+
+  NodeStruct * nodeStruct = Nodes.Find(node);
+
+  if (nodeStruct)
+    {
+      AttributeValue * attrValue = nodeStruct->Attributes.Find(attribute);
+
+      if (attrValue)
+        {
+          attrValue->Source = source;
+          return StatusCode::Good;
+        }
+    }
+
+  return StatusCode::BadAttributeIdInvalid;
+}
+
+std::vector<NodeId> AddressSpaceInMemory::GetSubtypes(const NodeId & type) const
+{
+  boost::shared_lock<boost::shared_mutex> lock(DbMutex);
+  return ReferenceTypes.GetSubtypes(type);
+}
+
 void AddressSpaceInMemory::SetMethod(const NodeId & node, std::function<std::vector<OpcUa::Variant> (NodeId context, std::vector<OpcUa::Variant> arguments)> callback)
 {
   boost::unique_lock<boost::shared_mutex> lock(DbMutex);
 
-  NodesMap::iterator it = Nodes.find(node);
+  NodeStruct * nodeStruct = Nodes.Find(node);
 
-  if (it != Nodes.end())
+  if (nodeStruct)
     {
-      it->second.Method = callback;
+      nodeStruct->Method = callback;
     }
 
   else
@@ -390,23 +1189,23 @@ std::vector<OpcUa::CallMethodResult> AddressSpaceInMemory::Call(const std::vecto
 CallMethodResult AddressSpaceInMemory::CallMethod(CallMethodRequest request)
 {
   CallMethodResult result;
-  NodesMap::iterator node_it = Nodes.find(request.ObjectId);
+  const NodeStruct * object = Nodes.Find(request.ObjectId);
 
-  if (node_it == Nodes.end())
+  if (!object)
     {
       result.Status = StatusCode::BadNodeIdUnknown;
       return result;
     }
 
-  NodesMap::iterator method_it = Nodes.find(request.MethodId);
+  const NodeStruct * method = Nodes.Find(request.MethodId);
 
-  if (method_it == Nodes.end())
+  if (!method)
     {
       result.Status = StatusCode::BadNodeIdUnknown;
       return result;
     }
 
-  if (! method_it->second.Method)
+  if (! method->Method)
     {
       result.Status = StatusCode::BadNothingToDo;
       return result;
@@ -415,7 +1214,7 @@ CallMethodResult AddressSpaceInMemory::CallMethod(CallMethodRequest request)
   //FIXME: find a way to return more information about failure to client
   try
     {
-      result.OutputArguments = method_it->second.Method(node_it->first, request.InputArguments);
+      result.OutputArguments = method->Method(object->Id, request.InputArguments);
     }
 
   catch (std::exception & ex)
@@ -434,24 +1233,32 @@ CallMethodResult AddressSpaceInMemory::CallMethod(CallMethodRequest request)
   return result;
 }
 
-StatusCode AddressSpaceInMemory::SetValue(const NodeId & node, AttributeId attribute, const DataValue & data)
+StatusCode AddressSpaceInMemory::SetValue(const NodeId & node, AttributeId attribute, const DataValue & data, std::vector<NodeHandle> & notified)
 {
-  NodesMap::iterator it = Nodes.find(node);
+  const NodeHandle nodeHandle = Nodes.FindHandle(node);
 
-  if (it != Nodes.end())
+  if (nodeHandle != InvalidNodeHandle)
     {
-      AttributesMap::iterator ait = it->second.Attributes.find(attribute);
+      boost::unique_lock<boost::shared_mutex> nodeLock(GetNodeMutex(nodeHandle));
+      NodeStruct * nodeStruct = &Nodes.Get(nodeHandle);
+      AttributeValue * attrValue = nodeStruct->Attributes.Find(attribute);
 
-      if (ait != it->second.Attributes.end())
+      if (attrValue)
         {
           DataValue value(data);
           value.SetServerTimestamp(DateTime::Current());
-          ait->second.Value = value;
+          const std::shared_ptr<const DataValue> snapshot = attrValue->Store(value);
 
-          //call registered callback
-          for (auto pair : ait->second.DataChangeCallbacks)
+          // registered callbacks are called by Write when locks are released
+          if (attrValue->DataChangeCallbacks && !attrValue->DataChangeCallbacks->empty())
             {
-              pair.second.Callback(it->first, ait->first, ait->second.Value);
+              DataChangeNotification notification;
+              notification.Callbacks = attrValue->DataChangeCallbacks;
+              notification.Node = nodeStruct->Id;
+              notification.Attribute = attribute;
+              notification.Value = snapshot;
+              Dispatcher.Push(nodeHandle, std::move(notification));
+              notified.push_back(nodeHandle);
             }
 
           return StatusCode::Good;
@@ -471,7 +1278,7 @@ bool AddressSpaceInMemory::IsSuitableReference(const BrowseDescription & desc, c
       return false;
     }
 
-  if (desc.ReferenceTypeId != ObjectId::Null && !IsSuitableReferenceType(reference, desc.ReferenceTypeId, desc.IncludeSubtypes))
+  if (desc.ReferenceTypeId != ObjectId::Null && !IsSuitableReferenceType(reference.ReferenceTypeId, desc.ReferenceTypeId, desc.IncludeSubtypes))
     {
 //      LOG_TRACE(Logger, "address_space_internal| reference has wrong type");
       return false;
@@ -487,47 +1294,24 @@ bool AddressSpaceInMemory::IsSuitableReference(const BrowseDescription & desc, c
   return true;
 }
 
-bool AddressSpaceInMemory::IsSuitableReferenceType(const ReferenceDescription & reference, const NodeId & typeId, bool includeSubtypes) const
+bool AddressSpaceInMemory::IsSuitableGroup(const BrowseDescription & desc, const NodeReferences::Group & group) const
 {
-  if (!includeSubtypes)
+  if ((desc.Direction == BrowseDirection::Forward && !group.IsForward) || (desc.Direction == BrowseDirection::Inverse && group.IsForward))
     {
-      return reference.ReferenceTypeId == typeId;
+      return false;
     }
 
-  const std::vector<NodeId> suitableTypes = SelectNodesHierarchy(std::vector<NodeId>(1, typeId));
-  const auto resultIt = std::find(suitableTypes.begin(), suitableTypes.end(), reference.ReferenceTypeId);
-  \
-  return resultIt != suitableTypes.end();
+  return IsSuitableReferenceType(group.ReferenceTypeId, desc.ReferenceTypeId, desc.IncludeSubtypes);
 }
 
-std::vector<NodeId> AddressSpaceInMemory::SelectNodesHierarchy(std::vector<NodeId> sourceNodes) const
+bool AddressSpaceInMemory::IsSuitableReferenceType(const NodeId & referenceTypeId, const NodeId & typeId, bool includeSubtypes) const
 {
-  std::vector<NodeId> subNodes;
-
-  for (NodeId nodeid : sourceNodes)
-    {
-      NodesMap::const_iterator node_it = Nodes.find(nodeid);
-
-      if (node_it != Nodes.end())
-        {
-          for (auto & ref : node_it->second.References)
-            {
-              if (ref.IsForward)
-                {
-                  subNodes.push_back(ref.TargetNodeId);
-                }
-            }
-        }
-    }
-
-  if (subNodes.empty())
+  if (!includeSubtypes)
     {
-      return sourceNodes;
+      return referenceTypeId == typeId;
     }
 
-  const std::vector<NodeId> allChilds = SelectNodesHierarchy(subNodes);
-  sourceNodes.insert(sourceNodes.end(), allChilds.begin(), allChilds.end());
-  return sourceNodes;
+  return ReferenceTypes.IsSubtypeOf(referenceTypeId, typeId);
 }
 
 AddNodesResult AddressSpaceInMemory::AddNode(const AddNodesItem & item)
@@ -538,20 +1322,20 @@ AddNodesResult AddressSpaceInMemory::AddNode(const AddNodesItem & item)
 
   const NodeId resultId = GetNewNodeId(item.RequestedNewNodeId);
 
-  if (!Nodes.empty() && resultId != ObjectId::Null && Nodes.find(resultId) != Nodes.end())
+  if (resultId != ObjectId::Null && Nodes.Contains(resultId))
     {
       LOG_ERROR(Logger, "address_space_internal| NodeId: '{}' already exists", resultId);
       result.Status = StatusCode::BadNodeIdExists;
       return result;
     }
 
-  NodesMap::iterator parent_node_it = Nodes.end();
+  NodeHandle parentHandle = InvalidNodeHandle;
 
   if (item.ParentNodeId != NodeId())
     {
-      parent_node_it = Nodes.find(item.ParentNodeId);
+      parentHandle = Nodes.FindHandle(item.ParentNodeId);
 
-      if (parent_node_it == Nodes.end())
+      if (parentHandle == InvalidNodeHandle)
         {
           LOG_ERROR(Logger, "address_space_internal| parent node '{}' does not exists", item.ParentNodeId);
           result.Status = StatusCode::BadParentNodeIdInvalid;
@@ -559,27 +1343,39 @@ AddNodesResult AddressSpaceInMemory::AddNode(const AddNodesItem & item)
         }
     }
 
+  for (const auto & attr : item.Attributes.Attributes)
+    {
+      if (!AttributesMap::IsValid(attr.first))
+        {
+          LOG_ERROR(Logger, "address_space_internal| invalid attribute id: {} of node: '{}'", static_cast<uint32_t>(attr.first), resultId);
+          result.Status = StatusCode::BadAttributeIdInvalid;
+          return result;
+        }
+    }
+
   NodeStruct nodestruct;
+  nodestruct.Id = resultId;
   //Add Common attributes
-  nodestruct.Attributes[AttributeId::NodeId].Value = resultId;
-  nodestruct.Attributes[AttributeId::BrowseName].Value = item.BrowseName;
-  nodestruct.Attributes[AttributeId::NodeClass].Value = static_cast<int32_t>(item.Class);
+  nodestruct.Attributes[AttributeId::NodeId].Store(DataValue(resultId));
+  nodestruct.Attributes[AttributeId::BrowseName].Store(DataValue(item.BrowseName));
+  nodestruct.Attributes[AttributeId::NodeClass].Store(DataValue(static_cast<int32_t>(item.Class)));
 
   // Add requested attributes
   for (const auto & attr : item.Attributes.Attributes)
     {
-      AttributeValue attval;
-      attval.Value = attr.second;
-
-      nodestruct.Attributes.insert(std::make_pair(attr.first, attval));
+      // common attributes set above are not overridden
+      if (!nodestruct.Attributes.Find(attr.first))
+        {
+          nodestruct.Attributes[attr.first].Store(DataValue(attr.second));
+        }
     }
 
-  Nodes.insert(std::make_pair(resultId, nodestruct));
+  Nodes.Insert(std::move(nodestruct));
 
-  if (parent_node_it != Nodes.end())
+  if (parentHandle != InvalidNodeHandle)
     {
       // Link from parent to child
-      NodeStruct& parent = parent_node_it->second;
+      NodeStruct & parent = Nodes.Get(parentHandle);
 
       ReferenceDescription desc;
       desc.ReferenceTypeId = item.ReferenceTypeId;
@@ -590,14 +1386,15 @@ AddNodesResult AddressSpaceInMemory::AddNode(const AddNodesItem & item)
       desc.TargetNodeTypeDefinition = item.TypeDefinition;
       desc.IsForward = true; // should this be in constructor?
 
-      parent.References.push_back(desc);
+      parent.References.Add(desc);
 
       // Link to parent
       AddReferencesItem typeRef;
       typeRef.ReferenceTypeId = item.ReferenceTypeId;
       typeRef.SourceNodeId = resultId;
       typeRef.TargetNodeId = item.ParentNodeId;
-      typeRef.TargetNodeClass = static_cast<NodeClass>(parent.Attributes[AttributeId::NodeClass].Value.Value.As<int32_t>());
+      const AttributeValue * parentClass = parent.Attributes.Find(AttributeId::NodeClass);
+      typeRef.TargetNodeClass = parentClass ? static_cast<NodeClass>(parentClass->Load()->Value.As<int32_t>()) : NodeClass::Unspecified;
       typeRef.IsForward = false;
       AddReference(typeRef);
     }
@@ -624,16 +1421,14 @@ AddNodesResult AddressSpaceInMemory::AddNode(const AddNodesItem & item)
 
 StatusCode AddressSpaceInMemory::AddReference(const AddReferencesItem & item)
 {
-  NodesMap::iterator node_it = Nodes.find(item.SourceNodeId);
+  NodeStruct * node = Nodes.Find(item.SourceNodeId);
 
-  if (node_it == Nodes.end())
+  if (!node)
     {
       return StatusCode::BadSourceNodeIdInvalid;
     }
 
-  NodesMap::iterator targetnode_it = Nodes.find(item.TargetNodeId);
-
-  if (targetnode_it == Nodes.end())
+  if (!Nodes.Contains(item.TargetNodeId))
     {
       return StatusCode::BadTargetNodeIdInvalid;
     }
@@ -667,7 +1462,21 @@ StatusCode AddressSpaceInMemory::AddReference(const AddReferencesItem & item)
       desc.DisplayName = LocalizedText(desc.BrowseName.Name);
     }
 
-  node_it->second.References.push_back(desc);
+  node->References.Add(desc);
+
+  if (item.ReferenceTypeId == ObjectId::HasSubtype)
+    {
+      if (item.IsForward)
+        {
+          ReferenceTypes.AddSubtype(item.SourceNodeId, item.TargetNodeId);
+        }
+
+      else
+        {
+          ReferenceTypes.AddSubtype(item.TargetNodeId, item.SourceNodeId);
+        }
+    }
+
   return StatusCode::Good;
 }
 
@@ -702,7 +1511,7 @@ NodeId AddressSpaceInMemory::GetNewNodeId(const NodeId & id)
     {
       NodeId result = OpcUa::NumericNodeId(++MaxNodeIdNum, idx);
 
-      if (Nodes.find(result) == Nodes.end())
+      if (!Nodes.Contains(result))
         {
           return result;
         }
@@ -723,5 +1532,15 @@ AddressSpace::UniquePtr CreateAddressSpace(const Common::Logger::SharedPtr & log
 {
   return AddressSpace::UniquePtr(new Internal::AddressSpaceInMemory(logger));
 }
+
+AddressSpace::UniquePtr CreateAddressSpace(const Common::Logger::SharedPtr & logger, const BrowseLimits & limits)
+{
+  return AddressSpace::UniquePtr(new Internal::AddressSpaceInMemory(logger, limits));
+}
+
+AddressSpace::UniquePtr CreateAddressSpace(const Common::Logger::SharedPtr & logger, const BrowseLimits & limits, uint32_t dataSourceTimeout)
+{
+  return AddressSpace::UniquePtr(new Internal::AddressSpaceInMemory(logger, limits, dataSourceTimeout));
+}
 }
 }
@@ -20,14 +20,27 @@
 
 #include <boost/thread/locks.hpp>
 #include <boost/thread/shared_mutex.hpp>
+#include <algorithm>
+#include <array>
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
 #include <ctime>
+#include <functional>
+#include <future>
 #include <limits>
 #include <list>
 #include <map>
+#include <memory>
+#include <mutex>
 #include <queue>
+#include <random>
 #include <deque>
 #include <set>
 #include <thread>
+#include <unordered_map>
+#include <unordered_set>
+#include <vector>
 
 
 
@@ -38,12 +51,18 @@ namespace Internal
 
 class InternalSubscription;
 
+/// @brief Dense handle of a node in the address space.
+/// Handles are never reused and stay valid while the address space exists.
+typedef uint32_t NodeHandle;
+
+const NodeHandle InvalidNodeHandle = std::numeric_limits<NodeHandle>::max();
+
 struct NodeAttribute
 {
-  NodeId Node;
+  NodeHandle Node;
   AttributeId Attribute;
-  NodeAttribute(NodeId node, AttributeId attribute) : Node(node), Attribute(attribute) {}
-  NodeAttribute() {} //seems compiler wants this one
+  NodeAttribute(NodeHandle node, AttributeId attribute) : Node(node), Attribute(attribute) {}
+  NodeAttribute() : Node(InvalidNodeHandle), Attribute(AttributeId::Unknown) {} //seems compiler wants this one
 };
 
 typedef std::map<uint32_t, NodeAttribute> ClientIdToAttributeMapType;
@@ -59,28 +78,355 @@ typedef std::map<uint32_t, DataChangeCallbackData> DataChangeCallbackMap;
 //Store an attribute value together with a link to all its suscriptions
 struct AttributeValue
 {
-  DataValue Value;
-  DataChangeCallbackMap DataChangeCallbacks;
+  /// @brief Current value of the attribute.
+  /// Published value is never modified: a write stores a new snapshot,
+  /// so readers do not need a lock of the node.
+  std::shared_ptr<const DataValue> Load() const
+  {
+    return std::atomic_load(&Value);
+  }
+
+  std::shared_ptr<const DataValue> Store(const DataValue & value)
+  {
+    std::shared_ptr<const DataValue> snapshot = std::make_shared<const DataValue>(value);
+    std::atomic_store(&Value, snapshot);
+    return snapshot;
+  }
+
+  /// @brief Callbacks called when the value is changed.
+  /// The map is replaced on every change, so notifications queued by writers keep callbacks they have to call.
+  std::shared_ptr<const DataChangeCallbackMap> DataChangeCallbacks;
   std::function<DataValue(void)> GetValueCallback;
+  Server::DataSource::SharedPtr Source; // reads are handed over to it
+
+private:
+  std::shared_ptr<const DataValue> Value;
+};
+
+struct DataChangeNotification
+{
+  std::shared_ptr<const DataChangeCallbackMap> Callbacks;
+  NodeId Node;
+  AttributeId Attribute;
+  std::shared_ptr<const DataValue> Value;
+};
+
+/// @brief Calls data change callbacks after locks of the address space are released.
+/// Writers push notifications under the lock of the written node, so notifications
+/// of a node are queued in order of writes. Every node has its own queue delivered
+/// by one thread at a time in the same order. Each writer delivers at most the
+/// notifications of its nodes queued up to its own, and those its callbacks queue,
+/// waiting while another writer of the same node delivers: a write returns once its
+/// callbacks have run and never delivers for later writers. Writers of unrelated
+/// nodes do not wait for each other's callbacks.
+/// Exceptions thrown by callbacks are logged and do not stop delivery.
+class DataChangeDispatcher
+{
+public:
+  explicit DataChangeDispatcher(const Common::Logger::SharedPtr & logger);
+
+  void Push(NodeHandle node, DataChangeNotification && notification);
+
+  /// @brief Deliver notifications of nodes queued before the call.
+  void Dispatch(const std::vector<NodeHandle> & nodes);
+
+  /// @brief Deliver notifications of node queued before the call.
+  /// Called from a data change callback of the node, leaves them
+  /// to the writer delivering it.
+  void Flush(NodeHandle node);
+
+private:
+  struct NodeQueue
+  {
+    std::deque<DataChangeNotification> Notifications;
+    uint64_t PushedCount = 0;
+    uint64_t TakenCount = 0; // taken from the queue for delivery
+    uint64_t DeliveredCount = 0;
+    // notifications queued by callbacks of the delivering writer, delivered by it as well
+    uint64_t NestedCount = 0;
+    bool Dispatching = false;
+    std::thread::id DispatchingThread;
+  };
+
+  // called with Mutex locked, the queue is dropped once empty
+  void Deliver(std::unique_lock<std::mutex> & lock, NodeHandle node, const std::shared_ptr<NodeQueue> & queue, uint64_t target);
+
+private:
+  Common::Logger::SharedPtr Logger;
+  std::mutex Mutex;
+  std::condition_variable Delivered;
+  std::unordered_map<NodeHandle, std::shared_ptr<NodeQueue>> Queues; // of nodes with notifications being queued or delivered
 };
 
-typedef std::map<AttributeId, AttributeValue> AttributesMap;
+/// @brief Calls expiration functions of asynchronous reads at their deadlines.
+/// A thread is started with the first deadline and joined on destruction.
+class ReadTimeouts
+{
+public:
+  ReadTimeouts() = default;
+  ReadTimeouts(const ReadTimeouts &) = delete;
+  ReadTimeouts & operator=(const ReadTimeouts &) = delete;
+  ~ReadTimeouts();
+
+  /// @brief Call expire at deadline, which has nothing to do if the read completed meanwhile.
+  void Add(std::chrono::steady_clock::time_point deadline, std::function<void ()> expire);
+
+private:
+  void Run();
+
+private:
+  std::mutex Mutex;
+  std::condition_variable Changed;
+  std::multimap<std::chrono::steady_clock::time_point, std::function<void ()>> Deadlines;
+  bool Stopping = false;
+  std::thread Thread;
+};
+
+/// @brief Attributes of a node.
+/// Values of present attributes are stored densely, a fixed slot per
+/// AttributeId holds the position of the value.
+class AttributesMap
+{
+public:
+  typedef std::vector<std::pair<AttributeId, AttributeValue>>::iterator iterator;
+  typedef std::vector<std::pair<AttributeId, AttributeValue>>::const_iterator const_iterator;
+
+  AttributesMap()
+  {
+    Slots.fill(static_cast<uint8_t>(NoSlot));
+  }
+
+  AttributeValue * Find(AttributeId attribute)
+  {
+    const std::size_t slot = GetSlot(attribute);
+    return slot == NoSlot ? nullptr : &Values[slot].second;
+  }
+
+  const AttributeValue * Find(AttributeId attribute) const
+  {
+    const std::size_t slot = GetSlot(attribute);
+    return slot == NoSlot ? nullptr : &Values[slot].second;
+  }
+
+  /// @brief Whether the attribute is one a node can have.
+  static bool IsValid(AttributeId attribute)
+  {
+    return attribute >= AttributeId::NodeId && attribute <= AttributeId::UserExecutable;
+  }
+
+  /// @brief Get existing or add a new attribute.
+  /// Callers check the id with IsValid first.
+  AttributeValue & operator[](AttributeId attribute)
+  {
+    if (AttributeValue * value = Find(attribute))
+      {
+        return *value;
+      }
+
+    const std::size_t index = static_cast<std::size_t>(attribute);
+
+    if (index >= Slots.size())
+      {
+        throw std::invalid_argument("address_space_internal| invalid attribute id " + std::to_string(index));
+      }
+
+    Slots[index] = static_cast<uint8_t>(Values.size());
+    Values.emplace_back(attribute, AttributeValue());
+    return Values.back().second;
+  }
+
+  iterator begin() { return Values.begin(); }
+  iterator end() { return Values.end(); }
+  const_iterator begin() const { return Values.begin(); }
+  const_iterator end() const { return Values.end(); }
+
+private:
+  std::size_t GetSlot(AttributeId attribute) const
+  {
+    const std::size_t index = static_cast<std::size_t>(attribute);
+
+    if (index >= Slots.size())
+      {
+        return NoSlot;
+      }
+
+    return Slots[index];
+  }
+
+private:
+  static const uint8_t NoSlot = std::numeric_limits<uint8_t>::max();
+  std::array<uint8_t, static_cast<std::size_t>(AttributeId::UserExecutable) + 1> Slots;
+  std::vector<std::pair<AttributeId, AttributeValue>> Values;
+};
+
+/// @brief References of a node with secondary indexes.
+/// References are grouped by type and direction for Browse. Nodes with
+/// many references also index them by browse name for path resolution.
+class NodeReferences
+{
+public:
+  struct Group
+  {
+    NodeId ReferenceTypeId;
+    bool IsForward;
+    std::vector<uint32_t> Indexes; // positions in All(), ascending
+  };
+
+public:
+  void Add(const ReferenceDescription & reference);
+
+  const std::vector<ReferenceDescription> & All() const
+  {
+    return References;
+  }
+
+  const std::vector<Group> & Groups() const
+  {
+    return ReferenceGroups;
+  }
+
+  /// @brief First reference with the browse name or nullptr.
+  const ReferenceDescription * FindByBrowseName(const QualifiedName & name) const;
+
+private:
+  void IndexBrowseName(uint32_t index);
+
+private:
+  static const std::size_t BrowseNameIndexThreshold = 32;
+
+  std::vector<ReferenceDescription> References;
+  std::vector<Group> ReferenceGroups;
+  std::unordered_map<QualifiedName, uint32_t> BrowseNames; // filled only for nodes with many references
+};
 
 //Store all data related to a Node
 struct NodeStruct
 {
+  NodeId Id;
   AttributesMap Attributes;
-  std::vector<ReferenceDescription> References;
+  NodeReferences References;
   std::function<std::vector<OpcUa::Variant> (NodeId, std::vector<OpcUa::Variant>)> Method;
 };
 
-typedef std::map<NodeId, NodeStruct> NodesMap;
+/// @brief Nodes of the address space indexed by hash of NodeId.
+class NodesMap
+{
+public:
+  NodeHandle FindHandle(const NodeId & id) const
+  {
+    const auto it = Index.find(id);
+    return it == Index.end() ? InvalidNodeHandle : it->second;
+  }
+
+  NodeStruct * Find(const NodeId & id)
+  {
+    const NodeHandle handle = FindHandle(id);
+    return handle == InvalidNodeHandle ? nullptr : &Nodes[handle];
+  }
+
+  const NodeStruct * Find(const NodeId & id) const
+  {
+    const NodeHandle handle = FindHandle(id);
+    return handle == InvalidNodeHandle ? nullptr : &Nodes[handle];
+  }
+
+  NodeStruct & Get(NodeHandle handle)
+  {
+    return Nodes[handle];
+  }
+
+  const NodeStruct & Get(NodeHandle handle) const
+  {
+    return Nodes[handle];
+  }
+
+  bool Contains(const NodeId & id) const
+  {
+    return Index.find(id) != Index.end();
+  }
+
+  bool Empty() const
+  {
+    return Nodes.empty();
+  }
+
+  NodeHandle Insert(NodeStruct && node)
+  {
+    const NodeHandle handle = static_cast<NodeHandle>(Nodes.size());
+    Index.emplace(node.Id, handle);
+    // deque keeps nodes in place when it grows
+    Nodes.push_back(std::move(node));
+    return handle;
+  }
+
+private:
+  std::unordered_map<NodeId, NodeHandle> Index;
+  std::deque<NodeStruct> Nodes;
+};
+
+/// @brief Closure of HasSubtype references between type nodes.
+/// Maintained when references are added, so that subtype check is a hash lookup.
+class TypeHierarchy
+{
+public:
+  void AddSubtype(const NodeId & type, const NodeId & subtype);
+
+  /// @brief Check that type is the same as baseType or derived from it.
+  bool IsSubtypeOf(const NodeId & type, const NodeId & baseType) const;
+
+  /// @brief Type and all its descendants.
+  std::vector<NodeId> GetSubtypes(const NodeId & type) const;
+
+private:
+  std::unordered_map<NodeId, std::unordered_set<NodeId>> Supertypes; // all ancestors of type
+  std::unordered_map<NodeId, std::vector<NodeId>> Subtypes; // direct subtypes
+};
+
+/// @brief Position of a paged Browse: references suitable for the browse are selected once
+/// and the next pages continue from the first one not returned yet.
+struct BrowseContinuation
+{
+  BrowseDescription Description;
+  std::vector<uint32_t> Indexes; // in references of the node, of the references suitable for the browse
+  std::size_t Next = 0; // position in Indexes of the first reference of the next page
+  uint32_t MaxReferencesPerNode = 0;
+};
+
+/// @brief Continuation points of one session by their random identifiers.
+typedef std::unordered_map<uint64_t, BrowseContinuation> SessionContinuationPoints;
 
 //In memory storage of server opc-ua data model
+//
+// Locking:
+//   DbMutex protects structure of the address space: set of nodes, their references,
+//   attributes sets and method and value callbacks. It is locked uniquely only by AddNodes,
+//   AddReferences, SetMethod, SetValueCallback and SetDataSource, every other service takes it shared.
+//   Writes of attributes and data change callbacks are protected by one of NodeMutexes
+//   selected by handle of the node. Stripe is always locked under shared DbMutex and
+//   only one stripe is held at a time, so writers of unrelated nodes do not serialize.
+//   Reads do not lock stripes: attribute values are immutable snapshots swapped atomically.
+//   ContinuationPointsMutex and CallbacksMutex are leaf locks.
+//
+// Lock ordering with InternalSubscription:
+//   Data change callbacks are not called under locks of the address space. Notifications are
+//   queued while the node is locked and delivered by Dispatcher when all locks are released,
+//   so data change callbacks may use the address space. A writer waits only for callbacks of
+//   its nodes delivered by earlier writers of the same nodes, so a callback must never wait
+//   on another thread writing its node.
+//   DeleteDataChangeCallback waits for notifications of the node queued before it. Samplers of
+//   subscriptions hand data changes over without subscription locks, but other callbacks of the
+//   node may use the subscription service, so InternalSubscription must not delete callbacks
+//   holding its own DbMutex.
+//   For the same reason a callback must never wait on a thread deleting a callback of its node.
+//   Value callbacks are called under shared DbMutex and must not change structure of the address space.
+//   Data sources are called without locks of the address space.
 class AddressSpaceInMemory : public Server::AddressSpace
 {
 public:
   AddressSpaceInMemory(const Common::Logger::SharedPtr & logger);
+  AddressSpaceInMemory(const Common::Logger::SharedPtr & logger, const Server::BrowseLimits & limits);
+  /// @param dataSourceTimeout longest wait of Read and ReadAsync for data sources in milliseconds.
+  AddressSpaceInMemory(const Common::Logger::SharedPtr & logger, const Server::BrowseLimits & limits, uint32_t dataSourceTimeout);
 
   ~AddressSpaceInMemory();
 
@@ -89,7 +435,10 @@ public:
   virtual std::vector<StatusCode> AddReferences(const std::vector<AddReferencesItem> & items);
   virtual std::vector<BrowsePathResult> TranslateBrowsePathsToNodeIds(const TranslateBrowsePathsParameters & params) const;
   virtual std::vector<BrowseResult> Browse(const OpcUa::NodesQuery & query) const;
-  virtual std::vector<BrowseResult> BrowseNext() const;
+  virtual std::vector<BrowseResult> BrowseNext(const BrowseNextParameters & params) const;
+  virtual std::vector<BrowseResult> Browse(const NodeId & session, const OpcUa::NodesQuery & query) const;
+  virtual std::vector<BrowseResult> BrowseNext(const NodeId & session, const BrowseNextParameters & params) const;
+  virtual void ReleaseContinuationPoints(const NodeId & session) const;
   virtual std::vector<NodeId> RegisterNodes(const std::vector<NodeId> & params) const;
   virtual void UnregisterNodes(const std::vector<NodeId> & params) const;
   virtual std::vector<DataValue> Read(const ReadParameters & params) const;
@@ -107,6 +456,13 @@ public:
 
   /// @brief Set callback which will be called to read new value of the attribue.
   StatusCode SetValueCallback(const NodeId & node, AttributeId attribute, std::function<DataValue(void)> callback);
+  bool HasValueCallback(const NodeId & node, AttributeId attribute) const;
+
+  /// @brief Hand reads of the attribute over to source.
+  StatusCode SetDataSource(const NodeId & node, AttributeId attribute, Server::DataSource::SharedPtr source);
+  void ReadAsync(const ReadParameters & params, Server::DataSource::ReadCallback done) const;
+
+  std::vector<NodeId> GetSubtypes(const NodeId & type) const;
 
   /// @brief Set method function for a method node.
   void SetMethod(const NodeId & node, std::function<std::vector<OpcUa::Variant> (NodeId context, std::vector<OpcUa::Variant> arguments)> callback);
@@ -115,10 +471,44 @@ private:
   std::tuple<bool, NodeId> FindElementInNode(const NodeId & nodeid, const RelativePathElement & element) const;
   BrowsePathResult TranslateBrowsePath(const BrowsePath & browsepath) const;
   DataValue GetValue(const NodeId & node, AttributeId attribute) const;
-  StatusCode SetValue(const NodeId & node, AttributeId attribute, const DataValue & data);
+  DataValue GetValue(const AttributeValue * attrValue) const;
+  const AttributeValue * FindAttribute(const NodeId & node, AttributeId attribute) const;
+
+  // Items of one Read served by the same data source.
+  struct SourceBatch
+  {
+    Server::DataSource::SharedPtr Source;
+    std::vector<ReadValueId> Items;
+    std::vector<std::size_t> Indexes; // of values of the items in the Read
+  };
+
+  // Values of one Read waiting for its data sources.
+  struct PendingRead
+  {
+    std::mutex Mutex;
+    std::vector<DataValue> Values;
+    std::vector<std::vector<std::size_t>> Indexes; // of values of every batch, cleared when the batch completes
+    std::size_t Remaining = 0; // batches not completed yet
+    Server::DataSource::ReadCallback Done;
+  };
+
+  std::vector<DataValue> ReadValues(const ReadParameters & params, std::vector<SourceBatch> & batches) const;
+  std::shared_ptr<PendingRead> ReadSources(std::vector<DataValue> values, const std::vector<SourceBatch> & batches, Server::DataSource::ReadCallback done) const;
+  // false if the batch was completed already
+  static bool CompleteBatch(const std::shared_ptr<PendingRead> & pending, std::size_t batch, std::vector<DataValue> read, StatusCode missing);
+  // false if every batch was completed already
+  static bool ExpireRead(const std::shared_ptr<PendingRead> & pending, StatusCode status);
+  // handle of the node is added to notified when its data change callbacks have to be called
+  StatusCode SetValue(const NodeId & node, AttributeId attribute, const DataValue & data, std::vector<NodeHandle> & notified);
+  boost::shared_mutex & GetNodeMutex(NodeHandle node) const;
   bool IsSuitableReference(const BrowseDescription & desc, const ReferenceDescription & reference) const;
-  bool IsSuitableReferenceType(const ReferenceDescription & reference, const NodeId & typeId, bool includeSubtypes) const;
-  std::vector<NodeId> SelectNodesHierarchy(std::vector<NodeId> sourceNodes) const;
+  bool IsSuitableReferenceType(const NodeId & referenceTypeId, const NodeId & typeId, bool includeSubtypes) const;
+  bool IsSuitableGroup(const BrowseDescription & desc, const NodeReferences::Group & group) const;
+  uint32_t GetMaxReferencesPerNode(uint32_t requested) const;
+  std::vector<uint32_t> GetSuitableReferences(const NodeStruct & node, const BrowseDescription & desc) const;
+  bool BrowseReferences(const NodeStruct & node, BrowseContinuation & position, BrowseResult & result) const;
+  void KeepContinuationPoint(const NodeId & session, BrowseContinuation & position, BrowseResult & result) const;
+  void ContinueBrowse(const NodeId & session, const std::vector<uint8_t> & continuationPoint, bool release, BrowseResult & result) const;
   AddNodesResult AddNode(const AddNodesItem & item);
   StatusCode AddReference(const AddReferencesItem & item);
   NodeId GetNewNodeId(const NodeId & id);
@@ -127,7 +517,18 @@ private:
 private:
   Common::Logger::SharedPtr Logger;
   mutable boost::shared_mutex DbMutex;
+  mutable std::array<boost::shared_mutex, 64> NodeMutexes; // lock stripes of node attributes
   NodesMap Nodes;
+  TypeHierarchy ReferenceTypes;
+  Server::BrowseLimits Limits;
+  std::chrono::milliseconds DataSourceTimeout;
+  mutable ReadTimeouts ExpiringReads; // ReadAsync waiting for data sources
+  // Continuation points are not part of the nodes, so they have own lock which can be taken under DbMutex.
+  mutable std::mutex ContinuationPointsMutex;
+  mutable std::map<NodeId, SessionContinuationPoints> ContinuationPoints;
+  mutable std::random_device ContinuationPointIds; // hard to guess, so points of other sessions cannot be probed
+  std::mutex CallbacksMutex;
+  DataChangeDispatcher Dispatcher;
   ClientIdToAttributeMapType ClientIdToAttributeMap; //Use to find callback using callback subcsriptionid
   uint32_t MaxNodeIdNum = 2000;
   uint32_t DefaultIdx = 2;
@@ -138,6 +539,8 @@ private:
 namespace Server
 {
 AddressSpace::UniquePtr CreateAddressSpace(const Common::Logger::SharedPtr & logger);
+AddressSpace::UniquePtr CreateAddressSpace(const Common::Logger::SharedPtr & logger, const BrowseLimits & limits);
+AddressSpace::UniquePtr CreateAddressSpace(const Common::Logger::SharedPtr & logger, const BrowseLimits & limits, uint32_t dataSourceTimeout);
 }
 }
 
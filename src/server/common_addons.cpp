@@ -125,6 +125,9 @@ Common::AddonParameters CreateAddonsParameters(const OpcUa::Server::Parameters &
 
   Common::ParametersGroup addressSpace(OpcUa::Server::AddressSpaceRegistryAddonId);
   addressSpace.Parameters.push_back(debugMode);
+  addressSpace.Parameters.push_back(Common::Parameter("max_continuation_points", std::to_string(serverParams.Browse.MaxContinuationPoints)));
+  addressSpace.Parameters.push_back(Common::Parameter("max_references_per_node", std::to_string(serverParams.Browse.MaxReferencesPerNode)));
+  addressSpace.Parameters.push_back(Common::Parameter("data_source_timeout", std::to_string(serverParams.DataSourceTimeout)));
   addons.Groups.push_back(addressSpace);
 
   Common::ParametersGroup endpointServices(OpcUa::Server::EndpointsRegistryAddonId);
@@ -0,0 +1,209 @@
+/// @brief Evaluation of data change filters of monitored items.
+/// @license GNU LGPL
+///
+/// Distributed under the GNU LGPL License
+/// (See accompanying file LICENSE or copy at
+/// http://www.gnu.org/licenses/lgpl.html)
+///
+
+#include "data_change_filter.h"
+
+#include <opc/ua/protocol/binary/stream.h>
+#include <opc/ua/protocol/object_ids.h>
+#include <opc/ua/protocol/protocol_auto.h>
+
+#include <cmath>
+
+namespace
+{
+using namespace OpcUa;
+
+// A value becoming NaN or a number again is a change, NaN follows NaN unchanged.
+inline bool Differs(double last, double value, double deadband)
+{
+  return (std::abs(value - last) > deadband) | (std::isnan(value) != std::isnan(last));
+}
+
+template <typename T>
+bool ExceedsDeadband(const T & last, const T & value, double deadband)
+{
+  return Differs(static_cast<double>(last), static_cast<double>(value), deadband);
+}
+
+template <typename T>
+bool ExceedsDeadband(const std::vector<T> & last, const std::vector<T> & value, double deadband)
+{
+  if (last.size() != value.size())
+    {
+      return true;
+    }
+
+  // No early exit and no branches: the loop is left to the vectorizer.
+  unsigned exceeds = 0;
+
+  for (std::size_t i = 0; i < value.size(); ++i)
+    {
+      exceeds |= Differs(static_cast<double>(last[i]), static_cast<double>(value[i]), deadband);
+    }
+
+  return exceeds != 0;
+}
+
+template <typename T>
+bool ExceedsTypedDeadband(const Variant & last, const Variant & value, double deadband)
+{
+  if (value.IsArray())
+    {
+      return ExceedsDeadband(last.AsRef<std::vector<T>>(), value.AsRef<std::vector<T>>(), deadband);
+    }
+
+  return ExceedsDeadband(last.AsRef<T>(), value.AsRef<T>(), deadband);
+}
+}
+
+namespace OpcUa
+{
+namespace Internal
+{
+
+DataChangeFilterEvaluator::DataChangeFilterEvaluator()
+  : Trigger(DataChangeTrigger::StatusValue)
+  , Deadband(DeadbandType::None)
+  , Threshold(0)
+{
+}
+
+DataChangeFilterEvaluator::DataChangeFilterEvaluator(const DataChangeFilter & filter, double range)
+  : Trigger(filter.Trigger)
+  , Deadband(filter.Deadband)
+  , Threshold(filter.Deadband == DeadbandType::Percent ? filter.DeadbandValue / 100 * range : filter.DeadbandValue)
+{
+}
+
+bool DataChangeFilterEvaluator::Report(const DataValue & value)
+{
+  if (!HasLast)
+    {
+      HasLast = true;
+      Last = value;
+      return true;
+    }
+
+  bool changed = value.Status != Last.Status;
+
+  if (!changed && Trigger != DataChangeTrigger::Status)
+    {
+      changed = Deadband == DeadbandType::None ? value.Value != Last.Value : ExceedsDeadband(Last.Value, value.Value, Threshold);
+
+      if (!changed && Trigger == DataChangeTrigger::StatusValueTimestamp)
+        {
+          changed = value.SourceTimestamp != Last.SourceTimestamp;
+        }
+    }
+
+  if (changed)
+    {
+      Last = value;
+    }
+
+  return changed;
+}
+
+bool IsNumeric(VariantType type)
+{
+  switch (type)
+    {
+    case VariantType::SBYTE:
+    case VariantType::BYTE:
+    case VariantType::INT16:
+    case VariantType::UINT16:
+    case VariantType::INT32:
+    case VariantType::UINT32:
+    case VariantType::INT64:
+    case VariantType::UINT64:
+    case VariantType::FLOAT:
+    case VariantType::DOUBLE:
+      return true;
+
+    default:
+      return false;
+    }
+}
+
+bool ExceedsDeadband(const Variant & last, const Variant & value, double deadband)
+{
+  if (last.Type() != value.Type() || last.IsArray() != value.IsArray() || !IsNumeric(value.Type()))
+    {
+      return last != value;
+    }
+
+  switch (value.Type())
+    {
+    case VariantType::SBYTE:
+      return ExceedsTypedDeadband<int8_t>(last, value, deadband);
+
+    case VariantType::BYTE:
+      return ExceedsTypedDeadband<uint8_t>(last, value, deadband);
+
+    case VariantType::INT16:
+      return ExceedsTypedDeadband<int16_t>(last, value, deadband);
+
+    case VariantType::UINT16:
+      return ExceedsTypedDeadband<uint16_t>(last, value, deadband);
+
+    case VariantType::INT32:
+      return ExceedsTypedDeadband<int32_t>(last, value, deadband);
+
+    case VariantType::UINT32:
+      return ExceedsTypedDeadband<uint32_t>(last, value, deadband);
+
+    case VariantType::INT64:
+      return ExceedsTypedDeadband<int64_t>(last, value, deadband);
+
+    case VariantType::UINT64:
+      return ExceedsTypedDeadband<uint64_t>(last, value, deadband);
+
+    case VariantType::FLOAT:
+      return ExceedsTypedDeadband<float>(last, value, deadband);
+
+    default:
+      return ExceedsTypedDeadband<double>(last, value, deadband);
+    }
+}
+
+bool ParseRange(const Variant & value, double & low, double & high)
+{
+  if (value.Type() == VariantType::DOUBLE && value.IsArray())
+    {
+      const std::vector<double> & range = value.AsRef<std::vector<double>>();
+
+      if (range.size() != 2)
+        {
+          return false;
+        }
+
+      low = range[0];
+      high = range[1];
+      return true;
+    }
+
+  if (value.Type() != VariantType::EXTENSION_OBJECT || value.IsArray())
+    {
+      return false;
+    }
+
+  const ExtensionObject & object = value.AsRef<ExtensionObject>();
+
+  // Binary encoding of Range: Low and High doubles
+  if (object.TypeId != ObjectId::Range_Encoding_DefaultBinary || object.Body.Data.size() != 2 * sizeof(double))
+    {
+      return false;
+    }
+
+  Binary::DataDeserializer body(reinterpret_cast<const char *>(object.Body.Data.data()), object.Body.Data.size());
+  body >> low >> high;
+  return true;
+}
+
+}
+}
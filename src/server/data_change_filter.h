@@ -0,0 +1,54 @@
+/// @brief Evaluation of data change filters of monitored items.
+/// @license GNU LGPL
+///
+/// Distributed under the GNU LGPL License
+/// (See accompanying file LICENSE or copy at
+/// http://www.gnu.org/licenses/lgpl.html)
+///
+
+#pragma once
+
+#include <opc/ua/protocol/data_value.h>
+#include <opc/ua/protocol/types_manual.h>
+#include <opc/ua/protocol/variant.h>
+
+namespace OpcUa
+{
+namespace Internal
+{
+
+/// @brief Decides which sampled values of a monitored item are reported (Part 4 7.17.2).
+/// Values are compared with the last reported one.
+class DataChangeFilterEvaluator
+{
+public:
+  /// @brief Default filter: changes of status or value are reported.
+  DataChangeFilterEvaluator();
+
+  /// @param range span of the node's EURange, used by percent deadband.
+  DataChangeFilterEvaluator(const DataChangeFilter & filter, double range);
+
+  /// @brief Check whether value has to be reported and remember it if so.
+  bool Report(const DataValue & value);
+
+private:
+  DataChangeTrigger Trigger;
+  DeadbandType Deadband;
+  double Threshold;
+  bool HasLast = false;
+  DataValue Last;
+};
+
+/// @brief Whether deadband can be applied to values of this type.
+bool IsNumeric(VariantType type);
+
+/// @brief Check whether numeric value or any element of numeric array differs
+/// from the last one by more than deadband. Other values are compared for equality.
+bool ExceedsDeadband(const Variant & last, const Variant & value, double deadband);
+
+/// @brief Get Low and High of a Range value (EURange property of analog items).
+/// A Range extension object and an array of two doubles are accepted.
+bool ParseRange(const Variant & value, double & low, double & high);
+
+}
+}
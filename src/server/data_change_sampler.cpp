@@ -0,0 +1,186 @@
+/// @brief Data change samplers shared by identical monitored items.
+/// @license GNU LGPL
+///
+/// Distributed under the GNU LGPL License
+/// (See accompanying file LICENSE or copy at
+/// http://www.gnu.org/licenses/lgpl.html)
+///
+
+#include "data_change_sampler.h"
+#include "internal_subscription.h"
+
+#include <algorithm>
+#include <tuple>
+
+namespace
+{
+// Threads reading values backed by value callbacks
+const unsigned SamplingThreads = 2;
+}
+
+namespace OpcUa
+{
+namespace Internal
+{
+
+bool DataChangeSamplers::Key::operator<(const Key & other) const
+{
+  return std::tie(Node, Attribute, SamplingInterval, Trigger, Deadband, DeadbandValue)
+         < std::tie(other.Node, other.Attribute, other.SamplingInterval, other.Trigger, other.Deadband, other.DeadbandValue);
+}
+
+DataChangeSamplers::DataChangeSamplers(Server::AddressSpace & addressSpace, boost::asio::io_service & io, const Common::Logger::SharedPtr & logger)
+  : AddressSpace(addressSpace)
+  , Logger(logger)
+  , Sampling(std::make_shared<SamplingScheduler>(addressSpace, io, SamplingThreads, logger))
+{
+}
+
+DataChangeSamplers::~DataChangeSamplers()
+{
+  Sampling->Stop();
+}
+
+void DataChangeSamplers::Subscribe(const Key & key, const DataChangeFilterEvaluator & filter, InternalSubscription & subscription, uint32_t monitoredItemId)
+{
+  std::unique_lock<std::mutex> lock(Mutex);
+  std::shared_ptr<Sampler> & sampler = Samplers[key];
+  std::unique_lock<std::mutex> samplerLock;
+  bool created = false;
+
+  if (!sampler)
+    {
+      LOG_DEBUG(Logger, "data_change_sampler   | create sampler of NodeId: {}", key.Node);
+
+      sampler = std::make_shared<Sampler>();
+      sampler->Filter = filter;
+      created = true;
+
+      // data changes wait for the initial value
+      samplerLock = std::unique_lock<std::mutex>(sampler->Mutex);
+
+      // the callback keeps its sampler alive until it is deleted
+      std::shared_ptr<Sampler> target = sampler;
+
+      if (AddressSpace.HasValueCallback(key.Node, key.Attribute))
+        {
+          LOG_DEBUG(Logger, "data_change_sampler   | sample NodeId: {} every {} ms", key.Node, key.SamplingInterval);
+
+          ReadValueId value;
+          value.NodeId = key.Node;
+          value.AttributeId = key.Attribute;
+          sampler->SamplingHandle = Sampling->Add(value, key.SamplingInterval, [target](const DataValue & value)
+          {
+            OnDataChange(*target, value);
+          });
+        }
+
+      else
+        {
+          sampler->CallbackHandle = AddressSpace.AddDataChangeCallback(key.Node, key.Attribute, [target](const NodeId &, AttributeId, const DataValue & value)
+          {
+            OnDataChange(*target, value);
+          });
+        }
+    }
+
+  else
+    {
+      samplerLock = std::unique_lock<std::mutex>(sampler->Mutex);
+    }
+
+  // the sampler cannot go away while locked, other samplers are not held up by the read
+  std::shared_ptr<Sampler> target = sampler;
+  lock.unlock();
+
+  // read after the callback is registered and before data changes reach the item:
+  // changes are either in the initial value or delivered after it
+  ReadParameters params;
+  ReadValueId value;
+  value.NodeId = key.Node;
+  value.AttributeId = key.Attribute;
+  params.AttributesToRead.push_back(value);
+  const DataValue initial = AddressSpace.Read(params).front();
+
+  if (created)
+    {
+      target->Filter.Report(initial);
+    }
+
+  target->Items.push_back(std::make_pair(&subscription, monitoredItemId));
+
+  // Forcing event: first value is reported whatever the filter
+  subscription.EnqueueDataChange(monitoredItemId, std::make_shared<const DataValue>(initial));
+}
+
+void DataChangeSamplers::Unsubscribe(const Key & key, InternalSubscription & subscription, uint32_t monitoredItemId)
+{
+  uint32_t callbackHandle = 0;
+  uint32_t samplingHandle = 0;
+  {
+    std::lock_guard<std::mutex> lock(Mutex);
+    auto it = Samplers.find(key);
+
+    if (it == Samplers.end())
+      {
+        return;
+      }
+
+    Sampler & sampler = *it->second;
+    std::lock_guard<std::mutex> samplerLock(sampler.Mutex);
+    sampler.Items.erase(std::remove(sampler.Items.begin(), sampler.Items.end(), std::make_pair(&subscription, monitoredItemId)), sampler.Items.end());
+
+    if (!sampler.Items.empty())
+      {
+        return;
+      }
+
+    LOG_DEBUG(Logger, "data_change_sampler   | delete sampler of NodeId: {}", key.Node);
+
+    callbackHandle = sampler.CallbackHandle;
+    samplingHandle = sampler.SamplingHandle;
+    Samplers.erase(it);
+  }
+
+  // deleting waits for queued data changes which lock the sampler
+  if (samplingHandle)
+    {
+      Sampling->Remove(samplingHandle);
+    }
+
+  else
+    {
+      AddressSpace.DeleteDataChangeCallback(callbackHandle);
+    }
+}
+
+std::size_t DataChangeSamplers::Size() const
+{
+  std::lock_guard<std::mutex> lock(Mutex);
+  return Samplers.size();
+}
+
+const SamplingScheduler & DataChangeSamplers::GetSamplingScheduler() const
+{
+  return *Sampling;
+}
+
+void DataChangeSamplers::OnDataChange(Sampler & sampler, const DataValue & value)
+{
+  std::lock_guard<std::mutex> lock(sampler.Mutex);
+
+  if (!sampler.Filter.Report(value))
+    {
+      return;
+    }
+
+  SharedDataValue shared = std::make_shared<const DataValue>(value);
+
+  for (const auto & item : sampler.Items)
+    {
+      item.first->EnqueueDataChange(item.second, shared);
+    }
+}
+
+}
+}
@@ -0,0 +1,97 @@
+/// @brief Data change samplers shared by identical monitored items.
+/// @license GNU LGPL
+///
+/// Distributed under the GNU LGPL License
+/// (See accompanying file LICENSE or copy at
+/// http://www.gnu.org/licenses/lgpl.html)
+///
+
+#pragma once
+
+#include "data_change_filter.h"
+#include "sampling_scheduler.h"
+
+#include <opc/common/logger.h>
+#include <opc/ua/server/address_space.h>
+
+#include <map>
+#include <memory>
+#include <mutex>
+#include <vector>
+
+namespace OpcUa
+{
+namespace Internal
+{
+
+class InternalSubscription;
+
+/// @brief Data change shared by every monitored item sampling it.
+typedef std::shared_ptr<const DataValue> SharedDataValue;
+
+/// @brief Monitored items with the same node, attribute, sampling interval and
+/// data change filter share one sampler. It is their only data change callback
+/// in the address space: the filter is evaluated once per change and the same
+/// immutable value is handed to every monitored item. Values read by a value
+/// callback do not report their changes: their samplers read them at the
+/// sampling interval instead.
+/// Data changes are handed to subscriptions under the sampler lock, without
+/// taking subscription locks (see InternalSubscription::EnqueueDataChange).
+class DataChangeSamplers
+{
+public:
+  struct Key
+  {
+    NodeId Node;
+    AttributeId Attribute;
+    double SamplingInterval;
+    DataChangeTrigger Trigger;
+    DeadbandType Deadband;
+    double DeadbandValue;
+
+    bool operator<(const Key & other) const;
+  };
+
+  DataChangeSamplers(Server::AddressSpace & addressSpace, boost::asio::io_service & io, const Common::Logger::SharedPtr & logger);
+  ~DataChangeSamplers();
+
+  /// @brief Add monitored item to the sampler of key and enqueue its initial value.
+  /// The value is read under the sampler lock, so data changes of the item
+  /// are either in it or follow it. A new sampler takes filter and remembers
+  /// the initial value as last reported one.
+  void Subscribe(const Key & key, const DataChangeFilterEvaluator & filter, InternalSubscription & subscription, uint32_t monitoredItemId);
+
+  /// @brief Remove monitored item, the sampler goes away with its last item.
+  /// Deleting its data change callback waits for callbacks of the node being
+  /// delivered, which may use the subscription service: do not call it while
+  /// holding the subscription lock.
+  void Unsubscribe(const Key & key, InternalSubscription & subscription, uint32_t monitoredItemId);
+
+  /// @brief Number of samplers, each one registered once in the address space.
+  std::size_t Size() const;
+
+  /// @brief Scheduler of samplers reading values backed by a value callback.
+  const SamplingScheduler & GetSamplingScheduler() const;
+
+private:
+  struct Sampler
+  {
+    std::mutex Mutex;
+    uint32_t CallbackHandle = 0;
+    uint32_t SamplingHandle = 0; // sampled periodically instead of data change callback
+    DataChangeFilterEvaluator Filter;
+    std::vector<std::pair<InternalSubscription *, uint32_t>> Items;
+  };
+
+  static void OnDataChange(Sampler & sampler, const DataValue & value);
+
+private:
+  Server::AddressSpace & AddressSpace;
+  Common::Logger::SharedPtr Logger;
+  std::shared_ptr<SamplingScheduler> Sampling;
+  mutable std::mutex Mutex;
+  std::map<Key, std::shared_ptr<Sampler>> Samplers;
+};
+
+}
+}
@@ -0,0 +1,682 @@
+/// @brief Event filters of monitored items compiled for evaluation.
+/// @license GNU LGPL
+///
+/// Distributed under the GNU LGPL License
+/// (See accompanying file LICENSE or copy at
+/// http://www.gnu.org/licenses/lgpl.html)
+///
+
+#include "event_filter.h"
+
+#include <opc/ua/protocol/object_ids.h>
+
+#include <algorithm>
+
+namespace
+{
+using namespace OpcUa;
+
+bool IsTrue(const Variant & value)
+{
+  return value.Type() == VariantType::BOOLEAN && value.IsScalar() && value.AsRef<bool>();
+}
+
+bool ToNumber(const Variant & value, double & number)
+{
+  if (!value.IsScalar())
+    {
+      return false;
+    }
+
+  switch (value.Type())
+    {
+    case VariantType::BOOLEAN:
+      number = value.AsRef<bool>() ? 1 : 0;
+      return true;
+
+    case VariantType::SBYTE:
+      number = value.AsRef<int8_t>();
+      return true;
+
+    case VariantType::BYTE:
+      number = value.AsRef<uint8_t>();
+      return true;
+
+    case VariantType::INT16:
+      number = value.AsRef<int16_t>();
+      return true;
+
+    case VariantType::UINT16:
+      number = value.AsRef<uint16_t>();
+      return true;
+
+    case VariantType::INT32:
+      number = value.AsRef<int32_t>();
+      return true;
+
+    case VariantType::UINT32:
+      number = value.AsRef<uint32_t>();
+      return true;
+
+    case VariantType::INT64:
+      number = static_cast<double>(value.AsRef<int64_t>());
+      return true;
+
+    case VariantType::UINT64:
+      number = static_cast<double>(value.AsRef<uint64_t>());
+      return true;
+
+    case VariantType::FLOAT:
+      number = value.AsRef<float>();
+      return true;
+
+    case VariantType::DOUBLE:
+      number = value.AsRef<double>();
+      return true;
+
+    case VariantType::DATE_TIME:
+      number = static_cast<double>(value.AsRef<DateTime>().Value);
+      return true;
+
+    default:
+      return false;
+    }
+}
+
+bool ToText(const Variant & value, std::string & text)
+{
+  if (!value.IsScalar())
+    {
+      return false;
+    }
+
+  if (value.Type() == VariantType::STRING)
+    {
+      text = value.AsRef<std::string>();
+      return true;
+    }
+
+  if (value.Type() == VariantType::LOCALIZED_TEXT)
+    {
+      text = value.AsRef<LocalizedText>().Text;
+      return true;
+    }
+
+  return false;
+}
+
+/// Three way comparison of numbers, times and strings. false if values can not be ordered.
+bool Compare(const Variant & lhs, const Variant & rhs, int & result)
+{
+  double left = 0;
+  double right = 0;
+
+  if (ToNumber(lhs, left) && ToNumber(rhs, right))
+    {
+      result = left < right ? -1 : (left > right ? 1 : 0);
+      return true;
+    }
+
+  std::string leftText;
+  std::string rightText;
+
+  if (ToText(lhs, leftText) && ToText(rhs, rightText))
+    {
+      result = leftText.compare(rightText);
+      return true;
+    }
+
+  return false;
+}
+
+bool Equals(const Variant & lhs, const Variant & rhs)
+{
+  int result = 0;
+
+  if (Compare(lhs, rhs, result))
+    {
+      return result == 0;
+    }
+
+  return lhs == rhs;
+}
+
+/// Match character against the list of a '[...]' or '[^...]' pattern element.
+/// Lists contain characters and ranges like 'a-z', '\' escapes.
+/// @return pattern following the closing ']', null if the list is not closed.
+const char * MatchesList(char c, const char * pattern, bool & matched)
+{
+  const unsigned char character = static_cast<unsigned char>(c);
+  ++pattern;
+  const bool negated = *pattern == '^';
+
+  if (negated)
+    {
+      ++pattern;
+    }
+
+  matched = false;
+
+  while (*pattern && *pattern != ']')
+    {
+      if (*pattern == '\\' && pattern[1])
+        {
+          ++pattern;
+        }
+
+      const unsigned char low = static_cast<unsigned char>(*pattern);
+      unsigned char high = low;
+
+      if (pattern[1] == '-' && pattern[2] && pattern[2] != ']')
+        {
+          pattern += 2;
+
+          if (*pattern == '\\' && pattern[1])
+            {
+              ++pattern;
+            }
+
+          high = static_cast<unsigned char>(*pattern);
+        }
+
+      matched |= low <= character && character <= high;
+      ++pattern;
+    }
+
+  if (!*pattern)
+    {
+      return nullptr;
+    }
+
+  matched = matched != negated;
+  return pattern + 1;
+}
+
+/// Match text character against a Like pattern element other than '%'.
+/// @return pattern following the element, null if the character does not match.
+const char * MatchesElement(const char * text, const char * pattern)
+{
+  if (*pattern == '_')
+    {
+      return *text ? pattern + 1 : nullptr;
+    }
+
+  if (*pattern == '[')
+    {
+      bool matched = false;
+      const char * next = MatchesList(*text, pattern, matched);
+
+      // '[' without closing ']' is an ordinary character
+      if (next)
+        {
+          return *text && matched ? next : nullptr;
+        }
+    }
+
+  else if (*pattern == '\\' && pattern[1])
+    {
+      ++pattern;
+    }
+
+  return *text && *text == *pattern ? pattern + 1 : nullptr;
+}
+
+/// Like operator pattern: '%' matches any characters, '_' one character,
+/// '[...]' one character of the list, '[^...]' one character not in the list, '\' escapes.
+/// Every other element matches one character, so on a mismatch only the last '%'
+/// takes one more character: no more steps than text length times pattern length.
+bool MatchesPattern(const char * text, const char * pattern)
+{
+  // pattern following the last '%' and the text it is tried on
+  const char * afterPercent = nullptr;
+  const char * percentText = nullptr;
+
+  while (*text)
+    {
+      if (*pattern == '%')
+        {
+          afterPercent = ++pattern;
+          percentText = text;
+          continue;
+        }
+
+      const char * next = *pattern ? MatchesElement(text, pattern) : nullptr;
+
+      if (next)
+        {
+          pattern = next;
+          ++text;
+          continue;
+        }
+
+      if (!afterPercent)
+        {
+          return false;
+        }
+
+      pattern = afterPercent;
+      text = ++percentText;
+    }
+
+  while (*pattern == '%')
+    {
+      ++pattern;
+    }
+
+  return *pattern == 0;
+}
+
+bool ToInteger(const Variant & value, int64_t & integer)
+{
+  double number = 0;
+
+  if (value.Type() == VariantType::FLOAT || value.Type() == VariantType::DOUBLE || !ToNumber(value, number))
+    {
+      return false;
+    }
+
+  integer = value.Type() == VariantType::UINT64 ? static_cast<int64_t>(value.AsRef<uint64_t>()) :
+            value.Type() == VariantType::INT64 ? value.AsRef<int64_t>() : static_cast<int64_t>(number);
+  return true;
+}
+
+std::size_t GetOperandsCount(FilterOperator op, bool & exact)
+{
+  exact = true;
+
+  switch (op)
+    {
+    case FilterOperator::IsNull:
+    case FilterOperator::Not:
+    case FilterOperator::OfType:
+      return 1;
+
+    case FilterOperator::Between:
+      return 3;
+
+    case FilterOperator::InList:
+      exact = false;
+      return 2;
+
+    default:
+      return 2;
+    }
+}
+}
+
+namespace OpcUa
+{
+namespace Internal
+{
+
+EventField::EventField()
+  : Id(Slot::Path)
+  , Attribute(AttributeId::Unknown)
+{
+}
+
+EventField::EventField(const SimpleAttributeOperand & operand)
+  : Id(Slot::Path)
+  , Attribute(operand.Attribute)
+  , Path(operand.BrowsePath)
+{
+  if (Path.empty())
+    {
+      Id = Slot::Attribute;
+      return;
+    }
+
+  if (Path.size() != 1 || Path[0].NamespaceIndex != 0)
+    {
+      return;
+    }
+
+  static const std::pair<const char *, Slot> Names[] =
+  {
+    {"EventId", Slot::EventId},
+    {"EventType", Slot::EventType},
+    {"SourceNode", Slot::SourceNode},
+    {"SourceName", Slot::SourceName},
+    {"Message", Slot::Message},
+    {"Severity", Slot::Severity},
+    {"LocalTime", Slot::LocalTime},
+    {"ReceiveTime", Slot::ReceiveTime},
+    {"Time", Slot::Time},
+  };
+
+  for (const auto & name : Names)
+    {
+      if (Path[0].Name == name.first)
+        {
+          Id = name.second;
+          return;
+        }
+    }
+}
+
+Variant EventField::Get(const Event & event) const
+{
+  switch (Id)
+    {
+    case Slot::EventId:
+      return Variant(event.EventId);
+
+    case Slot::EventType:
+      return Variant(event.EventType);
+
+    case Slot::SourceNode:
+      return Variant(event.SourceNode);
+
+    case Slot::SourceName:
+      return Variant(event.SourceName);
+
+    case Slot::Message:
+      return Variant(event.Message);
+
+    case Slot::Severity:
+      return Variant(event.Severity);
+
+    case Slot::LocalTime:
+      return Variant(event.LocalTime);
+
+    case Slot::ReceiveTime:
+      return Variant(event.ReceiveTime);
+
+    case Slot::Time:
+      return Variant(event.Time);
+
+    case Slot::Attribute:
+      return event.GetValue(Attribute);
+
+    default:
+      break;
+    }
+
+  if (Path.empty())
+    {
+      return Variant();
+    }
+
+  // events of one type share their layout: the slot is looked up once per layout
+  if (event.GetLayout())
+    {
+      const std::shared_ptr<const LayoutSlots> slots = std::atomic_load(&CachedSlots);
+      const LayoutSlot * cached = nullptr;
+
+      if (slots)
+        {
+          for (const LayoutSlot & slot : *slots)
+            {
+              if (slot.Layout == event.GetLayout())
+                {
+                  cached = &slot;
+                  break;
+                }
+            }
+        }
+
+      int32_t index = -1;
+
+      if (cached)
+        {
+          index = cached->Index;
+        }
+
+      else
+        {
+          index = event.GetLayout()->GetSlot(Path);
+          std::shared_ptr<LayoutSlots> updated = slots ? std::make_shared<LayoutSlots>(*slots) : std::make_shared<LayoutSlots>();
+
+          if (updated->size() >= MaxCachedLayouts)
+            {
+              updated->erase(updated->begin());
+            }
+
+          updated->push_back(LayoutSlot{event.GetLayout(), index});
+          std::atomic_store(&CachedSlots, std::shared_ptr<const LayoutSlots>(updated));
+        }
+
+      if (index >= 0)
+        {
+          return event.GetSlotValue(index);
+        }
+    }
+
+  return event.GetValue(Path);
+}
+
+CompiledEventFilter::CompiledEventFilter()
+  : Status(StatusCode::Good)
+{
+}
+
+CompiledEventFilter::CompiledEventFilter(const EventFilter & filter, Server::AddressSpace & addressSpace)
+  : Status(StatusCode::Good)
+{
+  for (const SimpleAttributeOperand & operand : filter.SelectClauses)
+    {
+      SelectFields.push_back(EventField(operand));
+    }
+
+  Where.resize(filter.WhereClause.size());
+
+  for (uint32_t index = 0; index < filter.WhereClause.size() && Status == StatusCode::Good; ++index)
+    {
+      Status = CompileElement(filter.WhereClause[index], index, addressSpace);
+    }
+}
+
+StatusCode CompiledEventFilter::CompileElement(const ContentFilterElement & source, uint32_t index, Server::AddressSpace & addressSpace)
+{
+  Element & element = Where[index];
+  element.Operator = source.Operator;
+
+  switch (source.Operator)
+    {
+    case FilterOperator::Cast:
+    case FilterOperator::InView:
+    case FilterOperator::RelatedTo:
+      return StatusCode::BadFilterOperatorUnsupported;
+
+    default:
+      if (source.Operator > FilterOperator::BitwiseOr)
+        {
+          return StatusCode::BadFilterOperatorInvalid;
+        }
+    }
+
+  bool exact = true;
+  const std::size_t count = GetOperandsCount(source.Operator, exact);
+
+  if (exact ? source.FilterOperands.size() != count : source.FilterOperands.size() < count)
+    {
+      return StatusCode::BadFilterOperandCountMismatch;
+    }
+
+  for (const FilterOperand & sourceOperand : source.FilterOperands)
+    {
+      Operand operand;
+      const ExpandedNodeId & type = sourceOperand.Header.TypeId;
+
+      if (type == ExpandedObjectId::LiteralOperand)
+        {
+          operand.Type = Operand::Kind::Literal;
+          operand.Literal = sourceOperand.Literal.Value;
+        }
+
+      else if (type == ExpandedObjectId::SimpleAttributeOperand)
+        {
+          operand.Type = Operand::Kind::Field;
+          operand.Field = EventField(sourceOperand.SimpleAttribute);
+        }
+
+      else if (type == ExpandedObjectId::ElementOperand)
+        {
+          // elements may only refer to the following ones, so there are no cycles
+          if (sourceOperand.Element.Index <= index || sourceOperand.Element.Index >= Where.size())
+            {
+              return StatusCode::BadFilterOperandInvalid;
+            }
+
+          operand.Type = Operand::Kind::Element;
+          operand.ElementIndex = sourceOperand.Element.Index;
+        }
+
+      else
+        {
+          return StatusCode::BadFilterOperandInvalid;
+        }
+
+      element.Operands.push_back(operand);
+    }
+
+  if (element.Operator == FilterOperator::OfType)
+    {
+      const Operand & operand = element.Operands.front();
+
+      if (operand.Type != Operand::Kind::Literal || operand.Literal.Type() != VariantType::NODE_Id)
+        {
+          return StatusCode::BadFilterOperandInvalid;
+        }
+
+      const std::vector<NodeId> subtypes = addressSpace.GetSubtypes(operand.Literal.AsRef<NodeId>());
+      element.Types.insert(subtypes.begin(), subtypes.end());
+    }
+
+  return StatusCode::Good;
+}
+
+StatusCode CompiledEventFilter::GetStatus() const
+{
+  return Status;
+}
+
+bool CompiledEventFilter::Matches(const Event & event) const
+{
+  return Where.empty() || IsTrue(Evaluate(0, event));
+}
+
+std::vector<Variant> CompiledEventFilter::Select(const Event & event) const
+{
+  std::vector<Variant> fields;
+  fields.reserve(SelectFields.size());
+
+  for (const EventField & field : SelectFields)
+    {
+      fields.push_back(field.Get(event));
+    }
+
+  return fields;
+}
+
+Variant CompiledEventFilter::GetOperand(const Operand & operand, const Event & event) const
+{
+  switch (operand.Type)
+    {
+    case Operand::Kind::Literal:
+      return operand.Literal;
+
+    case Operand::Kind::Field:
+      return operand.Field.Get(event);
+
+    default:
+      return Evaluate(operand.ElementIndex, event);
+    }
+}
+
+Variant CompiledEventFilter::Evaluate(uint32_t index, const Event & event) const
+{
+  const Element & element = Where[index];
+  const std::vector<Operand> & operands = element.Operands;
+
+  switch (element.Operator)
+    {
+    case FilterOperator::OfType:
+      return Variant(element.Types.count(event.EventType) != 0);
+
+    case FilterOperator::IsNull:
+      return Variant(GetOperand(operands[0], event).IsNul());
+
+    case FilterOperator::Not:
+      return Variant(!IsTrue(GetOperand(operands[0], event)));
+
+    case FilterOperator::And:
+      return Variant(IsTrue(GetOperand(operands[0], event)) && IsTrue(GetOperand(operands[1], event)));
+
+    case FilterOperator::Or:
+      return Variant(IsTrue(GetOperand(operands[0], event)) || IsTrue(GetOperand(operands[1], event)));
+
+    case FilterOperator::Equals:
+      return Variant(Equals(GetOperand(operands[0], event), GetOperand(operands[1], event)));
+
+    case FilterOperator::InList:
+      {
+        const Variant value = GetOperand(operands[0], event);
+        bool found = false;
+
+        for (std::size_t i = 1; i < operands.size() && !found; ++i)
+          {
+            found = Equals(value, GetOperand(operands[i], event));
+          }
+
+        return Variant(found);
+      }
+
+    case FilterOperator::Like:
+      {
+        std::string text;
+        std::string pattern;
+        return Variant(ToText(GetOperand(operands[0], event), text) && ToText(GetOperand(operands[1], event), pattern) && MatchesPattern(text.c_str(), pattern.c_str()));
+      }
+
+    case FilterOperator::Between:
+      {
+        const Variant value = GetOperand(operands[0], event);
+        int low = 0;
+        int high = 0;
+        return Variant(Compare(value, GetOperand(operands[1], event), low) && Compare(value, GetOperand(operands[2], event), high) && low >= 0 && high <= 0);
+      }
+
+    case FilterOperator::BitwiseAnd:
+    case FilterOperator::BitwiseOr:
+      {
+        int64_t lhs = 0;
+        int64_t rhs = 0;
+
+        if (!ToInteger(GetOperand(operands[0], event), lhs) || !ToInteger(GetOperand(operands[1], event), rhs))
+          {
+            return Variant();
+          }
+
+        return Variant(element.Operator == FilterOperator::BitwiseAnd ? (lhs & rhs) : (lhs | rhs));
+      }
+
+    default:
+      {
+        int result = 0;
+
+        if (!Compare(GetOperand(operands[0], event), GetOperand(operands[1], event), result))
+          {
+            return Variant(false);
+          }
+
+        switch (element.Operator)
+          {
+          case FilterOperator::GreaterThan:
+            return Variant(result > 0);
+
+          case FilterOperator::LessThan:
+            return Variant(result < 0);
+
+          case FilterOperator::GreaterThanOrEqual:
+            return Variant(result >= 0);
+
+          default:
+            return Variant(result <= 0);
+          }
+      }
+    }
+}
+
+}
+}
@@ -0,0 +1,125 @@
+/// @brief Event filters of monitored items compiled for evaluation.
+/// @license GNU LGPL
+///
+/// Distributed under the GNU LGPL License
+/// (See accompanying file LICENSE or copy at
+/// http://www.gnu.org/licenses/lgpl.html)
+///
+
+#pragma once
+
+#include <opc/ua/event.h>
+#include <opc/ua/protocol/types_manual.h>
+#include <opc/ua/server/address_space.h>
+
+#include <memory>
+#include <unordered_set>
+#include <vector>
+
+namespace OpcUa
+{
+namespace Internal
+{
+
+/// @brief Event field referenced by a SimpleAttributeOperand, resolved once
+/// so that reading it from an event does not compare browse names.
+class EventField
+{
+public:
+  /// @brief Field which is null in every event.
+  EventField();
+  explicit EventField(const SimpleAttributeOperand & operand);
+
+  /// @brief Value of the field in the event.
+  /// Safe to call from several threads: the slots resolved for the layouts
+  /// of the last events are replaced as a whole.
+  Variant Get(const Event & event) const;
+
+private:
+  enum class Slot
+  {
+    EventId,
+    EventType,
+    SourceNode,
+    SourceName,
+    Message,
+    Severity,
+    LocalTime,
+    ReceiveTime,
+    Time,
+    Attribute,
+    Path,
+  };
+
+  // slot of Path in a layout
+  struct LayoutSlot
+  {
+    EventLayout::SharedPtr Layout;
+    int32_t Index;
+  };
+  typedef std::vector<LayoutSlot> LayoutSlots;
+
+  // event types alternating in a stream of events stay in the cache
+  static const std::size_t MaxCachedLayouts = 8;
+
+  Slot Id;
+  AttributeId Attribute;
+  std::vector<QualifiedName> Path;
+  // slots of Path in the layouts of the last events read, oldest first, accessed with std::atomic_load/store
+  mutable std::shared_ptr<const LayoutSlots> CachedSlots;
+};
+
+/// @brief EventFilter of a monitored item compiled at creation time.
+/// Select clauses become event fields and the where clause becomes a list of
+/// elements whose operands are literals, fields or indexes of other elements.
+/// OfType keeps the set of all subtypes of its type.
+class CompiledEventFilter
+{
+public:
+  /// @brief Filter which selects no fields and matches every event.
+  CompiledEventFilter();
+
+  /// @brief Compile filter, subtypes used by OfType are read from the address space.
+  CompiledEventFilter(const EventFilter & filter, Server::AddressSpace & addressSpace);
+
+  /// @brief Good or the reason why the filter can not be evaluated.
+  StatusCode GetStatus() const;
+
+  bool Matches(const Event & event) const;
+  std::vector<Variant> Select(const Event & event) const;
+
+private:
+  struct Operand
+  {
+    enum class Kind
+    {
+      Literal,
+      Field,
+      Element,
+    };
+
+    Kind Type;
+    Variant Literal;
+    EventField Field;
+    uint32_t ElementIndex;
+  };
+
+  struct Element
+  {
+    FilterOperator Operator;
+    std::vector<Operand> Operands;
+    std::unordered_set<NodeId> Types; // OfType: the type and all its subtypes
+  };
+
+  StatusCode CompileElement(const ContentFilterElement & source, uint32_t index, Server::AddressSpace & addressSpace);
+  Variant Evaluate(uint32_t index, const Event & event) const;
+  Variant GetOperand(const Operand & operand, const Event & event) const;
+
+private:
+  StatusCode Status;
+  std::vector<EventField> SelectFields;
+  std::vector<Element> Where;
+};
+
+}
+}
@@ -1,33 +1,85 @@
 #include "internal_subscription.h"
 
+#include <opc/ua/protocol/binary/stream.h>
+
 #include <boost/thread/locks.hpp>
 
+#include <algorithm>
+#include <limits>
+
+namespace
+{
+// InfoType DataValue with the Overflow bit, see Part 4 7.34.1
+const uint32_t StatusOverflowBits = 0x480;
+// Revised queue sizes of monitored items
+const uint32_t MaxDataChangeQueueSize = 1000;
+const uint32_t DefaultEventQueueSize = 1000;
+const uint32_t MaxEventQueueSize = 10000;
+// Shortest sampling interval given to clients asking for the fastest practical rate
+const double FastestSamplingInterval = 10;
+// Data changes handed over between two publishing cycles without allocation, more go to a list
+const std::size_t IncomingDataChangesCapacity = 1024;
+
+void SetOverflowBit(OpcUa::DataValue & value)
+{
+  value.Status = static_cast<OpcUa::StatusCode>(static_cast<uint32_t>(value.Status) | StatusOverflowBits);
+  value.Encoding |= OpcUa::DATA_VALUE_STATUS_CODE;
+}
+
+// Output channel of a serializer which keeps the serialized data.
+struct MessageBuffer
+{
+  std::vector<char> Data;
+
+  void Send(const char * data, std::size_t size)
+  {
+    Data.assign(data, data + size);
+  }
+};
+
+OpcUa::Server::EncodedNotificationMessage EncodeNotificationMessage(const OpcUa::NotificationMessage & message)
+{
+  OpcUa::Binary::DataSerializer serializer;
+  serializer << message;
+  MessageBuffer buffer;
+  serializer.Flush(buffer);
+  return std::make_shared<const std::vector<char>>(std::move(buffer.Data));
+}
+
+uint32_t ReviseQueueSize(const OpcUa::MonitoredItemCreateRequest & request)
+{
+  const uint32_t requested = request.RequestedParameters.QueueSize;
+
+  if (request.ItemToMonitor.AttributeId == OpcUa::AttributeId::EventNotifier)
+    {
+      return requested == 0 ? DefaultEventQueueSize : std::min(requested, MaxEventQueueSize);
+    }
+
+  return std::max<uint32_t>(std::min(requested, MaxDataChangeQueueSize), 1);
+}
+}
+
 namespace OpcUa
 {
 namespace Internal
 {
 
-InternalSubscription::InternalSubscription(SubscriptionServiceInternal & service, const SubscriptionData & data, const NodeId & SessionAuthenticationToken, std::function<void (PublishResult)> callback, const Common::Logger::SharedPtr & logger)
+InternalSubscription::InternalSubscription(SubscriptionServiceInternal & service, const SubscriptionData & data, const CreateSubscriptionParameters & parameters, const NodeId & SessionAuthenticationToken, std::function<void (PublishResult)> callback, std::function<void (const Server::EncodedPublishResult &)> encodedCallback, const Common::Logger::SharedPtr & logger)
   : Service(service)
   , AddressSpace(Service.GetAddressSpace())
   , Data(data)
+  , MaxNotificationsPerPublish(parameters.MaxNotificationsPerPublish)
+  , Priority(parameters.Priority)
   , CurrentSession(SessionAuthenticationToken)
   , Callback(callback)
-  , io(service.GetIOService())
-  , Timer(io, boost::posix_time::microseconds(static_cast<unsigned long>(1000 * data.RevisedPublishingInterval)))
+  , EncodedCallback(encodedCallback)
+  , IncomingDataChanges(IncomingDataChangesCapacity)
   , LifeTimeCount(data.RevisedLifetimeCount)
   , Logger(logger)
 {
   LOG_DEBUG(Logger, "internal_subscription | id: {}, create", Data.SubscriptionId);
 }
 
-void InternalSubscription::Start()
-{
-  LOG_DEBUG(Logger, "internal_subscription | id: {}, start", Data.SubscriptionId);
-  std::shared_ptr<InternalSubscription> self = shared_from_this();
-  Timer.async_wait([self](const boost::system::error_code & error) { self->PublishResults(error); });
-}
-
 InternalSubscription::~InternalSubscription()
 {
   //Stop();
@@ -38,7 +90,22 @@ void InternalSubscription::Stop()
 {
   LOG_DEBUG(Logger, "internal_subscription | id: {}, stop", Data.SubscriptionId);
   DeleteAllMonitoredItems();
-  Timer.cancel();
+}
+
+uint32_t InternalSubscription::GetSubscriptionId() const
+{
+  return Data.SubscriptionId;
+}
+
+const NodeId & InternalSubscription::GetSession() const
+{
+  return CurrentSession;
+}
+
+double InternalSubscription::GetPublishingInterval() const
+{
+  boost::shared_lock<boost::shared_mutex> lock(DbMutex);
+  return Data.RevisedPublishingInterval;
 }
 
 void InternalSubscription::DeleteAllMonitoredItems()
@@ -49,7 +116,7 @@ void InternalSubscription::DeleteAllMonitoredItems()
   {
     boost::shared_lock<boost::shared_mutex> lock(DbMutex);
 
-    for (auto pair : MonitoredDataChanges)
+    for (const auto & pair : MonitoredDataChanges)
       {
         handles.push_back(pair.first);
       }
@@ -69,53 +136,153 @@ bool InternalSubscription::HasExpired()
   return expired;
 }
 
-void InternalSubscription::PublishResults(const boost::system::error_code & error)
+uint32_t InternalSubscription::Publish(uint32_t elapsedIntervals)
+{
+  uint8_t priority;
+  {
+    boost::unique_lock<boost::shared_mutex> lock(DbMutex);
+    priority = Priority;
+
+    // intervals skipped while sleeping had nothing to publish
+    if (elapsedIntervals > 1)
+      {
+        KeepAliveCount += elapsedIntervals - 1;
+      }
+
+    Sleeping = false;
+    DrainIncomingDataChanges();
+  }
+
+  if (HasExpired())
+    {
+      return 0;
+    }
+
+  // without a publish request the subscription waits for one, see PublishLate
+  if (HasPublishResult() && Service.PopPublishRequest(CurrentSession, Data.SubscriptionId, priority))
+    {
+      SendPublishResult();
+    }
+
+  return GetSleepIntervals();
+}
+
+void InternalSubscription::PublishLate()
 {
-  if (error)
+  bool ready;
+  {
+    boost::unique_lock<boost::shared_mutex> lock(DbMutex);
+    DrainIncomingDataChanges();
+    ready = IsReadyToPublish();
+  }
+
+  if (!ready)
     {
-      LOG_WARN(Logger, "internal_subscription | id: {}, PublishResults: error: stopping subscription timer", Data.SubscriptionId);
+      // sent meanwhile by a publishing cycle
+      Service.ReturnPublishRequest(CurrentSession);
       return;
     }
 
-  if (HasExpired())
+  LOG_DEBUG(Logger, "internal_subscription | id: {}, answer publish request received late", Data.SubscriptionId);
+  SendPublishResult();
+}
+
+void InternalSubscription::SendPublishResult()
+{
+  Server::EncodedNotificationMessage encoded;
+  PublishResult result = PopPublishResult(encoded);
+
+  if (EncodedCallback)
     {
-      return;
+      LOG_DEBUG(Logger, "internal_subscription | id: {}, calling callback with encoded message", Data.SubscriptionId);
+
+      Server::EncodedPublishResult sent;
+      sent.SubscriptionId = result.SubscriptionId;
+      sent.AvailableSequenceNumbers = result.AvailableSequenceNumbers;
+      sent.MoreNotifications = result.MoreNotifications;
+      sent.NotificationMessage = encoded;
+      sent.Results = result.Results;
+      EncodedCallback(sent);
+    }
+
+  else if (Callback)
+    {
+      LOG_DEBUG(Logger, "internal_subscription | id: {}, calling callback", Data.SubscriptionId);
+      Callback(result);
     }
 
-  if (HasPublishResult() && Service.PopPublishRequest(CurrentSession))   //Check we received a publishrequest before sending response
+  else
     {
+      LOG_DEBUG(Logger, "internal_subscription | id: {}, no callback defined for this subscription", Data.SubscriptionId);
+    }
 
-      std::vector<PublishResult> results = PopPublishResult();
+  if (result.MoreNotifications)
+    {
+      // the rest is sent with the next publish request, after the
+      // subscriptions of the session which are already waiting for one
+      uint8_t priority;
+      {
+        boost::shared_lock<boost::shared_mutex> lock(DbMutex);
+        priority = Priority;
+      }
+      Service.RequeuePublish(CurrentSession, Data.SubscriptionId, priority);
+    }
+}
 
-      if (results.size() > 0)
-        {
-          LOG_DEBUG(Logger, "internal_subscription | id: {}, have {} results", Data.SubscriptionId, results.size());
+uint32_t InternalSubscription::GetSleepIntervals()
+{
+  boost::unique_lock<boost::shared_mutex> lock(DbMutex);
 
-          if (Callback)
-            {
-              LOG_DEBUG(Logger, "internal_subscription | id: {}, calling callback", Data.SubscriptionId);
-              Callback(results[0]);
-            }
+  if (IsReadyToPublish())
+    {
+      return 1;
+    }
 
-          else
-            {
-              LOG_DEBUG(Logger, "internal_subscription | id: {}, no callback defined for this subscription", Data.SubscriptionId);
-            }
+  // Nothing to publish until a notification arrives: sleep until the cycle
+  // which sends keep alive or detects expiration, see HasPublishResult and HasExpired.
+  // counts lowered by ModifySubscription may already be passed
+  const uint64_t keepAliveLimit = uint64_t(Data.RevisedMaxKeepAliveCount) + 2;
+  const uint64_t lifeTimeLimit = uint64_t(LifeTimeCount) + 2;
+  const uint64_t keepAlive = keepAliveLimit > KeepAliveCount ? keepAliveLimit - KeepAliveCount : 1;
+  const uint64_t lifeTime = lifeTimeLimit > KeepAliveCount ? lifeTimeLimit - KeepAliveCount : 1;
+  const uint64_t intervals = std::min<uint64_t>(std::min(keepAlive, lifeTime), std::numeric_limits<uint32_t>::max());
+
+  if (intervals > 1)
+    {
+      Sleeping = true;
+      std::atomic_thread_fence(std::memory_order_seq_cst);
+
+      // a data change handed over before Sleeping was set did not wake us up
+      if (!IncomingDataChanges.Empty() || HasOverflowDataChanges)
+        {
+          Sleeping = false;
+          return 1;
         }
     }
 
-  TimerStopped = false;
-  Timer.expires_at(Timer.expires_at() + boost::posix_time::microseconds(static_cast<unsigned long>(1000 * Data.RevisedPublishingInterval)));
-  std::shared_ptr<InternalSubscription> self = shared_from_this();
-  Timer.async_wait([self](const boost::system::error_code & error) { self->PublishResults(error); });
+  return static_cast<uint32_t>(std::max<uint64_t>(intervals, 1));
+}
+
+void InternalSubscription::WakeUp()
+{
+  if (Sleeping.exchange(false))
+    {
+      Service.WakeUpSubscription(Data.SubscriptionId);
+    }
 }
 
 
+bool InternalSubscription::IsReadyToPublish() const
+{
+  // called under DbMutex
+  return Startup || !PendingDataChanges.empty() || !PendingEvents.empty() || KeepAliveCount > Data.RevisedMaxKeepAliveCount;
+}
+
 bool InternalSubscription::HasPublishResult()
 {
   boost::unique_lock<boost::shared_mutex> lock(DbMutex);
 
-  if (Startup || !TriggeredDataChangeEvents.empty() || !TriggeredEvents.empty())
+  if (Startup || !PendingDataChanges.empty() || !PendingEvents.empty())
     {
       LOG_TRACE(Logger, "internal_subscription | id: {}, HasPublishResult: all queues empty, should send publish event", Data.SubscriptionId);
       return true;
@@ -133,46 +300,37 @@ bool InternalSubscription::HasPublishResult()
 
 }
 
-std::vector<PublishResult> InternalSubscription::PopPublishResult()
+PublishResult InternalSubscription::PopPublishResult(Server::EncodedNotificationMessage & encoded)
 {
   boost::unique_lock<boost::shared_mutex> lock(DbMutex);
+  DrainIncomingDataChanges();
 
-  LOG_DEBUG(Logger, "internal_subscription | id: {}, PopPublishResult: {} queued items", Data.SubscriptionId, TriggeredDataChangeEvents.size());
+  LOG_DEBUG(Logger, "internal_subscription | id: {}, PopPublishResult: {} items with queued data changes", Data.SubscriptionId, PendingDataChanges.size());
   PublishResult result;
   result.SubscriptionId = Data.SubscriptionId;
   result.NotificationMessage.PublishTime = DateTime::Current();
 
-  if (!TriggeredDataChangeEvents.empty())
+  // notifications which do not fit are kept for the next message
+  std::size_t budget = MaxNotificationsPerPublish ? MaxNotificationsPerPublish : std::numeric_limits<std::size_t>::max();
+
+  if (!PendingDataChanges.empty())
     {
-      NotificationData data = GetNotificationData();
+      NotificationData data = GetNotificationData(budget);
       result.NotificationMessage.NotificationData.push_back(data);
       result.Results.push_back(StatusCode::Good);
     }
 
-  if (!TriggeredEvents.empty())
+  if (!PendingEvents.empty() && budget > 0)
     {
-      LOG_DEBUG(Logger, "internal_subscription | id: {}, PopPublishResult: {} events to send", Data.SubscriptionId, TriggeredEvents.size());
+      EventNotificationList notif = GetEventNotifications(budget);
 
-      EventNotificationList notif;
+      LOG_DEBUG(Logger, "internal_subscription | id: {}, PopPublishResult: {} events to send", Data.SubscriptionId, notif.Events.size());
 
-      for (TriggeredEvent ev : TriggeredEvents)
-        {
-          notif.Events.push_back(ev.Data);
-        }
-
-      TriggeredEvents.clear();
       NotificationData data(notif);
       result.NotificationMessage.NotificationData.push_back(data);
       result.Results.push_back(StatusCode::Good);
     }
 
-  // clear TriggerCount to enable new events for next
-  // publishing cycle
-  for (auto & mdc : MonitoredDataChanges)
-    {
-        mdc.second.TriggerCount = 0;
-    }
-
   // FIXME: also add statuschange notification since they can be send in same result
 
   KeepAliveCount = 0;
@@ -180,48 +338,79 @@ std::vector<PublishResult> InternalSubscription::PopPublishResult()
 
   result.NotificationMessage.SequenceNumber = NotificationSequence;
   ++NotificationSequence;
-  result.MoreNotifications = false;
+  result.MoreNotifications = !PendingDataChanges.empty() || !PendingEvents.empty();
+
+  // encoded once: the same bytes are sent and kept for republish
+  encoded = EncodeNotificationMessage(result.NotificationMessage);
+  KeepForRetransmission(result.NotificationMessage.SequenceNumber, encoded);
 
-  for (const PublishResult & res : NotAcknowledgedResults)
+  // messages sent before this one which are still kept
+  for (std::size_t i = 0; i + 1 < NotAcknowledgedMessages.size(); ++i)
     {
-      result.AvailableSequenceNumbers.push_back(res.NotificationMessage.SequenceNumber);
+      result.AvailableSequenceNumbers.push_back(NotAcknowledgedMessages[i].first);
     }
 
-  NotAcknowledgedResults.push_back(result);
-
   LOG_DEBUG(Logger, "internal_subscription | id: {}, sending PublishResult with: {} notifications", Data.SubscriptionId, result.NotificationMessage.NotificationData.size());
 
-  std::vector<PublishResult> resultlist;
-  resultlist.push_back(result);
+  return result;
+}
+
+void InternalSubscription::KeepForRetransmission(uint32_t sequenceNumber, const Server::EncodedNotificationMessage & message)
+{
+  NotAcknowledgedMessages.push_back(std::make_pair(sequenceNumber, message));
+  NotAcknowledgedBytes += message->size();
+
+  // the latest message is kept whatever its size
+  const std::size_t budget = Service.GetRetransmissionBudget();
+
+  while (NotAcknowledgedBytes > budget && NotAcknowledgedMessages.size() > 1)
+    {
+      LOG_DEBUG(Logger, "internal_subscription | id: {}, retransmission budget exceeded, drop message: {}", Data.SubscriptionId, NotAcknowledgedMessages.front().first);
 
-  return resultlist;
+      NotAcknowledgedBytes -= NotAcknowledgedMessages.front().second->size();
+      NotAcknowledgedMessages.pop_front();
+    }
 }
 
 RepublishResponse InternalSubscription::Republish(const RepublishParameters & params)
 {
-  LOG_DEBUG(Logger, "internal_subscription | id: {}, Republish request for sequence: {}", Data.SubscriptionId, params.RetransmitSequenceNumber);
+  RepublishResponse response;
+  Server::EncodedNotificationMessage message = RepublishEncoded(params.RetransmitSequenceNumber);
 
-  boost::unique_lock<boost::shared_mutex> lock(DbMutex);
+  if (!message)
+    {
+      response.Header.ServiceResult = StatusCode::BadMessageNotAvailable;
+      return response;
+    }
 
-  RepublishResponse response;
+  Binary::IStreamBinary stream(message->data(), message->size());
+  stream >> response.NotificationMessage;
+  return response;
+}
+
+Server::EncodedNotificationMessage InternalSubscription::RepublishEncoded(uint32_t sequenceNumber)
+{
+  LOG_DEBUG(Logger, "internal_subscription | id: {}, Republish request for sequence: {}", Data.SubscriptionId, sequenceNumber);
+
+  boost::shared_lock<boost::shared_mutex> lock(DbMutex);
 
-  for (const PublishResult & res : NotAcknowledgedResults)
+  for (const auto & message : NotAcknowledgedMessages)
     {
-      if (res.NotificationMessage.SequenceNumber == params.RetransmitSequenceNumber)
+      if (message.first == sequenceNumber)
         {
-          response.NotificationMessage = res.NotificationMessage;
-          return response;
+          return message.second;
         }
     }
 
-  response.Header.ServiceResult = StatusCode::BadMessageNotAvailable;
-  return response;
+  return Server::EncodedNotificationMessage();
 }
 
 ModifySubscriptionResult InternalSubscription::ModifySubscription(const ModifySubscriptionParameters & data)
 {
   LOG_DEBUG(Logger, "internal_subscription | id: {}, ModifySubscription", Data.SubscriptionId);
 
+  boost::unique_lock<boost::shared_mutex> lock(DbMutex);
+
   ModifySubscriptionResult result;
 
   if (data.RequestedLifetimeCount)
@@ -245,28 +434,123 @@ ModifySubscriptionResult InternalSubscription::ModifySubscription(const ModifySu
 
   result.RevisedMaxKeepAliveCount = Data.RevisedMaxKeepAliveCount;
 
+  MaxNotificationsPerPublish = data.MaxNotificationsPerPublish;
+  Priority = data.Priority;
+
   return result;
 }
 
-NotificationData InternalSubscription::GetNotificationData()
+NotificationData InternalSubscription::GetNotificationData(std::size_t & budget)
 {
   DataChangeNotification notification;
+  std::vector<QueuedDataChange> changes;
+  std::size_t sent = 0; // monitored items with all their data changes taken
 
-  for (const TriggeredDataChange & event : TriggeredDataChangeEvents)
+  for (; sent < PendingDataChanges.size() && budget > 0; ++sent)
     {
-      notification.Notification.push_back(event.Data);
+      MonitoredDataChange & monitoredItem = MonitoredDataChanges[PendingDataChanges[sent]];
+      budget -= monitoredItem.DataChanges.Drain(changes, budget);
+
+      // values are shared with other monitored items until copied here
+      for (const QueuedDataChange & change : changes)
+        {
+          MonitoredItems item;
+          item.ClientHandle = monitoredItem.ClientHandle;
+          item.Value = *change.Value;
+
+          if (change.Overflow)
+            {
+              SetOverflowBit(item.Value);
+            }
+
+          notification.Notification.push_back(item);
+        }
+
+      changes.clear();
+
+      if (!monitoredItem.DataChanges.Empty())
+        {
+          break;
+        }
+
+      monitoredItem.Pending = false;
     }
 
-  TriggeredDataChangeEvents.clear();
+  PendingDataChanges.erase(PendingDataChanges.begin(), PendingDataChanges.begin() + sent);
   NotificationData data(notification);
   return data;
 }
 
+EventNotificationList InternalSubscription::GetEventNotifications(std::size_t & budget)
+{
+  EventNotificationList notification;
+  std::size_t sent = 0; // monitored items with all their events taken
+
+  for (; sent < PendingEvents.size() && budget > 0; ++sent)
+    {
+      MonitoredDataChange & monitoredItem = MonitoredDataChanges[PendingEvents[sent]];
+
+      // overflow event takes the place of the discarded events
+      if (monitoredItem.EventsOverflow && monitoredItem.Events.DiscardOldest())
+        {
+          notification.Events.push_back(GetOverflowEventFields(monitoredItem));
+          monitoredItem.EventsOverflow = false;
+          --budget;
+        }
+
+      budget -= monitoredItem.Events.Drain(notification.Events, budget);
+
+      if (!monitoredItem.Events.Empty())
+        {
+          break;
+        }
+
+      if (monitoredItem.EventsOverflow)
+        {
+          if (budget == 0)
+            {
+              break;
+            }
+
+          notification.Events.push_back(GetOverflowEventFields(monitoredItem));
+          monitoredItem.EventsOverflow = false;
+          --budget;
+        }
+
+      monitoredItem.Pending = false;
+    }
+
+  PendingEvents.erase(PendingEvents.begin(), PendingEvents.begin() + sent);
+  return notification;
+}
+
+EventFieldList InternalSubscription::GetOverflowEventFields(const MonitoredDataChange & monitoredItem)
+{
+  Event event(ObjectId::EventQueueOverflowEventType);
+  event.SourceNode = ObjectId::Server;
+  event.SourceName = "Server";
+  event.Time = event.ReceiveTime = DateTime::Current();
+  event.Message = LocalizedText("Event queue overflow");
+
+  EventFieldList fields;
+  fields.ClientHandle = monitoredItem.ClientHandle;
+  fields.EventFields = monitoredItem.EventFilter.Select(event);
+  return fields;
+}
+
 void InternalSubscription::NewAcknowlegment(const SubscriptionAcknowledgement & ack)
 {
   boost::unique_lock<boost::shared_mutex> lock(DbMutex);
 
-  NotAcknowledgedResults.remove_if([&](PublishResult res) { return ack.SequenceNumber == res.NotificationMessage.SequenceNumber; });
+  for (auto it = NotAcknowledgedMessages.begin(); it != NotAcknowledgedMessages.end(); ++it)
+    {
+      if (it->first == ack.SequenceNumber)
+        {
+          NotAcknowledgedBytes -= it->second->size();
+          NotAcknowledgedMessages.erase(it);
+          return;
+        }
+    }
 }
 
 
@@ -275,14 +559,55 @@ MonitoredItemCreateResult InternalSubscription::CreateMonitoredItem(const Monito
   LOG_DEBUG(Logger, "internal_subscription | id: {}, CreateMonitoredItem", Data.SubscriptionId);
 
   MonitoredItemCreateResult result;
-  uint32_t callbackHandle = 0;
+  DataChangeFilterEvaluator filter;
+  CompiledEventFilter eventFilter;
+
+  if (request.ItemToMonitor.AttributeId == AttributeId::EventNotifier)
+    {
+      eventFilter = CompiledEventFilter(request.RequestedParameters.Filter.Event, AddressSpace);
+      result.Status = eventFilter.GetStatus();
+
+      if (result.Status != StatusCode::Good)
+        {
+          LOG_DEBUG(Logger, "internal_subscription | id: {}, rejected event filter: {}", Data.SubscriptionId, ToString(result.Status));
+          return result;
+        }
+    }
+
+  else
+    {
+      result.Status = CreateDataChangeFilter(request, filter);
+
+      if (result.Status != StatusCode::Good)
+        {
+          LOG_DEBUG(Logger, "internal_subscription | id: {}, rejected data change filter: {}", Data.SubscriptionId, ToString(result.Status));
+          return result;
+        }
+    }
+
+  // read before locking as the address space may call data change callbacks
+  const double minimumSamplingInterval = GetMinimumSamplingInterval(request.ItemToMonitor);
+
   {
     boost::unique_lock<boost::shared_mutex> lock(DbMutex);
 
     result.MonitoredItemId = ++LastMonitoredItemId;
     result.Status = OpcUa::StatusCode::Good;
-    result.RevisedSamplingInterval = Data.RevisedPublishingInterval; // Force our own rate
-    result.RevisedQueueSize = request.RequestedParameters.QueueSize; // We should check that value, maybe set to a default...
+
+    // negative interval asks for the publishing interval, 0 for the fastest rate (Part 4 5.12.1.2)
+    const double requested = request.RequestedParameters.SamplingInterval;
+
+    if (request.ItemToMonitor.AttributeId == AttributeId::EventNotifier || requested < 0)
+      {
+        result.RevisedSamplingInterval = Data.RevisedPublishingInterval;
+      }
+
+    else
+      {
+        result.RevisedSamplingInterval = std::max(requested, minimumSamplingInterval);
+      }
+
+    result.RevisedQueueSize = ReviseQueueSize(request);
     result.FilterResult = request.RequestedParameters.Filter; // We can omit that one if we do not change anything in filter
 
     if (request.ItemToMonitor.AttributeId == AttributeId::EventNotifier)
@@ -292,68 +617,171 @@ MonitoredItemCreateResult InternalSubscription::CreateMonitoredItem(const Monito
 
         // Client wants to subscribe to events
         // FIXME: check attribute EVENT notifier is set for the node
-        MonitoredEvents[request.ItemToMonitor.NodeId] = result.MonitoredItemId;
+        MonitoredEvents[result.MonitoredItemId] = request.ItemToMonitor.NodeId;
       }
   }
 
-  // Do not lock this part as it (indirectly) calls a locked AddressSpaceInMemory
-  // function.
-  // AddressSpaceInMemory functions call locked InternalSubscription functions
-  // which will result in deadlocks when used from different threads
+  // Subscribing reads the value and registers callbacks in the address space:
+  // it is done with the subscription unlocked.
+  MonitoredDataChange mdata;
+
   if (request.ItemToMonitor.AttributeId != AttributeId::EventNotifier)
     {
-      LOG_DEBUG(Logger, "internal_subscription | id: {}, subscribe to data changes", Data.SubscriptionId);
-
-      uint32_t id = result.MonitoredItemId;
-      callbackHandle = AddressSpace.AddDataChangeCallback(request.ItemToMonitor.NodeId, request.ItemToMonitor.AttributeId, [this, id](const OpcUa::NodeId & nodeId, OpcUa::AttributeId attr, const DataValue & value)
-      {
-        this->DataChangeCallback(id, value);
-      });
+      const MonitoringFilter & requested = request.RequestedParameters.Filter;
+      const bool hasFilter = requested.Header.TypeId == ExpandedObjectId::DataChangeFilter;
+      mdata.Sampled = true;
+      mdata.SamplerKey.Node = request.ItemToMonitor.NodeId;
+      mdata.SamplerKey.Attribute = request.ItemToMonitor.AttributeId;
+      mdata.SamplerKey.SamplingInterval = result.RevisedSamplingInterval;
+      mdata.SamplerKey.Trigger = hasFilter ? requested.DataChange.Trigger : DataChangeTrigger::StatusValue;
+      mdata.SamplerKey.Deadband = hasFilter ? requested.DataChange.Deadband : DeadbandType::None;
+      mdata.SamplerKey.DeadbandValue = hasFilter ? requested.DataChange.DeadbandValue : 0;
     }
 
-  MonitoredDataChange mdata;
   {
     boost::unique_lock<boost::shared_mutex> lock(DbMutex);
 
     mdata.Parameters = result;
     mdata.Mode = request.MonitoringMode;
-    mdata.TriggerCount = 0;
+    mdata.EventFilter = eventFilter;
+    mdata.DataChanges = NotificationQueue<QueuedDataChange>(result.RevisedQueueSize, request.RequestedParameters.DiscardOldest);
+    mdata.Events = NotificationQueue<EventFieldList>(result.RevisedQueueSize, request.RequestedParameters.DiscardOldest);
     mdata.ClientHandle = request.RequestedParameters.ClientHandle;
-    mdata.CallbackHandle = callbackHandle;
     mdata.MonitoredItemId = result.MonitoredItemId;
     MonitoredDataChanges[result.MonitoredItemId] = mdata;
   }
 
-  // Do not lock this part as it (indirectly) calls a locked AddressSpaceInMemory
-  // function.
   LOG_DEBUG(Logger, "internal_subscription | id: {}, created MonitoredItem id: {}, ClientHandle: {}", Data.SubscriptionId, result.MonitoredItemId, mdata.ClientHandle);
 
-  // Forcing event
-  if (request.ItemToMonitor.AttributeId != AttributeId::EventNotifier)
+  // The item exists before it is subscribed, so none of its data changes
+  // are dropped. The sampler enqueues the initial value of the item.
+  if (mdata.Sampled)
     {
-      TriggerDataChangeEvent(mdata, request.ItemToMonitor);
+      LOG_DEBUG(Logger, "internal_subscription | id: {}, subscribe to data changes", Data.SubscriptionId);
+
+      Service.GetDataChangeSamplers().Subscribe(mdata.SamplerKey, filter, *this, result.MonitoredItemId);
+
+      boost::unique_lock<boost::shared_mutex> lock(DbMutex);
+
+      // deleted meanwhile, its unsubscription found nothing to remove
+      if (!MonitoredDataChanges.count(result.MonitoredItemId))
+        {
+          lock.unlock();
+          Service.GetDataChangeSamplers().Unsubscribe(mdata.SamplerKey, *this, result.MonitoredItemId);
+        }
     }
 
   return result;
 }
 
-void InternalSubscription::TriggerDataChangeEvent(MonitoredDataChange monitoreditems, ReadValueId attrval)
+double InternalSubscription::GetMinimumSamplingInterval(const ReadValueId & item)
 {
-  LOG_DEBUG(Logger, "internal_subscription | id: {}, TriggerDataChangeEvent: ClientHandle: {}", Data.SubscriptionId, monitoreditems.ClientHandle);
+  if (item.AttributeId == AttributeId::EventNotifier)
+    {
+      return FastestSamplingInterval;
+    }
 
   ReadParameters params;
-  params.AttributesToRead.push_back(attrval);
-  std::vector<DataValue> vals = AddressSpace.Read(params);
+  ReadValueId minimum;
+  minimum.NodeId = item.NodeId;
+  minimum.AttributeId = AttributeId::MinimumSamplingInterval;
+  params.AttributesToRead.push_back(minimum);
+  const DataValue value = AddressSpace.Read(params).front();
+
+  // not set or not a variable
+  if (value.Status != StatusCode::Good || value.Value.Type() != VariantType::DOUBLE)
+    {
+      return FastestSamplingInterval;
+    }
 
-  TriggeredDataChange event;
-  event.MonitoredItemId = monitoreditems.MonitoredItemId;
-  event.Data.ClientHandle = monitoreditems.ClientHandle;
-  event.Data.Value = vals[0];
-  {
-    boost::unique_lock<boost::shared_mutex> lock(DbMutex);
+  return std::max(value.Value.As<double>(), FastestSamplingInterval);
+}
 
-    TriggeredDataChangeEvents.push_back(event);
-  }
+StatusCode InternalSubscription::CreateDataChangeFilter(const MonitoredItemCreateRequest & request, DataChangeFilterEvaluator & filter)
+{
+  const MonitoringFilter & requested = request.RequestedParameters.Filter;
+
+  if (requested.Header.TypeId != ExpandedObjectId::DataChangeFilter)
+    {
+      return StatusCode::Good;
+    }
+
+  const DataChangeFilter & dataChange = requested.DataChange;
+
+  if (request.ItemToMonitor.AttributeId != AttributeId::Value)
+    {
+      return StatusCode::BadFilterNotAllowed;
+    }
+
+  if (dataChange.Trigger > DataChangeTrigger::StatusValueTimestamp || dataChange.Deadband > DeadbandType::Percent)
+    {
+      return StatusCode::BadMonitoredItemFilterInvalid;
+    }
+
+  if (dataChange.Deadband == DeadbandType::None)
+    {
+      filter = DataChangeFilterEvaluator(dataChange, 0);
+      return StatusCode::Good;
+    }
+
+  if (dataChange.DeadbandValue < 0 || (dataChange.Deadband == DeadbandType::Percent && dataChange.DeadbandValue > 100))
+    {
+      return StatusCode::BadDeadbandFilterInvalid;
+    }
+
+  // deadband is only defined for numeric values
+  ReadParameters params;
+  params.AttributesToRead.push_back(request.ItemToMonitor);
+
+  if (!IsNumeric(AddressSpace.Read(params).front().Value.Type()))
+    {
+      return StatusCode::BadFilterNotAllowed;
+    }
+
+  double range = 0;
+
+  if (dataChange.Deadband == DeadbandType::Percent)
+    {
+      double low = 0;
+      double high = 0;
+
+      if (!GetEURange(request.ItemToMonitor.NodeId, low, high))
+        {
+          return StatusCode::BadFilterNotAllowed;
+        }
+
+      range = high - low;
+    }
+
+  filter = DataChangeFilterEvaluator(dataChange, range);
+  return StatusCode::Good;
+}
+
+bool InternalSubscription::GetEURange(const NodeId & node, double & low, double & high)
+{
+  RelativePathElement element;
+  element.ReferenceTypeId = ObjectId::HasProperty;
+  element.TargetName = QualifiedName("EURange", 0);
+
+  BrowsePath path;
+  path.StartingNode = node;
+  path.Path.Elements.push_back(element);
+
+  TranslateBrowsePathsParameters translate;
+  translate.BrowsePaths.push_back(path);
+  std::vector<BrowsePathResult> paths = AddressSpace.TranslateBrowsePathsToNodeIds(translate);
+
+  if (paths.empty() || paths.front().Status != StatusCode::Good || paths.front().Targets.empty())
+    {
+      return false;
+    }
+
+  ReadValueId value;
+  value.NodeId = paths.front().Targets.front().Node;
+  value.AttributeId = AttributeId::Value;
+  ReadParameters params;
+  params.AttributesToRead.push_back(value);
+  return ParseRange(AddressSpace.Read(params).front().Value, low, high);
 }
 
 std::vector<StatusCode> InternalSubscription::DeleteMonitoredItemsIds(const std::vector<uint32_t> & monitoreditemsids)
@@ -396,32 +824,18 @@ bool InternalSubscription::DeleteMonitoredDataChange(uint32_t handle)
 
   else
     {
-      if (it->second.CallbackHandle != 0)  //if 0 this monitoreditem did not use callbacks
+      if (it->second.Sampled)
         {
+          const DataChangeSamplers::Key key = it->second.SamplerKey;
           lock.unlock();
-          // break deadlock condition: InternalSubscription <-> AddressSpace
-          AddressSpace.DeleteDataChangeCallback(it->second.CallbackHandle);
+          // unsubscribing may wait for data change callbacks, which may use this subscription
+          Service.GetDataChangeSamplers().Unsubscribe(key, *this, handle);
           lock.lock();
         }
 
+      // queued notifications go away with the monitored item
       MonitoredDataChanges.erase(handle);
-
-      //We remove you our monitoreditem, now empty events which are already triggered
-      for (auto ev = TriggeredDataChangeEvents.begin(); ev != TriggeredDataChangeEvents.end();)
-        {
-          if (ev->MonitoredItemId == handle)
-            {
-              LOG_DEBUG(Logger, "internal_subscription | id: {}, remove TriggeredDataChangeEvents of MonitoredItemId: {}", Data.SubscriptionId, handle);
-
-              ev = TriggeredDataChangeEvents.erase(ev);
-            }
-
-          else
-            {
-              ++ev;
-            }
-        }
-
+      PendingDataChanges.erase(std::remove(PendingDataChanges.begin(), PendingDataChanges.end(), handle), PendingDataChanges.end());
       return true;
     }
 }
@@ -430,81 +844,111 @@ bool InternalSubscription::DeleteMonitoredEvent(uint32_t handle)
 {
   boost::unique_lock<boost::shared_mutex> lock(DbMutex);
 
-  for (auto pair : MonitoredEvents)
+  if (MonitoredEvents.erase(handle) == 0)
     {
-      if (pair.second == handle)
-        {
-          MonitoredEvents.erase(pair.first);
-
-          //We remove you our monitoreditem, now empty events which are already triggered
-          for (auto ev = TriggeredEvents.begin(); ev != TriggeredEvents.end();)
-            {
-              if (ev->MonitoredItemId == handle)
-                {
-                  LOG_DEBUG(Logger, "internal_subscription | id: {}, remove TriggeredEvents of MonitoredItemId: {}", Data.SubscriptionId, handle);
+      return false;
+    }
 
-                  ev = TriggeredEvents.erase(ev);
-                }
+  // queued events go away with the monitored item
+  MonitoredDataChanges.erase(handle);
+  PendingEvents.erase(std::remove(PendingEvents.begin(), PendingEvents.end(), handle), PendingEvents.end());
+  return true;
+}
 
-              else
-                {
-                  ++ev;
-                }
-            }
+void InternalSubscription::EnqueueDataChange(uint32_t monitoredItemId, const SharedDataValue & value)
+{
+  IncomingDataChange change;
+  change.MonitoredItemId = monitoredItemId;
+  change.Value = value;
+  change.Sequence = ++IncomingSequence;
 
-          return true;
-        }
+  if (!IncomingDataChanges.Push(change))
+    {
+      // publishing cycles do not keep up: the list lock is only held to append or take it
+      std::lock_guard<std::mutex> lock(OverflowMutex);
+      OverflowDataChanges.push_back(change);
+      HasOverflowDataChanges = true;
     }
 
-  return false;
+  std::atomic_thread_fence(std::memory_order_seq_cst);
+  WakeUp();
 }
 
-void InternalSubscription::DataChangeCallback(const uint32_t & m_id, const DataValue & value)
+void InternalSubscription::DrainIncomingDataChanges()
 {
-  boost::unique_lock<boost::shared_mutex> lock(DbMutex);
+  // called under DbMutex, which makes it the only consumer
+  IncomingDataChange change;
 
-  TriggeredDataChange event;
-  MonitoredDataChangeMap::iterator it_monitoreditem = MonitoredDataChanges.find(m_id);
+  while (IncomingDataChanges.Pop(change))
+    {
+      TakeIncomingDataChange(change);
+    }
 
-  if (it_monitoreditem == MonitoredDataChanges.end())
+  if (HasOverflowDataChanges.exchange(false))
     {
-      LOG_WARN(Logger, "internal_subscription | id: {}, DataChangeCallback called for unknown item: {}", Data.SubscriptionId, m_id);
-      return ;
+      std::vector<IncomingDataChange> overflow;
+      {
+        std::lock_guard<std::mutex> lock(OverflowMutex);
+        overflow.swap(OverflowDataChanges);
+      }
+
+      for (const IncomingDataChange & change : overflow)
+        {
+          TakeIncomingDataChange(change);
+        }
     }
+}
 
-  MonitoredDataChange& monitoredDataChange = it_monitoreditem->second;
-  // spec says default sample interval for MonitoredItems is the same
-  // as Subscription publishing interval, so bail out if event has been
-  // triggered before
-  if (monitoredDataChange.TriggerCount > 0)
+void InternalSubscription::TakeIncomingDataChange(const IncomingDataChange & change)
+{
+  MonitoredDataChangeMap::iterator it_monitoreditem = MonitoredDataChanges.find(change.MonitoredItemId);
+
+  // the monitored item may have been deleted since
+  if (it_monitoreditem == MonitoredDataChanges.end())
     {
       return;
     }
-  event.MonitoredItemId = it_monitoreditem->first;
-  event.Data.ClientHandle = monitoredDataChange.ClientHandle;
-  event.Data.Value = value;
 
-  LOG_DEBUG(Logger, "internal_subscription | id: {}, enqueue TriggeredDataChange event: ClientHandle: {}", Data.SubscriptionId, event.Data.ClientHandle);
+  MonitoredDataChange & monitoredItem = it_monitoreditem->second;
 
-  ++monitoredDataChange.TriggerCount;
-  TriggeredDataChangeEvents.push_back(event);
+  // a value left in the list may be taken after a later one of the queue,
+  // it is discarded as if the queue of the monitored item had overflowed
+  if (change.Sequence < monitoredItem.LastIncomingSequence)
+    {
+      if (monitoredItem.DataChanges.Capacity() > 1 && !monitoredItem.DataChanges.Empty())
+        {
+          monitoredItem.DataChanges.Back().Overflow = true;
+        }
+
+      return;
+    }
+
+  monitoredItem.LastIncomingSequence = change.Sequence;
+  PushDataChange(monitoredItem, change.Value);
 }
 
-void InternalSubscription::TriggerEvent(NodeId node, Event event)
+void InternalSubscription::PushDataChange(MonitoredDataChange & monitoredItem, const SharedDataValue & value)
 {
-  boost::shared_lock<boost::shared_mutex> lock(DbMutex);
+  LOG_DEBUG(Logger, "internal_subscription | id: {}, enqueue data change: ClientHandle: {}", Data.SubscriptionId, monitoredItem.ClientHandle);
 
-  MonitoredEventsMap::iterator it = MonitoredEvents.find(node);
+  QueuedDataChange change;
+  change.Value = value;
 
-  if (it == MonitoredEvents.end())
+  // a queue of one just keeps the latest value, larger queues flag the
+  // value next to the discarded one (Part 4 5.12.1.5)
+  if (monitoredItem.DataChanges.Push(change) && monitoredItem.DataChanges.Capacity() > 1)
     {
-      LOG_DEBUG(Logger, "internal_subscription | id: {} does not monitor NodeId: {}", Data.SubscriptionId, node);
+      QueuedDataChange & flagged = monitoredItem.DataChanges.DiscardOldest() ? monitoredItem.DataChanges.Front() : monitoredItem.DataChanges.Back();
+      flagged.Overflow = true;
+    }
 
-      return;
+  if (!monitoredItem.Pending)
+    {
+      monitoredItem.Pending = true;
+      PendingDataChanges.push_back(monitoredItem.MonitoredItemId);
     }
 
-  lock.unlock();//Enqueue vill need to set a unique lock
-  EnqueueEvent(it->second, event);
+  WakeUp();
 }
 
 bool InternalSubscription::EnqueueEvent(uint32_t monitoredItemId, const Event & event)
@@ -523,96 +967,72 @@ bool InternalSubscription::EnqueueEvent(uint32_t monitoredItemId, const Event &
       return false;
     }
 
-  //Check filter against event data and create EventFieldList to send
-  //FIXME: Here we should also check event agains WhereClause of filter
-  EventFieldList fieldlist;
-  fieldlist.ClientHandle = mii_it->second.ClientHandle;
-  fieldlist.EventFields = GetEventFields(mii_it->second.Parameters.FilterResult.Event, event);
-  TriggeredEvent ev;
-  ev.Data = fieldlist;
-  ev.MonitoredItemId = monitoredItemId;
-  TriggeredEvents.push_back(ev);
+  if (!AppendEvent(monitoredItemId, mii_it->second, event))
+    {
+      return false;
+    }
+
+  WakeUp();
   return true;
 }
 
-std::vector<Variant> InternalSubscription::GetEventFields(const EventFilter & filter, const Event & event)
+void InternalSubscription::EnqueueEvents(const std::vector<uint32_t> & monitoredItemIds, const std::vector<Event> & events)
 {
-  //Go through filter and add value og matches as in spec
-  std::vector<Variant> fields;
+  LOG_DEBUG(Logger, "internal_subscription | id: {}, EnqueueEvents: {} events for {} monitored items", Data.SubscriptionId, events.size(), monitoredItemIds.size());
 
-  LOG_DEBUG(Logger, "internal_subscription | id: {}, GetEventFields: filter size: {}", Data.SubscriptionId, filter.SelectClauses.size());
+  boost::unique_lock<boost::shared_mutex> lock(DbMutex);
 
-  for (SimpleAttributeOperand sattr : filter.SelectClauses)
+  bool enqueued = false;
+
+  for (uint32_t monitoredItemId : monitoredItemIds)
     {
-      LOG_DEBUG(Logger, "internal_subscription | id: {}, BrowsePath size: {}", Data.SubscriptionId, sattr.BrowsePath.size());
+      std::map<uint32_t, MonitoredDataChange>::iterator mii_it = MonitoredDataChanges.find(monitoredItemId);
 
-      if (sattr.BrowsePath.size() == 0)
+      if (mii_it == MonitoredDataChanges.end())
         {
-          fields.push_back(event.GetValue(sattr.Attribute));
+          LOG_DEBUG(Logger, "internal_subscription | id: {}, MonitoredItemId: {} is already deleted", Data.SubscriptionId, monitoredItemId);
+
+          continue;
         }
 
-      else
+      for (const Event & event : events)
         {
-          LOG_DEBUG(Logger, "internal_subscription | id: {}, send value for: {}", Data.SubscriptionId, sattr.BrowsePath[0]);
-
-          if (sattr.BrowsePath[0] == QualifiedName("EventId", 0))
-            {
-              fields.push_back(event.EventId);
-            }
-
-          else if (sattr.BrowsePath[0] == QualifiedName("EventType", 0))
-            {
-              fields.push_back(event.EventType);
-            }
-
-          else if (sattr.BrowsePath[0] == QualifiedName("SourceNode", 0))
-            {
-              fields.push_back(event.SourceNode);
-            }
-
-          else if (sattr.BrowsePath[0] == QualifiedName("SourceName", 0))
-            {
-              fields.push_back(event.SourceName);
-            }
-
-          else if (sattr.BrowsePath[0] == QualifiedName("Message", 0))
-            {
-              LOG_DEBUG(Logger, "internal_subscription | message is: {}", event.Message);
-
-              fields.push_back(event.Message);
-            }
+          enqueued |= AppendEvent(monitoredItemId, mii_it->second, event);
+        }
+    }
 
-          else if (sattr.BrowsePath[0] == QualifiedName("Severity", 0))
-            {
-              fields.push_back(event.Severity);
-            }
+  if (enqueued)
+    {
+      WakeUp();
+    }
+}
 
-          else if (sattr.BrowsePath[0] == QualifiedName("LocalTime", 0))
-            {
-              fields.push_back(event.LocalTime);
-            }
+bool InternalSubscription::AppendEvent(uint32_t monitoredItemId, MonitoredDataChange & monitoredItem, const Event & event)
+{
+  if (!monitoredItem.EventFilter.Matches(event))
+    {
+      LOG_DEBUG(Logger, "internal_subscription | id: {}, event filtered out by where clause of MonitoredItemId: {}", Data.SubscriptionId, monitoredItemId);
+      return false;
+    }
 
-          else if (sattr.BrowsePath[0] == QualifiedName("ReceiveTime", 0))
-            {
-              fields.push_back(event.ReceiveTime);
-            }
+  EventFieldList fieldlist;
+  fieldlist.ClientHandle = monitoredItem.ClientHandle;
+  fieldlist.EventFields = monitoredItem.EventFilter.Select(event);
 
-          else if (sattr.BrowsePath[0] == QualifiedName("Time", 0))
-            {
-              fields.push_back(event.Time);
-            }
+  if (monitoredItem.Events.Push(fieldlist))
+    {
+      monitoredItem.EventsOverflow = true;
+    }
 
-          else
-            {
-              fields.push_back(event.GetValue(sattr.BrowsePath));
-            }
-        }
+  if (!monitoredItem.Pending)
+    {
+      monitoredItem.Pending = true;
+      PendingEvents.push_back(monitoredItemId);
     }
 
-  return fields;
+  return true;
 }
 
-
 }
 }
 
@@ -2,10 +2,15 @@
 #pragma once
 
 //#include "address_space_internal.h"
+#include "data_change_filter.h"
+#include "event_filter.h"
+#include "mpsc_queue.h"
+#include "notification_queue.h"
 #include "subscription_service_internal.h"
 
 #include <opc/ua/event.h>
 #include <opc/ua/server/address_space.h>
+#include <opc/ua/server/subscription_service.h>
 #include <opc/ua/protocol/monitored_items.h>
 #include <opc/ua/protocol/strings.h>
 #include <opc/ua/protocol/string_utils.h>
@@ -13,9 +18,11 @@
 
 #include <boost/asio.hpp>
 #include <boost/thread/shared_mutex.hpp>
+#include <atomic>
 #include <chrono>
-#include <iostream>
+#include <deque>
 #include <list>
+#include <mutex>
 #include <vector>
 
 
@@ -26,33 +33,43 @@ namespace Internal
 
 class SubscriptionServiceInternal;
 
-//Structure to store description of a MonitoredItems
-struct MonitoredDataChange
+//Data change waiting in the queue of a monitored item
+struct QueuedDataChange
 {
-  uint32_t MonitoredItemId;
-  MonitoringMode Mode;
-  time_t LastTrigger;
-  uint32_t TriggerCount;
-  MonitoredItemCreateResult Parameters;
-  uint32_t ClientHandle;
-  uint32_t CallbackHandle;
+  SharedDataValue Value;
+  bool Overflow = false; // set overflow bits of status when published
 };
 
-struct TriggeredDataChange
+//Data change handed over by a sampler, not yet in the queue of its monitored item
+struct IncomingDataChange
 {
-  uint32_t MonitoredItemId;
-  MonitoredItems Data;
+  uint32_t MonitoredItemId = 0;
+  SharedDataValue Value;
+  uint64_t Sequence = 0; // order of hand over, values overtaken by a later one are stale
 };
 
-struct TriggeredEvent
+//Structure to store description of a MonitoredItems
+struct MonitoredDataChange
 {
   uint32_t MonitoredItemId;
-  EventFieldList Data;
+  MonitoringMode Mode;
+  time_t LastTrigger;
+  MonitoredItemCreateResult Parameters;
+  uint32_t ClientHandle;
+  bool Sampled = false; // data changes come from the sampler of SamplerKey
+  DataChangeSamplers::Key SamplerKey;
+  CompiledEventFilter EventFilter;
+  // notifications waiting for the next publishing cycle
+  NotificationQueue<QueuedDataChange> DataChanges;
+  NotificationQueue<EventFieldList> Events;
+  bool EventsOverflow = false; // events were discarded since last publishing cycle
+  bool Pending = false; // listed in PendingDataChanges or PendingEvents
+  uint64_t LastIncomingSequence = 0; // of the latest data change taken from the incoming ones
 };
 
 //typedef std::pair<NodeId, AttributeId> MonitoredItemsIndex;
 typedef std::map<uint32_t, MonitoredDataChange> MonitoredDataChangeMap;
-typedef std::map<NodeId, uint32_t> MonitoredEventsMap;
+typedef std::map<uint32_t, NodeId> MonitoredEventsMap; // MonitoredItemId, event notifier node
 
 class AddressSpaceInMemory; //pre-declaration
 
@@ -60,40 +77,71 @@ class AddressSpaceInMemory; //pre-declaration
 class InternalSubscription : public std::enable_shared_from_this<InternalSubscription>
 {
 public:
-  InternalSubscription(SubscriptionServiceInternal & service, const SubscriptionData & data, const NodeId & SessionAuthenticationToken, std::function<void (PublishResult)> Callback, const Common::Logger::SharedPtr & logger);
+  /// @param parameters requested MaxNotificationsPerPublish and Priority are taken from it.
+  /// @param encodedCallback used instead of callback when set: receives the notification message as it was encoded for the retransmission queue.
+  InternalSubscription(SubscriptionServiceInternal & service, const SubscriptionData & data, const CreateSubscriptionParameters & parameters, const NodeId & SessionAuthenticationToken, std::function<void (PublishResult)> Callback, std::function<void (const Server::EncodedPublishResult &)> encodedCallback, const Common::Logger::SharedPtr & logger);
   ~InternalSubscription();
-  void Start();
   void Stop();
 
+  /// @brief Run publishing cycle.
+  /// @param elapsedIntervals publishing intervals since previous cycle, more than one after sleeping.
+  /// @return publishing intervals until next cycle, 0 when subscription has expired.
+  uint32_t Publish(uint32_t elapsedIntervals);
+  /// @brief Answer the publish request reserved for this subscription while it was waiting for one.
+  void PublishLate();
+  uint32_t GetSubscriptionId() const;
+  const NodeId & GetSession() const;
+  double GetPublishingInterval() const;
+
   void NewAcknowlegment(const SubscriptionAcknowledgement & ack);
   std::vector<StatusCode> DeleteMonitoredItemsIds(const std::vector<uint32_t> & ids);
   bool EnqueueEvent(uint32_t monitoreditemid, const Event & event);
-  bool EnqueueDataChange(uint32_t monitoreditemid, const DataValue & value);
+  /// @brief Enqueue every event into every monitored item taking the lock once.
+  void EnqueueEvents(const std::vector<uint32_t> & monitoreditemids, const std::vector<Event> & events);
+  /// @brief Hand over a data change without waiting for the subscription lock.
+  /// It is moved to the queue of its monitored item by the next publishing cycle.
+  void EnqueueDataChange(uint32_t monitoreditemid, const SharedDataValue & value);
   MonitoredItemCreateResult CreateMonitoredItem(const MonitoredItemCreateRequest & request);
-  void DataChangeCallback(const uint32_t &, const DataValue & value);
   bool HasExpired();
-  void TriggerEvent(NodeId node, Event event);
   RepublishResponse Republish(const RepublishParameters & params);
+  Server::EncodedNotificationMessage RepublishEncoded(uint32_t sequenceNumber);
   ModifySubscriptionResult ModifySubscription(const ModifySubscriptionParameters & data);
 
 private:
   void DeleteAllMonitoredItems();
   bool DeleteMonitoredEvent(uint32_t handle);
   bool DeleteMonitoredDataChange(uint32_t handle);
-  std::vector<PublishResult> PopPublishResult();
+  void SendPublishResult();
+  PublishResult PopPublishResult(Server::EncodedNotificationMessage & encoded);
+  void KeepForRetransmission(uint32_t sequenceNumber, const Server::EncodedNotificationMessage & message);
   bool HasPublishResult();
-  NotificationData GetNotificationData();
-  void PublishResults(const boost::system::error_code & error);
-  std::vector<Variant> GetEventFields(const EventFilter & filter, const Event & event);
-  void TriggerDataChangeEvent(MonitoredDataChange monitoreditems, ReadValueId attrval);
+  bool IsReadyToPublish() const;
+  NotificationData GetNotificationData(std::size_t & budget);
+  uint32_t GetSleepIntervals();
+  void WakeUp();
+  bool AppendEvent(uint32_t monitoredItemId, MonitoredDataChange & monitoredItem, const Event & event);
+  StatusCode CreateDataChangeFilter(const MonitoredItemCreateRequest & request, DataChangeFilterEvaluator & filter);
+  bool GetEURange(const NodeId & node, double & low, double & high);
+  double GetMinimumSamplingInterval(const ReadValueId & item);
+  void PushDataChange(MonitoredDataChange & monitoredItem, const SharedDataValue & value);
+  void DrainIncomingDataChanges();
+  void TakeIncomingDataChange(const IncomingDataChange & change);
+  EventNotificationList GetEventNotifications(std::size_t & budget);
+  EventFieldList GetOverflowEventFields(const MonitoredDataChange & monitoredItem);
 
 private:
   SubscriptionServiceInternal & Service;
   Server::AddressSpace & AddressSpace;
+  // Samplers never take it, they hand data changes over to IncomingDataChanges.
+  // Other data change callbacks of a node may use the subscription service, so
+  // do not delete data change callbacks while holding it (see AddressSpaceInMemory).
   mutable boost::shared_mutex DbMutex;
   SubscriptionData Data;
+  uint32_t MaxNotificationsPerPublish; // 0 for no limit
+  uint8_t Priority;
   const NodeId CurrentSession;
   std::function<void (PublishResult)> Callback;
+  std::function<void (const Server::EncodedPublishResult &)> EncodedCallback;
 
   uint32_t NotificationSequence = 1; //NotificationSequence start at 1! not 0
   uint32_t KeepAliveCount = 0;
@@ -101,12 +149,23 @@ private:
   uint32_t LastMonitoredItemId = 100;
   MonitoredDataChangeMap MonitoredDataChanges;
   MonitoredEventsMap MonitoredEvents;
-  std::list<PublishResult> NotAcknowledgedResults; //result that have not be acknowledeged and may have to be resent
-  std::list<TriggeredDataChange> TriggeredDataChangeEvents;
-  std::list<TriggeredEvent> TriggeredEvents;
-  boost::asio::io_service & io;
-  boost::asio::deadline_timer Timer;
-  bool TimerStopped = false;
+  // sent messages that have not be acknowledeged and may have to be resent, oldest first
+  std::deque<std::pair<uint32_t, Server::EncodedNotificationMessage>> NotAcknowledgedMessages;
+  std::size_t NotAcknowledgedBytes = 0;
+  // monitored items with queued notifications in order of their first notification,
+  // the ones which did not fit in the last message stay first
+  std::vector<uint32_t> PendingDataChanges;
+  std::vector<uint32_t> PendingEvents;
+  // idle cycles are skipped until next notification or keep alive,
+  // set under DbMutex and cleared by whoever wakes the subscription up
+  std::atomic<bool> Sleeping{false};
+  // filled by samplers without DbMutex, emptied under it
+  MpscQueue<IncomingDataChange> IncomingDataChanges;
+  std::atomic<uint64_t> IncomingSequence{0};
+  // data changes which did not fit in IncomingDataChanges, samplers never wait for DbMutex
+  std::mutex OverflowMutex;
+  std::vector<IncomingDataChange> OverflowDataChanges;
+  std::atomic<bool> HasOverflowDataChanges{false};
   uint32_t LifeTimeCount;
   Common::Logger::SharedPtr Logger;
 
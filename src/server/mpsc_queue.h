@@ -0,0 +1,136 @@
+/// @brief Bounded lock free queue with many producers and one consumer.
+/// @license GNU LGPL
+///
+/// Distributed under the GNU LGPL License
+/// (See accompanying file LICENSE or copy at
+/// http://www.gnu.org/licenses/lgpl.html)
+///
+
+#pragma once
+
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+namespace OpcUa
+{
+namespace Internal
+{
+
+/// @brief Ring of slots allocated once, each slot carries the sequence number
+/// of the position it is ready for. Producers claim a position with one
+/// compare and swap and never wait for each other or for the consumer.
+/// Pop and Empty must not be called concurrently with each other.
+template <typename T>
+class MpscQueue
+{
+public:
+  /// @param capacity rounded up to a power of two.
+  explicit MpscQueue(std::size_t capacity)
+    : Mask(RoundUp(capacity) - 1)
+    , Slots(Mask + 1)
+  {
+    for (std::size_t i = 0; i < Slots.size(); ++i)
+      {
+        Slots[i].Sequence.store(i, std::memory_order_relaxed);
+      }
+  }
+
+  MpscQueue(const MpscQueue &) = delete;
+  MpscQueue & operator=(const MpscQueue &) = delete;
+
+  /// @return false if the queue is full.
+  bool Push(T value)
+  {
+    std::size_t position = Tail.load(std::memory_order_relaxed);
+    Slot * slot;
+
+    for (;;)
+      {
+        slot = &Slots[position & Mask];
+        const std::size_t sequence = slot->Sequence.load(std::memory_order_acquire);
+        const std::intptr_t difference = static_cast<std::intptr_t>(sequence) - static_cast<std::intptr_t>(position);
+
+        if (difference == 0)
+          {
+            if (Tail.compare_exchange_weak(position, position + 1, std::memory_order_relaxed))
+              {
+                break;
+              }
+          }
+
+        else if (difference < 0)
+          {
+            // the consumer did not take the value of the previous round yet
+            return false;
+          }
+
+        else
+          {
+            position = Tail.load(std::memory_order_relaxed);
+          }
+      }
+
+    slot->Value = std::move(value);
+    slot->Sequence.store(position + 1, std::memory_order_release);
+    return true;
+  }
+
+  /// @return false if the queue is empty or its oldest value is still being written.
+  bool Pop(T & value)
+  {
+    Slot & slot = Slots[Head & Mask];
+
+    if (slot.Sequence.load(std::memory_order_acquire) != Head + 1)
+      {
+        return false;
+      }
+
+    value = std::move(slot.Value);
+    slot.Value = T();
+    slot.Sequence.store(Head + Mask + 1, std::memory_order_release);
+    ++Head;
+    return true;
+  }
+
+  bool Empty() const
+  {
+    return Slots[Head & Mask].Sequence.load(std::memory_order_acquire) != Head + 1;
+  }
+
+  std::size_t Capacity() const
+  {
+    return Slots.size();
+  }
+
+private:
+  static std::size_t RoundUp(std::size_t capacity)
+  {
+    std::size_t size = 2;
+
+    while (size < capacity)
+      {
+        size <<= 1;
+      }
+
+    return size;
+  }
+
+  struct Slot
+  {
+    std::atomic<std::size_t> Sequence;
+    T Value;
+  };
+
+private:
+  const std::size_t Mask;
+  std::vector<Slot> Slots;
+  // producers and consumer update them, keep them on different cache lines
+  std::atomic<std::size_t> Tail{0};
+  char Padding[64];
+  std::size_t Head = 0;
+};
+
+}
+}
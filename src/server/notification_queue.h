@@ -0,0 +1,128 @@
+/// @brief Bounded queue of monitored item notifications.
+/// @license GNU LGPL
+///
+/// Distributed under the GNU LGPL License
+/// (See accompanying file LICENSE or copy at
+/// http://www.gnu.org/licenses/lgpl.html)
+///
+
+#pragma once
+
+#include <algorithm>
+#include <cstddef>
+#include <iterator>
+#include <vector>
+
+namespace OpcUa
+{
+namespace Internal
+{
+
+/// @brief Fixed capacity ring buffer with QueueSize/DiscardOldest semantics of monitored items.
+/// Memory is taken on demand up to the capacity. The queue is emptied by Drain
+/// as a whole, or partly when a notification message has room for less.
+template <typename T>
+class NotificationQueue
+{
+public:
+  explicit NotificationQueue(std::size_t capacity = 1, bool discardOldest = true)
+    : MaxSize(std::max<std::size_t>(capacity, 1))
+    , DiscardOldestValue(discardOldest)
+  {
+  }
+
+  /// @brief Add notification. When the queue is full the oldest
+  /// or the newest notification is replaced depending on DiscardOldest.
+  /// @return true if a notification was discarded.
+  bool Push(const T & value)
+  {
+    if (Buffer.size() < MaxSize)
+      {
+        Buffer.push_back(value);
+        return false;
+      }
+
+    if (DiscardOldestValue)
+      {
+        Buffer[Head] = value;
+        Head = (Head + 1) % MaxSize;
+      }
+
+    else
+      {
+        Buffer[(Head + MaxSize - 1) % MaxSize] = value;
+      }
+
+    return true;
+  }
+
+  T & Front()
+  {
+    return Buffer[Head];
+  }
+
+  T & Back()
+  {
+    return Buffer[(Head + Buffer.size() - 1) % Buffer.size()];
+  }
+
+  /// @brief Move notifications to the end of out in order of arrival.
+  void Drain(std::vector<T> & out)
+  {
+    for (std::size_t i = 0; i < Buffer.size(); ++i)
+      {
+        out.push_back(std::move(Buffer[(Head + i) % Buffer.size()]));
+      }
+
+    Buffer.clear();
+    Head = 0;
+  }
+
+  /// @brief Move at most max oldest notifications to the end of out.
+  /// @return number of notifications moved.
+  std::size_t Drain(std::vector<T> & out, std::size_t max)
+  {
+    if (max >= Buffer.size())
+      {
+        const std::size_t count = Buffer.size();
+        Drain(out);
+        return count;
+      }
+
+    std::rotate(Buffer.begin(), Buffer.begin() + Head, Buffer.end());
+    Head = 0;
+    std::move(Buffer.begin(), Buffer.begin() + max, std::back_inserter(out));
+    Buffer.erase(Buffer.begin(), Buffer.begin() + max);
+    return max;
+  }
+
+  bool Empty() const
+  {
+    return Buffer.empty();
+  }
+
+  std::size_t Size() const
+  {
+    return Buffer.size();
+  }
+
+  std::size_t Capacity() const
+  {
+    return MaxSize;
+  }
+
+  bool DiscardOldest() const
+  {
+    return DiscardOldestValue;
+  }
+
+private:
+  std::size_t MaxSize;
+  bool DiscardOldestValue;
+  // Head is not zero only when the queue is full.
+  std::size_t Head = 0;
+  std::vector<T> Buffer;
+};
+
+}
+}
@@ -26,7 +26,6 @@
 #include <opc/ua/protocol/binary/stream.h>
 #include <opc/ua/protocol/channel.h>
 #include <opc/ua/protocol/secure_channel.h>
-#include <opc/ua/protocol/input_from_buffer.h>
 
 #include <array>
 #include <boost/asio.hpp>
@@ -202,8 +201,7 @@ void OpcTcpConnection::ProcessHeader(const boost::system::error_code & error, st
 
   LOG_DEBUG(Logger, "opc_tcp_async         | received message header with size: {}", bytes_transferred);
 
-  OpcUa::InputFromBuffer messageChannel(&Buffer[0], bytes_transferred);
-  IStreamBinary messageStream(messageChannel);
+  IStreamBinary messageStream(&Buffer[0], bytes_transferred);
   OpcUa::Binary::Header header;
   messageStream >> header;
 
@@ -235,8 +233,7 @@ void OpcTcpConnection::ProcessMessage(OpcUa::Binary::MessageType type, const boo
   LOG_TRACE(Logger, "opc_tcp_async         | received message: {}", ToHexDump(Buffer, bytesTransferred));
 
   // restrict server size code only with current message.
-  OpcUa::InputFromBuffer messageChannel(&Buffer[0], bytesTransferred);
-  IStreamBinary messageStream(messageChannel);
+  IStreamBinary messageStream(&Buffer[0], bytesTransferred);
 
   bool cont = true;
 
@@ -252,7 +249,7 @@ void OpcTcpConnection::ProcessMessage(OpcUa::Binary::MessageType type, const boo
       return;
     }
 
-  if (messageChannel.GetRemainSize())
+  if (messageStream.GetRemainSize())
     {
       std::cerr << "opc_tcp_async         | ERROR!!! Message from client has been processed partially." << std::endl;
     }
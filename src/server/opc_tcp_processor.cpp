@@ -68,6 +68,7 @@ OpcTcpMessages::~OpcTcpMessages()
   try
     {
       DeleteAllSubscriptions();
+      ReleaseContinuationPoints();
     }
 
   catch (const std::exception & exc)
@@ -140,6 +141,27 @@ bool OpcTcpMessages::ProcessMessage(MessageType msgType, IStreamBinary & iStream
   return true;
 }
 
+bool OpcTcpMessages::PopPublishRequest(PublishRequestElement & requestData)
+{
+  // called under ProcessMutex
+  // test if OutputChannel is still active, the stream holds a reference to it
+  if (OutputChannel.expired())
+    {
+      LOG_WARN(Logger, "opc_tcp_processor     | parent instance already deleted");
+      return false;
+    }
+
+  if (PublishRequestQueue.empty())
+    {
+      LOG_WARN(Logger, "error trying to send publish response while we do not have data from a PublishRequest");
+      return false;
+    }
+
+  requestData = PublishRequestQueue.front();
+  PublishRequestQueue.pop();
+  return true;
+}
+
 void OpcTcpMessages::ForwardPublishResponse(const PublishResult result)
 {
   std::lock_guard<std::mutex> lock(ProcessMutex);
@@ -149,36 +171,75 @@ void OpcTcpMessages::ForwardPublishResponse(const PublishResult result)
   // get a shared_ptr from weak_ptr to make sure OutputChannel
   // does not get deleted before end of operation
   OpcUa::OutputChannel::SharedPtr outputChannel = OutputChannel.lock();
-  // test if OutputChannel was still active when calling lock
-  if (!outputChannel) {
-    LOG_WARN(Logger, "opc_tcp_processor     | parent instance already deleted");
-    return;
-  }
+  PublishRequestElement requestData;
 
-  if (PublishRequestQueue.empty())
+  if (!outputChannel || !PopPublishRequest(requestData))
     {
-      LOG_WARN(Logger, "error trying to send publish response while we do not have data from a PublishRequest");
       return;
     }
 
-  PublishRequestElement requestData = PublishRequestQueue.front();
-  PublishRequestQueue.pop();
-
   PublishResponse response;
 
   FillResponseHeader(requestData.requestHeader, response.Header);
   response.Parameters = result;
 
-  requestData.sequence.SequenceNumber = ++SequenceNb;
-
   SecureHeader secureHeader(MT_SECURE_MESSAGE, CHT_SINGLE, ChannelId);
-  secureHeader.AddSize(RawSize(requestData.algorithmHeader));
-  secureHeader.AddSize(RawSize(requestData.sequence));
-  secureHeader.AddSize(RawSize(response));
 
   LOG_DEBUG(Logger, "opc_tcp_processor     | sending PublishResponse with: {} PublishResults", response.Parameters.NotificationMessage.NotificationData.size());
 
-  OutputStream << secureHeader << requestData.algorithmHeader << requestData.sequence << response << flush;
+  OutputStream << begin_message << secureHeader << requestData.algorithmHeader << NextSequence(requestData.sequence) << response << flush;
+}
+
+void OpcTcpMessages::ForwardEncodedPublishResponse(const EncodedPublishResult & result)
+{
+  std::lock_guard<std::mutex> lock(ProcessMutex);
+
+  LOG_DEBUG(Logger, "opc_tcp_processor     | sending encoded PublishResult to client");
+
+  OpcUa::OutputChannel::SharedPtr outputChannel = OutputChannel.lock();
+  PublishRequestElement requestData;
+
+  if (!outputChannel || !PopPublishRequest(requestData))
+    {
+      return;
+    }
+
+  PublishResponse response;
+
+  FillResponseHeader(requestData.requestHeader, response.Header);
+
+  SecureHeader secureHeader(MT_SECURE_MESSAGE, CHT_SINGLE, ChannelId);
+
+  // fields of PublishResponse, the notification message is copied as it was encoded
+  OutputStream << begin_message << secureHeader << requestData.algorithmHeader << NextSequence(requestData.sequence)
+               << response.TypeId << response.Header
+               << result.SubscriptionId << result.AvailableSequenceNumbers << result.MoreNotifications
+               << RawMessage(result.NotificationMessage->data(), result.NotificationMessage->size())
+               << result.Results
+               << ~uint32_t() // no DiagnosticInfos
+               << flush;
+}
+
+void OpcTcpMessages::ForwardReadResponse(const RequestHeader & requestHeader, const SymmetricAlgorithmHeader & algorithmHeader, SequenceHeader sequence, std::vector<DataValue> values)
+{
+  std::lock_guard<std::mutex> lock(ProcessMutex);
+
+  LOG_DEBUG(Logger, "opc_tcp_processor     | sending ReadResponse with: {} values read by data sources", values.size());
+
+  OpcUa::OutputChannel::SharedPtr outputChannel = OutputChannel.lock();
+
+  if (!outputChannel)
+    {
+      LOG_WARN(Logger, "opc_tcp_processor     | parent instance already deleted");
+      return;
+    }
+
+  ReadResponse response;
+  FillResponseHeader(requestHeader, response.Header);
+  response.Results = std::move(values);
+
+  SecureHeader secureHeader(MT_SECURE_MESSAGE, CHT_SINGLE, ChannelId);
+  OutputStream << begin_message << secureHeader << algorithmHeader << NextSequence(sequence) << response << flush;
 }
 
 void OpcTcpMessages::HelloClient(IStreamBinary & istream, OStreamBinary & ostream)
@@ -197,11 +258,10 @@ void OpcTcpMessages::HelloClient(IStreamBinary & istream, OStreamBinary & ostrea
   ack.MaxChunkCount = 1;
 
   Header ackHeader(MT_ACKNOWLEDGE, CHT_SINGLE);
-  ackHeader.AddSize(RawSize(ack));
 
   LOG_DEBUG(Logger, "opc_tcp_processor     | sending answer");
 
-  ostream << ackHeader << ack << flush;
+  ostream << begin_message << ackHeader << ack << flush;
 }
 
 void OpcTcpMessages::OpenChannel(IStreamBinary & istream, OStreamBinary & ostream)
@@ -233,8 +293,6 @@ void OpcTcpMessages::OpenChannel(IStreamBinary & istream, OStreamBinary & ostrea
       ++TokenId;
     }
 
-  sequence.SequenceNumber = ++SequenceNb;
-
   OpenSecureChannelResponse response;
   FillResponseHeader(request.Header, response.Header);
   response.ChannelSecurityToken.SecureChannelId = ChannelId;
@@ -243,10 +301,7 @@ void OpcTcpMessages::OpenChannel(IStreamBinary & istream, OStreamBinary & ostrea
   response.ChannelSecurityToken.RevisedLifetime = request.Parameters.RequestLifeTime;
 
   SecureHeader responseHeader(MT_SECURE_OPEN, CHT_SINGLE, ChannelId);
-  responseHeader.AddSize(RawSize(algorithmHeader));
-  responseHeader.AddSize(RawSize(sequence));
-  responseHeader.AddSize(RawSize(response));
-  ostream << responseHeader << algorithmHeader << sequence << response << flush;
+  ostream << begin_message << responseHeader << algorithmHeader << NextSequence(sequence) << response << flush;
 }
 
 void OpcTcpMessages::CloseChannel(IStreamBinary & istream)
@@ -281,7 +336,6 @@ void OpcTcpMessages::ProcessRequest(IStreamBinary & istream, OStreamBinary & ost
   RequestHeader requestHeader;
   istream >> requestHeader;
 
-  sequence.SequenceNumber = ++SequenceNb;
   /*
         const std::size_t receivedSize =
           RawSize(channelId) +
@@ -306,10 +360,7 @@ void OpcTcpMessages::ProcessRequest(IStreamBinary & istream, OStreamBinary & ost
       response.Endpoints = Server->Endpoints()->GetEndpoints(filter);
 
       SecureHeader secureHeader(MT_SECURE_MESSAGE, CHT_SINGLE, ChannelId);
-      secureHeader.AddSize(RawSize(algorithmHeader));
-      secureHeader.AddSize(RawSize(sequence));
-      secureHeader.AddSize(RawSize(response));
-      ostream << secureHeader << algorithmHeader << sequence << response << flush;
+      ostream << begin_message << secureHeader << algorithmHeader << NextSequence(sequence) << response << flush;
       return;
     }
 
@@ -325,10 +376,7 @@ void OpcTcpMessages::ProcessRequest(IStreamBinary & istream, OStreamBinary & ost
       response.Data.Descriptions = Server->Endpoints()->FindServers(params);
 
       SecureHeader secureHeader(MT_SECURE_MESSAGE, CHT_SINGLE, ChannelId);
-      secureHeader.AddSize(RawSize(algorithmHeader));
-      secureHeader.AddSize(RawSize(sequence));
-      secureHeader.AddSize(RawSize(response));
-      ostream << secureHeader << algorithmHeader << sequence << response << flush;
+      ostream << begin_message << secureHeader << algorithmHeader << NextSequence(sequence) << response << flush;
       return;
     }
 
@@ -340,15 +388,32 @@ void OpcTcpMessages::ProcessRequest(IStreamBinary & istream, OStreamBinary & ost
       istream >> query;
 
       BrowseResponse response;
-      response.Results =  Server->Views()->Browse(query);
+      AddressSpace::SharedPtr addressSpace = std::dynamic_pointer_cast<AddressSpace>(Server->Views());
+      // continuation points are owned by the session
+      response.Results = addressSpace ? addressSpace->Browse(SessionId, query) : Server->Views()->Browse(query);
+
+      FillResponseHeader(requestHeader, response.Header);
+
+      SecureHeader secureHeader(MT_SECURE_MESSAGE, CHT_SINGLE, ChannelId);
+      ostream << begin_message << secureHeader << algorithmHeader << NextSequence(sequence) << response << flush;
+      return;
+    }
+
+    case OpcUa::BROWSE_NEXT_REQUEST:
+    {
+      LOG_DEBUG(Logger, "opc_tcp_processor     | processing 'Browse Next' request");
+
+      BrowseNextParameters params;
+      istream >> params;
+
+      BrowseNextResponse response;
+      AddressSpace::SharedPtr addressSpace = std::dynamic_pointer_cast<AddressSpace>(Server->Views());
+      response.Results = addressSpace ? addressSpace->BrowseNext(SessionId, params) : Server->Views()->BrowseNext(params);
 
       FillResponseHeader(requestHeader, response.Header);
 
       SecureHeader secureHeader(MT_SECURE_MESSAGE, CHT_SINGLE, ChannelId);
-      secureHeader.AddSize(RawSize(algorithmHeader));
-      secureHeader.AddSize(RawSize(sequence));
-      secureHeader.AddSize(RawSize(response));
-      ostream << secureHeader << algorithmHeader << sequence << response << flush;
+      ostream << begin_message << secureHeader << algorithmHeader << NextSequence(sequence) << response << flush;
       return;
     }
 
@@ -376,7 +441,59 @@ void OpcTcpMessages::ProcessRequest(IStreamBinary & istream, OStreamBinary & ost
       FillResponseHeader(requestHeader, response.Header);
       std::vector<DataValue> values;
 
-      if (std::shared_ptr<OpcUa::AttributeServices> service = Server->Attributes())
+      std::shared_ptr<OpcUa::AttributeServices> service = Server->Attributes();
+      AddressSpace::SharedPtr addressSpace = std::dynamic_pointer_cast<AddressSpace>(service);
+
+      if (addressSpace)
+        {
+          // values of data sources may be read later by their own threads
+          struct PendingRead
+          {
+            std::mutex Mutex;
+            bool Returned = false;
+            bool Done = false;
+            std::vector<DataValue> Values;
+          };
+
+          std::shared_ptr<PendingRead> pending = std::make_shared<PendingRead>();
+          SharedPtr self = shared_from_this();
+          addressSpace->ReadAsync(params, [self, pending, requestHeader, algorithmHeader, sequence](std::vector<DataValue> values)
+          {
+            {
+              std::lock_guard<std::mutex> lock(pending->Mutex);
+
+              if (!pending->Returned)
+                {
+                  pending->Values = std::move(values);
+                  pending->Done = true;
+                  return;
+                }
+            }
+
+            try
+              {
+                self->ForwardReadResponse(requestHeader, algorithmHeader, sequence, std::move(values));
+              }
+
+            catch (std::exception & ex)
+              {
+                LOG_WARN(self->Logger, "error forwarding ReadResponse to client: {}", ex.what());
+              }
+          });
+
+          std::lock_guard<std::mutex> lock(pending->Mutex);
+          pending->Returned = true;
+
+          // response is sent when the read completes
+          if (!pending->Done)
+            {
+              return;
+            }
+
+          values = std::move(pending->Values);
+        }
+
+      else if (service)
         {
           values = service->Read(params);
         }
@@ -395,10 +512,7 @@ void OpcTcpMessages::ProcessRequest(IStreamBinary & istream, OStreamBinary & ost
       response.Results = values;
 
       SecureHeader secureHeader(MT_SECURE_MESSAGE, CHT_SINGLE, ChannelId);
-      secureHeader.AddSize(RawSize(algorithmHeader));
-      secureHeader.AddSize(RawSize(sequence));
-      secureHeader.AddSize(RawSize(response));
-      ostream << secureHeader << algorithmHeader << sequence << response << flush;
+      ostream << begin_message << secureHeader << algorithmHeader << NextSequence(sequence) << response << flush;
 
       return;
     }
@@ -425,10 +539,7 @@ void OpcTcpMessages::ProcessRequest(IStreamBinary & istream, OStreamBinary & ost
         }
 
       SecureHeader secureHeader(MT_SECURE_MESSAGE, CHT_SINGLE, ChannelId);
-      secureHeader.AddSize(RawSize(algorithmHeader));
-      secureHeader.AddSize(RawSize(sequence));
-      secureHeader.AddSize(RawSize(response));
-      ostream << secureHeader << algorithmHeader << sequence << response << flush;
+      ostream << begin_message << secureHeader << algorithmHeader << NextSequence(sequence) << response << flush;
 
       return;
     }
@@ -474,13 +585,10 @@ void OpcTcpMessages::ProcessRequest(IStreamBinary & istream, OStreamBinary & ost
       FillResponseHeader(requestHeader, response.Header);
       response.Result.Paths = result;
       SecureHeader secureHeader(MT_SECURE_MESSAGE, CHT_SINGLE, ChannelId);
-      secureHeader.AddSize(RawSize(algorithmHeader));
-      secureHeader.AddSize(RawSize(sequence));
-      secureHeader.AddSize(RawSize(response));
 
       LOG_DEBUG(Logger, "opc_tcp_processor     | sending response to 'Translate Browse Paths To Node Ids' request");
 
-      ostream << secureHeader << algorithmHeader << sequence << response << flush;
+      ostream << begin_message << secureHeader << algorithmHeader << NextSequence(sequence) << response << flush;
       return;
     }
 
@@ -504,10 +612,7 @@ void OpcTcpMessages::ProcessRequest(IStreamBinary & istream, OStreamBinary & ost
 
 
       SecureHeader secureHeader(MT_SECURE_MESSAGE, CHT_SINGLE, ChannelId);
-      secureHeader.AddSize(RawSize(algorithmHeader));
-      secureHeader.AddSize(RawSize(sequence));
-      secureHeader.AddSize(RawSize(response));
-      ostream << secureHeader << algorithmHeader << sequence << response << flush;
+      ostream << begin_message << secureHeader << algorithmHeader << NextSequence(sequence) << response << flush;
 
       return;
     }
@@ -523,10 +628,7 @@ void OpcTcpMessages::ProcessRequest(IStreamBinary & istream, OStreamBinary & ost
       FillResponseHeader(requestHeader, response.Header);
 
       SecureHeader secureHeader(MT_SECURE_MESSAGE, CHT_SINGLE, ChannelId);
-      secureHeader.AddSize(RawSize(algorithmHeader));
-      secureHeader.AddSize(RawSize(sequence));
-      secureHeader.AddSize(RawSize(response));
-      ostream << secureHeader << algorithmHeader << sequence << response << flush;
+      ostream << begin_message << secureHeader << algorithmHeader << NextSequence(sequence) << response << flush;
       return;
     }
 
@@ -542,14 +644,13 @@ void OpcTcpMessages::ProcessRequest(IStreamBinary & istream, OStreamBinary & ost
           DeleteAllSubscriptions();
         }
 
+      ReleaseContinuationPoints();
+
       CloseSessionResponse response;
       FillResponseHeader(requestHeader, response.Header);
 
       SecureHeader secureHeader(MT_SECURE_MESSAGE, CHT_SINGLE, ChannelId);
-      secureHeader.AddSize(RawSize(algorithmHeader));
-      secureHeader.AddSize(RawSize(sequence));
-      secureHeader.AddSize(RawSize(response));
-      ostream << secureHeader << algorithmHeader << sequence << response << flush;
+      ostream << begin_message << secureHeader << algorithmHeader << NextSequence(sequence) << response << flush;
 
       LOG_DEBUG(Logger, "opc_tcp_processor     | session closed");
 
@@ -568,27 +669,47 @@ void OpcTcpMessages::ProcessRequest(IStreamBinary & istream, OStreamBinary & ost
       FillResponseHeader(requestHeader, response.Header);
 
       SharedPtr self = shared_from_this();
-      response.Data = Server->Subscriptions()->CreateSubscription(request, [self](PublishResult i)
-      {
-        try
+      SubscriptionService::SharedPtr encodedSubscriptions = std::dynamic_pointer_cast<SubscriptionService>(Server->Subscriptions());
+
+      if (encodedSubscriptions)
+        {
+          // notification messages are sent as they were encoded for republish
+          response.Data = encodedSubscriptions->CreateEncodedSubscription(request, [self](const EncodedPublishResult & result)
           {
-            self->ForwardPublishResponse(i);
-          }
+            try
+              {
+                self->ForwardEncodedPublishResponse(result);
+              }
+
+            catch (std::exception & ex)
+              {
+                // TODO Disconnect client!
+                LOG_WARN(self->Logger, "error forwarding PublishResult to client: {}", ex.what());
+              }
+          });
+        }
 
-        catch (std::exception & ex)
+      else
+        {
+          response.Data = Server->Subscriptions()->CreateSubscription(request, [self](PublishResult i)
           {
-            // TODO Disconnect client!
-            LOG_WARN(self->Logger, "error forwarding PublishResult to client: {}", ex.what());
-          }
-      });
+            try
+              {
+                self->ForwardPublishResponse(i);
+              }
+
+            catch (std::exception & ex)
+              {
+                // TODO Disconnect client!
+                LOG_WARN(self->Logger, "error forwarding PublishResult to client: {}", ex.what());
+              }
+          });
+        }
 
       Subscriptions.push_back(response.Data.SubscriptionId); //Keep a link to eventually delete subcriptions when exiting
 
       SecureHeader secureHeader(MT_SECURE_MESSAGE, CHT_SINGLE, ChannelId);
-      secureHeader.AddSize(RawSize(algorithmHeader));
-      secureHeader.AddSize(RawSize(sequence));
-      secureHeader.AddSize(RawSize(response));
-      ostream << secureHeader << algorithmHeader << sequence << response << flush;
+      ostream << begin_message << secureHeader << algorithmHeader << NextSequence(sequence) << response << flush;
       return;
     }
 
@@ -604,13 +725,10 @@ void OpcTcpMessages::ProcessRequest(IStreamBinary & istream, OStreamBinary & ost
       FillResponseHeader(requestHeader, response.Header);
 
       SecureHeader secureHeader(MT_SECURE_MESSAGE, CHT_SINGLE, ChannelId);
-      secureHeader.AddSize(RawSize(algorithmHeader));
-      secureHeader.AddSize(RawSize(sequence));
-      secureHeader.AddSize(RawSize(response));
 
       LOG_DEBUG(Logger, "opc_tcp_processor     | sending response to 'Modify Subscription' request");
 
-      ostream << secureHeader << algorithmHeader << sequence << response << flush;
+      ostream << begin_message << secureHeader << algorithmHeader << NextSequence(sequence) << response << flush;
       return;
     }
 
@@ -629,13 +747,10 @@ void OpcTcpMessages::ProcessRequest(IStreamBinary & istream, OStreamBinary & ost
       response.Results = Server->Subscriptions()->DeleteSubscriptions(ids);
 
       SecureHeader secureHeader(MT_SECURE_MESSAGE, CHT_SINGLE, ChannelId);
-      secureHeader.AddSize(RawSize(algorithmHeader));
-      secureHeader.AddSize(RawSize(sequence));
-      secureHeader.AddSize(RawSize(response));
 
       LOG_DEBUG(Logger, "opc_tcp_processor     | sending response to 'Delete Subscription' request");
 
-      ostream << secureHeader << algorithmHeader << sequence << response << flush;
+      ostream << begin_message << secureHeader << algorithmHeader << NextSequence(sequence) << response << flush;
       return;
     }
 
@@ -652,13 +767,10 @@ void OpcTcpMessages::ProcessRequest(IStreamBinary & istream, OStreamBinary & ost
 
       FillResponseHeader(requestHeader, response.Header);
       SecureHeader secureHeader(MT_SECURE_MESSAGE, CHT_SINGLE, ChannelId);
-      secureHeader.AddSize(RawSize(algorithmHeader));
-      secureHeader.AddSize(RawSize(sequence));
-      secureHeader.AddSize(RawSize(response));
 
       LOG_DEBUG(Logger, "opc_tcp_processor     | sending response to 'Create Monitored Items' request");
 
-      ostream << secureHeader << algorithmHeader << sequence << response << flush;
+      ostream << begin_message << secureHeader << algorithmHeader << NextSequence(sequence) << response << flush;
       return;
     }
 
@@ -675,13 +787,10 @@ void OpcTcpMessages::ProcessRequest(IStreamBinary & istream, OStreamBinary & ost
 
       FillResponseHeader(requestHeader, response.Header);
       SecureHeader secureHeader(MT_SECURE_MESSAGE, CHT_SINGLE, ChannelId);
-      secureHeader.AddSize(RawSize(algorithmHeader));
-      secureHeader.AddSize(RawSize(sequence));
-      secureHeader.AddSize(RawSize(response));
 
       LOG_DEBUG(Logger, "opc_tcp_processor     | sending response to 'Delete Monitored Items' request");
 
-      ostream << secureHeader << algorithmHeader << sequence << response << flush;
+      ostream << begin_message << secureHeader << algorithmHeader << NextSequence(sequence) << response << flush;
       return;
     }
 
@@ -700,8 +809,6 @@ void OpcTcpMessages::ProcessRequest(IStreamBinary & istream, OStreamBinary & ost
       PublishRequestQueue.push(data);
       Server->Subscriptions()->Publish(request);
 
-      --SequenceNb; //We do not send response, so do not increase sequence
-
       return;
     }
 
@@ -718,13 +825,10 @@ void OpcTcpMessages::ProcessRequest(IStreamBinary & istream, OStreamBinary & ost
       response.Result.Results.resize(params.SubscriptionIds.size(), StatusCode::Good);
 
       SecureHeader secureHeader(MT_SECURE_MESSAGE, CHT_SINGLE, ChannelId);
-      secureHeader.AddSize(RawSize(algorithmHeader));
-      secureHeader.AddSize(RawSize(sequence));
-      secureHeader.AddSize(RawSize(response));
 
       LOG_DEBUG(Logger, "opc_tcp_processor     | sending response to 'Set Publishing Mode' request");
 
-      ostream << secureHeader << algorithmHeader << sequence << response << flush;
+      ostream << begin_message << secureHeader << algorithmHeader << NextSequence(sequence) << response << flush;
       return;
     }
 
@@ -742,13 +846,10 @@ void OpcTcpMessages::ProcessRequest(IStreamBinary & istream, OStreamBinary & ost
       response.results = results;
 
       SecureHeader secureHeader(MT_SECURE_MESSAGE, CHT_SINGLE, ChannelId);
-      secureHeader.AddSize(RawSize(algorithmHeader));
-      secureHeader.AddSize(RawSize(sequence));
-      secureHeader.AddSize(RawSize(response));
 
       LOG_DEBUG(Logger, "opc_tcp_processor     | sending response to 'Add Nodes' request");
 
-      ostream << secureHeader << algorithmHeader << sequence << response << flush;
+      ostream << begin_message << secureHeader << algorithmHeader << NextSequence(sequence) << response << flush;
       return;
     }
 
@@ -766,13 +867,10 @@ void OpcTcpMessages::ProcessRequest(IStreamBinary & istream, OStreamBinary & ost
       response.Results = results;
 
       SecureHeader secureHeader(MT_SECURE_MESSAGE, CHT_SINGLE, ChannelId);
-      secureHeader.AddSize(RawSize(algorithmHeader));
-      secureHeader.AddSize(RawSize(sequence));
-      secureHeader.AddSize(RawSize(response));
 
       LOG_DEBUG(Logger, "opc_tcp_processor     | sending response to 'Add References' request");
 
-      ostream << secureHeader << algorithmHeader << sequence << response << flush;
+      ostream << begin_message << secureHeader << algorithmHeader << NextSequence(sequence) << response << flush;
       return;
     }
 
@@ -783,19 +881,27 @@ void OpcTcpMessages::ProcessRequest(IStreamBinary & istream, OStreamBinary & ost
       RepublishParameters params;
       istream >> params;
 
-      //Not implemented so we just say we do not have that notification
       RepublishResponse response;
       FillResponseHeader(requestHeader, response.Header);
-      response.Header.ServiceResult = StatusCode::BadMessageNotAvailable;
+
+      // subscriptions belong to the session they were created with
+      SubscriptionService::SharedPtr subscriptions = std::dynamic_pointer_cast<SubscriptionService>(Server->Subscriptions());
+      EncodedNotificationMessage message;
+      const StatusCode status = subscriptions ? subscriptions->RepublishEncoded(requestHeader.SessionAuthenticationToken, params, message) : StatusCode::BadNotImplemented;
 
       SecureHeader secureHeader(MT_SECURE_MESSAGE, CHT_SINGLE, ChannelId);
-      secureHeader.AddSize(RawSize(algorithmHeader));
-      secureHeader.AddSize(RawSize(sequence));
-      secureHeader.AddSize(RawSize(response));
 
       LOG_DEBUG(Logger, "opc_tcp_processor     | sending response to 'Republish' request");
 
-      ostream << secureHeader << algorithmHeader << sequence << response << flush;
+      if (status != StatusCode::Good)
+        {
+          response.Header.ServiceResult = status;
+          ostream << begin_message << secureHeader << algorithmHeader << NextSequence(sequence) << response << flush;
+          return;
+        }
+
+      // the notification message is resent as it was encoded for publish
+      ostream << begin_message << secureHeader << algorithmHeader << NextSequence(sequence) << response.TypeId << response.Header << RawMessage(message->data(), message->size()) << flush;
       return;
     }
 
@@ -825,10 +931,7 @@ void OpcTcpMessages::ProcessRequest(IStreamBinary & istream, OStreamBinary & ost
         }
 
       SecureHeader secureHeader(MT_SECURE_MESSAGE, CHT_SINGLE, ChannelId);
-      secureHeader.AddSize(RawSize(algorithmHeader));
-      secureHeader.AddSize(RawSize(sequence));
-      secureHeader.AddSize(RawSize(response));
-      ostream << secureHeader << algorithmHeader << sequence << response << flush;
+      ostream << begin_message << secureHeader << algorithmHeader << NextSequence(sequence) << response << flush;
 
       return;
     }
@@ -847,13 +950,10 @@ void OpcTcpMessages::ProcessRequest(IStreamBinary & istream, OStreamBinary & ost
       FillResponseHeader(requestHeader, response.Header);
 
       SecureHeader secureHeader(MT_SECURE_MESSAGE, CHT_SINGLE, ChannelId);
-      secureHeader.AddSize(RawSize(algorithmHeader));
-      secureHeader.AddSize(RawSize(sequence));
-      secureHeader.AddSize(RawSize(response));
 
       LOG_DEBUG(Logger, "opc_tcp_processor     | sending response to 'Register Nodes' request");
 
-      ostream << secureHeader << algorithmHeader << sequence << response << flush;
+      ostream << begin_message << secureHeader << algorithmHeader << NextSequence(sequence) << response << flush;
       return;
     }
 
@@ -871,13 +971,10 @@ void OpcTcpMessages::ProcessRequest(IStreamBinary & istream, OStreamBinary & ost
       FillResponseHeader(requestHeader, response.Header);
 
       SecureHeader secureHeader(MT_SECURE_MESSAGE, CHT_SINGLE, ChannelId);
-      secureHeader.AddSize(RawSize(algorithmHeader));
-      secureHeader.AddSize(RawSize(sequence));
-      secureHeader.AddSize(RawSize(response));
 
       LOG_DEBUG(Logger, "opc_tcp_processor     | sending response to 'Unregister Nodes' request");
 
-      ostream << secureHeader << algorithmHeader << sequence << response << flush;
+      ostream << begin_message << secureHeader << algorithmHeader << NextSequence(sequence) << response << flush;
       return;
     }
 
@@ -888,18 +985,32 @@ void OpcTcpMessages::ProcessRequest(IStreamBinary & istream, OStreamBinary & ost
       response.Header.ServiceResult = StatusCode::BadNotImplemented;
 
       SecureHeader secureHeader(MT_SECURE_MESSAGE, CHT_SINGLE, ChannelId);
-      secureHeader.AddSize(RawSize(algorithmHeader));
-      secureHeader.AddSize(RawSize(sequence));
-      secureHeader.AddSize(RawSize(response));
 
       LOG_WARN(Logger, "opc_tcp_processor     | sending 'ServiceFaultResponse' to unsupported request of id: {}", message);
 
-      ostream << secureHeader << algorithmHeader << sequence << response << flush;
+      ostream << begin_message << secureHeader << algorithmHeader << NextSequence(sequence) << response << flush;
       return;
     }
     }
 }
 
+SequenceHeader OpcTcpMessages::NextSequence(SequenceHeader sequence)
+{
+  sequence.SequenceNumber = ++SequenceNb;
+  return sequence;
+}
+
+void OpcTcpMessages::ReleaseContinuationPoints()
+{
+  // only the address space keeps continuation points of sessions
+  AddressSpace::SharedPtr addressSpace = std::dynamic_pointer_cast<AddressSpace>(Server->Views());
+
+  if (addressSpace)
+    {
+      addressSpace->ReleaseContinuationPoints(SessionId);
+    }
+}
+
 void OpcTcpMessages::FillResponseHeader(const RequestHeader & requestHeader, ResponseHeader & responseHeader)
 {
   //responseHeader.InnerDiagnostics.push_back(DiagnosticInfo());
@@ -11,6 +11,7 @@
 #include <opc/common/logger.h>
 #include <opc/ua/protocol/binary/common.h>
 #include <opc/ua/protocol/binary/stream.h>
+#include <opc/ua/server/subscription_service.h>
 #include <opc/ua/services/services.h>
 
 #include <chrono>
@@ -43,6 +44,11 @@ private:
   void DeleteSubscriptions(const std::vector<uint32_t> & ids);
   void DeleteAllSubscriptions();
   void ForwardPublishResponse(const PublishResult response);
+  void ForwardEncodedPublishResponse(const EncodedPublishResult & result);
+  void ForwardReadResponse(const RequestHeader & requestHeader, const Binary::SymmetricAlgorithmHeader & algorithmHeader, Binary::SequenceHeader sequence, std::vector<DataValue> values);
+  void ReleaseContinuationPoints();
+  // request sequence header with the number of the response, taken when the response is written
+  Binary::SequenceHeader NextSequence(Binary::SequenceHeader sequence);
 
 private:
   std::mutex ProcessMutex;
@@ -66,6 +72,8 @@ private:
   std::list<uint32_t> Subscriptions; //Keep a list of subscriptions to query internal server at correct rate
   std::mutex PublishRequestQueueMutex;
   std::queue<PublishRequestElement> PublishRequestQueue; //Keep track of request data to answer them when we have data and
+
+  bool PopPublishRequest(PublishRequestElement & requestData);
 };
 
 
@@ -19,7 +19,6 @@
 #include <opc/common/uri_facade.h>
 #include <opc/common/addons_core/addon_manager.h>
 #include <opc/ua/protocol/endpoints.h>
-#include <opc/ua/protocol/input_from_buffer.h>
 #include <opc/ua/protocol/utils.h>
 #include <opc/ua/server/addons/opcua_protocol.h>
 #include <opc/ua/server/addons/endpoints_services.h>
@@ -93,11 +92,10 @@ private:
     LOG_DEBUG(Logger, "opc_tcp_processor| received message:\n{}", ToHexDump(buffer));
 
     // restrict server size code only with current message.
-    OpcUa::InputFromBuffer messageChannel(&buffer[0], buffer.size());
-    IStreamBinary messageStream(messageChannel);
+    IStreamBinary messageStream(&buffer[0], buffer.size());
     messageProcessor.ProcessMessage(hdr.Type, messageStream);
 
-    if (messageChannel.GetRemainSize())
+    if (messageStream.GetRemainSize())
       {
         LOG_ERROR(Logger, "opc_tcp_processor| message has not been processed completely");
       }
@@ -0,0 +1,255 @@
+/// @brief Periodic sampling of values which do not report their changes.
+/// @license GNU LGPL
+///
+/// Distributed under the GNU LGPL License
+/// (See accompanying file LICENSE or copy at
+/// http://www.gnu.org/licenses/lgpl.html)
+///
+
+#include "sampling_scheduler.h"
+
+#include <algorithm>
+#include <cmath>
+#include <stdexcept>
+
+namespace OpcUa
+{
+namespace Internal
+{
+
+SamplingScheduler::Group::Group(boost::asio::io_service & io, std::chrono::milliseconds interval)
+  : Timer(io)
+  , Interval(interval)
+{
+}
+
+SamplingScheduler::SamplingScheduler(Server::AddressSpace & addressSpace, boost::asio::io_service & io, unsigned threads, const Common::Logger::SharedPtr & logger)
+  : AddressSpace(addressSpace)
+  , Io(io)
+  , ThreadsCount(std::max(threads, 1u))
+  , Logger(logger)
+{
+}
+
+SamplingScheduler::~SamplingScheduler()
+{
+  Stop();
+}
+
+uint32_t SamplingScheduler::Add(const ReadValueId & value, double interval, SampleCallback callback)
+{
+  const std::chrono::milliseconds period(std::max<int64_t>(static_cast<int64_t>(std::ceil(interval)), 1));
+
+  std::shared_ptr<Item> item = std::make_shared<Item>();
+  item->Value = value;
+  item->Callback = callback;
+
+  std::unique_lock<std::mutex> lock(Mutex);
+
+  if (Stopped)
+    {
+      throw std::logic_error("sampling_scheduler    | scheduler is stopped");
+    }
+
+  if (Threads.empty())
+    {
+      LOG_DEBUG(Logger, "sampling_scheduler    | start {} sampling threads", ThreadsCount);
+
+      Work.reset(new boost::asio::io_service::work(Workers));
+
+      for (unsigned i = 0; i < ThreadsCount; ++i)
+        {
+          Threads.emplace_back([this]()
+          {
+            Workers.run();
+          });
+        }
+    }
+
+  std::shared_ptr<Group> & group = Groups[period];
+
+  if (!group)
+    {
+      LOG_DEBUG(Logger, "sampling_scheduler    | create group of sampling interval: {} ms", period.count());
+
+      group = std::make_shared<Group>(Io, period);
+      group->Timer.expires_from_now(period);
+      Arm(group);
+    }
+
+  group->Items.push_back(item);
+
+  const uint32_t handle = ++LastHandle;
+  Items[handle] = std::make_pair(period, item);
+  return handle;
+}
+
+void SamplingScheduler::Remove(uint32_t handle)
+{
+  std::shared_ptr<Item> item;
+  {
+    std::unique_lock<std::mutex> lock(Mutex);
+    auto it = Items.find(handle);
+
+    if (it == Items.end())
+      {
+        return;
+      }
+
+    item = it->second.second;
+    auto groupIt = Groups.find(it->second.first);
+    Items.erase(it);
+
+    if (groupIt != Groups.end())
+      {
+        std::vector<std::shared_ptr<Item>> & items = groupIt->second->Items;
+        items.erase(std::remove(items.begin(), items.end(), item), items.end());
+
+        if (items.empty())
+          {
+            LOG_DEBUG(Logger, "sampling_scheduler    | delete group of sampling interval: {} ms", groupIt->first.count());
+
+            groupIt->second->Timer.cancel();
+            Groups.erase(groupIt);
+          }
+      }
+  }
+
+  // waits for a sample being delivered
+  std::unique_lock<std::mutex> itemLock(item->Mutex);
+  item->Active = false;
+}
+
+void SamplingScheduler::Stop()
+{
+  {
+    std::unique_lock<std::mutex> lock(Mutex);
+
+    if (Stopped)
+      {
+        return;
+      }
+
+    Stopped = true;
+
+    for (auto & group : Groups)
+      {
+        group.second->Timer.cancel();
+      }
+
+    Groups.clear();
+    Items.clear();
+    Work.reset();
+  }
+
+  // samples being read are finished
+  for (std::thread & thread : Threads)
+    {
+      if (thread.get_id() == std::this_thread::get_id())
+        {
+          // released by its last sample
+          thread.detach();
+        }
+
+      else
+        {
+          thread.join();
+        }
+    }
+
+  Threads.clear();
+}
+
+std::size_t SamplingScheduler::GetGroupsCount() const
+{
+  std::unique_lock<std::mutex> lock(Mutex);
+  return Groups.size();
+}
+
+void SamplingScheduler::Arm(const std::shared_ptr<Group> & group)
+{
+  // called under Mutex
+  std::shared_ptr<SamplingScheduler> self = shared_from_this();
+  group->Timer.async_wait([self, group](const boost::system::error_code & error) { self->OnTimer(group, error); });
+}
+
+void SamplingScheduler::OnTimer(const std::shared_ptr<Group> & group, const boost::system::error_code & error)
+{
+  if (error)
+    {
+      return;
+    }
+
+  std::unique_lock<std::mutex> lock(Mutex);
+
+  // stopped or last item removed
+  if (Stopped || group->Items.empty())
+    {
+      return;
+    }
+
+  if (group->Busy)
+    {
+      LOG_DEBUG(Logger, "sampling_scheduler    | sampling interval: {} ms, previous sample not finished, skip", group->Interval.count());
+    }
+
+  else
+    {
+      group->Busy = true;
+      std::shared_ptr<SamplingScheduler> self = shared_from_this();
+      Workers.post([self, group]() { self->Sample(group); });
+    }
+
+  // keep the pace of the interval, do not catch up missed ticks
+  const std::chrono::steady_clock::time_point now = std::chrono::steady_clock::now();
+  std::chrono::steady_clock::time_point next = group->Timer.expires_at() + group->Interval;
+
+  if (next <= now)
+    {
+      next = now + group->Interval;
+    }
+
+  group->Timer.expires_at(next);
+  Arm(group);
+}
+
+void SamplingScheduler::Sample(const std::shared_ptr<Group> & group)
+{
+  std::vector<std::shared_ptr<Item>> items;
+  {
+    std::unique_lock<std::mutex> lock(Mutex);
+
+    if (Stopped)
+      {
+        return;
+      }
+
+    items = group->Items;
+  }
+
+  ReadParameters params;
+  params.TimestampsToReturn = TimestampsToReturn::Both;
+
+  for (const std::shared_ptr<Item> & item : items)
+    {
+      params.AttributesToRead.push_back(item->Value);
+    }
+
+  const std::vector<DataValue> values = AddressSpace.Read(params);
+
+  for (std::size_t i = 0; i < items.size() && i < values.size(); ++i)
+    {
+      std::unique_lock<std::mutex> itemLock(items[i]->Mutex);
+
+      if (items[i]->Active)
+        {
+          items[i]->Callback(values[i]);
+        }
+    }
+
+  std::unique_lock<std::mutex> lock(Mutex);
+  group->Busy = false;
+}
+
+}
+}
@@ -0,0 +1,99 @@
+/// @brief Periodic sampling of values which do not report their changes.
+/// @license GNU LGPL
+///
+/// Distributed under the GNU LGPL License
+/// (See accompanying file LICENSE or copy at
+/// http://www.gnu.org/licenses/lgpl.html)
+///
+
+#pragma once
+
+#include <opc/common/logger.h>
+#include <opc/ua/server/address_space.h>
+
+#include <boost/asio.hpp>
+#include <boost/asio/steady_timer.hpp>
+
+#include <chrono>
+#include <functional>
+#include <map>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <unordered_map>
+#include <vector>
+
+namespace OpcUa
+{
+namespace Internal
+{
+
+/// @brief Reads values backed by value callbacks at their sampling interval.
+/// Items with the same interval form a group sampled by one timer: the timer
+/// runs on the io service and hands the group over to a pool of sampling
+/// threads which reads all its values in one Read call, so slow value
+/// callbacks never hold io threads. A group whose previous sample is
+/// still running skips the tick.
+class SamplingScheduler : public std::enable_shared_from_this<SamplingScheduler>
+{
+public:
+  typedef std::function<void (const DataValue &)> SampleCallback;
+
+  SamplingScheduler(Server::AddressSpace & addressSpace, boost::asio::io_service & io, unsigned threads, const Common::Logger::SharedPtr & logger);
+  ~SamplingScheduler();
+
+  /// @brief Sample item every interval milliseconds.
+  /// Sampling threads are started with the first item.
+  /// @return handle to pass to Remove.
+  uint32_t Add(const ReadValueId & item, double interval, SampleCallback callback);
+
+  /// @brief Stop sampling item. The callback is not running when it returns
+  /// and will not be called again: do not call it from the callback.
+  void Remove(uint32_t handle);
+
+  /// @brief Stop timers and join sampling threads.
+  void Stop();
+
+  /// @brief Number of sampling intervals in use.
+  std::size_t GetGroupsCount() const;
+
+private:
+  struct Item
+  {
+    ReadValueId Value;
+    SampleCallback Callback;
+    std::mutex Mutex; // held while the callback runs
+    bool Active = true;
+  };
+
+  struct Group
+  {
+    explicit Group(boost::asio::io_service & io, std::chrono::milliseconds interval);
+
+    boost::asio::steady_timer Timer;
+    const std::chrono::milliseconds Interval;
+    std::vector<std::shared_ptr<Item>> Items;
+    bool Busy = false; // sampled by a sampling thread
+  };
+
+  void Arm(const std::shared_ptr<Group> & group);
+  void OnTimer(const std::shared_ptr<Group> & group, const boost::system::error_code & error);
+  void Sample(const std::shared_ptr<Group> & group);
+
+private:
+  Server::AddressSpace & AddressSpace;
+  boost::asio::io_service & Io;
+  const unsigned ThreadsCount;
+  Common::Logger::SharedPtr Logger;
+  mutable std::mutex Mutex;
+  std::map<std::chrono::milliseconds, std::shared_ptr<Group>> Groups;
+  std::unordered_map<uint32_t, std::pair<std::chrono::milliseconds, std::shared_ptr<Item>>> Items;
+  uint32_t LastHandle = 0;
+  bool Stopped = false;
+  boost::asio::io_service Workers;
+  std::unique_ptr<boost::asio::io_service::work> Work;
+  std::vector<std::thread> Threads;
+};
+
+}
+}
@@ -219,7 +219,25 @@ ServerOperations UaServer::CreateServerOperations()
 
 void UaServer::TriggerEvent(Event event)
 {
-  SubscriptionService->TriggerEvent(ObjectId::Server, event);
+  SubscriptionService->TriggerEvent(ObjectId::Server, std::move(event));
+}
+
+void UaServer::TriggerEvents(std::vector<Event> events)
+{
+  SubscriptionService->TriggerEvents(ObjectId::Server, std::move(events));
+}
+
+EventLayout::SharedPtr UaServer::RegisterEventType(const NodeId & type)
+{
+  std::lock_guard<std::mutex> lock(EventLayoutsMutex);
+  EventLayout::SharedPtr & layout = EventLayouts[type];
+
+  if (!layout)
+    {
+      layout = EventLayout::Create(GetNode(type));
+    }
+
+  return layout;
 }
 
 }
@@ -98,7 +98,7 @@ public:
     return std::vector<BrowseResult>();
   }
 
-  virtual std::vector<BrowseResult> BrowseNext() const
+  virtual std::vector<BrowseResult> BrowseNext(const BrowseNextParameters & params) const
   {
     return std::vector<BrowseResult>();
   }
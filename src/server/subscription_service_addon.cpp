@@ -16,7 +16,11 @@
 #include <opc/ua/server/address_space.h>
 #include <opc/ua/server/subscription_service.h>
 
+#include <cerrno>
+#include <cstdlib>
 #include <iostream>
+#include <limits>
+#include <string>
 
 namespace
 {
@@ -29,11 +33,11 @@ public:
   void Initialize(Common::AddonsManager & manager, const Common::AddonParameters & parameters)
   {
     Logger = manager.GetLogger();
-    ApplyAddonParameters(parameters);
     Services = manager.GetAddon<OpcUa::Server::ServicesRegistry>(OpcUa::Server::ServicesRegistryAddonId);
     OpcUa::Server::AddressSpace::SharedPtr addressSpace = manager.GetAddon<OpcUa::Server::AddressSpace>(OpcUa::Server::AddressSpaceRegistryAddonId);
     OpcUa::Server::AsioAddon::SharedPtr asio = manager.GetAddon<OpcUa::Server::AsioAddon>(OpcUa::Server::AsioAddonId);
     Subscriptions = OpcUa::Server::CreateSubscriptionService(addressSpace, asio->GetIoService(), Logger);
+    ApplyAddonParameters(parameters);
     Services->RegisterSubscriptionServices(Subscriptions);
   }
 
@@ -47,7 +51,12 @@ public:
 public:
   void TriggerEvent(OpcUa::NodeId node, OpcUa::Event event)
   {
-    Subscriptions->TriggerEvent(node, event);
+    Subscriptions->TriggerEvent(node, std::move(event));
+  }
+
+  void TriggerEvents(OpcUa::NodeId node, std::vector<OpcUa::Event> events)
+  {
+    Subscriptions->TriggerEvents(node, std::move(events));
   }
 
 public:
@@ -56,6 +65,11 @@ public:
     return Subscriptions->CreateSubscription(request, callback);
   }
 
+  OpcUa::SubscriptionData CreateEncodedSubscription(const OpcUa::CreateSubscriptionRequest & request, std::function<void (const OpcUa::Server::EncodedPublishResult &)> callback)
+  {
+    return Subscriptions->CreateEncodedSubscription(request, callback);
+  }
+
   OpcUa::ModifySubscriptionResponse ModifySubscription(const OpcUa::ModifySubscriptionParameters & parameters)
   {
     return Subscriptions->ModifySubscription(parameters);
@@ -76,6 +90,21 @@ public:
     return Subscriptions->Republish(request);
   }
 
+  OpcUa::RepublishResponse Republish(const OpcUa::NodeId & session, const OpcUa::RepublishParameters & request)
+  {
+    return Subscriptions->Republish(session, request);
+  }
+
+  OpcUa::StatusCode RepublishEncoded(const OpcUa::NodeId & session, const OpcUa::RepublishParameters & request, OpcUa::Server::EncodedNotificationMessage & message)
+  {
+    return Subscriptions->RepublishEncoded(session, request, message);
+  }
+
+  void SetRetransmissionBudget(std::size_t bytes)
+  {
+    Subscriptions->SetRetransmissionBudget(bytes);
+  }
+
   std::vector<OpcUa::MonitoredItemCreateResult> CreateMonitoredItems(const OpcUa::MonitoredItemsParameters & parameters)
   {
     return Subscriptions->CreateMonitoredItems(parameters);
@@ -88,8 +117,47 @@ public:
 
 
 private:
+  // only plain decimal digits, std::stoul would wrap a sign around and skip spaces
+  static bool ParseSize(const std::string & text, std::size_t & value)
+  {
+    if (text.empty() || text.find_first_not_of("0123456789") != std::string::npos)
+      {
+        return false;
+      }
+
+    errno = 0;
+    const unsigned long long parsed = std::strtoull(text.c_str(), nullptr, 10);
+
+    if (errno == ERANGE || parsed > std::numeric_limits<std::size_t>::max())
+      {
+        return false;
+      }
+
+    value = static_cast<std::size_t>(parsed);
+    return true;
+  }
+
   void ApplyAddonParameters(const Common::AddonParameters & addons)
   {
+    for (const Common::Parameter & parameter : addons.Parameters)
+      {
+        // bytes of not acknowledged notification messages kept by each subscription
+        if (parameter.Name == "max_retransmission_bytes" && !parameter.Value.empty())
+          {
+            std::size_t bytes = 0;
+
+            if (ParseSize(parameter.Value, bytes))
+              {
+                Subscriptions->SetRetransmissionBudget(bytes);
+              }
+
+            else
+              {
+                LOG_ERROR(Logger, "subscription_service  | invalid max_retransmission_bytes '{}', default is used", parameter.Value);
+              }
+          }
+      }
+
     /*
     for (const Common::Parameter parameter : addons.Parameters)
       {
@@ -9,7 +9,10 @@
 
 #include "subscription_service_internal.h"
 
+#include <opc/ua/protocol/object_ids.h>
+
 #include <boost/thread/locks.hpp>
+#include <algorithm>
 
 namespace
 {
@@ -26,6 +29,13 @@ OpcUa::ByteString GenerateEventId()
 
   return str;
 }
+
+// Resolution of publishing intervals.
+const std::chrono::milliseconds PublishTick(10);
+// Jitter is reported every that much publishing cycles.
+const uint64_t JitterReportCycles = 1000;
+// Not acknowledged notification messages kept by a subscription.
+const std::size_t DefaultRetransmissionBudget = 1024 * 1024;
 }
 
 namespace OpcUa
@@ -33,15 +43,298 @@ namespace OpcUa
 namespace Internal
 {
 
+PublishScheduler::PublishScheduler(boost::asio::io_service & io, std::chrono::milliseconds tick, const Common::Logger::SharedPtr & logger)
+  : Timer(io)
+  , Tick(tick)
+  , StartTime(std::chrono::steady_clock::now())
+  , Logger(logger)
+{
+}
+
+std::chrono::milliseconds PublishScheduler::GetTick() const
+{
+  return Tick;
+}
+
+PublishJitter PublishScheduler::GetJitter() const
+{
+  std::unique_lock<std::mutex> lock(Mutex);
+  return Jitter;
+}
+
+uint64_t PublishScheduler::Now() const
+{
+  return (std::chrono::steady_clock::now() - StartTime) / Tick;
+}
+
+uint64_t PublishScheduler::ToTicks(double milliseconds) const
+{
+  const uint64_t ticks = static_cast<uint64_t>(milliseconds / Tick.count() + 0.5);
+  return std::max<uint64_t>(ticks, 1);
+}
+
+void PublishScheduler::Add(const std::shared_ptr<InternalSubscription> & subscription)
+{
+  const uint32_t id = subscription->GetSubscriptionId();
+  const uint64_t intervalTicks = ToTicks(subscription->GetPublishingInterval());
+
+  std::unique_lock<std::mutex> lock(Mutex);
+
+  if (Stopped)
+    {
+      return;
+    }
+
+  const uint64_t now = Now();
+
+  // idle wheel does not follow time, move it without walking every tick
+  if (Wheel.Empty())
+    {
+      Wheel.Advance(now);
+    }
+
+  Entry entry;
+  entry.Subscription = subscription;
+  entry.IntervalTicks = intervalTicks;
+  entry.LastTick = now;
+  entry.DueTick = now + intervalTicks;
+  entry.Running = false;
+  entry.WakeRequested = false;
+  entry.IntervalModified = false;
+  Subscriptions[id] = entry;
+  Wheel.Schedule(id, entry.DueTick);
+  Arm();
+}
+
+void PublishScheduler::Remove(uint32_t subscriptionId)
+{
+  std::unique_lock<std::mutex> lock(Mutex);
+  // timer left in the wheel is skipped when it expires
+  Subscriptions.erase(subscriptionId);
+}
+
+void PublishScheduler::WakeUp(uint32_t subscriptionId)
+{
+  std::unique_lock<std::mutex> lock(Mutex);
+
+  auto it = Subscriptions.find(subscriptionId);
+
+  if (it == Subscriptions.end())
+    {
+      return;
+    }
+
+  ScheduleNextInterval(subscriptionId, it->second);
+}
+
+void PublishScheduler::Reschedule(uint32_t subscriptionId, double publishingInterval)
+{
+  const uint64_t intervalTicks = ToTicks(publishingInterval);
+
+  std::unique_lock<std::mutex> lock(Mutex);
+
+  auto it = Subscriptions.find(subscriptionId);
+
+  if (it == Subscriptions.end())
+    {
+      return;
+    }
+
+  Entry & entry = it->second;
+  entry.IntervalTicks = intervalTicks;
+  entry.IntervalModified = entry.Running;
+  ScheduleNextInterval(subscriptionId, entry);
+}
+
+void PublishScheduler::ScheduleNextInterval(uint32_t subscriptionId, Entry & entry)
+{
+  if (entry.Running)
+    {
+      entry.WakeRequested = true;
+      return;
+    }
+
+  const uint64_t now = Now();
+  uint64_t next = entry.LastTick + entry.IntervalTicks;
+
+  if (now >= next)
+    {
+      next += ((now - next) / entry.IntervalTicks + 1) * entry.IntervalTicks;
+    }
+
+  if (next < entry.DueTick)
+    {
+      entry.DueTick = next;
+      Wheel.Schedule(subscriptionId, next);
+      Arm();
+    }
+}
+
+void PublishScheduler::Stop()
+{
+  std::unique_lock<std::mutex> lock(Mutex);
+  Stopped = true;
+  Subscriptions.clear();
+  Timer.cancel();
+}
+
+void PublishScheduler::Arm()
+{
+  if (Stopped || Wheel.Empty())
+    {
+      return;
+    }
+
+  // sleep until the earliest due subscription, an earlier one re-arms the timer
+  const uint64_t tick = Wheel.GetNextExpiry();
+
+  if (Armed && ArmedTick <= tick)
+    {
+      return;
+    }
+
+  Armed = true;
+  ArmedTick = tick;
+  // cancels the wait for a later tick
+  Timer.expires_at(StartTime + Tick * tick);
+  std::shared_ptr<PublishScheduler> self = shared_from_this();
+  Timer.async_wait([self](const boost::system::error_code & error) { self->OnTick(error); });
+}
+
+void PublishScheduler::RecordJitter(uint64_t tick, std::chrono::steady_clock::time_point now)
+{
+  const std::chrono::steady_clock::time_point planned = StartTime + Tick * tick;
+  const std::chrono::microseconds delay = now > planned ? std::chrono::duration_cast<std::chrono::microseconds>(now - planned) : std::chrono::microseconds(0);
+
+  ++Jitter.Cycles;
+  Jitter.Total += delay;
+  Jitter.Max = std::max(Jitter.Max, delay);
+
+  if (Jitter.Cycles % JitterReportCycles == 0)
+    {
+      LOG_DEBUG(Logger, "subscription_service  | publish jitter: mean: {} us, max: {} us, cycles: {}", Jitter.Total.count() / Jitter.Cycles, Jitter.Max.count(), Jitter.Cycles);
+    }
+}
+
+void PublishScheduler::OnTick(const boost::system::error_code & error)
+{
+  if (error)
+    {
+      return;
+    }
+
+  std::vector<Cycle> cycles;
+  {
+    std::unique_lock<std::mutex> lock(Mutex);
+    Armed = false;
+
+    if (Stopped)
+      {
+        return;
+      }
+
+    const std::chrono::steady_clock::time_point now = std::chrono::steady_clock::now();
+
+    for (const TimerWheel::Timer & timer : Wheel.Advance(Now()))
+      {
+        auto it = Subscriptions.find(timer.Id);
+
+        // timers of removed subscriptions and timers replaced by a wake up
+        if (it == Subscriptions.end() || it->second.DueTick != timer.Tick || it->second.Running)
+          {
+            continue;
+          }
+
+        Entry & entry = it->second;
+        Cycle cycle;
+        cycle.Subscription = entry.Subscription.lock();
+
+        if (!cycle.Subscription)
+          {
+            Subscriptions.erase(it);
+            continue;
+          }
+
+        entry.Running = true;
+        cycle.SubscriptionId = timer.Id;
+        cycle.Tick = timer.Tick;
+        cycle.ElapsedIntervals = static_cast<uint32_t>(std::max<uint64_t>((timer.Tick - entry.LastTick) / entry.IntervalTicks, 1));
+        cycles.push_back(cycle);
+        RecordJitter(timer.Tick, now);
+      }
+  }
+
+  // Subscriptions lock themselves and call WakeUp, publish them unlocked.
+  for (Cycle & cycle : cycles)
+    {
+      cycle.SleepIntervals = cycle.Subscription->Publish(cycle.ElapsedIntervals);
+      cycle.IntervalTicks = ToTicks(cycle.Subscription->GetPublishingInterval());
+    }
+
+  std::unique_lock<std::mutex> lock(Mutex);
+  const uint64_t now = Now();
+
+  for (const Cycle & cycle : cycles)
+    {
+      auto it = Subscriptions.find(cycle.SubscriptionId);
+
+      if (it == Subscriptions.end())
+        {
+          continue;
+        }
+
+      Entry & entry = it->second;
+      entry.Running = false;
+
+      if (cycle.SleepIntervals == 0)
+        {
+          LOG_DEBUG(Logger, "subscription_service  | stop publishing expired SubscriptionId: {}", cycle.SubscriptionId);
+          Subscriptions.erase(it);
+          continue;
+        }
+
+      const uint64_t sleep = entry.WakeRequested ? 1 : cycle.SleepIntervals;
+      entry.WakeRequested = false;
+      entry.IntervalTicks = entry.IntervalModified ? entry.IntervalTicks : cycle.IntervalTicks;
+      entry.IntervalModified = false;
+      entry.LastTick = cycle.Tick;
+      entry.DueTick = cycle.Tick + entry.IntervalTicks * sleep;
+
+      // do not try to catch up cycles missed by a late timer
+      if (entry.DueTick <= now)
+        {
+          entry.DueTick += ((now - entry.DueTick) / entry.IntervalTicks + 1) * entry.IntervalTicks;
+        }
+
+      Wheel.Schedule(cycle.SubscriptionId, entry.DueTick);
+    }
+
+  Arm();
+}
+
 SubscriptionServiceInternal::SubscriptionServiceInternal(Server::AddressSpace::SharedPtr addressspace, boost::asio::io_service & ioService, const Common::Logger::SharedPtr & logger)
   : io(ioService)
   , AddressSpace(addressspace)
   , Logger(logger)
+  , Scheduler(std::make_shared<PublishScheduler>(ioService, PublishTick, logger))
+  , Samplers(*addressspace, io, logger)
+  , RetransmissionBudget(DefaultRetransmissionBudget)
 {
 }
 
 SubscriptionServiceInternal::~SubscriptionServiceInternal()
 {
+  Scheduler->Stop();
+}
+
+void SubscriptionServiceInternal::WakeUpSubscription(uint32_t subscriptionId)
+{
+  Scheduler->WakeUp(subscriptionId);
+}
+
+PublishJitter SubscriptionServiceInternal::GetPublishJitter() const
+{
+  return Scheduler->GetJitter();
 }
 
 Server::AddressSpace & SubscriptionServiceInternal::GetAddressSpace()
@@ -49,6 +342,11 @@ Server::AddressSpace & SubscriptionServiceInternal::GetAddressSpace()
   return *AddressSpace;
 }
 
+DataChangeSamplers & SubscriptionServiceInternal::GetDataChangeSamplers()
+{
+  return Samplers;
+}
+
 boost::asio::io_service & SubscriptionServiceInternal::GetIOService()
 {
   return io;
@@ -87,12 +385,25 @@ std::vector<StatusCode> SubscriptionServiceInternal::DeleteSubscriptions(const s
         {
           LOG_DEBUG(Logger, "subscription_service  | delete SubscriptionId: {}", subid);
 
+          Scheduler->Remove(subid);
+          DeleteEventRoutes(subid);
           itsub->second->Stop();
           SubscriptionsMap.erase(subid);
           result.push_back(StatusCode::Good);
         }
     }
 
+  std::lock_guard<std::mutex> queuesLock(PublishQueuesMutex);
+
+  for (auto & queue : PublishQueues)
+    {
+      std::vector<std::pair<uint32_t, uint8_t>> & waiting = queue.second.Waiting;
+      waiting.erase(std::remove_if(waiting.begin(), waiting.end(), [&subscriptions](const std::pair<uint32_t, uint8_t> & item)
+      {
+        return std::find(subscriptions.begin(), subscriptions.end(), item.first) != subscriptions.end();
+      }), waiting.end());
+    }
+
   return result;
 }
 
@@ -114,26 +425,46 @@ ModifySubscriptionResponse SubscriptionServiceInternal::ModifySubscription(const
 
   LOG_DEBUG(Logger, "subscription_service  | modify SubscriptionId: {}", subid);
 
+  ModifySubscriptionParameters revised = parameters;
+
+  if (revised.RequestedPublishingInterval)
+    {
+      revised.RequestedPublishingInterval = std::max<double>(revised.RequestedPublishingInterval, Scheduler->GetTick().count());
+    }
+
   std::shared_ptr<InternalSubscription> sub = itsub->second;
-  response.Parameters = sub->ModifySubscription(parameters);
+  response.Parameters = sub->ModifySubscription(revised);
+  // a sleeping subscription would keep the deadline of its old interval and keep alive count
+  Scheduler->Reschedule(subid, response.Parameters.RevisedPublishingInterval);
   return response;
 }
 
 SubscriptionData SubscriptionServiceInternal::CreateSubscription(const CreateSubscriptionRequest & request, std::function<void (PublishResult)> callback)
+{
+  return AddSubscription(request, callback, std::function<void (const Server::EncodedPublishResult &)>());
+}
+
+SubscriptionData SubscriptionServiceInternal::CreateEncodedSubscription(const CreateSubscriptionRequest & request, std::function<void (const Server::EncodedPublishResult &)> callback)
+{
+  return AddSubscription(request, std::function<void (PublishResult)>(), callback);
+}
+
+SubscriptionData SubscriptionServiceInternal::AddSubscription(const CreateSubscriptionRequest & request, std::function<void (PublishResult)> callback, std::function<void (const Server::EncodedPublishResult &)> encodedCallback)
 {
   boost::unique_lock<boost::shared_mutex> lock(DbMutex);
 
   SubscriptionData data;
   data.SubscriptionId = ++LastSubscriptionId;
   data.RevisedLifetimeCount = request.Parameters.RequestedLifetimeCount;
-  data.RevisedPublishingInterval = request.Parameters.RequestedPublishingInterval;
+  // publishing cycles can not be shorter than a scheduler tick
+  data.RevisedPublishingInterval = std::max<double>(request.Parameters.RequestedPublishingInterval, Scheduler->GetTick().count());
   data.RevisedMaxKeepAliveCount = request.Parameters.RequestedMaxKeepAliveCount;
 
   LOG_DEBUG(Logger, "subscription_service  | CreateSubscription id: {}", data.SubscriptionId);
 
-  std::shared_ptr<InternalSubscription> sub(new InternalSubscription(*this, data, request.Header.SessionAuthenticationToken, callback, Logger));
-  sub->Start();
+  std::shared_ptr<InternalSubscription> sub(new InternalSubscription(*this, data, request.Parameters, request.Header.SessionAuthenticationToken, callback, encodedCallback, Logger));
   SubscriptionsMap[data.SubscriptionId] = sub;
+  Scheduler->Add(sub);
   return data;
 }
 
@@ -160,6 +491,12 @@ std::vector<MonitoredItemCreateResult> SubscriptionServiceInternal::CreateMonito
   for (const MonitoredItemCreateRequest & req : params.ItemsToCreate) //FIXME: loop could be in InternalSubscription
     {
       MonitoredItemCreateResult result = itsub->second->CreateMonitoredItem(req);
+
+      if (result.Status == StatusCode::Good && req.ItemToMonitor.AttributeId == AttributeId::EventNotifier)
+        {
+          AddEventRoute(req.ItemToMonitor.NodeId, MonitoredItemKey(params.SubscriptionId, result.MonitoredItemId));
+        }
+
       data.push_back(result);
     }
 
@@ -186,19 +523,74 @@ std::vector<StatusCode> SubscriptionServiceInternal::DeleteMonitoredItems(const
     }
 
   results = itsub->second->DeleteMonitoredItemsIds(params.MonitoredItemIds);
+
+  for (uint32_t id : params.MonitoredItemIds)
+    {
+      DeleteEventRoute(MonitoredItemKey(params.SubscriptionId, id));
+    }
+
   return results;
 }
 
+void SubscriptionServiceInternal::AddEventRoute(const NodeId & node, const MonitoredItemKey & item)
+{
+  EventRoutes[node].push_back(item);
+  EventRouteNodes[item] = node;
+  HasEventRoutes = true;
+}
+
+void SubscriptionServiceInternal::DeleteEventRoute(const MonitoredItemKey & item)
+{
+  auto nodeIt = EventRouteNodes.find(item);
+
+  if (nodeIt == EventRouteNodes.end())
+    {
+      return;
+    }
+
+  auto routesIt = EventRoutes.find(nodeIt->second);
+  std::vector<MonitoredItemKey> & routes = routesIt->second;
+  routes.erase(std::remove(routes.begin(), routes.end(), item), routes.end());
+
+  if (routes.empty())
+    {
+      EventRoutes.erase(routesIt);
+    }
+
+  EventRouteNodes.erase(nodeIt);
+  HasEventRoutes = !EventRoutes.empty();
+}
+
+void SubscriptionServiceInternal::DeleteEventRoutes(uint32_t subscriptionId)
+{
+  std::vector<MonitoredItemKey> items;
+
+  for (auto it = EventRouteNodes.lower_bound(MonitoredItemKey(subscriptionId, 0)); it != EventRouteNodes.end() && it->first.first == subscriptionId; ++it)
+    {
+      items.push_back(it->first);
+    }
+
+  for (const MonitoredItemKey & item : items)
+    {
+      DeleteEventRoute(item);
+    }
+}
+
 void SubscriptionServiceInternal::Publish(const PublishRequest & request)
 {
   boost::unique_lock<boost::shared_mutex> lock(DbMutex);
 
   const NodeId& session = request.Header.SessionAuthenticationToken;
-  if (PublishRequestQueues[session] < 100)
-    {
-      PublishRequestQueues[session] += 1;
-      LOG_DEBUG(Logger, "subscription_service  | push PublishRequest for session: {}: available requests: {}", session, PublishRequestQueues[session]);
-    }
+  {
+    std::lock_guard<std::mutex> queuesLock(PublishQueuesMutex);
+    SessionPublishQueue & queue = PublishQueues[session];
+
+    if (queue.Requests < 100)
+      {
+        ++queue.Requests;
+        LOG_DEBUG(Logger, "subscription_service  | push PublishRequest for session: {}: available requests: {}", session, queue.Requests);
+      }
+  }
 
   //FIXME: else spec says we should return error to warn client
 
@@ -211,16 +603,26 @@ void SubscriptionServiceInternal::Publish(const PublishRequest & request)
           sub_it->second->NewAcknowlegment(ack);
         }
     }
+
+  // subscriptions waiting with notifications do not wait for their next cycle
+  DispatchPublishRequests(session);
 }
 
 RepublishResponse SubscriptionServiceInternal::Republish(const RepublishParameters & params)
+{
+  return Republish(NodeId(), params);
+}
+
+RepublishResponse SubscriptionServiceInternal::Republish(const NodeId & session, const RepublishParameters & params)
 {
   boost::shared_lock<boost::shared_mutex> lock(DbMutex);
 
   SubscriptionsIdMap::iterator sub_it = SubscriptionsMap.find(params.SubscriptionId);
 
-  if (sub_it == SubscriptionsMap.end())
+  // messages of other sessions are not disclosed
+  if (sub_it == SubscriptionsMap.end() || sub_it->second->GetSession() != session)
     {
+      LOG_DEBUG(Logger, "subscription_service  | session: {} has no SubscriptionId: {} to republish", session, params.SubscriptionId);
       RepublishResponse response;
       response.Header.ServiceResult = StatusCode::BadSubscriptionIdInvalid;
       return response;
@@ -229,44 +631,235 @@ RepublishResponse SubscriptionServiceInternal::Republish(const RepublishParamete
   return sub_it->second->Republish(params);
 }
 
+StatusCode SubscriptionServiceInternal::RepublishEncoded(const NodeId & session, const RepublishParameters & params, Server::EncodedNotificationMessage & message)
+{
+  boost::shared_lock<boost::shared_mutex> lock(DbMutex);
+
+  SubscriptionsIdMap::iterator sub_it = SubscriptionsMap.find(params.SubscriptionId);
 
-bool SubscriptionServiceInternal::PopPublishRequest(NodeId node)
+  // messages of other sessions are not disclosed
+  if (sub_it == SubscriptionsMap.end() || sub_it->second->GetSession() != session)
+    {
+      LOG_DEBUG(Logger, "subscription_service  | session: {} has no SubscriptionId: {} to republish", session, params.SubscriptionId);
+      return StatusCode::BadSubscriptionIdInvalid;
+    }
+
+  message = sub_it->second->RepublishEncoded(params.RetransmitSequenceNumber);
+  return message ? StatusCode::Good : StatusCode::BadMessageNotAvailable;
+}
+
+void SubscriptionServiceInternal::SetRetransmissionBudget(std::size_t bytes)
+{
+  RetransmissionBudget = bytes;
+}
+
+std::size_t SubscriptionServiceInternal::GetRetransmissionBudget() const
+{
+  return RetransmissionBudget;
+}
+
+
+bool SubscriptionServiceInternal::PopPublishRequest(const NodeId & session, uint32_t subscriptionId, uint8_t priority)
 {
-  std::map<NodeId, uint32_t>::iterator queue_it = PublishRequestQueues.find(node);
+  std::lock_guard<std::mutex> lock(PublishQueuesMutex);
+  SessionPublishQueue & queue = PublishQueues[session];
 
-  if (queue_it == PublishRequestQueues.end())
+  if (queue.Requests > 0)
     {
-      LOG_ERROR(Logger, "subscription_service  | attempt to pop publish request for unknown session: {}", node);
+      LOG_DEBUG(Logger, "subscription_service  | pop PublishRequest for session: {}: available requests: {}", session, queue.Requests);
+      --queue.Requests;
+      return true;
+    }
+
+  auto waiting = std::find_if(queue.Waiting.begin(), queue.Waiting.end(), [subscriptionId](const std::pair<uint32_t, uint8_t> & item)
+  {
+    return item.first == subscriptionId;
+  });
 
-      if (Logger && Logger->should_log(spdlog::level::debug))
+  if (waiting == queue.Waiting.end())
+    {
+      LOG_DEBUG(Logger, "subscription_service  | no publish request for session: {}, SubscriptionId: {} waits for one", session, subscriptionId);
+      queue.Waiting.push_back(std::make_pair(subscriptionId, priority));
+    }
+
+  return false;
+}
+
+void SubscriptionServiceInternal::RequeuePublish(const NodeId & session, uint32_t subscriptionId, uint8_t priority)
+{
+  boost::shared_lock<boost::shared_mutex> lock(DbMutex);
+  {
+    std::lock_guard<std::mutex> queuesLock(PublishQueuesMutex);
+    std::vector<std::pair<uint32_t, uint8_t>> & waiting = PublishQueues[session].Waiting;
+    waiting.erase(std::remove_if(waiting.begin(), waiting.end(), [subscriptionId](const std::pair<uint32_t, uint8_t> & item)
+    {
+      return item.first == subscriptionId;
+    }), waiting.end());
+    waiting.push_back(std::make_pair(subscriptionId, priority));
+  }
+
+  DispatchPublishRequests(session);
+}
+
+void SubscriptionServiceInternal::ReturnPublishRequest(const NodeId & session)
+{
+  boost::shared_lock<boost::shared_mutex> lock(DbMutex);
+  {
+    std::lock_guard<std::mutex> queuesLock(PublishQueuesMutex);
+    ++PublishQueues[session].Requests;
+  }
+
+  DispatchPublishRequests(session);
+}
+
+void SubscriptionServiceInternal::DispatchPublishRequests(const NodeId & session)
+{
+  std::vector<std::weak_ptr<InternalSubscription>> ready;
+  {
+    std::lock_guard<std::mutex> queuesLock(PublishQueuesMutex);
+    auto queue_it = PublishQueues.find(session);
+
+    if (queue_it == PublishQueues.end())
+      {
+        return;
+      }
+
+    SessionPublishQueue & queue = queue_it->second;
+
+    while (queue.Requests > 0 && !queue.Waiting.empty())
+      {
+        // first one of the highest priority
+        auto best = std::max_element(queue.Waiting.begin(), queue.Waiting.end(), [](const std::pair<uint32_t, uint8_t> & a, const std::pair<uint32_t, uint8_t> & b)
+        {
+          return a.second < b.second;
+        });
+
+        SubscriptionsIdMap::iterator sub_it = SubscriptionsMap.find(best->first);
+        queue.Waiting.erase(best);
+
+        if (sub_it != SubscriptionsMap.end())
+          {
+            LOG_DEBUG(Logger, "subscription_service  | reserve PublishRequest of session: {} for SubscriptionId: {}", session, sub_it->first);
+            --queue.Requests;
+            ready.push_back(sub_it->second);
+          }
+      }
+  }
+
+  // Publish requests arrive while the binary protocol holds its lock,
+  // answers are sent from the io service as publishing cycles are.
+  for (const std::weak_ptr<InternalSubscription> & subscription : ready)
+    {
+      io.post([this, session, subscription]()
+      {
+        if (std::shared_ptr<InternalSubscription> sub = subscription.lock())
+          {
+            sub->PublishLate();
+          }
+
+        else
+          {
+            // the request reserved for a subscription deleted meanwhile answers another one
+            ReturnPublishRequest(session);
+          }
+      });
+    }
+}
+
+std::vector<NodeId> SubscriptionServiceInternal::GetEventNotifiers(const NodeId & source) const
+{
+  std::vector<NodeId> notifiers;
+  std::set<NodeId> visited;
+  std::vector<NodeId> pending(1, source);
+
+  while (!pending.empty())
+    {
+      const NodeId current = pending.back();
+      pending.pop_back();
+
+      if (!visited.insert(current).second)
         {
-          for (auto i : PublishRequestQueues)
+          continue;
+        }
+
+      notifiers.push_back(current);
+
+      // HasNotifier is a subtype of HasEventSource
+      BrowseDescription description;
+      description.NodeToBrowse = current;
+      description.Direction = BrowseDirection::Inverse;
+      description.ReferenceTypeId = ObjectId::HasEventSource;
+      description.IncludeSubtypes = true;
+      description.NodeClasses = NodeClass::Object;
+      NodesQuery query;
+      query.NodesToBrowse.push_back(description);
+
+      // every page is taken, so no continuation point is left behind
+      std::vector<BrowseResult> results = AddressSpace->Browse(query);
+
+      while (!results.empty())
+        {
+          BrowseNextParameters next;
+
+          for (const BrowseResult & result : results)
             {
-              Logger->debug("subscription_service  |   available session: {}", i.first);
+              for (const ReferenceDescription & reference : result.Referencies)
+                {
+                  pending.push_back(reference.TargetNodeId);
+                }
+
+              if (!result.ContinuationPoint.empty())
+                {
+                  next.ContinuationPoints.push_back(result.ContinuationPoint);
+                }
             }
+
+          if (next.ContinuationPoints.empty())
+            {
+              break;
+            }
+
+          results = AddressSpace->BrowseNext(next);
         }
-      return false;
     }
 
-  else
+  return notifiers;
+}
+
+std::map<uint32_t, std::vector<uint32_t>> SubscriptionServiceInternal::GetEventRoutes(const std::vector<NodeId> & notifiers) const
+{
+  // routes are grouped by subscription so that each one is locked once
+  std::map<uint32_t, std::vector<uint32_t>> items;
+
+  for (const NodeId & notifier : notifiers)
     {
-      if (queue_it->second == 0)
+      auto routesIt = EventRoutes.find(notifier);
+
+      if (routesIt == EventRoutes.end())
         {
-          LOG_ERROR(Logger, "subscription_service  | unable to send response: no publish request for session: {}", node);
-          return false;
+          continue;
         }
 
-      else
+      for (const MonitoredItemKey & item : routesIt->second)
         {
-          LOG_DEBUG(Logger, "subscription_service  | pop PublishRequest for session: {}: available requests: {}", node, queue_it->second);
-          --queue_it->second;
-          return true;
+          items[item.first].push_back(item.second);
         }
     }
+
+  return items;
 }
 
 void SubscriptionServiceInternal::TriggerEvent(NodeId node, Event event)
 {
+  if (!HasEventRoutes)
+    {
+      LOG_DEBUG(Logger, "subscription_service  | no monitored items for events of NodeId: {}", node);
+      return;
+    }
+
+  // browsing takes the address space lock, done before taking ours
+  const std::vector<NodeId> notifiers = GetEventNotifiers(node);
+
   boost::shared_lock<boost::shared_mutex> lock(DbMutex);
 
   //A new id must be generated every time we trigger an event,
@@ -276,11 +869,67 @@ void SubscriptionServiceInternal::TriggerEvent(NodeId node, Event event)
       event.EventId = GenerateEventId();
     }
 
-  for (auto sub : SubscriptionsMap)
+  const std::map<uint32_t, std::vector<uint32_t>> items = GetEventRoutes(notifiers);
+
+  if (items.empty())
+    {
+      LOG_DEBUG(Logger, "subscription_service  | no monitored items for events of NodeId: {}", node);
+      return;
+    }
+
+  for (const auto & subItems : items)
+    {
+      SubscriptionsIdMap::iterator sub_it = SubscriptionsMap.find(subItems.first);
+
+      if (sub_it == SubscriptionsMap.end())
+        {
+          continue;
+        }
+
+      for (uint32_t item : subItems.second)
+        {
+          sub_it->second->EnqueueEvent(item, event);
+        }
+    }
+}
+
+void SubscriptionServiceInternal::TriggerEvents(NodeId node, std::vector<Event> events)
+{
+  if (!HasEventRoutes)
     {
-      sub.second->TriggerEvent(node, event);
+      LOG_DEBUG(Logger, "subscription_service  | no monitored items for events of NodeId: {}", node);
+      return;
     }
 
+  const std::vector<NodeId> notifiers = GetEventNotifiers(node);
+
+  boost::shared_lock<boost::shared_mutex> lock(DbMutex);
+
+  for (Event & event : events)
+    {
+      if (event.EventId.Data.empty())
+        {
+          event.EventId = GenerateEventId();
+        }
+    }
+
+  const std::map<uint32_t, std::vector<uint32_t>> items = GetEventRoutes(notifiers);
+
+  if (items.empty())
+    {
+      LOG_DEBUG(Logger, "subscription_service  | no monitored items for events of NodeId: {}", node);
+      return;
+    }
+
+  for (const auto & subItems : items)
+    {
+      SubscriptionsIdMap::iterator sub_it = SubscriptionsMap.find(subItems.first);
+
+      if (sub_it != SubscriptionsMap.end())
+        {
+          sub_it->second->EnqueueEvents(subItems.second, events);
+        }
+    }
 }
 
 } // namespace Internal
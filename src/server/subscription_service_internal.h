@@ -10,7 +10,9 @@
 #pragma once
 
 #include "address_space_addon.h"
+#include "data_change_sampler.h"
 #include "internal_subscription.h"
+#include "timer_wheel.h"
 
 
 #include <opc/ua/server/subscription_service.h>
@@ -21,15 +23,21 @@
 #include <opc/ua/protocol/string_utils.h>
 
 #include <boost/asio.hpp>
+#include <boost/asio/steady_timer.hpp>
 #include <boost/thread/shared_mutex.hpp>
+#include <atomic>
+#include <chrono>
 #include <ctime>
 #include <limits>
 #include <list>
 #include <map>
+#include <memory>
+#include <mutex>
 #include <queue>
 #include <deque>
 #include <set>
 #include <thread>
+#include <unordered_map>
 
 namespace OpcUa
 {
@@ -40,6 +48,82 @@ class InternalSubscription;
 
 typedef std::map <uint32_t, std::shared_ptr<InternalSubscription>> SubscriptionsIdMap; // Map SubscptioinId, SubscriptionData
 
+/// @brief Delay of publishing cycles after the time they were planned for.
+struct PublishJitter
+{
+  uint64_t Cycles = 0;
+  std::chrono::microseconds Total = std::chrono::microseconds(0);
+  std::chrono::microseconds Max = std::chrono::microseconds(0);
+};
+
+/// @brief Runs publishing cycles of all subscriptions from one timer.
+/// Subscriptions are kept in a timer wheel and the ones due at the same tick
+/// are published in one batch. The timer sleeps until the earliest due subscription.
+/// A subscription without notifications asks to sleep until its next keep alive
+/// and is woken up by WakeUp when a notification arrives.
+class PublishScheduler : public std::enable_shared_from_this<PublishScheduler>
+{
+public:
+  PublishScheduler(boost::asio::io_service & io, std::chrono::milliseconds tick, const Common::Logger::SharedPtr & logger);
+
+  /// @brief Start publishing cycles of the subscription.
+  void Add(const std::shared_ptr<InternalSubscription> & subscription);
+  void Remove(uint32_t subscriptionId);
+  /// @brief Publish a sleeping subscription at its next publishing interval.
+  void WakeUp(uint32_t subscriptionId);
+  /// @brief Publish the subscription at its new interval after its parameters were modified.
+  /// A subscription sleeping until its keep alive does not keep the deadline of its old parameters.
+  void Reschedule(uint32_t subscriptionId, double publishingInterval);
+  void Stop();
+
+  std::chrono::milliseconds GetTick() const;
+  PublishJitter GetJitter() const;
+
+private:
+  struct Entry
+  {
+    std::weak_ptr<InternalSubscription> Subscription;
+    uint64_t IntervalTicks;
+    uint64_t LastTick;
+    uint64_t DueTick;
+    bool Running;
+    bool WakeRequested;
+    bool IntervalModified; // while running, the interval read by the cycle may be stale
+  };
+
+  struct Cycle
+  {
+    uint32_t SubscriptionId;
+    uint64_t Tick;
+    uint32_t ElapsedIntervals;
+    std::shared_ptr<InternalSubscription> Subscription;
+    uint32_t SleepIntervals;
+    uint64_t IntervalTicks;
+  };
+
+  uint64_t Now() const;
+  uint64_t ToTicks(double milliseconds) const;
+  void Arm();
+  void ScheduleNextInterval(uint32_t subscriptionId, Entry & entry);
+  void OnTick(const boost::system::error_code & error);
+  void RecordJitter(uint64_t tick, std::chrono::steady_clock::time_point now);
+
+private:
+  boost::asio::steady_timer Timer;
+  const std::chrono::milliseconds Tick;
+  const std::chrono::steady_clock::time_point StartTime;
+  Common::Logger::SharedPtr Logger;
+  // Leaf lock: subscriptions call WakeUp under their own locks,
+  // so subscriptions are never called while it is held.
+  mutable std::mutex Mutex;
+  TimerWheel Wheel;
+  std::unordered_map<uint32_t, Entry> Subscriptions;
+  bool Armed = false;
+  uint64_t ArmedTick = 0;
+  bool Stopped = false;
+  PublishJitter Jitter;
+};
+
 
 class SubscriptionServiceInternal : public Server::SubscriptionService
 {
@@ -51,16 +135,58 @@ public:
   virtual std::vector<StatusCode> DeleteSubscriptions(const std::vector<uint32_t> & subscriptions);
   virtual ModifySubscriptionResponse ModifySubscription(const ModifySubscriptionParameters & parameters);
   virtual SubscriptionData CreateSubscription(const CreateSubscriptionRequest & request, std::function<void (PublishResult)> callback);
+  virtual SubscriptionData CreateEncodedSubscription(const CreateSubscriptionRequest & request, std::function<void (const Server::EncodedPublishResult &)> callback);
   virtual std::vector<MonitoredItemCreateResult> CreateMonitoredItems(const MonitoredItemsParameters & params);
   virtual std::vector<StatusCode> DeleteMonitoredItems(const DeleteMonitoredItemsParameters & params);
   virtual void Publish(const PublishRequest & request);
   virtual RepublishResponse Republish(const RepublishParameters & request);
+  virtual RepublishResponse Republish(const NodeId & session, const RepublishParameters & request);
+  virtual StatusCode RepublishEncoded(const NodeId & session, const RepublishParameters & request, Server::EncodedNotificationMessage & message);
+  virtual void SetRetransmissionBudget(std::size_t bytes);
 
   void DeleteAllSubscriptions();
   boost::asio::io_service & GetIOService();
-  bool PopPublishRequest(NodeId node);
+  /// @brief Take a publish request of the session to answer the subscription.
+  /// Without one the subscription waits in line and its PublishLate is called as
+  /// soon as the session sends a request: highest priority first, then in order of arrival.
+  bool PopPublishRequest(const NodeId & session, uint32_t subscriptionId, uint8_t priority);
+  /// @brief Put subscription with notifications left at the end of the line.
+  void RequeuePublish(const NodeId & session, uint32_t subscriptionId, uint8_t priority);
+  /// @brief Give back a publish request taken by PublishLate without anything to send.
+  void ReturnPublishRequest(const NodeId & session);
   void TriggerEvent(NodeId node, Event event);
+  void TriggerEvents(NodeId node, std::vector<Event> events);
   Server::AddressSpace & GetAddressSpace();
+  DataChangeSamplers & GetDataChangeSamplers();
+  void WakeUpSubscription(uint32_t subscriptionId);
+  PublishJitter GetPublishJitter() const;
+  std::size_t GetRetransmissionBudget() const;
+
+private:
+  SubscriptionData AddSubscription(const CreateSubscriptionRequest & request, std::function<void (PublishResult)> callback, std::function<void (const Server::EncodedPublishResult &)> encodedCallback);
+
+private:
+  typedef std::pair<uint32_t, uint32_t> MonitoredItemKey; // SubscriptionId, MonitoredItemId
+
+  void AddEventRoute(const NodeId & node, const MonitoredItemKey & item);
+  void DeleteEventRoute(const MonitoredItemKey & item);
+  void DeleteEventRoutes(uint32_t subscriptionId);
+  /// @brief Source node and the notifiers above it through HasEventSource and HasNotifier references.
+  std::vector<NodeId> GetEventNotifiers(const NodeId & source) const;
+  /// @brief Monitored items of each subscription routed from the notifiers, called under DbMutex.
+  std::map<uint32_t, std::vector<uint32_t>> GetEventRoutes(const std::vector<NodeId> & notifiers) const;
+
+private:
+  struct SessionPublishQueue
+  {
+    uint32_t Requests = 0; // publish requests not answered yet
+    // subscriptions waiting for a publish request in order of arrival,
+    // never waiting while requests are available
+    std::vector<std::pair<uint32_t, uint8_t>> Waiting; // SubscriptionId, Priority
+  };
+
+  // Called under DbMutex.
+  void DispatchPublishRequests(const NodeId & session);
 
 private:
   boost::asio::io_service & io;
@@ -69,7 +195,17 @@ private:
   mutable boost::shared_mutex DbMutex;
   SubscriptionsIdMap SubscriptionsMap; // Map SubscptioinId, SubscriptionData
   uint32_t LastSubscriptionId = 2;
-  std::map<NodeId, uint32_t> PublishRequestQueues;
+  // Leaf lock: subscriptions take publish requests while holding no lock.
+  std::mutex PublishQueuesMutex;
+  std::map<NodeId, SessionPublishQueue> PublishQueues;
+  // Event notifier nodes and monitored items their events are routed to.
+  std::unordered_map<NodeId, std::vector<MonitoredItemKey>> EventRoutes;
+  std::map<MonitoredItemKey, NodeId> EventRouteNodes;
+  // set under DbMutex, read without it so that events nobody monitors are not routed
+  std::atomic<bool> HasEventRoutes{false};
+  std::shared_ptr<PublishScheduler> Scheduler;
+  DataChangeSamplers Samplers;
+  std::atomic<std::size_t> RetransmissionBudget;
 };
 
 
@@ -0,0 +1,168 @@
+/// @brief Hierarchical timer wheel.
+/// @license GNU LGPL
+///
+/// Distributed under the GNU LGPL License
+/// (See accompanying file LICENSE or copy at
+/// http://www.gnu.org/licenses/lgpl.html)
+///
+
+#include "timer_wheel.h"
+
+#include <algorithm>
+
+namespace OpcUa
+{
+namespace Internal
+{
+
+TimerWheel::TimerWheel()
+{
+  LevelSizes.fill(0);
+}
+
+void TimerWheel::Schedule(uint32_t id, uint64_t tick)
+{
+  Timer timer;
+  timer.Id = id;
+  timer.Tick = std::max(tick, Current + 1);
+  Insert(timer);
+  ++Count;
+}
+
+void TimerWheel::Insert(const Timer & timer)
+{
+  // A timer belongs to the lowest level whose whole rotation
+  // contains both the current tick and the timer tick.
+  for (unsigned level = 0; level < LevelsCount; ++level)
+    {
+      const unsigned shift = SlotBits * (level + 1);
+
+      if ((timer.Tick >> shift) == (Current >> shift))
+        {
+          const unsigned slot = (timer.Tick >> (SlotBits * level)) & (SlotsCount - 1);
+          Levels[level][slot].push_back(timer);
+          ++LevelSizes[level];
+          return;
+        }
+    }
+
+  Overflow.push_back(timer);
+  ++LevelSizes[LevelsCount];
+}
+
+void TimerWheel::Cascade(unsigned level)
+{
+  std::vector<Timer> timers;
+
+  if (level < LevelsCount)
+    {
+      const unsigned slot = (Current >> (SlotBits * level)) & (SlotsCount - 1);
+      timers.swap(Levels[level][slot]);
+    }
+
+  else
+    {
+      timers.swap(Overflow);
+    }
+
+  LevelSizes[level] -= timers.size();
+
+  for (const Timer & timer : timers)
+    {
+      Insert(timer);
+    }
+}
+
+uint64_t TimerWheel::GetNextCascade() const
+{
+  // Nothing happens before the next rotation of the lowest non empty level.
+  unsigned level = 0;
+
+  while (level < LevelsCount && LevelSizes[level] == 0)
+    {
+      ++level;
+    }
+
+  const unsigned shift = SlotBits * level;
+  return level == 0 ? Current + 1 : ((Current >> shift) + 1) << shift;
+}
+
+std::vector<TimerWheel::Timer> TimerWheel::Advance(uint64_t tick)
+{
+  std::vector<Timer> expired;
+
+  while (Current < tick)
+    {
+      if (Count == 0)
+        {
+          Current = tick;
+          break;
+        }
+
+      Current = std::min(GetNextCascade(), tick);
+
+      // Higher levels first: they cascade into the slots of lower ones.
+      for (unsigned level = LevelsCount; level > 0; --level)
+        {
+          const uint64_t mask = (uint64_t(1) << (SlotBits * level)) - 1;
+
+          if ((Current & mask) == 0)
+            {
+              Cascade(level);
+            }
+        }
+
+      std::vector<Timer> & slot = Levels[0][Current & (SlotsCount - 1)];
+      expired.insert(expired.end(), slot.begin(), slot.end());
+      Count -= slot.size();
+      LevelSizes[0] -= slot.size();
+      slot.clear();
+    }
+
+  return expired;
+}
+
+uint64_t TimerWheel::GetNextExpiry() const
+{
+  const auto byTick = [](const Timer & left, const Timer & right) { return left.Tick < right.Tick; };
+
+  // Every timer of a level expires before timers of higher levels,
+  // and slots of a level which are behind the current tick are empty.
+  for (unsigned level = 0; level < LevelsCount; ++level)
+    {
+      if (LevelSizes[level] == 0)
+        {
+          continue;
+        }
+
+      for (unsigned slot = (Current >> (SlotBits * level)) & (SlotsCount - 1); slot < SlotsCount; ++slot)
+        {
+          const std::vector<Timer> & timers = Levels[level][slot];
+
+          if (!timers.empty())
+            {
+              return std::min_element(timers.begin(), timers.end(), byTick)->Tick;
+            }
+        }
+    }
+
+  return std::min_element(Overflow.begin(), Overflow.end(), byTick)->Tick;
+}
+
+uint64_t TimerWheel::GetCurrentTick() const
+{
+  return Current;
+}
+
+std::size_t TimerWheel::Size() const
+{
+  return Count;
+}
+
+bool TimerWheel::Empty() const
+{
+  return Count == 0;
+}
+
+}
+}
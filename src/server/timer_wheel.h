@@ -0,0 +1,76 @@
+/// @brief Hierarchical timer wheel.
+/// @license GNU LGPL
+///
+/// Distributed under the GNU LGPL License
+/// (See accompanying file LICENSE or copy at
+/// http://www.gnu.org/licenses/lgpl.html)
+///
+
+#pragma once
+
+#include <array>
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+namespace OpcUa
+{
+namespace Internal
+{
+
+/// @brief Hierarchical timer wheel counting time in ticks.
+/// Level N has 64 slots of 64^N ticks each. Timers are put into the level
+/// matching their distance from the current tick and cascade to lower levels
+/// as time advances, so scheduling and expiring cost the same for thousands of timers.
+/// Not thread safe.
+class TimerWheel
+{
+public:
+  struct Timer
+  {
+    uint32_t Id;
+    uint64_t Tick;
+  };
+
+public:
+  TimerWheel();
+
+  /// @brief Schedule timer with id to expire at tick.
+  /// Ticks which are already passed expire at the next tick.
+  /// Scheduling the same id twice creates two timers.
+  void Schedule(uint32_t id, uint64_t tick);
+
+  /// @brief Advance current tick up to tick.
+  /// @return timers expired on the way ordered by their ticks.
+  std::vector<Timer> Advance(uint64_t tick);
+
+  /// @brief Tick of the earliest timer, empty slots are skipped.
+  /// Must not be called on an empty wheel.
+  uint64_t GetNextExpiry() const;
+
+  uint64_t GetCurrentTick() const;
+  std::size_t Size() const;
+  bool Empty() const;
+
+private:
+  void Insert(const Timer & timer);
+  void Cascade(unsigned level);
+  uint64_t GetNextCascade() const;
+
+private:
+  static const unsigned SlotBits = 6;
+  static const unsigned SlotsCount = 1 << SlotBits;
+  static const unsigned LevelsCount = 4;
+
+  typedef std::array<std::vector<Timer>, SlotsCount> Level;
+  std::array<Level, LevelsCount> Levels;
+  // timers too far in the future for the highest level
+  std::vector<Timer> Overflow;
+  // timers in each level, the last one counts overflow
+  std::array<std::size_t, LevelsCount + 1> LevelSizes;
+  uint64_t Current = 0;
+  std::size_t Count = 0;
+};
+
+}
+}
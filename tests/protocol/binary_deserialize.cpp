@@ -620,10 +620,10 @@ TEST_F(OpcUaBinaryDeserialization, AdditionalHeader)
   GetStream() >> header;
 
   ASSERT_EQ(header.TypeId.Encoding, uint8_t(EV_STRING | EV_NAMESPACE_URI_FLAG | EV_Server_INDEX_FLAG));
-  ASSERT_EQ(header.TypeId.StringData.NamespaceIndex, 0x1);
-  ASSERT_EQ(header.TypeId.StringData.Identifier, "id");
-  ASSERT_EQ(header.TypeId.NamespaceURI, "uri");
-  ASSERT_EQ(header.TypeId.ServerIndex, 1);
+  ASSERT_EQ(header.TypeId.GetNamespaceIndex(), 0x1);
+  ASSERT_EQ(header.TypeId.GetStringIdentifier(), "id");
+  ASSERT_EQ(header.TypeId.GetNamespaceURI(), "uri");
+  ASSERT_EQ(header.TypeId.GetServerIndex(), 1);
   ASSERT_EQ(header.Encoding, 1);
 
   ASSERT_EQ(expectedData.size(), Binary::RawSize(header));
@@ -1057,3 +1057,115 @@ TEST_F(OpcUaBinaryDeserialization, IntegerId)
   ASSERT_EQ(id, 5);
 }
 
+
+//-------------------------------------------------------------------
+// Decoding from contiguous buffer
+//-------------------------------------------------------------------
+
+TEST(OpcUaBinaryBufferDeserialization, DecodesInPlace)
+{
+  using namespace OpcUa;
+  using namespace OpcUa::Binary;
+
+  const std::vector<char> expectedData =
+  {
+    1, 0,
+    4, 0, 0, 0, 'n', 'a', 'm', 'e',
+    5, 0, 0, 0
+  };
+
+  IStreamBinary stream(&expectedData[0], expectedData.size());
+
+  QualifiedName name;
+  uint32_t number = 0;
+  stream >> name >> number;
+
+  ASSERT_EQ(name.NamespaceIndex, 1);
+  ASSERT_EQ(name.Name, "name");
+  ASSERT_EQ(number, 5);
+  ASSERT_EQ(stream.GetRemainSize(), 0);
+}
+
+TEST(OpcUaBinaryBufferDeserialization, ReportsRemainSize)
+{
+  using namespace OpcUa::Binary;
+
+  const std::vector<char> expectedData = {1, 2, 3, 4, 5};
+  IStreamBinary stream(&expectedData[0], expectedData.size());
+
+  uint16_t word = 0;
+  stream >> word;
+
+  ASSERT_EQ(word, 0x0201);
+  ASSERT_EQ(stream.GetRemainSize(), 3);
+}
+
+TEST_F(OpcUaBinaryDeserialization, UInt32ArrayLargerThanBlock)
+{
+  // 160000 bytes, read in 64k blocks
+  const uint32_t count = 40000;
+  std::vector<char> serializedData = {0x40, (char)0x9c, 0, 0};
+
+  for (uint32_t i = 0; i < count; ++i)
+    {
+      const uint32_t value = i * 0x01020304;
+
+      for (int byte = 0; byte < 4; ++byte)
+        {
+          serializedData.push_back(static_cast<char>(value >> (8 * byte)));
+        }
+    }
+
+  GetChannel().SetData(serializedData);
+
+  std::vector<uint32_t> values;
+  GetStream() >> values;
+
+  ASSERT_EQ(values.size(), count);
+
+  for (uint32_t i = 0; i < count; ++i)
+    {
+      ASSERT_EQ(values[i], i * 0x01020304) << "index " << i;
+    }
+}
+
+TEST(OpcUaBinaryBufferDeserialization, ThrowsOnBufferOverrun)
+{
+  using namespace OpcUa::Binary;
+
+  const std::vector<char> expectedData = {1, 2, 3};
+  IStreamBinary stream(&expectedData[0], expectedData.size());
+
+  uint32_t dword = 0;
+  ASSERT_THROW(stream >> dword, std::logic_error);
+}
+
+TEST(OpcUaBinaryBufferDeserialization, ThrowsOnStringLongerThanBuffer)
+{
+  using namespace OpcUa::Binary;
+
+  // length of almost 4 GB followed by two bytes
+  const std::vector<char> expectedData = {-2, -1, -1, -1, 'a', 'b'};
+
+  IStreamBinary stringStream(&expectedData[0], expectedData.size());
+  std::string str;
+  ASSERT_THROW(stringStream >> str, std::logic_error);
+
+  IStreamBinary byteStream(&expectedData[0], expectedData.size());
+  OpcUa::ByteString bytes;
+  ASSERT_THROW(byteStream >> bytes, std::logic_error);
+}
+
+TEST(OpcUaBinaryBufferDeserialization, ThrowsOnArrayLongerThanBuffer)
+{
+  using namespace OpcUa::Binary;
+
+  // 0x7fffffff doubles followed by one
+  const std::vector<char> expectedData = {-1, -1, -1, 0x7f, 0, 0, 0, 0, 0, 0, -16, 0x3f};
+  IStreamBinary stream(&expectedData[0], expectedData.size());
+
+  std::vector<double> values;
+  ASSERT_THROW(stream >> values, std::logic_error);
+  // storage grows by 64k blocks, the declared size is never allocated
+  ASSERT_LE(values.capacity() * sizeof(double), 65536);
+}
@@ -372,6 +372,23 @@ TEST_F(OpcUaBinarySerialization, SecureMessageHeader)
   ASSERT_EQ(expectedData.size(), RawSize(hdr));
 }
 
+TEST_F(OpcUaBinarySerialization, SecureMessageHeaderWithBackPatchedSize)
+{
+  OpcUa::Binary::SecureHeader hdr(OpcUa::Binary::MT_SECURE_MESSAGE, OpcUa::Binary::CHT_SINGLE, 0x1);
+  const uint32_t body = 0x05060708;
+
+  const std::vector<char> expectedData =
+  {
+    'M', 'S', 'G',
+    'F',
+    16, 0, 0, 0,
+    1, 0, 0, 0,
+    8, 7, 6, 5
+  };
+  GetStream() << begin_message << hdr << body << flush;
+  ASSERT_EQ(expectedData, GetChannel().SerializedData);
+}
+
 
 //---------------------------------------------------------
 // Hello
@@ -527,11 +544,9 @@ TEST_F(OpcUaBinarySerialization, AdditionalHeader)
   using namespace OpcUa;
   using namespace OpcUa::Binary;
   AdditionalHeader header;
-  header.TypeId.Encoding = static_cast<NodeIdEncoding>(EV_STRING | EV_NAMESPACE_URI_FLAG | EV_Server_INDEX_FLAG);
-  header.TypeId.StringData.NamespaceIndex = 0x1;
-  header.TypeId.StringData.Identifier = "id";
-  header.TypeId.NamespaceURI = "uri";
-  header.TypeId.ServerIndex = 1;
+  header.TypeId = StringNodeId("id", 0x1);
+  header.TypeId.SetNamespaceURI("uri");
+  header.TypeId.SetServerIndex(1);
   header.Encoding = 1;
 
   const std::vector<char> expectedData =
@@ -112,6 +112,52 @@ TEST_F(OpcUaBinarySerialization, Variant_BOOLEAN_DIMENSIONS)
   ASSERT_EQ(expectedData, GetChannel().SerializedData) << PrintData(GetChannel().SerializedData) << std::endl << PrintData(expectedData);
 }
 
+TEST_F(OpcUaBinarySerialization, Variant_DOUBLE_Array)
+{
+
+  using namespace OpcUa;
+  using namespace OpcUa::Binary;
+
+  Variant var = std::vector<double> {1200000, 1200000};
+
+  GetStream() << var << flush;
+
+  char encodingMask = static_cast<uint8_t>(VariantType::DOUBLE) | HAS_ARRAY_MASK;
+  const std::vector<char> expectedData =
+  {
+    encodingMask,
+    2, 0, 0, 0,
+    0, 0, 0, 0, (char)0x80, (char)0x4f, (char)0x32, (char)0x41, // 1200000
+    0, 0, 0, 0, (char)0x80, (char)0x4f, (char)0x32, (char)0x41  // 1200000
+  };
+
+  ASSERT_EQ(expectedData.size(), RawSize(var));
+  ASSERT_EQ(expectedData, GetChannel().SerializedData) << PrintData(GetChannel().SerializedData) << std::endl << PrintData(expectedData);
+}
+
+TEST_F(OpcUaBinarySerialization, Variant_INT16_Array)
+{
+
+  using namespace OpcUa;
+  using namespace OpcUa::Binary;
+
+  Variant var = std::vector<int16_t> {1, -2};
+
+  GetStream() << var << flush;
+
+  char encodingMask = static_cast<uint8_t>(VariantType::INT16) | HAS_ARRAY_MASK;
+  const std::vector<char> expectedData =
+  {
+    encodingMask,
+    2, 0, 0, 0,
+    1, 0,
+    -2, -1
+  };
+
+  ASSERT_EQ(expectedData.size(), RawSize(var));
+  ASSERT_EQ(expectedData, GetChannel().SerializedData) << PrintData(GetChannel().SerializedData) << std::endl << PrintData(expectedData);
+}
+
 
 //-------------------------------------------------------
 // Deserialization
@@ -1830,3 +1876,49 @@ TEST(Variant, Comparable)
   ASSERT_NE(OpcUa::Variant(true), OpcUa::Variant(false));
   ASSERT_NE(OpcUa::Variant(true), false);
 }
+
+TEST(Variant, CopyAndMoveKeepValue)
+{
+  OpcUa::Variant var(std::vector<std::string> {"1", "2"});
+  const OpcUa::Variant copy(var);
+  ASSERT_EQ(copy, var);
+
+  const OpcUa::Variant moved(std::move(var));
+  ASSERT_EQ(moved.Type(), OpcUa::VariantType::STRING);
+  ASSERT_TRUE(moved.IsArray());
+  ASSERT_EQ(moved, copy);
+  ASSERT_TRUE(var.IsNul());
+}
+
+TEST(Variant, ReassignChangesType)
+{
+  OpcUa::Variant var(std::string("string"));
+  var = 1.5;
+  ASSERT_EQ(var.Type(), OpcUa::VariantType::DOUBLE);
+  ASSERT_EQ(var.As<double>(), 1.5);
+
+  var = OpcUa::LocalizedText("text");
+  ASSERT_EQ(var.Type(), OpcUa::VariantType::LOCALIZED_TEXT);
+  ASSERT_EQ(var.As<OpcUa::LocalizedText>(), OpcUa::LocalizedText("text"));
+}
+
+TEST(Variant, ThrowsIfCastToOtherType)
+{
+  const OpcUa::Variant var(int32_t(1));
+  ASSERT_THROW(var.As<uint32_t>(), std::bad_cast);
+  ASSERT_THROW(var.As<std::vector<int32_t>>(), std::bad_cast);
+  ASSERT_THROW(OpcUa::Variant().As<int32_t>(), std::bad_cast);
+}
+
+TEST(Variant, DifferentTypesAreNotEqual)
+{
+  ASSERT_NE(OpcUa::Variant(int32_t(1)), OpcUa::Variant(uint32_t(1)));
+  ASSERT_NE(OpcUa::Variant(int32_t(1)), OpcUa::Variant(std::vector<int32_t> {1}));
+  ASSERT_NE(OpcUa::Variant(int32_t(1)), OpcUa::Variant());
+}
+
+TEST(Variant, SByteToString)
+{
+  const OpcUa::Variant var(int8_t('a'));
+  ASSERT_EQ(var.ToString(), "a");
+}
@@ -31,8 +31,8 @@ TEST(NodeId, DefaultConstructor)
   NodeId id;
   ASSERT_EQ(id.Encoding, EV_TWO_BYTE);
   ASSERT_EQ(id.TwoByteData.Identifier, 0);
-  ASSERT_EQ(id.ServerIndex, 0);
-  ASSERT_EQ(id.NamespaceURI, std::string());
+  ASSERT_EQ(id.GetServerIndex(), 0);
+  ASSERT_EQ(id.GetNamespaceURI(), std::string());
 }
 
 TEST(NodeId, NumericConstructor)
@@ -56,8 +56,8 @@ TEST(Node, ConstructFromMessageId)
   NodeId id(ACTIVATE_SESSION_REQUEST);
   ASSERT_EQ(id.Encoding, EV_FOUR_BYTE);
   ASSERT_EQ(id.FourByteData.Identifier, ACTIVATE_SESSION_REQUEST);
-  ASSERT_EQ(id.ServerIndex, 0);
-  ASSERT_EQ(id.NamespaceURI, std::string());
+  ASSERT_EQ(id.GetServerIndex(), 0);
+  ASSERT_EQ(id.GetNamespaceURI(), std::string());
 }
 
 TEST(Node, ConstructFromReferenceId)
@@ -65,8 +65,8 @@ TEST(Node, ConstructFromReferenceId)
   NodeId id(ReferenceId::HasChild);
   ASSERT_EQ(id.Encoding, EV_NUMERIC);
   ASSERT_EQ(id.NumericData.Identifier, static_cast<uint16_t>(ReferenceId::HasChild));
-  ASSERT_EQ(id.ServerIndex, 0);
-  ASSERT_EQ(id.NamespaceURI, std::string());
+  ASSERT_EQ(id.GetServerIndex(), 0);
+  ASSERT_EQ(id.GetNamespaceURI(), std::string());
 }
 
 TEST(Node, EqualIfSameType)
@@ -199,8 +199,31 @@ TEST_F(NodeDeserialization, String)
   GetStream() >> id;
 
   ASSERT_EQ(id.Encoding, EV_STRING);
-  ASSERT_EQ(id.StringData.NamespaceIndex, 0x1);
-  ASSERT_EQ(id.StringData.Identifier, "id");
+  ASSERT_EQ(id.GetNamespaceIndex(), 0x1);
+  ASSERT_EQ(id.GetStringIdentifier(), "id");
+}
+
+TEST_F(NodeDeserialization, NumericOverString)
+{
+  using namespace OpcUa;
+
+  const std::vector<char> expectedData =
+  {
+    EV_NUMERIC,
+    1, 0,
+    2, 0, 0, 0
+  };
+
+  GetChannel().SetData(expectedData);
+
+  NodeId id = StringNodeId("id", 3);
+  id.SetNamespaceURI("uri");
+  GetStream() >> id;
+
+  ASSERT_EQ(id.Encoding, EV_NUMERIC);
+  ASSERT_EQ(id.GetNamespaceIndex(), 0x1);
+  ASSERT_EQ(id.GetIntegerIdentifier(), 2);
+  ASSERT_FALSE(id.HasNamespaceURI());
 }
 
 TEST_F(NodeDeserialization, Guid)
@@ -221,9 +244,9 @@ TEST_F(NodeDeserialization, Guid)
   GetStream() >> id;
 
   ASSERT_EQ(id.Encoding, EV_BYTE_STRING);
-  ASSERT_EQ(id.BinaryData.NamespaceIndex, 0x1);
+  ASSERT_EQ(id.GetNamespaceIndex(), 0x1);
   std::vector<uint8_t> expectedBytes = {1, 2, 3, 4};
-  ASSERT_EQ(id.BinaryData.Identifier, expectedBytes);
+  ASSERT_EQ(id.GetBinaryIdentifier(), expectedBytes);
 }
 
 TEST_F(NodeDeserialization, ByteString)
@@ -246,18 +269,18 @@ TEST_F(NodeDeserialization, ByteString)
   GetStream() >> id;
 
   ASSERT_EQ(id.Encoding, EV_GUId);
-  ASSERT_EQ(id.GuidData.NamespaceIndex, 0x1);
-  ASSERT_EQ(id.GuidData.Identifier.Data1, 0x01020304);
-  ASSERT_EQ(id.GuidData.Identifier.Data2, 0x0506);
-  ASSERT_EQ(id.GuidData.Identifier.Data3, 0x0708);
-  ASSERT_EQ(id.GuidData.Identifier.Data4[0], 0x01);
-  ASSERT_EQ(id.GuidData.Identifier.Data4[1], 0x02);
-  ASSERT_EQ(id.GuidData.Identifier.Data4[2], 0x03);
-  ASSERT_EQ(id.GuidData.Identifier.Data4[3], 0x04);
-  ASSERT_EQ(id.GuidData.Identifier.Data4[4], 0x05);
-  ASSERT_EQ(id.GuidData.Identifier.Data4[5], 0x06);
-  ASSERT_EQ(id.GuidData.Identifier.Data4[6], 0x07);
-  ASSERT_EQ(id.GuidData.Identifier.Data4[7], 0x08);
+  ASSERT_EQ(id.GetNamespaceIndex(), 0x1);
+  ASSERT_EQ(id.GetGuidIdentifier().Data1, 0x01020304);
+  ASSERT_EQ(id.GetGuidIdentifier().Data2, 0x0506);
+  ASSERT_EQ(id.GetGuidIdentifier().Data3, 0x0708);
+  ASSERT_EQ(id.GetGuidIdentifier().Data4[0], 0x01);
+  ASSERT_EQ(id.GetGuidIdentifier().Data4[1], 0x02);
+  ASSERT_EQ(id.GetGuidIdentifier().Data4[2], 0x03);
+  ASSERT_EQ(id.GetGuidIdentifier().Data4[3], 0x04);
+  ASSERT_EQ(id.GetGuidIdentifier().Data4[4], 0x05);
+  ASSERT_EQ(id.GetGuidIdentifier().Data4[5], 0x06);
+  ASSERT_EQ(id.GetGuidIdentifier().Data4[6], 0x07);
+  ASSERT_EQ(id.GetGuidIdentifier().Data4[7], 0x08);
 }
 
 TEST_F(NodeDeserialization, NamespaceUri)
@@ -280,9 +303,9 @@ TEST_F(NodeDeserialization, NamespaceUri)
   GetStream() >> id;
 
   ASSERT_EQ(id.Encoding, uint8_t(EV_STRING | EV_NAMESPACE_URI_FLAG));
-  ASSERT_EQ(id.StringData.NamespaceIndex, 0x1);
-  ASSERT_EQ(id.StringData.Identifier, "id");
-  ASSERT_EQ(id.NamespaceURI, "uri");
+  ASSERT_EQ(id.GetNamespaceIndex(), 0x1);
+  ASSERT_EQ(id.GetStringIdentifier(), "id");
+  ASSERT_EQ(id.GetNamespaceURI(), "uri");
 }
 
 TEST_F(NodeDeserialization, ServerIndexFlag)
@@ -304,9 +327,9 @@ TEST_F(NodeDeserialization, ServerIndexFlag)
   GetStream() >> id;
 
   ASSERT_EQ(id.Encoding, uint8_t(EV_STRING | EV_Server_INDEX_FLAG));
-  ASSERT_EQ(id.StringData.NamespaceIndex, 0x1);
-  ASSERT_EQ(id.StringData.Identifier, "id");
-  ASSERT_EQ(id.ServerIndex, 1);
+  ASSERT_EQ(id.GetNamespaceIndex(), 0x1);
+  ASSERT_EQ(id.GetStringIdentifier(), "id");
+  ASSERT_EQ(id.GetServerIndex(), 1);
 }
 
 TEST_F(NodeDeserialization, NamespaceUriAndServerIndex)
@@ -330,10 +353,10 @@ TEST_F(NodeDeserialization, NamespaceUriAndServerIndex)
   GetStream() >> id;
 
   ASSERT_EQ(id.Encoding, uint8_t(EV_STRING | EV_NAMESPACE_URI_FLAG | EV_Server_INDEX_FLAG));
-  ASSERT_EQ(id.StringData.NamespaceIndex, 0x1);
-  ASSERT_EQ(id.StringData.Identifier, "id");
-  ASSERT_EQ(id.NamespaceURI, "uri");
-  ASSERT_EQ(id.ServerIndex, 1);
+  ASSERT_EQ(id.GetNamespaceIndex(), 0x1);
+  ASSERT_EQ(id.GetStringIdentifier(), "id");
+  ASSERT_EQ(id.GetNamespaceURI(), "uri");
+  ASSERT_EQ(id.GetServerIndex(), 1);
 }
 
 //---------------------------------------------------------
@@ -408,10 +431,7 @@ TEST_F(NodeSerialization, String)
 {
   using namespace OpcUa;
   using namespace OpcUa::Binary;
-  NodeId id;
-  id.Encoding = EV_STRING;
-  id.StringData.NamespaceIndex = 0x1;
-  id.StringData.Identifier = "id";
+  NodeId id = StringNodeId("id", 0x1);
 
   const std::vector<char> expectedData =
   {
@@ -431,10 +451,7 @@ TEST_F(NodeSerialization, ByteString)
 {
   using namespace OpcUa;
   using namespace OpcUa::Binary;
-  NodeId id;
-  id.Encoding = EV_BYTE_STRING;
-  id.BinaryData.NamespaceIndex = 0x1;
-  id.BinaryData.Identifier = {1, 2, 3, 4};
+  NodeId id = BinaryNodeId({1, 2, 3, 4}, 0x1);
 
   const std::vector<char> expectedData =
   {
@@ -454,20 +471,19 @@ TEST_F(NodeSerialization, Guid)
 {
   using namespace OpcUa;
   using namespace OpcUa::Binary;
-  NodeId id;
-  id.Encoding = EV_GUId;
-  id.GuidData.NamespaceIndex = 0x1;
-  id.GuidData.Identifier.Data1 = 0x01020304;
-  id.GuidData.Identifier.Data2 = 0x0506;
-  id.GuidData.Identifier.Data3 = 0x0708;
-  id.GuidData.Identifier.Data4[0] = 0x01;
-  id.GuidData.Identifier.Data4[1] = 0x02;
-  id.GuidData.Identifier.Data4[2] = 0x03;
-  id.GuidData.Identifier.Data4[3] = 0x04;
-  id.GuidData.Identifier.Data4[4] = 0x05;
-  id.GuidData.Identifier.Data4[5] = 0x06;
-  id.GuidData.Identifier.Data4[6] = 0x07;
-  id.GuidData.Identifier.Data4[7] = 0x08;
+  Guid guid;
+  guid.Data1 = 0x01020304;
+  guid.Data2 = 0x0506;
+  guid.Data3 = 0x0708;
+  guid.Data4[0] = 0x01;
+  guid.Data4[1] = 0x02;
+  guid.Data4[2] = 0x03;
+  guid.Data4[3] = 0x04;
+  guid.Data4[4] = 0x05;
+  guid.Data4[5] = 0x06;
+  guid.Data4[6] = 0x07;
+  guid.Data4[7] = 0x08;
+  NodeId id = GuidNodeId(guid, 0x1);
 
   const std::vector<char> expectedData =
   {
@@ -489,11 +505,8 @@ TEST_F(NodeSerialization, NamespaceUri)
 {
   using namespace OpcUa;
   using namespace OpcUa::Binary;
-  ExpandedNodeId id;
-  id.Encoding = static_cast<NodeIdEncoding>(EV_STRING | EV_NAMESPACE_URI_FLAG);
-  id.StringData.NamespaceIndex = 0x1;
-  id.StringData.Identifier = "id";
-  id.NamespaceURI = "uri";
+  ExpandedNodeId id = StringNodeId("id", 0x1);
+  id.SetNamespaceURI("uri");
 
   const std::vector<char> expectedData =
   {
@@ -515,11 +528,8 @@ TEST_F(NodeSerialization, ServerIndexFlag)
 {
   using namespace OpcUa;
   using namespace OpcUa::Binary;
-  ExpandedNodeId id;
-  id.Encoding = static_cast<NodeIdEncoding>(EV_STRING | EV_Server_INDEX_FLAG);
-  id.StringData.NamespaceIndex = 0x1;
-  id.StringData.Identifier = "id";
-  id.ServerIndex = 1;
+  ExpandedNodeId id = StringNodeId("id", 0x1);
+  id.SetServerIndex(1);
 
   const std::vector<char> expectedData =
   {
@@ -540,12 +550,9 @@ TEST_F(NodeSerialization, NamespaceUriAndServerIndex)
 {
   using namespace OpcUa;
   using namespace OpcUa::Binary;
-  ExpandedNodeId id;
-  id.Encoding = static_cast<NodeIdEncoding>(EV_STRING | EV_NAMESPACE_URI_FLAG | EV_Server_INDEX_FLAG);
-  id.StringData.NamespaceIndex = 0x1;
-  id.StringData.Identifier = "id";
-  id.NamespaceURI = "uri";
-  id.ServerIndex = 1;
+  ExpandedNodeId id = StringNodeId("id", 0x1);
+  id.SetNamespaceURI("uri");
+  id.SetServerIndex(1);
 
   const std::vector<char> expectedData =
   {
@@ -693,3 +700,57 @@ TEST(NodeId, SettingNamespaceUri_And_Index)
   ASSERT_TRUE(node.HasNamespaceURI());
   ASSERT_TRUE(node.HasServerIndex());
 }
+
+TEST(NodeId, IsCompact)
+{
+  ASSERT_LE(sizeof(NodeId), 4 * sizeof(void *));
+}
+
+TEST(NodeId, CopyAndMoveStringId)
+{
+  NodeId node = StringNodeId("id", 2);
+  node.SetNamespaceURI("uri");
+
+  const NodeId copy(node);
+  ASSERT_EQ(copy.GetStringIdentifier(), "id");
+  ASSERT_EQ(copy.GetNamespaceIndex(), 2);
+  ASSERT_EQ(copy.GetNamespaceURI(), "uri");
+
+  const NodeId moved(std::move(node));
+  ASSERT_EQ(moved, copy);
+  ASSERT_EQ(moved.GetNamespaceURI(), "uri");
+}
+
+TEST(NodeId, AssignOtherEncoding)
+{
+  NodeId node = StringNodeId("id", 2);
+  node = NumericNodeId(5, 1);
+  ASSERT_EQ(node.Encoding, EV_NUMERIC);
+  ASSERT_EQ(node.GetIntegerIdentifier(), 5);
+  ASSERT_EQ(node.GetNamespaceIndex(), 1);
+
+  node = BinaryNodeId({1, 2}, 3);
+  ASSERT_EQ(node.Encoding, EV_BYTE_STRING);
+  ASSERT_EQ(node.GetBinaryIdentifier(), std::vector<uint8_t>({1, 2}));
+  ASSERT_EQ(node.GetNamespaceIndex(), 3);
+  ASSERT_FALSE(node.HasNamespaceURI());
+}
+
+TEST(NodeId, CopyFourByteId)
+{
+  const NodeId node = FourByteNodeId(0x1234, 5);
+  const NodeId copy(node);
+  ASSERT_EQ(copy.Encoding, EV_FOUR_BYTE);
+  ASSERT_EQ(copy.GetIntegerIdentifier(), 0x1234);
+  ASSERT_EQ(copy.GetNamespaceIndex(), 5);
+}
+
+TEST(NodeId, HashIsConsistentWithEquality)
+{
+  const std::hash<NodeId> hash;
+  ASSERT_EQ(hash(TwoByteNodeId(5)), hash(NumericNodeId(5)));
+  ASSERT_EQ(hash(FourByteNodeId(5, 1)), hash(NumericNodeId(5, 1)));
+  ASSERT_EQ(hash(StringNodeId("id", 1)), hash(NodeId("id", 1)));
+  ASSERT_NE(hash(NumericNodeId(5, 1)), hash(NumericNodeId(5, 2)));
+  ASSERT_NE(hash(StringNodeId("id", 1)), hash(StringNodeId("di", 1)));
+}
@@ -27,6 +27,9 @@
 #include <gmock/gmock.h>
 #include <gtest/gtest.h>
 
+#include <future>
+#include <thread>
+
 using namespace testing;
 
 class AddressSpace : public Test
@@ -87,6 +90,29 @@ TEST_F(AddressSpace, GeneratesIfNodeIdDuplicated)
   EXPECT_EQ(result.AddedNodeId, OpcUa::ObjectId::Null);
 }
 
+TEST_F(AddressSpace, RejectsInvalidAttributeIds)
+{
+  OpcUa::AddNodesItem newNode;
+  newNode.BrowseName.Name = "newNode";
+  newNode.RequestedNewNodeId = OpcUa::NumericNodeId(5000, 1);
+  newNode.Attributes = OpcUa::ObjectAttributes();
+  newNode.Attributes.Attributes[static_cast<OpcUa::AttributeId>(100)] = OpcUa::Variant(1);
+  std::vector<OpcUa::AddNodesResult> results = NameSpace->AddNodes({newNode});
+  ASSERT_EQ(results.size(), 1u);
+  EXPECT_EQ(results[0].Status, OpcUa::StatusCode::BadAttributeIdInvalid);
+
+  // the node is not added
+  OpcUa::ReadParameters readParams;
+  readParams.AttributesToRead.push_back(ToReadValueId(OpcUa::NumericNodeId(5000, 1), OpcUa::AttributeId::BrowseName));
+  EXPECT_EQ(NameSpace->Read(readParams).at(0).Status, OpcUa::StatusCode::BadNotReadable);
+
+  OpcUa::WriteValue value;
+  value.NodeId = CreateValue();
+  value.AttributeId = static_cast<OpcUa::AttributeId>(100);
+  value.Value = OpcUa::DataValue(1);
+  EXPECT_EQ(NameSpace->Write({value}), std::vector<OpcUa::StatusCode>(1, OpcUa::StatusCode::BadAttributeIdInvalid));
+}
+
 TEST_F(AddressSpace, ReadAttributes)
 {
   OpcUa::ReadParameters readParams;
@@ -99,6 +125,17 @@ TEST_F(AddressSpace, ReadAttributes)
   EXPECT_EQ(result.Value, OpcUa::QualifiedName(OpcUa::Names::Root));
 }
 
+TEST_F(AddressSpace, ReadMissingAttribute)
+{
+  OpcUa::ReadParameters readParams;
+  readParams.AttributesToRead.push_back(ToReadValueId(OpcUa::ObjectId::RootFolder, OpcUa::AttributeId::Value));
+  readParams.AttributesToRead.push_back(ToReadValueId(OpcUa::ObjectId::RootFolder, OpcUa::AttributeId::Unknown));
+  std::vector<OpcUa::DataValue> results = NameSpace->Read(readParams);
+  ASSERT_EQ(results.size(), 2);
+  EXPECT_EQ(results[0].Status, OpcUa::StatusCode::BadNotReadable);
+  EXPECT_EQ(results[1].Status, OpcUa::StatusCode::BadNotReadable);
+}
+
 TEST_F(AddressSpace, CallsDataChangeCallbackOnWrite)
 {
   OpcUa::NodeId valueId = CreateValue();
@@ -135,6 +172,248 @@ TEST_F(AddressSpace, CallsDataChangeCallbackOnWrite)
   ASSERT_FALSE(callbackCalled);
 }
 
+TEST_F(AddressSpace, WriteDoesNotBlockReadOfOtherNodes)
+{
+  OpcUa::NodeId valueId = CreateValue();
+  std::promise<void> callbackEntered;
+  std::promise<void> releaseCallback;
+  std::shared_future<void> released = releaseCallback.get_future().share();
+  NameSpace->AddDataChangeCallback(valueId, OpcUa::AttributeId::Value, [&](const OpcUa::NodeId &, OpcUa::AttributeId, const OpcUa::DataValue &)
+  {
+    callbackEntered.set_value();
+    released.wait();
+  });
+
+  OpcUa::WriteValue value;
+  value.AttributeId = OpcUa::AttributeId::Value;
+  value.NodeId = valueId;
+  value.Value = 10;
+  std::future<std::vector<OpcUa::StatusCode>> written = std::async(std::launch::async, [&]()
+  {
+    return NameSpace->Write({value});
+  });
+  callbackEntered.get_future().wait();
+
+  // the writer is delivering its callback, reads do not wait for it
+  std::future<std::vector<OpcUa::DataValue>> read = std::async(std::launch::async, [&]()
+  {
+    OpcUa::ReadParameters readParams;
+    readParams.AttributesToRead.push_back(ToReadValueId(OpcUa::ObjectId::RootFolder, OpcUa::AttributeId::BrowseName));
+    return NameSpace->Read(readParams);
+  });
+  const std::future_status status = read.wait_for(std::chrono::seconds(5));
+  releaseCallback.set_value();
+
+  ASSERT_EQ(status, std::future_status::ready);
+  const std::vector<OpcUa::DataValue> values = read.get();
+  ASSERT_EQ(values.size(), 1);
+  EXPECT_EQ(values[0].Value, OpcUa::QualifiedName(OpcUa::Names::Root));
+  EXPECT_EQ(written.get(), std::vector<OpcUa::StatusCode>(1, OpcUa::StatusCode::Good));
+}
+
+TEST_F(AddressSpace, ReadsValuesWrittenConcurrently)
+{
+  OpcUa::NodeId valueId = CreateValue();
+  const int32_t count = 2000;
+
+  std::future<void> writer = std::async(std::launch::async, [&]()
+  {
+    for (int32_t i = 1; i <= count; ++i)
+      {
+        OpcUa::WriteValue value;
+        value.AttributeId = OpcUa::AttributeId::Value;
+        value.NodeId = valueId;
+        value.Value = i;
+        NameSpace->Write({value});
+      }
+  });
+
+  OpcUa::ReadParameters readParams;
+  readParams.AttributesToRead.push_back(OpcUa::ToReadValueId(valueId, OpcUa::AttributeId::Value));
+  int32_t last = 0;
+
+  while (last != count)
+    {
+      const std::vector<OpcUa::DataValue> result = NameSpace->Read(readParams);
+      ASSERT_EQ(result.size(), 1);
+
+      if (result[0].Value.IsNul())
+        {
+          continue;
+        }
+
+      // every read sees a complete value which is never older than the previous one
+      const int32_t current = result[0].Value.As<int32_t>();
+      ASSERT_GE(current, last);
+      last = current;
+    }
+
+  writer.get();
+}
+
+TEST_F(AddressSpace, DataChangeCallbackCanWriteAddressSpace)
+{
+  OpcUa::NodeId sourceId = CreateValue();
+  OpcUa::NodeId mirrorId = CreateValue();
+  NameSpace->AddDataChangeCallback(sourceId, OpcUa::AttributeId::Value, [&](const OpcUa::NodeId &, OpcUa::AttributeId, const OpcUa::DataValue & data)
+  {
+    OpcUa::WriteValue mirror;
+    mirror.AttributeId = OpcUa::AttributeId::Value;
+    mirror.NodeId = mirrorId;
+    mirror.Value = data.Value;
+    NameSpace->Write({mirror});
+  });
+
+  OpcUa::DataValue mirrored;
+  NameSpace->AddDataChangeCallback(mirrorId, OpcUa::AttributeId::Value, [&](const OpcUa::NodeId &, OpcUa::AttributeId, const OpcUa::DataValue & data)
+  {
+    mirrored = data;
+  });
+
+  OpcUa::WriteValue value;
+  value.AttributeId = OpcUa::AttributeId::Value;
+  value.NodeId = sourceId;
+  value.Value = 10;
+  std::vector<OpcUa::StatusCode> result = NameSpace->Write({value});
+  ASSERT_EQ(result.size(), 1);
+  EXPECT_EQ(result[0], OpcUa::StatusCode::Good);
+  EXPECT_EQ(mirrored, 10);
+
+  OpcUa::ReadParameters readParams;
+  readParams.AttributesToRead.push_back(OpcUa::ToReadValueId(mirrorId, OpcUa::AttributeId::Value));
+  std::vector<OpcUa::DataValue> values = NameSpace->Read(readParams);
+  ASSERT_EQ(values.size(), 1);
+  EXPECT_EQ(values[0].Value, 10);
+}
+
+TEST_F(AddressSpace, CallbackThrowingAnythingDoesNotStopDataChanges)
+{
+  OpcUa::NodeId valueId = CreateValue();
+  NameSpace->AddDataChangeCallback(valueId, OpcUa::AttributeId::Value, [](const OpcUa::NodeId &, OpcUa::AttributeId, const OpcUa::DataValue &)
+  {
+    throw 1;
+  });
+
+  std::vector<OpcUa::DataValue> received;
+  NameSpace->AddDataChangeCallback(valueId, OpcUa::AttributeId::Value, [&](const OpcUa::NodeId &, OpcUa::AttributeId, const OpcUa::DataValue & data)
+  {
+    received.push_back(data);
+  });
+
+  OpcUa::WriteValue value;
+  value.AttributeId = OpcUa::AttributeId::Value;
+  value.NodeId = valueId;
+  value.Value = 10;
+  EXPECT_EQ(NameSpace->Write({value}), std::vector<OpcUa::StatusCode>(1, OpcUa::StatusCode::Good));
+  value.Value = 20;
+  EXPECT_EQ(NameSpace->Write({value}), std::vector<OpcUa::StatusCode>(1, OpcUa::StatusCode::Good));
+
+  ASSERT_EQ(received.size(), 2);
+  EXPECT_EQ(received[0], 10);
+  EXPECT_EQ(received[1], 20);
+}
+
+TEST_F(AddressSpace, WriterDoesNotDeliverCallbacksOfLaterWrites)
+{
+  OpcUa::NodeId valueId = CreateValue();
+  std::promise<void> callbackEntered;
+  std::promise<void> releaseCallback;
+  std::shared_future<void> released = releaseCallback.get_future().share();
+  std::mutex callbacksMutex;
+  std::vector<std::pair<int32_t, std::thread::id>> callbacks;
+  NameSpace->AddDataChangeCallback(valueId, OpcUa::AttributeId::Value, [&](const OpcUa::NodeId &, OpcUa::AttributeId, const OpcUa::DataValue & data)
+  {
+    {
+      std::lock_guard<std::mutex> lock(callbacksMutex);
+      callbacks.push_back(std::make_pair(data.Value.As<int32_t>(), std::this_thread::get_id()));
+    }
+
+    if (data.Value == 10)
+      {
+        callbackEntered.set_value();
+        released.wait();
+      }
+  });
+
+  OpcUa::WriteValue first;
+  first.AttributeId = OpcUa::AttributeId::Value;
+  first.NodeId = valueId;
+  first.Value = 10;
+  std::thread::id firstWriterThread;
+  std::future<void> firstWritten = std::async(std::launch::async, [&]()
+  {
+    firstWriterThread = std::this_thread::get_id();
+    NameSpace->Write({first});
+  });
+  callbackEntered.get_future().wait();
+
+  // queued for the same node while the first writer is delivering its own notification
+  OpcUa::WriteValue second = first;
+  second.Value = 20;
+  std::thread::id secondWriterThread;
+  std::future<void> secondWritten = std::async(std::launch::async, [&]()
+  {
+    secondWriterThread = std::this_thread::get_id();
+    NameSpace->Write({second});
+  });
+
+  OpcUa::ReadParameters readParams;
+  readParams.AttributesToRead.push_back(OpcUa::ToReadValueId(valueId, OpcUa::AttributeId::Value));
+
+  while (NameSpace->Read(readParams).front().Value != 20)
+    {
+      std::this_thread::yield();
+    }
+
+  // takes the lock of the node, released by the second writer once its notification is queued
+  const uint32_t handle = NameSpace->AddDataChangeCallback(valueId, OpcUa::AttributeId::Value, [](const OpcUa::NodeId &, OpcUa::AttributeId, const OpcUa::DataValue &) {});
+  releaseCallback.set_value();
+
+  ASSERT_EQ(firstWritten.wait_for(std::chrono::seconds(5)), std::future_status::ready);
+  secondWritten.get();
+  NameSpace->DeleteDataChangeCallback(handle);
+
+  ASSERT_EQ(callbacks.size(), 2u);
+  EXPECT_EQ(callbacks[0].first, 10);
+  EXPECT_EQ(callbacks[0].second, firstWriterThread);
+  EXPECT_EQ(callbacks[1].first, 20);
+  EXPECT_EQ(callbacks[1].second, secondWriterThread);
+}
+
+TEST_F(AddressSpace, CallbackCanWaitForWriterOfAnotherNode)
+{
+  OpcUa::NodeId firstId = CreateValue();
+  OpcUa::NodeId secondId = CreateValue();
+  bool secondCalled = false;
+  NameSpace->AddDataChangeCallback(secondId, OpcUa::AttributeId::Value, [&](const OpcUa::NodeId &, OpcUa::AttributeId, const OpcUa::DataValue &)
+  {
+    secondCalled = true;
+  });
+
+  std::future_status secondWrite = std::future_status::deferred;
+  NameSpace->AddDataChangeCallback(firstId, OpcUa::AttributeId::Value, [&](const OpcUa::NodeId &, OpcUa::AttributeId, const OpcUa::DataValue &)
+  {
+    // the other writer does not wait for this callback
+    std::future<void> written = std::async(std::launch::async, [&]()
+    {
+      OpcUa::WriteValue second;
+      second.AttributeId = OpcUa::AttributeId::Value;
+      second.NodeId = secondId;
+      second.Value = 2;
+      NameSpace->Write({second});
+    });
+    secondWrite = written.wait_for(std::chrono::seconds(5));
+  });
+
+  OpcUa::WriteValue first;
+  first.AttributeId = OpcUa::AttributeId::Value;
+  first.NodeId = firstId;
+  first.Value = 1;
+  NameSpace->Write({first});
+  EXPECT_EQ(secondWrite, std::future_status::ready);
+  EXPECT_TRUE(secondCalled);
+}
+
 TEST_F(AddressSpace, ValueCallbackIsCalled)
 {
   OpcUa::NodeId valueId = CreateValue();
@@ -152,3 +431,417 @@ TEST_F(AddressSpace, ValueCallbackIsCalled)
   EXPECT_TRUE(result[0].Encoding & OpcUa::DATA_VALUE);
   EXPECT_EQ(result[0].Value, 10);
 }
+
+namespace
+{
+// Completes every batch on its own thread, values are the number of the call.
+class BatchDataSource : public OpcUa::Server::DataSource
+{
+public:
+  virtual void Read(const std::vector<OpcUa::ReadValueId> & items, ReadCallback done)
+  {
+    const int call = ++Calls;
+    Threads.push_back(std::thread([items, done, call]()
+    {
+      done(std::vector<OpcUa::DataValue>(items.size(), OpcUa::DataValue(call)));
+    }));
+  }
+
+  ~BatchDataSource()
+  {
+    for (std::thread & thread : Threads)
+      {
+        thread.join();
+      }
+  }
+
+  int Calls = 0;
+  std::vector<std::thread> Threads;
+};
+}
+
+TEST_F(AddressSpace, DataSourceReadsItsItemsInOneCall)
+{
+  std::shared_ptr<BatchDataSource> source = std::make_shared<BatchDataSource>();
+  OpcUa::NodeId first = CreateValue();
+  OpcUa::NodeId second = CreateValue();
+  OpcUa::NodeId local = CreateValue();
+  ASSERT_EQ(NameSpace->SetDataSource(first, OpcUa::AttributeId::Value, source), OpcUa::StatusCode::Good);
+  ASSERT_EQ(NameSpace->SetDataSource(second, OpcUa::AttributeId::Value, source), OpcUa::StatusCode::Good);
+  EXPECT_TRUE(NameSpace->HasValueCallback(first, OpcUa::AttributeId::Value));
+  EXPECT_FALSE(NameSpace->HasValueCallback(local, OpcUa::AttributeId::Value));
+
+  OpcUa::ReadParameters readParams;
+  readParams.AttributesToRead.push_back(OpcUa::ToReadValueId(first, OpcUa::AttributeId::Value));
+  readParams.AttributesToRead.push_back(OpcUa::ToReadValueId(local, OpcUa::AttributeId::BrowseName));
+  readParams.AttributesToRead.push_back(OpcUa::ToReadValueId(second, OpcUa::AttributeId::Value));
+  std::vector<OpcUa::DataValue> result = NameSpace->Read(readParams);
+  ASSERT_EQ(result.size(), 3);
+  EXPECT_EQ(source->Calls, 1);
+  EXPECT_EQ(result[0].Value, 1);
+  EXPECT_EQ(result[1].Value, OpcUa::QualifiedName("value"));
+  EXPECT_EQ(result[2].Value, 1);
+
+  std::promise<std::vector<OpcUa::DataValue>> completed;
+  NameSpace->ReadAsync(readParams, [&completed](std::vector<OpcUa::DataValue> values)
+  {
+    completed.set_value(values);
+  });
+  result = completed.get_future().get();
+  ASSERT_EQ(result.size(), 3);
+  EXPECT_EQ(source->Calls, 2);
+  EXPECT_EQ(result[2].Value, 2);
+}
+
+TEST_F(AddressSpace, FailingDataSourceDoesNotBlockRead)
+{
+  class FailingDataSource : public OpcUa::Server::DataSource
+  {
+  public:
+    virtual void Read(const std::vector<OpcUa::ReadValueId> &, ReadCallback)
+    {
+      throw std::runtime_error("device is gone");
+    }
+  };
+
+  std::shared_ptr<BatchDataSource> source = std::make_shared<BatchDataSource>();
+  OpcUa::NodeId failing = CreateValue();
+  OpcUa::NodeId working = CreateValue();
+  ASSERT_EQ(NameSpace->SetDataSource(failing, OpcUa::AttributeId::Value, std::make_shared<FailingDataSource>()), OpcUa::StatusCode::Good);
+  ASSERT_EQ(NameSpace->SetDataSource(working, OpcUa::AttributeId::Value, source), OpcUa::StatusCode::Good);
+
+  OpcUa::ReadParameters readParams;
+  readParams.AttributesToRead.push_back(OpcUa::ToReadValueId(working, OpcUa::AttributeId::Value));
+  readParams.AttributesToRead.push_back(OpcUa::ToReadValueId(failing, OpcUa::AttributeId::Value));
+  const std::vector<OpcUa::DataValue> result = NameSpace->Read(readParams);
+  ASSERT_EQ(result.size(), 2);
+  EXPECT_EQ(result[0].Value, 1);
+  EXPECT_EQ(result[1].Status, OpcUa::StatusCode::BadInternalError);
+}
+
+TEST_F(AddressSpace, ReadAsyncTimesOutSilentDataSource)
+{
+  class SilentDataSource : public OpcUa::Server::DataSource
+  {
+  public:
+    virtual void Read(const std::vector<OpcUa::ReadValueId> &, ReadCallback done)
+    {
+      Done = done;
+    }
+
+    ReadCallback Done;
+  };
+
+  NameSpace = OpcUa::Server::CreateAddressSpace(Logger, OpcUa::Server::BrowseLimits(), 50);
+  OpcUa::Server::FillStandardNamespace(*NameSpace, Logger);
+  std::shared_ptr<SilentDataSource> source = std::make_shared<SilentDataSource>();
+  OpcUa::NodeId silent = CreateValue();
+  ASSERT_EQ(NameSpace->SetDataSource(silent, OpcUa::AttributeId::Value, source), OpcUa::StatusCode::Good);
+
+  OpcUa::ReadParameters readParams;
+  readParams.AttributesToRead.push_back(OpcUa::ToReadValueId(silent, OpcUa::AttributeId::Value));
+  std::promise<std::vector<OpcUa::DataValue>> completed;
+  NameSpace->ReadAsync(readParams, [&completed](std::vector<OpcUa::DataValue> values)
+  {
+    completed.set_value(values);
+  });
+
+  std::future<std::vector<OpcUa::DataValue>> result = completed.get_future();
+  ASSERT_EQ(result.wait_for(std::chrono::seconds(5)), std::future_status::ready);
+  const std::vector<OpcUa::DataValue> values = result.get();
+  ASSERT_EQ(values.size(), 1u);
+  EXPECT_EQ(values[0].Status, OpcUa::StatusCode::BadTimeout);
+
+  // late values are dropped, the read is not completed twice
+  ASSERT_TRUE(static_cast<bool>(source->Done));
+  source->Done(std::vector<OpcUa::DataValue>(1, OpcUa::DataValue(1)));
+}
+
+TEST_F(AddressSpace, ReadAsyncTimesOutDataSourceDroppingCallback)
+{
+  class DroppingDataSource : public OpcUa::Server::DataSource
+  {
+  public:
+    virtual void Read(const std::vector<OpcUa::ReadValueId> &, ReadCallback)
+    {
+    }
+  };
+
+  NameSpace = OpcUa::Server::CreateAddressSpace(Logger, OpcUa::Server::BrowseLimits(), 50);
+  OpcUa::Server::FillStandardNamespace(*NameSpace, Logger);
+  OpcUa::NodeId dropping = CreateValue();
+  ASSERT_EQ(NameSpace->SetDataSource(dropping, OpcUa::AttributeId::Value, std::make_shared<DroppingDataSource>()), OpcUa::StatusCode::Good);
+
+  OpcUa::ReadParameters readParams;
+  readParams.AttributesToRead.push_back(OpcUa::ToReadValueId(dropping, OpcUa::AttributeId::Value));
+  std::shared_ptr<std::promise<std::vector<OpcUa::DataValue>>> completed = std::make_shared<std::promise<std::vector<OpcUa::DataValue>>>();
+  std::future<std::vector<OpcUa::DataValue>> result = completed->get_future();
+  NameSpace->ReadAsync(readParams, [completed](std::vector<OpcUa::DataValue> values)
+  {
+    completed->set_value(values);
+  });
+
+  ASSERT_EQ(result.wait_for(std::chrono::seconds(5)), std::future_status::ready);
+  const std::vector<OpcUa::DataValue> values = result.get();
+  ASSERT_EQ(values.size(), 1u);
+  EXPECT_EQ(values[0].Status, OpcUa::StatusCode::BadTimeout);
+}
+
+TEST_F(AddressSpace, BrowseIncludesSubtypesOfReferenceType)
+{
+  OpcUa::BrowseDescription description;
+  description.NodeToBrowse = OpcUa::ObjectId::RootFolder;
+  description.Direction = OpcUa::BrowseDirection::Forward;
+  description.ReferenceTypeId = OpcUa::ObjectId::HierarchicalReferences;
+  description.IncludeSubtypes = true;
+
+  OpcUa::NodesQuery query;
+  query.NodesToBrowse.push_back(description);
+  std::vector<OpcUa::BrowseResult> results = NameSpace->Browse(query);
+  ASSERT_EQ(results.size(), 1);
+  ASSERT_EQ(results[0].Referencies.size(), 3);
+
+  for (const OpcUa::ReferenceDescription & ref : results[0].Referencies)
+    {
+      EXPECT_EQ(ref.ReferenceTypeId, OpcUa::ObjectId::Organizes);
+    }
+
+  query.NodesToBrowse[0].IncludeSubtypes = false;
+  results = NameSpace->Browse(query);
+  ASSERT_EQ(results.size(), 1);
+  EXPECT_TRUE(results[0].Referencies.empty());
+}
+
+TEST_F(AddressSpace, FindsChildOfLargeFolderByBrowsePath)
+{
+  std::vector<OpcUa::AddNodesItem> items;
+
+  for (int i = 0; i < 100; ++i)
+    {
+      OpcUa::AddNodesItem item;
+      item.Attributes = OpcUa::VariableAttributes();
+      item.BrowseName = OpcUa::QualifiedName("value" + std::to_string(i), 2);
+      item.Class = OpcUa::NodeClass::Variable;
+      item.ParentNodeId = OpcUa::ObjectId::ObjectsFolder;
+      item.ReferenceTypeId = OpcUa::ObjectId::HasComponent;
+      items.push_back(item);
+    }
+
+  const std::vector<OpcUa::AddNodesResult> added = NameSpace->AddNodes(items);
+  ASSERT_EQ(added.size(), 100);
+
+  OpcUa::RelativePathElement element;
+  element.TargetName = OpcUa::QualifiedName("value77", 2);
+  OpcUa::BrowsePath path;
+  path.StartingNode = OpcUa::ObjectId::ObjectsFolder;
+  path.Path.Elements.push_back(element);
+  OpcUa::TranslateBrowsePathsParameters params;
+  params.BrowsePaths.push_back(path);
+
+  std::vector<OpcUa::BrowsePathResult> results = NameSpace->TranslateBrowsePathsToNodeIds(params);
+  ASSERT_EQ(results.size(), 1);
+  ASSERT_EQ(results[0].Status, OpcUa::StatusCode::Good);
+  ASSERT_EQ(results[0].Targets.size(), 1);
+  EXPECT_EQ(results[0].Targets[0].Node, added[77].AddedNodeId);
+
+  params.BrowsePaths[0].Path.Elements[0].TargetName = OpcUa::QualifiedName("value77", 3);
+  results = NameSpace->TranslateBrowsePathsToNodeIds(params);
+  ASSERT_EQ(results.size(), 1);
+  EXPECT_EQ(results[0].Status, OpcUa::StatusCode::BadNoMatch);
+
+  OpcUa::BrowseDescription description;
+  description.NodeToBrowse = OpcUa::ObjectId::ObjectsFolder;
+  description.Direction = OpcUa::BrowseDirection::Forward;
+  description.ReferenceTypeId = OpcUa::ObjectId::HasComponent;
+  OpcUa::NodesQuery query;
+  query.NodesToBrowse.push_back(description);
+  const std::vector<OpcUa::BrowseResult> browsed = NameSpace->Browse(query);
+  ASSERT_EQ(browsed.size(), 1);
+  ASSERT_EQ(browsed[0].Referencies.size(), 100);
+  EXPECT_EQ(browsed[0].Referencies[77].TargetNodeId, added[77].AddedNodeId);
+}
+
+TEST_F(AddressSpace, BrowseNextReturnsReferencesPageByPage)
+{
+  std::vector<OpcUa::AddNodesItem> items;
+
+  for (int i = 0; i < 25; ++i)
+    {
+      OpcUa::AddNodesItem item;
+      item.Attributes = OpcUa::VariableAttributes();
+      item.BrowseName = OpcUa::QualifiedName("value" + std::to_string(i), 2);
+      item.Class = OpcUa::NodeClass::Variable;
+      item.ParentNodeId = OpcUa::ObjectId::ObjectsFolder;
+      item.ReferenceTypeId = OpcUa::ObjectId::HasComponent;
+      items.push_back(item);
+    }
+
+  const std::vector<OpcUa::AddNodesResult> added = NameSpace->AddNodes(items);
+
+  OpcUa::BrowseDescription description;
+  description.NodeToBrowse = OpcUa::ObjectId::ObjectsFolder;
+  description.Direction = OpcUa::BrowseDirection::Forward;
+  description.ReferenceTypeId = OpcUa::ObjectId::HasComponent;
+  OpcUa::NodesQuery query;
+  query.MaxReferenciesPerNode = 10;
+  query.NodesToBrowse.push_back(description);
+
+  std::vector<OpcUa::BrowseResult> results = NameSpace->Browse(query);
+  ASSERT_EQ(results.size(), 1);
+  ASSERT_EQ(results[0].Referencies.size(), 10);
+  ASSERT_FALSE(results[0].ContinuationPoint.empty());
+
+  std::vector<OpcUa::NodeId> browsed;
+  std::vector<std::size_t> pages;
+
+  while (true)
+    {
+      pages.push_back(results[0].Referencies.size());
+
+      for (const OpcUa::ReferenceDescription & ref : results[0].Referencies)
+        {
+          browsed.push_back(ref.TargetNodeId);
+        }
+
+      if (results[0].ContinuationPoint.empty())
+        {
+          break;
+        }
+
+      OpcUa::BrowseNextParameters next;
+      next.ContinuationPoints.push_back(results[0].ContinuationPoint);
+      results = NameSpace->BrowseNext(next);
+      ASSERT_EQ(results.size(), 1);
+      ASSERT_EQ(results[0].Status, OpcUa::StatusCode::Good);
+    }
+
+  EXPECT_EQ(pages, std::vector<std::size_t>({10, 10, 5}));
+  ASSERT_EQ(browsed.size(), 25);
+
+  for (std::size_t i = 0; i < added.size(); ++i)
+    {
+      EXPECT_EQ(browsed[i], added[i].AddedNodeId);
+    }
+}
+
+TEST_F(AddressSpace, ReleasesContinuationPoints)
+{
+  OpcUa::Server::BrowseLimits limits;
+  limits.MaxContinuationPoints = 1;
+  NameSpace = OpcUa::Server::CreateAddressSpace(Logger, limits);
+  OpcUa::Server::FillStandardNamespace(*NameSpace, Logger);
+
+  OpcUa::BrowseDescription description;
+  description.NodeToBrowse = OpcUa::ObjectId::Server;
+  description.Direction = OpcUa::BrowseDirection::Forward;
+  OpcUa::NodesQuery query;
+  query.MaxReferenciesPerNode = 1;
+  query.NodesToBrowse.push_back(description);
+
+  const std::vector<OpcUa::BrowseResult> first = NameSpace->Browse(query);
+  ASSERT_EQ(first.size(), 1);
+  ASSERT_FALSE(first[0].ContinuationPoint.empty());
+
+  std::vector<OpcUa::BrowseResult> second = NameSpace->Browse(query);
+  ASSERT_EQ(second.size(), 1);
+  EXPECT_EQ(second[0].Status, OpcUa::StatusCode::BadNoContinuationPoints);
+  EXPECT_EQ(second[0].Referencies.size(), 1);
+  EXPECT_TRUE(second[0].ContinuationPoint.empty());
+
+  OpcUa::BrowseNextParameters release;
+  release.ReleaseContinuationPoints = true;
+  release.ContinuationPoints.push_back(first[0].ContinuationPoint);
+  std::vector<OpcUa::BrowseResult> released = NameSpace->BrowseNext(release);
+  ASSERT_EQ(released.size(), 1);
+  EXPECT_EQ(released[0].Status, OpcUa::StatusCode::Good);
+  EXPECT_TRUE(released[0].Referencies.empty());
+
+  released = NameSpace->BrowseNext(release);
+  ASSERT_EQ(released.size(), 1);
+  EXPECT_EQ(released[0].Status, OpcUa::StatusCode::BadContinuationPointInvalid);
+
+  second = NameSpace->Browse(query);
+  ASSERT_EQ(second.size(), 1);
+  EXPECT_EQ(second[0].Status, OpcUa::StatusCode::Good);
+  EXPECT_FALSE(second[0].ContinuationPoint.empty());
+}
+
+TEST_F(AddressSpace, ContinuationPointsBelongToSession)
+{
+  OpcUa::Server::BrowseLimits limits;
+  limits.MaxContinuationPoints = 1;
+  NameSpace = OpcUa::Server::CreateAddressSpace(Logger, limits);
+  OpcUa::Server::FillStandardNamespace(*NameSpace, Logger);
+
+  OpcUa::BrowseDescription description;
+  description.NodeToBrowse = OpcUa::ObjectId::Server;
+  description.Direction = OpcUa::BrowseDirection::Forward;
+  OpcUa::NodesQuery query;
+  query.MaxReferenciesPerNode = 1;
+  query.NodesToBrowse.push_back(description);
+
+  const OpcUa::NodeId owner = OpcUa::NumericNodeId(10, 1);
+  const OpcUa::NodeId other = OpcUa::NumericNodeId(11, 1);
+  const std::vector<OpcUa::BrowseResult> first = NameSpace->Browse(owner, query);
+  ASSERT_EQ(first.size(), 1);
+  ASSERT_EQ(first[0].ContinuationPoint.size(), 8);
+
+  // limit of the owner does not apply to other sessions
+  const std::vector<OpcUa::BrowseResult> second = NameSpace->Browse(other, query);
+  ASSERT_EQ(second.size(), 1);
+  EXPECT_EQ(second[0].Status, OpcUa::StatusCode::Good);
+  EXPECT_NE(second[0].ContinuationPoint, first[0].ContinuationPoint);
+
+  OpcUa::BrowseNextParameters next;
+  next.ContinuationPoints.push_back(first[0].ContinuationPoint);
+  std::vector<OpcUa::BrowseResult> stolen = NameSpace->BrowseNext(other, next);
+  ASSERT_EQ(stolen.size(), 1);
+  EXPECT_EQ(stolen[0].Status, OpcUa::StatusCode::BadContinuationPointInvalid);
+  EXPECT_TRUE(stolen[0].Referencies.empty());
+
+  next.ReleaseContinuationPoints = true;
+  stolen = NameSpace->BrowseNext(other, next);
+  EXPECT_EQ(stolen[0].Status, OpcUa::StatusCode::BadContinuationPointInvalid);
+
+  next.ReleaseContinuationPoints = false;
+  const std::vector<OpcUa::BrowseResult> continued = NameSpace->BrowseNext(owner, next);
+  ASSERT_EQ(continued.size(), 1);
+  EXPECT_EQ(continued[0].Status, OpcUa::StatusCode::Good);
+  ASSERT_EQ(continued[0].Referencies.size(), 1);
+  EXPECT_NE(continued[0].Referencies[0].TargetNodeId, first[0].Referencies[0].TargetNodeId);
+}
+
+TEST_F(AddressSpace, ReleasesAllContinuationPointsOfSession)
+{
+  OpcUa::BrowseDescription description;
+  description.NodeToBrowse = OpcUa::ObjectId::Server;
+  description.Direction = OpcUa::BrowseDirection::Forward;
+  OpcUa::NodesQuery query;
+  query.MaxReferenciesPerNode = 1;
+  query.NodesToBrowse.push_back(description);
+  query.NodesToBrowse.push_back(description);
+
+  const OpcUa::NodeId closed = OpcUa::NumericNodeId(10, 1);
+  const OpcUa::NodeId other = OpcUa::NumericNodeId(11, 1);
+  const std::vector<OpcUa::BrowseResult> points = NameSpace->Browse(closed, query);
+  const std::vector<OpcUa::BrowseResult> kept = NameSpace->Browse(other, query);
+  ASSERT_EQ(points.size(), 2);
+  ASSERT_EQ(kept.size(), 2);
+
+  NameSpace->ReleaseContinuationPoints(closed);
+
+  OpcUa::BrowseNextParameters next;
+  next.ContinuationPoints.push_back(points[0].ContinuationPoint);
+  next.ContinuationPoints.push_back(points[1].ContinuationPoint);
+  std::vector<OpcUa::BrowseResult> results = NameSpace->BrowseNext(closed, next);
+  ASSERT_EQ(results.size(), 2);
+  EXPECT_EQ(results[0].Status, OpcUa::StatusCode::BadContinuationPointInvalid);
+  EXPECT_EQ(results[1].Status, OpcUa::StatusCode::BadContinuationPointInvalid);
+
+  next.ContinuationPoints.clear();
+  next.ContinuationPoints.push_back(kept[0].ContinuationPoint);
+  results = NameSpace->BrowseNext(other, next);
+  ASSERT_EQ(results.size(), 1);
+  EXPECT_EQ(results[0].Status, OpcUa::StatusCode::Good);
+  EXPECT_EQ(results[0].Referencies.size(), 1);
+}
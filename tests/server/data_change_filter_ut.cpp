@@ -0,0 +1,134 @@
+/// @brief Data change filter tests.
+/// @license GNU LGPL
+///
+/// Distributed under the GNU LGPL License
+/// (See accompanying file LICENSE or copy at
+/// http://www.gnu.org/licenses/lgpl.html)
+///
+
+#include "data_change_filter.h"
+
+#include <opc/ua/protocol/object_ids.h>
+#include <opc/ua/protocol/protocol_auto.h>
+
+#include <gtest/gtest.h>
+
+#include <limits>
+
+using namespace testing;
+using namespace OpcUa;
+using OpcUa::Internal::DataChangeFilterEvaluator;
+
+namespace
+{
+DataChangeFilter MakeFilter(DataChangeTrigger trigger, DeadbandType deadband, double value)
+{
+  DataChangeFilter filter;
+  filter.Trigger = trigger;
+  filter.Deadband = deadband;
+  filter.DeadbandValue = value;
+  return filter;
+}
+}
+
+TEST(DataChangeFilter, DefaultReportsChangedValuesAndStatus)
+{
+  DataChangeFilterEvaluator filter;
+  ASSERT_TRUE(filter.Report(DataValue(1)));
+  ASSERT_FALSE(filter.Report(DataValue(1)));
+  ASSERT_TRUE(filter.Report(DataValue(2)));
+
+  DataValue bad(2);
+  bad.Status = StatusCode::BadNoData;
+  ASSERT_TRUE(filter.Report(bad));
+}
+
+TEST(DataChangeFilter, StatusTriggerIgnoresValues)
+{
+  DataChangeFilterEvaluator filter(MakeFilter(DataChangeTrigger::Status, DeadbandType::None, 0), 0);
+  ASSERT_TRUE(filter.Report(DataValue(1)));
+  ASSERT_FALSE(filter.Report(DataValue(2)));
+
+  DataValue bad(2);
+  bad.Status = StatusCode::BadNoData;
+  ASSERT_TRUE(filter.Report(bad));
+}
+
+TEST(DataChangeFilter, TimestampTriggerReportsNewTimestamps)
+{
+  DataChangeFilterEvaluator filter(MakeFilter(DataChangeTrigger::StatusValueTimestamp, DeadbandType::None, 0), 0);
+  DataValue value(1);
+  value.SetSourceTimestamp(DateTime::FromTimeT(1));
+  ASSERT_TRUE(filter.Report(value));
+  ASSERT_FALSE(filter.Report(value));
+
+  value.SetSourceTimestamp(DateTime::FromTimeT(2));
+  ASSERT_TRUE(filter.Report(value));
+}
+
+TEST(DataChangeFilter, AbsoluteDeadbandComparesWithLastReportedValue)
+{
+  DataChangeFilterEvaluator filter(MakeFilter(DataChangeTrigger::StatusValue, DeadbandType::Absolute, 1.0), 0);
+  ASSERT_TRUE(filter.Report(DataValue(10.0)));
+  ASSERT_FALSE(filter.Report(DataValue(10.6)));
+  ASSERT_FALSE(filter.Report(DataValue(11.0)));
+  ASSERT_TRUE(filter.Report(DataValue(11.1)));
+  ASSERT_FALSE(filter.Report(DataValue(10.5)));
+}
+
+TEST(DataChangeFilter, AbsoluteDeadbandComparesArrayElements)
+{
+  DataChangeFilterEvaluator filter(MakeFilter(DataChangeTrigger::StatusValue, DeadbandType::Absolute, 2.0), 0);
+  ASSERT_TRUE(filter.Report(DataValue(std::vector<int32_t>({1, 2, 3}))));
+  ASSERT_FALSE(filter.Report(DataValue(std::vector<int32_t>({2, 4, 1}))));
+  ASSERT_TRUE(filter.Report(DataValue(std::vector<int32_t>({1, 2, 6}))));
+  ASSERT_TRUE(filter.Report(DataValue(std::vector<int32_t>({1, 2}))));
+}
+
+TEST(DataChangeFilter, PercentDeadbandUsesRange)
+{
+  DataChangeFilterEvaluator filter(MakeFilter(DataChangeTrigger::StatusValue, DeadbandType::Percent, 10), 200);
+  ASSERT_TRUE(filter.Report(DataValue(uint16_t(100))));
+  ASSERT_FALSE(filter.Report(DataValue(uint16_t(120))));
+  ASSERT_TRUE(filter.Report(DataValue(uint16_t(79))));
+}
+
+TEST(DataChangeFilter, ParsesRange)
+{
+  double low = 0;
+  double high = 0;
+  ASSERT_TRUE(Internal::ParseRange(Variant(std::vector<double>({-5, 5})), low, high));
+  ASSERT_EQ(low, -5);
+  ASSERT_EQ(high, 5);
+  ASSERT_FALSE(Internal::ParseRange(Variant(1.0), low, high));
+}
+
+TEST(DataChangeFilter, ParsesRangeExtensionObject)
+{
+  // Range{Low = -5, High = 5} in binary encoding: little endian doubles
+  ExtensionObject range;
+  range.TypeId = ObjectId::Range_Encoding_DefaultBinary;
+  range.Encoding = 1;
+  range.Body.Data = {0, 0, 0, 0, 0, 0, 0x14, 0xc0, 0, 0, 0, 0, 0, 0, 0x14, 0x40};
+
+  double low = 0;
+  double high = 0;
+  ASSERT_TRUE(Internal::ParseRange(Variant(range), low, high));
+  ASSERT_EQ(low, -5);
+  ASSERT_EQ(high, 5);
+
+  range.Body.Data.pop_back();
+  ASSERT_FALSE(Internal::ParseRange(Variant(range), low, high));
+}
+
+TEST(DataChangeFilter, DeadbandReportsTransitionsToAndFromNaN)
+{
+  const double nan = std::numeric_limits<double>::quiet_NaN();
+  DataChangeFilterEvaluator filter(MakeFilter(DataChangeTrigger::StatusValue, DeadbandType::Absolute, 1.0), 0);
+  ASSERT_TRUE(filter.Report(DataValue(10.0)));
+  ASSERT_TRUE(filter.Report(DataValue(nan)));
+  ASSERT_FALSE(filter.Report(DataValue(nan)));
+  ASSERT_TRUE(filter.Report(DataValue(10.0)));
+
+  ASSERT_TRUE(Internal::ExceedsDeadband(Variant(std::vector<float>({1, 2})), Variant(std::vector<float>({1, std::numeric_limits<float>::quiet_NaN()})), 1.0));
+}
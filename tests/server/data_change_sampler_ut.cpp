@@ -0,0 +1,140 @@
+/// @brief Shared data change sampler tests.
+/// @license GNU LGPL
+///
+/// Distributed under the GNU LGPL License
+/// (See accompanying file LICENSE or copy at
+/// http://www.gnu.org/licenses/lgpl.html)
+///
+
+#include "subscription_service_test.h"
+
+#include <opc/ua/protocol/object_ids.h>
+
+using namespace testing;
+using namespace OpcUa;
+
+class DataChangeSamplerTest : public OpcUa::Test::SubscriptionServiceTest
+{
+protected:
+  static MonitoredItemCreateRequest MonitorValue(const NodeId & node, double deadband)
+  {
+    MonitoredItemCreateRequest request = SubscriptionServiceTest::MonitorValue(node, 1, 100);
+
+    if (deadband > 0)
+      {
+        request.RequestedParameters.Filter.Header.TypeId = ExpandedObjectId::DataChangeFilter;
+        request.RequestedParameters.Filter.DataChange.Trigger = DataChangeTrigger::StatusValue;
+        request.RequestedParameters.Filter.DataChange.Deadband = DeadbandType::Absolute;
+        request.RequestedParameters.Filter.DataChange.DeadbandValue = deadband;
+      }
+
+    return request;
+  }
+
+  uint32_t CreateSubscription()
+  {
+    return SubscriptionServiceTest::CreateSubscription(SubscriptionRequest(100));
+  }
+
+  // Values of data changes published to subscription in results received since first.
+  std::vector<uint8_t> GetPublishedValues(uint32_t subscriptionId, std::size_t first)
+  {
+    std::vector<uint8_t> values;
+
+    for (std::size_t i = first; i < Results.size(); ++i)
+      {
+        if (Results[i].SubscriptionId != subscriptionId)
+          {
+            continue;
+          }
+
+        for (const NotificationData & data : Results[i].NotificationMessage.NotificationData)
+          {
+            for (const MonitoredItems & item : data.DataChange.Notification)
+              {
+                values.push_back(item.Value.Value.As<uint8_t>());
+              }
+          }
+      }
+
+    return values;
+  }
+};
+
+TEST_F(DataChangeSamplerTest, IdenticalItemsShareOneSampler)
+{
+  const NodeId node = ObjectId::Server_ServiceLevel;
+  Write(node, Variant(uint8_t(10)));
+
+  const uint32_t first = CreateSubscription();
+  const uint32_t second = CreateSubscription();
+
+  ASSERT_EQ(Monitor(first, MonitorValue(node, 0)).Status, StatusCode::Good);
+  ASSERT_EQ(Monitor(second, MonitorValue(node, 0)).Status, StatusCode::Good);
+  ASSERT_EQ(Service->GetDataChangeSamplers().Size(), 1);
+
+  // another filter needs its own evaluation
+  ASSERT_EQ(Monitor(second, MonitorValue(node, 5)).Status, StatusCode::Good);
+  ASSERT_EQ(Service->GetDataChangeSamplers().Size(), 2);
+
+  // initial values
+  Publish(2);
+  std::size_t published = Results.size();
+
+  // the shared sampler fans the change out to both subscriptions, the deadband filters it
+  Write(node, Variant(uint8_t(12)));
+  Publish(2);
+  EXPECT_EQ(GetPublishedValues(first, published), std::vector<uint8_t>({12}));
+  EXPECT_EQ(GetPublishedValues(second, published), std::vector<uint8_t>({12}));
+  published = Results.size();
+
+  Write(node, Variant(uint8_t(20)));
+  Publish(2);
+  EXPECT_EQ(GetPublishedValues(first, published), std::vector<uint8_t>({20}));
+  EXPECT_EQ(GetPublishedValues(second, published), std::vector<uint8_t>({20, 20}));
+  ASSERT_EQ(Service->GetDataChangeSamplers().Size(), 2);
+}
+
+TEST_F(DataChangeSamplerTest, SamplerGoesAwayWithLastItem)
+{
+  const NodeId node = ObjectId::Server_ServiceLevel;
+  Write(node, Variant(uint8_t(10)));
+
+  const uint32_t first = CreateSubscription();
+  const uint32_t second = CreateSubscription();
+  const MonitoredItemCreateResult item = Monitor(first, MonitorValue(node, 0));
+  Monitor(second, MonitorValue(node, 0));
+
+  DeleteMonitoredItemsParameters params;
+  params.SubscriptionId = first;
+  params.MonitoredItemIds.push_back(item.MonitoredItemId);
+  ASSERT_EQ(Service->DeleteMonitoredItems(params).front(), StatusCode::Good);
+  ASSERT_EQ(Service->GetDataChangeSamplers().Size(), 1);
+
+  Service->DeleteSubscriptions(std::vector<uint32_t>(1, second));
+  ASSERT_EQ(Service->GetDataChangeSamplers().Size(), 0);
+
+  // no callback is left in the address space
+  Write(node, Variant(uint8_t(20)));
+}
+
+TEST_F(DataChangeSamplerTest, WritesBetweenCyclesBeyondQueueCapacityKeepLatestValue)
+{
+  const NodeId node = ObjectId::Server_ServiceLevel;
+  Write(node, Variant(uint8_t(10)));
+
+  const uint32_t id = CreateSubscription();
+  ASSERT_EQ(Monitor(id, MonitorValue(node, 0)).Status, StatusCode::Good);
+  Publish(1);
+  const std::size_t published = Results.size();
+
+  // no publishing cycle runs meanwhile, writers do not wait for one
+  for (int i = 0; i < 3000; ++i)
+    {
+      Write(node, Variant(uint8_t(i % 200)));
+    }
+
+  Write(node, Variant(uint8_t(250)));
+  Publish(1);
+  EXPECT_EQ(GetPublishedValues(id, published), std::vector<uint8_t>({250}));
+}
@@ -0,0 +1,286 @@
+/// @brief Compiled event filter tests.
+/// @license GNU LGPL
+///
+/// Distributed under the GNU LGPL License
+/// (See accompanying file LICENSE or copy at
+/// http://www.gnu.org/licenses/lgpl.html)
+///
+
+#include "event_filter.h"
+
+#include <opc/ua/protocol/object_ids.h>
+#include <opc/ua/server/standard_address_space.h>
+
+#include <gtest/gtest.h>
+
+#include <functional>
+#include <thread>
+
+using namespace testing;
+using namespace OpcUa;
+using OpcUa::Internal::CompiledEventFilter;
+
+namespace
+{
+SimpleAttributeOperand Field(const std::string & name)
+{
+  SimpleAttributeOperand operand;
+  operand.TypeId = ObjectId::BaseEventType;
+  operand.Attribute = AttributeId::Value;
+  operand.BrowsePath.push_back(QualifiedName(name, 0));
+  return operand;
+}
+
+FilterOperand MakeField(const std::string & name)
+{
+  FilterOperand operand;
+  operand.Header.TypeId = ExpandedObjectId::SimpleAttributeOperand;
+  operand.SimpleAttribute = Field(name);
+  return operand;
+}
+
+FilterOperand MakeLiteral(const Variant & value)
+{
+  FilterOperand operand;
+  operand.Header.TypeId = ExpandedObjectId::LiteralOperand;
+  operand.Literal.Value = value;
+  return operand;
+}
+
+FilterOperand MakeElement(uint32_t index)
+{
+  FilterOperand operand;
+  operand.Header.TypeId = ExpandedObjectId::ElementOperand;
+  operand.Element.Index = index;
+  return operand;
+}
+
+ContentFilterElement Element(FilterOperator op, const std::vector<FilterOperand> & operands)
+{
+  ContentFilterElement element;
+  element.Operator = op;
+  element.FilterOperands = operands;
+  return element;
+}
+}
+
+class EventFilterTest : public Test
+{
+protected:
+  virtual void SetUp()
+  {
+    spdlog::drop_all();
+    Logger = spdlog::stderr_color_mt("test");
+    Logger->set_level(spdlog::level::info);
+    NameSpace = Server::CreateAddressSpace(Logger);
+    Server::FillStandardNamespace(*NameSpace, Logger);
+
+    Alarm = Event(ObjectId::SystemEventType);
+    Alarm.Severity = 500;
+    Alarm.SourceName = "Pump 12";
+    Alarm.Message = LocalizedText("pressure");
+    Alarm.SetValue("Custom", Variant(42));
+  }
+
+protected:
+  Server::AddressSpace::UniquePtr NameSpace;
+  Common::Logger::SharedPtr Logger;
+  Event Alarm;
+};
+
+TEST_F(EventFilterTest, SelectsFields)
+{
+  EventFilter filter;
+  filter.SelectClauses = {Field("Severity"), Field("SourceName"), Field("Message"), Field("Custom"), Field("Unknown")};
+
+  CompiledEventFilter compiled(filter, *NameSpace);
+  ASSERT_EQ(compiled.GetStatus(), StatusCode::Good);
+  ASSERT_TRUE(compiled.Matches(Alarm));
+
+  const std::vector<Variant> fields = compiled.Select(Alarm);
+  ASSERT_EQ(fields.size(), 5u);
+  ASSERT_EQ(fields[0], uint16_t(500));
+  ASSERT_EQ(fields[1], std::string("Pump 12"));
+  ASSERT_EQ(fields[2], LocalizedText("pressure"));
+  ASSERT_EQ(fields[3], 42);
+  ASSERT_TRUE(fields[4].IsNul());
+}
+
+TEST_F(EventFilterTest, EvaluatesWhereClauseElements)
+{
+  EventFilter filter;
+  filter.WhereClause =
+  {
+    Element(FilterOperator::And, {MakeElement(1), MakeElement(2)}),
+    Element(FilterOperator::GreaterThanOrEqual, {MakeField("Severity"), MakeLiteral(Variant(int32_t(500)))}),
+    Element(FilterOperator::Like, {MakeField("SourceName"), MakeLiteral(Variant(std::string("Pump _%")))}),
+  };
+
+  CompiledEventFilter compiled(filter, *NameSpace);
+  ASSERT_EQ(compiled.GetStatus(), StatusCode::Good);
+  ASSERT_TRUE(compiled.Matches(Alarm));
+
+  Alarm.Severity = 499;
+  ASSERT_FALSE(compiled.Matches(Alarm));
+
+  Alarm.Severity = 900;
+  Alarm.SourceName = "Valve 1";
+  ASSERT_FALSE(compiled.Matches(Alarm));
+}
+
+TEST_F(EventFilterTest, LikeMatchesCharacterLists)
+{
+  auto matches = [this](const std::string & pattern)
+  {
+    EventFilter filter;
+    filter.WhereClause = {Element(FilterOperator::Like, {MakeField("SourceName"), MakeLiteral(Variant(pattern))})};
+    return CompiledEventFilter(filter, *NameSpace).Matches(Alarm);
+  };
+
+  // Alarm comes from "Pump 12"
+  EXPECT_TRUE(matches("[PV]ump%"));
+  EXPECT_FALSE(matches("[V]ump%"));
+  EXPECT_TRUE(matches("[^V]ump%"));
+  EXPECT_FALSE(matches("[^P]ump%"));
+  EXPECT_TRUE(matches("Pump [0-9][0-9]"));
+  EXPECT_FALSE(matches("Pump [2-9]%"));
+  EXPECT_TRUE(matches("Pump[ \\]]12"));
+  EXPECT_FALSE(matches("Pump 12[0-9]"));
+  // without closing bracket '[' is an ordinary character
+  EXPECT_FALSE(matches("Pump [12"));
+}
+
+TEST_F(EventFilterTest, LikeBacktracksOnlyToLastPercent)
+{
+  auto matches = [this](const std::string & pattern)
+  {
+    EventFilter filter;
+    filter.WhereClause = {Element(FilterOperator::Like, {MakeField("SourceName"), MakeLiteral(Variant(pattern))})};
+    return CompiledEventFilter(filter, *NameSpace).Matches(Alarm);
+  };
+
+  // trying every split of the text between the '%' would not finish
+  Alarm.SourceName = std::string(5000, 'a');
+  EXPECT_FALSE(matches("%a%a%a%a%a%b"));
+  EXPECT_TRUE(matches("%a%a%a%a%a%"));
+  EXPECT_TRUE(matches("a%%a_"));
+
+  Alarm.SourceName = "Pump 12";
+  EXPECT_TRUE(matches("%u%2"));
+  EXPECT_TRUE(matches("P%[0-9]"));
+  EXPECT_FALSE(matches("%1"));
+  EXPECT_TRUE(matches("%"));
+  EXPECT_FALSE(matches("%\\%"));
+}
+
+TEST_F(EventFilterTest, OfTypeMatchesSubtypes)
+{
+  EventFilter filter;
+  filter.WhereClause = {Element(FilterOperator::OfType, {MakeLiteral(Variant(NodeId(ObjectId::BaseEventType)))})};
+  CompiledEventFilter baseType(filter, *NameSpace);
+  ASSERT_EQ(baseType.GetStatus(), StatusCode::Good);
+  ASSERT_TRUE(baseType.Matches(Alarm));
+
+  filter.WhereClause = {Element(FilterOperator::OfType, {MakeLiteral(Variant(NodeId(ObjectId::AuditEventType)))})};
+  CompiledEventFilter auditType(filter, *NameSpace);
+  ASSERT_FALSE(auditType.Matches(Alarm));
+}
+
+TEST_F(EventFilterTest, EvaluatesInListAndNot)
+{
+  EventFilter filter;
+  filter.WhereClause =
+  {
+    Element(FilterOperator::Not, {MakeElement(1)}),
+    Element(FilterOperator::InList, {MakeField("Severity"), MakeLiteral(Variant(int32_t(100))), MakeLiteral(Variant(int32_t(500)))}),
+  };
+
+  CompiledEventFilter compiled(filter, *NameSpace);
+  ASSERT_FALSE(compiled.Matches(Alarm));
+
+  Alarm.Severity = 200;
+  ASSERT_TRUE(compiled.Matches(Alarm));
+}
+
+TEST_F(EventFilterTest, RejectsInvalidWhereClause)
+{
+  EventFilter filter;
+  filter.WhereClause = {Element(FilterOperator::Equals, {MakeField("Severity")})};
+  ASSERT_EQ(CompiledEventFilter(filter, *NameSpace).GetStatus(), StatusCode::BadFilterOperandCountMismatch);
+
+  filter.WhereClause = {Element(FilterOperator::Not, {MakeElement(0)})};
+  ASSERT_EQ(CompiledEventFilter(filter, *NameSpace).GetStatus(), StatusCode::BadFilterOperandInvalid);
+
+  filter.WhereClause = {Element(FilterOperator::RelatedTo, {MakeField("Severity"), MakeField("Severity")})};
+  ASSERT_EQ(CompiledEventFilter(filter, *NameSpace).GetStatus(), StatusCode::BadFilterOperatorUnsupported);
+}
+
+TEST_F(EventFilterTest, SelectsFieldsStoredBySlot)
+{
+  EventLayout::SharedPtr layout = std::make_shared<EventLayout>(ObjectId::SystemEventType, std::vector<std::vector<QualifiedName>>
+  {
+    {QualifiedName("Custom", 0)},
+    {QualifiedName("State", 0), QualifiedName("Id", 0)},
+  });
+  ASSERT_EQ(layout->GetSlot("Custom"), 0);
+  ASSERT_EQ(layout->GetSlot("Unknown"), -1);
+
+  Event first(layout);
+  first.SetValue("Custom", Variant(42));
+  first.SetValue("Unknown", Variant(1));
+  ASSERT_EQ(first.GetSlotValue(0), Variant(42));
+  ASSERT_EQ(first.GetValue("Unknown"), Variant(1));
+
+  Event second(layout);
+  second.SetSlotValue(layout->GetSlot("Custom"), Variant(7));
+
+  EventFilter filter;
+  filter.SelectClauses = {Field("Custom"), Field("Unknown")};
+  CompiledEventFilter compiled(filter, *NameSpace);
+
+  std::vector<Variant> fields = compiled.Select(first);
+  ASSERT_EQ(fields[0], Variant(42));
+  ASSERT_EQ(fields[1], Variant(1));
+  ASSERT_EQ(compiled.Select(second)[0], Variant(7));
+  ASSERT_EQ(compiled.Select(Alarm)[0], Variant(42));
+}
+
+TEST_F(EventFilterTest, SelectsFieldsOfSeveralLayoutsFromThreads)
+{
+  EventLayout::SharedPtr first = std::make_shared<EventLayout>(ObjectId::SystemEventType, std::vector<std::vector<QualifiedName>>
+  {
+    {QualifiedName("Custom", 0)},
+  });
+  EventLayout::SharedPtr second = std::make_shared<EventLayout>(ObjectId::SystemEventType, std::vector<std::vector<QualifiedName>>
+  {
+    {QualifiedName("Other", 0)},
+    {QualifiedName("Custom", 0)},
+  });
+
+  EventFilter filter;
+  filter.SelectClauses = {Field("Custom")};
+  const CompiledEventFilter compiled(filter, *NameSpace);
+
+  // every thread switches the cached slot to the layout of its events
+  auto select = [&compiled](EventLayout::SharedPtr layout, int32_t value, bool & matched)
+  {
+    Event event(layout);
+    event.SetValue("Custom", Variant(value));
+    matched = true;
+
+    for (int i = 0; i < 10000; ++i)
+      {
+        matched &= compiled.Select(event)[0] == Variant(value);
+      }
+  };
+
+  bool firstMatched = false;
+  bool secondMatched = false;
+  std::thread firstThread(select, first, 1, std::ref(firstMatched));
+  std::thread secondThread(select, second, 2, std::ref(secondMatched));
+  firstThread.join();
+  secondThread.join();
+
+  ASSERT_TRUE(firstMatched);
+  ASSERT_TRUE(secondMatched);
+}
@@ -0,0 +1,240 @@
+/// @brief Routing of events to monitored items tests.
+/// @license GNU LGPL
+///
+/// Distributed under the GNU LGPL License
+/// (See accompanying file LICENSE or copy at
+/// http://www.gnu.org/licenses/lgpl.html)
+///
+
+#include "subscription_service_test.h"
+
+#include <opc/ua/protocol/object_ids.h>
+
+#include <map>
+
+using namespace testing;
+using namespace OpcUa;
+
+class EventRoutingTest : public OpcUa::Test::SubscriptionServiceTest
+{
+protected:
+  virtual void SetUp()
+  {
+    SubscriptionServiceTest::SetUp();
+
+    // Server -HasNotifier-> Area -HasEventSource-> Tank, Other is not a source of anything
+    Area = AddObject(1000, "Area");
+    Tank = AddObject(1001, "Tank");
+    Other = AddObject(1002, "Other");
+    AddReference(ObjectId::Server, ObjectId::HasNotifier, Area);
+    AddReference(Area, ObjectId::HasEventSource, Tank);
+  }
+
+  NodeId AddObject(uint32_t id, const std::string & name)
+  {
+    AddNodesItem node;
+    node.ParentNodeId = ObjectId::ObjectsFolder;
+    node.ReferenceTypeId = ObjectId::Organizes;
+    node.RequestedNewNodeId = NumericNodeId(id, 1);
+    node.BrowseName = QualifiedName(name, 1);
+    node.Class = NodeClass::Object;
+    node.TypeDefinition = ObjectId::BaseObjectType;
+    ObjectAttributes attrs;
+    attrs.DisplayName = LocalizedText(name);
+    attrs.EventNotifier = 1;
+    node.Attributes = attrs;
+    return NameSpace->AddNodes(std::vector<AddNodesItem>(1, node)).front().AddedNodeId;
+  }
+
+  // References are stored by their source node, the inverse one is added as well.
+  void AddReference(const NodeId & source, const NodeId & type, const NodeId & target)
+  {
+    AddReferencesItem forward;
+    forward.SourceNodeId = source;
+    forward.ReferenceTypeId = type;
+    forward.IsForward = true;
+    forward.TargetNodeId = target;
+    forward.TargetNodeClass = NodeClass::Object;
+
+    AddReferencesItem inverse = forward;
+    inverse.SourceNodeId = target;
+    inverse.IsForward = false;
+    inverse.TargetNodeId = source;
+
+    std::vector<AddReferencesItem> references;
+    references.push_back(forward);
+    references.push_back(inverse);
+    ASSERT_EQ(NameSpace->AddReferences(references), std::vector<StatusCode>(2, StatusCode::Good));
+  }
+
+  uint32_t MonitorEvents(uint32_t subscriptionId, const NodeId & node, uint32_t clientHandle)
+  {
+    SimpleAttributeOperand severity;
+    severity.TypeId = ObjectId::BaseEventType;
+    severity.Attribute = AttributeId::Value;
+    severity.BrowsePath.push_back(QualifiedName("Severity", 0));
+
+    EventFilter filter;
+    filter.SelectClauses.push_back(severity);
+
+    MonitoredItemCreateRequest request;
+    request.ItemToMonitor.NodeId = node;
+    request.ItemToMonitor.AttributeId = AttributeId::EventNotifier;
+    request.MonitoringMode = MonitoringMode::Reporting;
+    request.RequestedParameters.ClientHandle = clientHandle;
+    request.RequestedParameters.QueueSize = 100;
+    request.RequestedParameters.Filter = MonitoringFilter(filter);
+
+    const MonitoredItemCreateResult result = Monitor(subscriptionId, request);
+    EXPECT_EQ(result.Status, StatusCode::Good);
+    return result.MonitoredItemId;
+  }
+
+  static Event Alarm(uint16_t severity)
+  {
+    Event event(ObjectId::BaseEventType);
+    event.Severity = severity;
+    return event;
+  }
+
+  // Events of every client handle in the notification message.
+  static std::map<uint32_t, std::size_t> CountEvents(const PublishResult & result)
+  {
+    std::map<uint32_t, std::size_t> counts;
+
+    for (const NotificationData & data : result.NotificationMessage.NotificationData)
+      {
+        for (const EventFieldList & fields : data.Events.Events)
+          {
+            ++counts[fields.ClientHandle];
+          }
+      }
+
+    return counts;
+  }
+
+protected:
+  NodeId Area;
+  NodeId Tank;
+  NodeId Other;
+};
+
+TEST_F(EventRoutingTest, RoutesEventToSourceAndNotifiersAbove)
+{
+  const uint32_t id = CreateSubscription(SubscriptionRequest(10));
+  MonitorEvents(id, Tank, 1);
+  MonitorEvents(id, Area, 2);
+  MonitorEvents(id, ObjectId::Server, 3);
+  MonitorEvents(id, Other, 4);
+
+  Service->TriggerEvent(Tank, Alarm(100));
+  Publish(1);
+
+  const std::map<uint32_t, std::size_t> expected = {{1, 1}, {2, 1}, {3, 1}};
+  ASSERT_EQ(CountEvents(Results[0]), expected);
+}
+
+TEST_F(EventRoutingTest, DoesNotRouteEventToNodesBelowSource)
+{
+  const uint32_t id = CreateSubscription(SubscriptionRequest(10));
+  MonitorEvents(id, Tank, 1);
+  MonitorEvents(id, Area, 2);
+  MonitorEvents(id, ObjectId::Server, 3);
+
+  Service->TriggerEvent(Area, Alarm(100));
+  Publish(1);
+
+  const std::map<uint32_t, std::size_t> expected = {{2, 1}, {3, 1}};
+  ASSERT_EQ(CountEvents(Results[0]), expected);
+}
+
+TEST_F(EventRoutingTest, DeletedMonitoredItemReceivesNoEvents)
+{
+  const uint32_t id = CreateSubscription(SubscriptionRequest(10));
+  MonitorEvents(id, Tank, 1);
+  const uint32_t area = MonitorEvents(id, Area, 2);
+
+  DeleteMonitoredItemsParameters params;
+  params.SubscriptionId = id;
+  params.MonitoredItemIds.push_back(area);
+  ASSERT_EQ(Service->DeleteMonitoredItems(params), std::vector<StatusCode>(1, StatusCode::Good));
+
+  Service->TriggerEvent(Tank, Alarm(100));
+  Publish(1);
+
+  const std::map<uint32_t, std::size_t> expected = {{1, 1}};
+  ASSERT_EQ(CountEvents(Results[0]), expected);
+}
+
+TEST_F(EventRoutingTest, DeletedSubscriptionReceivesNoEvents)
+{
+  const uint32_t deleted = CreateSubscription(SubscriptionRequest(10));
+  const uint32_t kept = CreateSubscription(SubscriptionRequest(10));
+  MonitorEvents(deleted, Tank, 1);
+  MonitorEvents(kept, Tank, 2);
+
+  ASSERT_EQ(Service->DeleteSubscriptions(std::vector<uint32_t>(1, deleted)), std::vector<StatusCode>(1, StatusCode::Good));
+
+  Service->TriggerEvent(Tank, Alarm(100));
+  Publish(1);
+
+  ASSERT_EQ(Results[0].SubscriptionId, kept);
+  const std::map<uint32_t, std::size_t> expected = {{2, 1}};
+  ASSERT_EQ(CountEvents(Results[0]), expected);
+}
+
+TEST_F(EventRoutingTest, DeliversBatchOnceToEverySubscription)
+{
+  const uint32_t first = CreateSubscription(SubscriptionRequest(10));
+  const uint32_t second = CreateSubscription(SubscriptionRequest(10));
+  MonitorEvents(first, Tank, 1);
+  MonitorEvents(first, ObjectId::Server, 2);
+  MonitorEvents(second, Area, 3);
+
+  std::vector<Event> events;
+  events.push_back(Alarm(100));
+  events.push_back(Alarm(200));
+  events.push_back(Alarm(300));
+  Service->TriggerEvents(Tank, events);
+  Publish(2);
+
+  // nothing is left for another notification message
+  Service->Publish(PublishRequest());
+  Io.run_for(std::chrono::milliseconds(100));
+  ASSERT_EQ(Results.size(), 2u);
+
+  std::map<uint32_t, std::map<uint32_t, std::size_t>> received;
+
+  for (const PublishResult & result : Results)
+    {
+      received[result.SubscriptionId] = CountEvents(result);
+    }
+
+  const std::map<uint32_t, std::size_t> expectedFirst = {{1, 3}, {2, 3}};
+  const std::map<uint32_t, std::size_t> expectedSecond = {{3, 3}};
+  ASSERT_EQ(received[first], expectedFirst);
+  ASSERT_EQ(received[second], expectedSecond);
+}
+
+TEST_F(EventRoutingTest, RoutesEventToNotifiersBeyondOneBrowsePage)
+{
+  // more notifiers above the source than references returned for a node at once
+  std::vector<NodeId> notifiers;
+
+  for (uint32_t id = 2000; id < 3100; ++id)
+    {
+      notifiers.push_back(AddObject(id, "Notifier" + std::to_string(id)));
+      AddReference(notifiers.back(), ObjectId::HasEventSource, Other);
+    }
+
+  const uint32_t sub = CreateSubscription(SubscriptionRequest(10));
+  MonitorEvents(sub, notifiers.front(), 1);
+  MonitorEvents(sub, notifiers[notifiers.size() / 2], 2);
+  MonitorEvents(sub, notifiers.back(), 3);
+
+  Service->TriggerEvent(Other, Alarm(100));
+  Publish(1);
+
+  const std::map<uint32_t, std::size_t> expected = {{1, 1}, {2, 1}, {3, 1}};
+  ASSERT_EQ(CountEvents(Results[0]), expected);
+}
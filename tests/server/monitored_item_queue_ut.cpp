@@ -0,0 +1,135 @@
+/// @brief Overflow of monitored item queues tests.
+/// @license GNU LGPL
+///
+/// Distributed under the GNU LGPL License
+/// (See accompanying file LICENSE or copy at
+/// http://www.gnu.org/licenses/lgpl.html)
+///
+
+#include "subscription_service_test.h"
+
+#include <opc/ua/protocol/object_ids.h>
+
+using namespace testing;
+using namespace OpcUa;
+
+namespace
+{
+// InfoType DataValue with the Overflow bit, see Part 4 7.34.1
+const uint32_t StatusOverflowBits = 0x480;
+}
+
+class MonitoredItemQueueTest : public OpcUa::Test::SubscriptionServiceTest
+{
+protected:
+  // Data changes published after the initial value for three writes in one cycle.
+  std::vector<MonitoredItems> WriteThreeValues(bool discardOldest)
+  {
+    const uint32_t id = CreateSubscription(SubscriptionRequest(10));
+    MonitoredItemCreateRequest request = MonitorValue(ObjectId::Server_ServiceLevel, 1, 100);
+    request.RequestedParameters.QueueSize = 2;
+    request.RequestedParameters.DiscardOldest = discardOldest;
+    EXPECT_EQ(Monitor(id, request).RevisedQueueSize, 2);
+    Publish(1);
+
+    Write(ObjectId::Server_ServiceLevel, 1);
+    Write(ObjectId::Server_ServiceLevel, 2);
+    Write(ObjectId::Server_ServiceLevel, 3);
+    Publish(1);
+
+    std::vector<MonitoredItems> changes;
+
+    for (const NotificationData & data : Results.back().NotificationMessage.NotificationData)
+      {
+        changes.insert(changes.end(), data.DataChange.Notification.begin(), data.DataChange.Notification.end());
+      }
+
+    return changes;
+  }
+
+  // Event types of the events published for two events triggered in one cycle.
+  std::vector<Variant> TriggerTwoEvents(bool discardOldest)
+  {
+    SimpleAttributeOperand eventType;
+    eventType.TypeId = ObjectId::BaseEventType;
+    eventType.Attribute = AttributeId::Value;
+    eventType.BrowsePath.push_back(QualifiedName("EventType", 0));
+
+    EventFilter filter;
+    filter.SelectClauses.push_back(eventType);
+
+    MonitoredItemCreateRequest request;
+    request.ItemToMonitor.NodeId = ObjectId::Server;
+    request.ItemToMonitor.AttributeId = AttributeId::EventNotifier;
+    request.MonitoringMode = MonitoringMode::Reporting;
+    request.RequestedParameters.ClientHandle = 1;
+    request.RequestedParameters.QueueSize = 1;
+    request.RequestedParameters.DiscardOldest = discardOldest;
+    request.RequestedParameters.Filter = MonitoringFilter(filter);
+
+    const uint32_t id = CreateSubscription(SubscriptionRequest(10));
+    EXPECT_EQ(Monitor(id, request).Status, StatusCode::Good);
+
+    Service->TriggerEvent(ObjectId::Server, Event(ObjectId::BaseEventType));
+    Service->TriggerEvent(ObjectId::Server, Event(ObjectId::AuditEventType));
+    Publish(1);
+
+    std::vector<Variant> types;
+
+    for (const NotificationData & data : Results.back().NotificationMessage.NotificationData)
+      {
+        for (const EventFieldList & fields : data.Events.Events)
+          {
+            EXPECT_EQ(fields.EventFields.size(), 1);
+            types.push_back(fields.EventFields.front());
+          }
+      }
+
+    return types;
+  }
+
+  static bool HasOverflowBits(const MonitoredItems & change)
+  {
+    return (static_cast<uint32_t>(change.Value.Status) & StatusOverflowBits) == StatusOverflowBits;
+  }
+};
+
+TEST_F(MonitoredItemQueueTest, DiscardOldestFlagsOldestKeptValue)
+{
+  const std::vector<MonitoredItems> changes = WriteThreeValues(true);
+
+  ASSERT_EQ(changes.size(), 2);
+  EXPECT_EQ(changes[0].Value.Value, 2);
+  EXPECT_TRUE(HasOverflowBits(changes[0]));
+  EXPECT_EQ(changes[1].Value.Value, 3);
+  EXPECT_FALSE(HasOverflowBits(changes[1]));
+}
+
+TEST_F(MonitoredItemQueueTest, DiscardNewestFlagsReplacedLastValue)
+{
+  const std::vector<MonitoredItems> changes = WriteThreeValues(false);
+
+  ASSERT_EQ(changes.size(), 2);
+  EXPECT_EQ(changes[0].Value.Value, 1);
+  EXPECT_FALSE(HasOverflowBits(changes[0]));
+  EXPECT_EQ(changes[1].Value.Value, 3);
+  EXPECT_TRUE(HasOverflowBits(changes[1]));
+}
+
+TEST_F(MonitoredItemQueueTest, DiscardOldestPutsOverflowEventFirst)
+{
+  const std::vector<Variant> types = TriggerTwoEvents(true);
+
+  ASSERT_EQ(types.size(), 2);
+  EXPECT_EQ(types[0], NodeId(ObjectId::EventQueueOverflowEventType));
+  EXPECT_EQ(types[1], NodeId(ObjectId::AuditEventType));
+}
+
+TEST_F(MonitoredItemQueueTest, DiscardNewestPutsOverflowEventLast)
+{
+  const std::vector<Variant> types = TriggerTwoEvents(false);
+
+  ASSERT_EQ(types.size(), 2);
+  EXPECT_EQ(types[0], NodeId(ObjectId::AuditEventType));
+  EXPECT_EQ(types[1], NodeId(ObjectId::EventQueueOverflowEventType));
+}
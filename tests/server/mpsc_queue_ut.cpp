@@ -0,0 +1,95 @@
+/// @brief Lock free multi producer queue tests.
+/// @license GNU LGPL
+///
+/// Distributed under the GNU LGPL License
+/// (See accompanying file LICENSE or copy at
+/// http://www.gnu.org/licenses/lgpl.html)
+///
+
+#include "mpsc_queue.h"
+
+#include <gtest/gtest.h>
+
+#include <thread>
+
+using namespace testing;
+using OpcUa::Internal::MpscQueue;
+
+TEST(MpscQueue, KeepsOrderUpToCapacity)
+{
+  MpscQueue<int> queue(3);
+  ASSERT_EQ(queue.Capacity(), 4u);
+  ASSERT_TRUE(queue.Empty());
+
+  for (int i = 1; i <= 4; ++i)
+    {
+      ASSERT_TRUE(queue.Push(i));
+    }
+
+  ASSERT_FALSE(queue.Push(5));
+
+  int value = 0;
+  ASSERT_TRUE(queue.Pop(value));
+  ASSERT_EQ(value, 1);
+  ASSERT_TRUE(queue.Push(5));
+
+  for (int i = 2; i <= 5; ++i)
+    {
+      ASSERT_TRUE(queue.Pop(value));
+      ASSERT_EQ(value, i);
+    }
+
+  ASSERT_TRUE(queue.Empty());
+  ASSERT_FALSE(queue.Pop(value));
+}
+
+TEST(MpscQueue, TakesValuesOfConcurrentProducers)
+{
+  const int producers = 4;
+  const int values = 10000;
+  MpscQueue<int> queue(64);
+
+  std::vector<std::thread> threads;
+
+  for (int p = 0; p < producers; ++p)
+    {
+      threads.push_back(std::thread([&queue, p, values]()
+      {
+        for (int i = 0; i < values; ++i)
+          {
+            while (!queue.Push(p * values + i))
+              {
+                std::this_thread::yield();
+              }
+          }
+      }));
+    }
+
+  // values of each producer come out in the order they were pushed
+  std::vector<int> last(producers, -1);
+  int received = 0;
+  int value = 0;
+  bool ordered = true;
+
+  while (received < producers * values)
+    {
+      if (!queue.Pop(value))
+        {
+          std::this_thread::yield();
+          continue;
+        }
+
+      const int producer = value / values;
+      ordered = ordered && value % values > last[producer];
+      last[producer] = value % values;
+      ++received;
+    }
+
+  for (std::thread & thread : threads)
+    {
+      thread.join();
+    }
+
+  ASSERT_TRUE(ordered);
+  ASSERT_TRUE(queue.Empty());
+}
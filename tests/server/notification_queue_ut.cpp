@@ -0,0 +1,87 @@
+/// @brief Notification queue tests.
+/// @license GNU LGPL
+///
+/// Distributed under the GNU LGPL License
+/// (See accompanying file LICENSE or copy at
+/// http://www.gnu.org/licenses/lgpl.html)
+///
+
+#include "notification_queue.h"
+
+#include <gtest/gtest.h>
+
+using namespace testing;
+using OpcUa::Internal::NotificationQueue;
+
+namespace
+{
+std::vector<int> Drain(NotificationQueue<int> & queue)
+{
+  std::vector<int> values;
+  queue.Drain(values);
+  return values;
+}
+}
+
+TEST(NotificationQueue, KeepsLatestValueWhenSizeIsOne)
+{
+  NotificationQueue<int> queue(0, false);
+  ASSERT_EQ(queue.Capacity(), 1);
+  ASSERT_FALSE(queue.Push(1));
+  ASSERT_TRUE(queue.Push(2));
+  ASSERT_EQ(Drain(queue), std::vector<int>({2}));
+  ASSERT_TRUE(queue.Empty());
+}
+
+TEST(NotificationQueue, DiscardsOldest)
+{
+  NotificationQueue<int> queue(3, true);
+
+  for (int i = 1; i <= 3; ++i)
+    {
+      ASSERT_FALSE(queue.Push(i));
+    }
+
+  ASSERT_TRUE(queue.Push(4));
+  ASSERT_TRUE(queue.Push(5));
+  ASSERT_EQ(queue.Front(), 3);
+  ASSERT_EQ(queue.Back(), 5);
+  ASSERT_EQ(Drain(queue), std::vector<int>({3, 4, 5}));
+
+  ASSERT_FALSE(queue.Push(6));
+  ASSERT_EQ(Drain(queue), std::vector<int>({6}));
+}
+
+TEST(NotificationQueue, ReplacesNewest)
+{
+  NotificationQueue<int> queue(3, false);
+
+  for (int i = 1; i <= 5; ++i)
+    {
+      queue.Push(i);
+    }
+
+  ASSERT_EQ(queue.Size(), 3);
+  ASSERT_EQ(queue.Back(), 5);
+  ASSERT_EQ(Drain(queue), std::vector<int>({1, 2, 5}));
+}
+
+TEST(NotificationQueue, DrainsPartlyInOrder)
+{
+  NotificationQueue<int> queue(3, true);
+
+  for (int i = 1; i <= 4; ++i)
+    {
+      queue.Push(i);
+    }
+
+  std::vector<int> values;
+  ASSERT_EQ(queue.Drain(values, 2), 2);
+  ASSERT_EQ(values, std::vector<int>({2, 3}));
+  ASSERT_EQ(queue.Size(), 1);
+
+  queue.Push(5);
+  ASSERT_EQ(queue.Drain(values, 10), 2);
+  ASSERT_EQ(values, std::vector<int>({2, 3, 4, 5}));
+  ASSERT_TRUE(queue.Empty());
+}
@@ -0,0 +1,204 @@
+/// @brief Binary protocol connection processor tests.
+/// @license GNU LGPL
+///
+/// Distributed under the GNU LGPL License
+/// (See accompanying file LICENSE or copy at
+/// http://www.gnu.org/licenses/lgpl.html)
+///
+
+#include "opc_tcp_processor.h"
+
+#include <opc/ua/protocol/object_ids.h>
+#include <opc/ua/protocol/protocol.h>
+#include <opc/ua/server/address_space.h>
+#include <opc/ua/server/services_registry.h>
+
+#include <gtest/gtest.h>
+
+#include <thread>
+
+using namespace testing;
+using namespace OpcUa;
+using OpcUa::Server::OpcTcpMessages;
+
+namespace
+{
+// Keeps every message flushed by the processor.
+class OutputCapture : public OpcUa::OutputChannel
+{
+public:
+  virtual void Send(const char * message, std::size_t size)
+  {
+    std::lock_guard<std::mutex> lock(Mutex);
+    Messages.push_back(std::vector<char>(message, message + size));
+  }
+
+  virtual void Stop()
+  {
+  }
+
+  std::vector<std::vector<char>> GetMessages()
+  {
+    std::lock_guard<std::mutex> lock(Mutex);
+    return Messages;
+  }
+
+private:
+  std::mutex Mutex;
+  std::vector<std::vector<char>> Messages;
+};
+
+// Completes reads only when the test asks for it.
+class ManualDataSource : public Server::DataSource
+{
+public:
+  virtual void Read(const std::vector<ReadValueId> & items, ReadCallback done)
+  {
+    Items = items;
+    Done = done;
+  }
+
+  std::vector<ReadValueId> Items;
+  ReadCallback Done;
+};
+
+// Completes reads before returning from Read.
+class InlineDataSource : public Server::DataSource
+{
+public:
+  virtual void Read(const std::vector<ReadValueId> & items, ReadCallback done)
+  {
+    done(std::vector<DataValue>(items.size(), DataValue(7)));
+  }
+};
+
+struct ReceivedRead
+{
+  Binary::SequenceHeader Sequence;
+  ReadResponse Response;
+};
+}
+
+class OpcTcpProcessorTest : public Test
+{
+protected:
+  virtual void SetUp()
+  {
+    spdlog::drop_all();
+    Logger = spdlog::stderr_color_mt("test");
+    Logger->set_level(spdlog::level::info);
+    NameSpace = Server::CreateAddressSpace(Logger);
+
+    AddNodesItem node;
+    node.RequestedNewNodeId = NumericNodeId(100, 1);
+    node.BrowseName = QualifiedName("Device", 1);
+    node.Class = NodeClass::Variable;
+    VariableAttributes attrs;
+    attrs.DisplayName = LocalizedText("Device");
+    attrs.Type = ObjectId::Int32;
+    attrs.Value = 0;
+    node.Attributes = attrs;
+    Device = NameSpace->AddNodes(std::vector<AddNodesItem>(1, node)).front().AddedNodeId;
+
+    Source = std::make_shared<ManualDataSource>();
+    ASSERT_EQ(NameSpace->SetDataSource(Device, AttributeId::Value, Source), StatusCode::Good);
+
+    Registry = Server::CreateServicesRegistry();
+    Registry->RegisterAttributeServices(NameSpace);
+    Output = std::make_shared<OutputCapture>();
+    Messages = std::make_shared<OpcTcpMessages>(Registry->GetServer(), Output, Logger);
+  }
+
+  virtual void TearDown()
+  {
+    Messages.reset();
+    Registry.reset();
+    NameSpace.reset();
+  }
+
+  void SendRead(uint32_t requestId, const ReadValueId & item)
+  {
+    Binary::SequenceHeader sequence;
+    sequence.SequenceNumber = requestId;
+    sequence.RequestId = requestId;
+
+    ReadRequest request;
+    request.Header.RequestHandle = requestId;
+    request.Parameters.AttributesToRead.push_back(item);
+
+    // message type and size are read by the connection before the processor
+    Binary::DataSerializer serializer;
+    serializer << uint32_t(1) << Binary::SymmetricAlgorithmHeader() << sequence << request;
+    OutputCapture message;
+    serializer.Flush(message);
+
+    const std::vector<char> data = message.GetMessages().front();
+    Binary::IStreamBinary stream(data.data(), data.size());
+    ASSERT_TRUE(Messages->ProcessMessage(Binary::MT_SECURE_MESSAGE, stream));
+  }
+
+  ReceivedRead GetResponse(std::size_t index)
+  {
+    const std::vector<char> data = Output->GetMessages().at(index);
+    Binary::IStreamBinary stream(data.data(), data.size());
+    Binary::SecureHeader secureHeader;
+    Binary::SymmetricAlgorithmHeader algorithmHeader;
+    ReceivedRead received;
+    stream >> secureHeader >> algorithmHeader >> received.Sequence >> received.Response;
+    return received;
+  }
+
+protected:
+  Common::Logger::SharedPtr Logger;
+  Server::AddressSpace::SharedPtr NameSpace;
+  NodeId Device;
+  std::shared_ptr<ManualDataSource> Source;
+  Server::ServicesRegistry::SharedPtr Registry;
+  std::shared_ptr<OutputCapture> Output;
+  OpcTcpMessages::SharedPtr Messages;
+};
+
+TEST_F(OpcTcpProcessorTest, AnswersReadWhenDataSourceCompletes)
+{
+  SendRead(1, ToReadValueId(Device, AttributeId::Value));
+  ASSERT_TRUE(static_cast<bool>(Source->Done));
+  ASSERT_EQ(Source->Items.size(), 1u);
+  // the connection is not blocked by the pending read
+  ASSERT_TRUE(Output->GetMessages().empty());
+
+  SendRead(2, ToReadValueId(Device, AttributeId::DisplayName));
+  ASSERT_EQ(Output->GetMessages().size(), 1u);
+  const ReceivedRead local = GetResponse(0);
+  EXPECT_EQ(local.Sequence.RequestId, 2u);
+  EXPECT_EQ(local.Sequence.SequenceNumber, 1u);
+  EXPECT_EQ(local.Response.Header.RequestHandle, 2u);
+  ASSERT_EQ(local.Response.Results.size(), 1u);
+  EXPECT_EQ(local.Response.Results[0].Value, LocalizedText("Device"));
+
+  std::thread device([this]()
+  {
+    Source->Done(std::vector<DataValue>(1, DataValue(42)));
+  });
+  device.join();
+
+  ASSERT_EQ(Output->GetMessages().size(), 2u);
+  const ReceivedRead deferred = GetResponse(1);
+  EXPECT_EQ(deferred.Sequence.RequestId, 1u);
+  EXPECT_EQ(deferred.Sequence.SequenceNumber, 2u);
+  EXPECT_EQ(deferred.Response.Header.RequestHandle, 1u);
+  ASSERT_EQ(deferred.Response.Results.size(), 1u);
+  EXPECT_EQ(deferred.Response.Results[0].Value, 42);
+}
+
+TEST_F(OpcTcpProcessorTest, AnswersReadCompletedBeforeReturning)
+{
+  NameSpace->SetDataSource(Device, AttributeId::Value, std::make_shared<InlineDataSource>());
+  SendRead(1, ToReadValueId(Device, AttributeId::Value));
+
+  ASSERT_EQ(Output->GetMessages().size(), 1u);
+  const ReceivedRead received = GetResponse(0);
+  EXPECT_EQ(received.Sequence.SequenceNumber, 1u);
+  EXPECT_EQ(received.Response.Header.RequestHandle, 1u);
+  ASSERT_EQ(received.Response.Results.size(), 1u);
+  EXPECT_EQ(received.Response.Results[0].Value, 7);
+}
@@ -0,0 +1,122 @@
+/// @brief Publish requests queue of sessions tests.
+/// @license GNU LGPL
+///
+/// Distributed under the GNU LGPL License
+/// (See accompanying file LICENSE or copy at
+/// http://www.gnu.org/licenses/lgpl.html)
+///
+
+#include "subscription_service_test.h"
+
+#include <opc/ua/protocol/object_ids.h>
+
+using namespace testing;
+using namespace OpcUa;
+
+class PublishQueueTest : public OpcUa::Test::SubscriptionServiceTest
+{
+protected:
+  uint32_t CreateSubscription(uint32_t maxNotifications, uint8_t priority)
+  {
+    CreateSubscriptionRequest request = SubscriptionRequest(10);
+    request.Parameters.MaxNotificationsPerPublish = maxNotifications;
+    request.Parameters.Priority = priority;
+    return SubscriptionServiceTest::CreateSubscription(request);
+  }
+
+  void Monitor(uint32_t subscriptionId, const NodeId & node, uint32_t clientHandle)
+  {
+    ASSERT_EQ(SubscriptionServiceTest::Monitor(subscriptionId, MonitorValue(node, clientHandle, 100)).Status, StatusCode::Good);
+  }
+
+  std::size_t CountDataChanges(const PublishResult & result)
+  {
+    std::size_t count = 0;
+
+    for (const NotificationData & data : result.NotificationMessage.NotificationData)
+      {
+        count += data.DataChange.Notification.size();
+      }
+
+    return count;
+  }
+};
+
+TEST_F(PublishQueueTest, SplitsNotificationsWithMoreNotifications)
+{
+  const uint32_t id = CreateSubscription(2, 0);
+
+  for (uint32_t handle = 1; handle <= 3; ++handle)
+    {
+      Monitor(id, ObjectId::Server_ServiceLevel, handle);
+    }
+
+  Publish(2);
+
+  ASSERT_EQ(CountDataChanges(Results[0]), 2);
+  ASSERT_TRUE(Results[0].MoreNotifications);
+  ASSERT_EQ(Results[0].NotificationMessage.NotificationData.front().DataChange.Notification.front().ClientHandle, 1);
+  ASSERT_EQ(CountDataChanges(Results[1]), 1);
+  ASSERT_FALSE(Results[1].MoreNotifications);
+  ASSERT_EQ(Results[1].NotificationMessage.NotificationData.front().DataChange.Notification.front().ClientHandle, 3);
+}
+
+TEST_F(PublishQueueTest, AnswersWaitingSubscriptionsByPriority)
+{
+  const uint32_t low = CreateSubscription(0, 1);
+  const uint32_t high = CreateSubscription(0, 200);
+
+  // both subscriptions run out of publish requests and wait for one
+  Io.run_for(std::chrono::milliseconds(100));
+  ASSERT_TRUE(Results.empty());
+
+  Publish(1);
+  ASSERT_EQ(Results[0].SubscriptionId, high);
+
+  Publish(1);
+  ASSERT_EQ(Results[1].SubscriptionId, low);
+}
+
+TEST_F(PublishQueueTest, RequestReservedForDeletedSubscriptionIsGivenBack)
+{
+  const uint32_t low = CreateSubscription(0, 1);
+  const uint32_t high = CreateSubscription(0, 200);
+  Io.run_for(std::chrono::milliseconds(100));
+  ASSERT_TRUE(Results.empty());
+
+  // reserved for the waiting subscription of highest priority, answered from Io
+  Service->Publish(PublishRequest());
+  ASSERT_EQ(Service->DeleteSubscriptions(std::vector<uint32_t>(1, high)), std::vector<StatusCode>(1, StatusCode::Good));
+
+  ASSERT_NO_FATAL_FAILURE(WaitForResults(1));
+  ASSERT_EQ(Results[0].SubscriptionId, low);
+}
+
+TEST_F(PublishQueueTest, SchedulerSleepsUntilSubscriptionIsDue)
+{
+  SubscriptionServiceTest::CreateSubscription(SubscriptionRequest(1000));
+
+  // nothing is due during the first interval, the timer does not tick meanwhile
+  ASSERT_EQ(Io.run_for(std::chrono::milliseconds(300)), 0);
+}
+
+TEST_F(PublishQueueTest, ModifiedSubscriptionIsRescheduled)
+{
+  CreateSubscriptionRequest request = SubscriptionRequest(200);
+  const uint32_t id = SubscriptionServiceTest::CreateSubscription(request);
+
+  // the first cycle answers, then the idle subscription sleeps until its keep alive 100 intervals later
+  Publish(1);
+
+  ModifySubscriptionParameters params;
+  params.SubscriptionId = id;
+  params.RequestedPublishingInterval = 10;
+  params.RequestedLifetimeCount = 1000;
+  params.RequestedMaxKeepAliveCount = 1;
+  ASSERT_EQ(Service->ModifySubscription(params).Header.ServiceResult, StatusCode::Good);
+
+  const auto start = std::chrono::steady_clock::now();
+  Publish(1);
+  ASSERT_LT(std::chrono::steady_clock::now() - start, std::chrono::seconds(1));
+  ASSERT_EQ(Results[1].SubscriptionId, id);
+}
@@ -0,0 +1,128 @@
+/// @brief Retransmission queue of encoded notification messages tests.
+/// @license GNU LGPL
+///
+/// Distributed under the GNU LGPL License
+/// (See accompanying file LICENSE or copy at
+/// http://www.gnu.org/licenses/lgpl.html)
+///
+
+#include "subscription_service_test.h"
+
+#include <opc/ua/protocol/binary/stream.h>
+
+using namespace testing;
+using namespace OpcUa;
+
+class RepublishTest : public OpcUa::Test::SubscriptionServiceTest
+{
+protected:
+  virtual void SetUp()
+  {
+    SubscriptionServiceTest::SetUp();
+
+    CreateSubscriptionRequest request = SubscriptionRequest(10);
+    request.Parameters.RequestedMaxKeepAliveCount = 1;
+    SubscriptionId = CreateEncodedSubscription(request);
+  }
+
+  uint32_t GetSequenceNumber(const Server::EncodedPublishResult & result)
+  {
+    NotificationMessage message;
+    Binary::IStreamBinary stream(result.NotificationMessage->data(), result.NotificationMessage->size());
+    stream >> message;
+    return message.SequenceNumber;
+  }
+
+  Server::EncodedNotificationMessage RepublishEncoded(uint32_t sequenceNumber)
+  {
+    RepublishParameters params;
+    params.SubscriptionId = SubscriptionId;
+    params.RetransmitSequenceNumber = sequenceNumber;
+    Server::EncodedNotificationMessage message;
+    const StatusCode status = Service->RepublishEncoded(NodeId(), params, message);
+    EXPECT_EQ(status, message ? StatusCode::Good : StatusCode::BadMessageNotAvailable);
+    return message;
+  }
+
+protected:
+  uint32_t SubscriptionId = 0;
+};
+
+TEST_F(RepublishTest, ResendsMessageAsItWasSent)
+{
+  Publish(2);
+
+  const uint32_t first = GetSequenceNumber(EncodedResults[0]);
+  const uint32_t second = GetSequenceNumber(EncodedResults[1]);
+  ASSERT_EQ(EncodedResults[1].AvailableSequenceNumbers, std::vector<uint32_t>(1, first));
+  ASSERT_EQ(RepublishEncoded(first), EncodedResults[0].NotificationMessage);
+  ASSERT_EQ(RepublishEncoded(second), EncodedResults[1].NotificationMessage);
+
+  RepublishParameters params;
+  params.SubscriptionId = SubscriptionId;
+  params.RetransmitSequenceNumber = second;
+  RepublishResponse response = Service->Republish(params);
+  ASSERT_EQ(response.Header.ServiceResult, StatusCode::Good);
+  ASSERT_EQ(response.NotificationMessage.SequenceNumber, second);
+
+  PublishRequest acknowledge;
+  SubscriptionAcknowledgement ack;
+  ack.SubscriptionId = SubscriptionId;
+  ack.SequenceNumber = first;
+  acknowledge.SubscriptionAcknowledgements.push_back(ack);
+  Service->Publish(acknowledge);
+  ASSERT_TRUE(RepublishEncoded(first) == nullptr);
+  ASSERT_TRUE(RepublishEncoded(second) != nullptr);
+}
+
+TEST_F(RepublishTest, KeepsLatestMessagesWithinBudget)
+{
+  Service->SetRetransmissionBudget(1);
+  Publish(2);
+
+  ASSERT_TRUE(RepublishEncoded(GetSequenceNumber(EncodedResults[0])) == nullptr);
+  ASSERT_EQ(RepublishEncoded(GetSequenceNumber(EncodedResults[1])), EncodedResults[1].NotificationMessage);
+  ASSERT_TRUE(EncodedResults[1].AvailableSequenceNumbers.empty());
+
+  RepublishParameters params;
+  params.SubscriptionId = SubscriptionId;
+  params.RetransmitSequenceNumber = GetSequenceNumber(EncodedResults[0]);
+  ASSERT_EQ(Service->Republish(params).Header.ServiceResult, StatusCode::BadMessageNotAvailable);
+}
+
+TEST_F(RepublishTest, RejectsSubscriptionOfAnotherSession)
+{
+  Publish(1);
+
+  RepublishParameters params;
+  params.SubscriptionId = SubscriptionId;
+  params.RetransmitSequenceNumber = GetSequenceNumber(EncodedResults[0]);
+  Server::EncodedNotificationMessage message;
+  ASSERT_EQ(Service->RepublishEncoded(NumericNodeId(100, 1), params, message), StatusCode::BadSubscriptionIdInvalid);
+  ASSERT_TRUE(message == nullptr);
+  ASSERT_EQ(Service->RepublishEncoded(NodeId(), params, message), StatusCode::Good);
+  ASSERT_EQ(message, EncodedResults[0].NotificationMessage);
+
+  ASSERT_EQ(Service->Republish(NumericNodeId(100, 1), params).Header.ServiceResult, StatusCode::BadSubscriptionIdInvalid);
+  ASSERT_EQ(Service->Republish(NodeId(), params).Header.ServiceResult, StatusCode::Good);
+}
+
+TEST_F(RepublishTest, InProcessRepublishDoesNotServeOtherSessions)
+{
+  CreateSubscriptionRequest remote = SubscriptionRequest(10);
+  remote.Header.SessionAuthenticationToken = NumericNodeId(100, 1);
+  remote.Parameters.RequestedMaxKeepAliveCount = 1;
+  const uint32_t remoteId = CreateEncodedSubscription(remote);
+
+  PublishRequest request;
+  request.Header.SessionAuthenticationToken = NumericNodeId(100, 1);
+  Service->Publish(request);
+  WaitForResults(1);
+  ASSERT_EQ(EncodedResults.back().SubscriptionId, remoteId);
+
+  RepublishParameters params;
+  params.SubscriptionId = remoteId;
+  params.RetransmitSequenceNumber = GetSequenceNumber(EncodedResults.back());
+  ASSERT_EQ(Service->Republish(params).Header.ServiceResult, StatusCode::BadSubscriptionIdInvalid);
+  ASSERT_EQ(Service->Republish(NumericNodeId(100, 1), params).Header.ServiceResult, StatusCode::Good);
+}
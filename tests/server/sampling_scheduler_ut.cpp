@@ -0,0 +1,114 @@
+/// @brief Sampling of values backed by value callbacks tests.
+/// @license GNU LGPL
+///
+/// Distributed under the GNU LGPL License
+/// (See accompanying file LICENSE or copy at
+/// http://www.gnu.org/licenses/lgpl.html)
+///
+
+#include "sampling_scheduler.h"
+#include "subscription_service_test.h"
+
+#include <opc/ua/protocol/object_ids.h>
+
+#include <atomic>
+
+using namespace testing;
+using namespace OpcUa;
+using OpcUa::Internal::SamplingScheduler;
+
+class SamplingSchedulerTest : public OpcUa::Test::SubscriptionServiceTest
+{
+protected:
+  virtual void SetUp()
+  {
+    SubscriptionServiceTest::SetUp();
+
+    AddNodesItem node;
+    node.RequestedNewNodeId = Device;
+    node.BrowseName = QualifiedName("Device", 1);
+    node.Class = NodeClass::Variable;
+    node.ParentNodeId = ObjectId::ObjectsFolder;
+    node.ReferenceTypeId = ObjectId::HasComponent;
+    node.TypeDefinition = ObjectId::BaseDataVariableType;
+    VariableAttributes attrs;
+    attrs.DisplayName = LocalizedText("Device");
+    attrs.Type = ObjectId::Byte;
+    attrs.Value = uint8_t(0);
+    attrs.MinimumSamplingInterval = 0;
+    node.Attributes = attrs;
+    ASSERT_EQ(NameSpace->AddNodes(std::vector<AddNodesItem>(1, node)).front().Status, StatusCode::Good);
+
+    // every read returns a new value
+    NameSpace->SetValueCallback(Device, AttributeId::Value, [this]()
+    {
+      return DataValue(Variant(uint8_t(++Reads)));
+    });
+  }
+
+  MonitoredItemCreateResult Monitor(uint32_t subscriptionId, const NodeId & node, double samplingInterval)
+  {
+    MonitoredItemCreateRequest request = MonitorValue(node, 1, samplingInterval);
+    request.RequestedParameters.QueueSize = 100;
+    return SubscriptionServiceTest::Monitor(subscriptionId, request);
+  }
+
+protected:
+  std::atomic<int> Reads{0};
+  const NodeId Device = NumericNodeId(100, 1);
+};
+
+TEST_F(SamplingSchedulerTest, ReadsItemsAtTheirInterval)
+{
+  std::shared_ptr<SamplingScheduler> scheduler = std::make_shared<SamplingScheduler>(*NameSpace, Io, 2, Logger);
+  std::atomic<int> samples(0);
+
+  ReadValueId item;
+  item.NodeId = Device;
+  item.AttributeId = AttributeId::Value;
+  const uint32_t handle = scheduler->Add(item, 10, [&samples](const DataValue & value)
+  {
+    if (value.Value.As<uint8_t>() > 0)
+      {
+        ++samples;
+      }
+  });
+  ASSERT_EQ(scheduler->GetGroupsCount(), 1);
+
+  Io.run_for(std::chrono::milliseconds(200));
+  ASSERT_GE(samples, 3);
+
+  scheduler->Remove(handle);
+  ASSERT_EQ(scheduler->GetGroupsCount(), 0);
+
+  const int stopped = samples;
+  Io.restart();
+  Io.run_for(std::chrono::milliseconds(50));
+  ASSERT_EQ(samples, stopped);
+  scheduler->Stop();
+}
+
+TEST_F(SamplingSchedulerTest, MonitoredItemReceivesSampledValues)
+{
+  const uint32_t id = CreateSubscription(SubscriptionRequest(500));
+
+  const MonitoredItemCreateResult created = Monitor(id, Device, 10);
+  ASSERT_EQ(created.Status, StatusCode::Good);
+  ASSERT_EQ(created.RevisedSamplingInterval, 10);
+  ASSERT_EQ(Service->GetDataChangeSamplers().GetSamplingScheduler().GetGroupsCount(), 1);
+
+  Publish(1);
+  ASSERT_EQ(Results[0].NotificationMessage.NotificationData.size(), 1);
+  // initial value and the values sampled during the publishing interval
+  ASSERT_GT(Results[0].NotificationMessage.NotificationData[0].DataChange.Notification.size(), 1);
+}
+
+TEST_F(SamplingSchedulerTest, RevisesSamplingInterval)
+{
+  const uint32_t id = CreateSubscription(SubscriptionRequest(500));
+
+  // MinimumSamplingInterval of ServerArray is 1000
+  ASSERT_EQ(Monitor(id, ObjectId::Server_ServerArray, 100).RevisedSamplingInterval, 1000);
+  // publishing interval
+  ASSERT_EQ(Monitor(id, Device, -1).RevisedSamplingInterval, 500);
+}
@@ -0,0 +1,144 @@
+/// @brief Fixture of subscription service tests.
+/// @license GNU LGPL
+///
+/// Distributed under the GNU LGPL License
+/// (See accompanying file LICENSE or copy at
+/// http://www.gnu.org/licenses/lgpl.html)
+///
+
+#pragma once
+
+#include "subscription_service_internal.h"
+
+#include <opc/ua/server/standard_address_space.h>
+
+#include <gtest/gtest.h>
+
+#include <chrono>
+#include <memory>
+#include <vector>
+
+namespace OpcUa
+{
+namespace Test
+{
+
+/// @brief Subscription service over the standard address space.
+/// Publishing cycles run only while a test runs Io.
+class SubscriptionServiceTest : public ::testing::Test
+{
+protected:
+  virtual void SetUp()
+  {
+    spdlog::drop_all();
+    Logger = spdlog::stderr_color_mt("test");
+    Logger->set_level(spdlog::level::info);
+    NameSpace = Server::CreateAddressSpace(Logger);
+    Server::FillStandardNamespace(*NameSpace, Logger);
+    Service.reset(new Internal::SubscriptionServiceInternal(NameSpace, Io, Logger));
+  }
+
+  virtual void TearDown()
+  {
+    Service.reset();
+    NameSpace.reset();
+  }
+
+  static CreateSubscriptionRequest SubscriptionRequest(double publishingInterval)
+  {
+    CreateSubscriptionRequest request;
+    request.Parameters.RequestedPublishingInterval = publishingInterval;
+    request.Parameters.RequestedLifetimeCount = 1000;
+    request.Parameters.RequestedMaxKeepAliveCount = 100;
+    request.Parameters.MaxNotificationsPerPublish = 0;
+    request.Parameters.PublishingEnabled = true;
+    request.Parameters.Priority = 0;
+    return request;
+  }
+
+  /// @brief Create subscription publishing into Results.
+  uint32_t CreateSubscription(const CreateSubscriptionRequest & request)
+  {
+    return Service->CreateSubscription(request, [this](PublishResult result)
+    {
+      Results.push_back(result);
+    }).SubscriptionId;
+  }
+
+  /// @brief Create subscription publishing encoded messages into EncodedResults.
+  uint32_t CreateEncodedSubscription(const CreateSubscriptionRequest & request)
+  {
+    return Service->CreateEncodedSubscription(request, [this](const Server::EncodedPublishResult & result)
+    {
+      EncodedResults.push_back(result);
+    }).SubscriptionId;
+  }
+
+  static MonitoredItemCreateRequest MonitorValue(const NodeId & node, uint32_t clientHandle, double samplingInterval)
+  {
+    MonitoredItemCreateRequest request;
+    request.ItemToMonitor.NodeId = node;
+    request.ItemToMonitor.AttributeId = AttributeId::Value;
+    request.MonitoringMode = MonitoringMode::Reporting;
+    request.RequestedParameters.ClientHandle = clientHandle;
+    request.RequestedParameters.SamplingInterval = samplingInterval;
+    request.RequestedParameters.QueueSize = 1;
+    request.RequestedParameters.DiscardOldest = true;
+    return request;
+  }
+
+  MonitoredItemCreateResult Monitor(uint32_t subscriptionId, const MonitoredItemCreateRequest & request)
+  {
+    MonitoredItemsParameters params;
+    params.SubscriptionId = subscriptionId;
+    params.TimestampsToReturn = TimestampsToReturn::Both;
+    params.ItemsToCreate.push_back(request);
+    return Service->CreateMonitoredItems(params).front();
+  }
+
+  void Write(const NodeId & node, const Variant & value)
+  {
+    WriteValue write;
+    write.NodeId = node;
+    write.AttributeId = AttributeId::Value;
+    write.Value = DataValue(value);
+    NameSpace->Write(std::vector<WriteValue>(1, write));
+  }
+
+  /// @brief Send count publish requests and run Io until all of them are answered.
+  void Publish(std::size_t count)
+  {
+    const std::size_t expected = Results.size() + EncodedResults.size() + count;
+
+    for (std::size_t i = 0; i < count; ++i)
+      {
+        Service->Publish(PublishRequest());
+      }
+
+    WaitForResults(expected);
+  }
+
+  /// @brief Run Io until there are count results in Results and EncodedResults.
+  void WaitForResults(std::size_t count)
+  {
+    const auto deadline = std::chrono::steady_clock::now() + std::chrono::seconds(5);
+
+    while (Results.size() + EncodedResults.size() < count && std::chrono::steady_clock::now() < deadline)
+      {
+        Io.run_one_for(std::chrono::milliseconds(10));
+      }
+
+    ASSERT_EQ(Results.size() + EncodedResults.size(), count);
+  }
+
+protected:
+  Common::Logger::SharedPtr Logger;
+  Server::AddressSpace::SharedPtr NameSpace;
+  boost::asio::io_service Io;
+  std::unique_ptr<Internal::SubscriptionServiceInternal> Service;
+  std::vector<PublishResult> Results;
+  std::vector<Server::EncodedPublishResult> EncodedResults;
+};
+
+}
+}
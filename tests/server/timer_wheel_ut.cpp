@@ -0,0 +1,99 @@
+/// @brief Timer wheel tests.
+/// @license GNU LGPL
+///
+/// Distributed under the GNU LGPL License
+/// (See accompanying file LICENSE or copy at
+/// http://www.gnu.org/licenses/lgpl.html)
+///
+
+#include "timer_wheel.h"
+
+#include <gtest/gtest.h>
+
+using namespace testing;
+using OpcUa::Internal::TimerWheel;
+
+namespace
+{
+std::vector<uint32_t> Ids(const std::vector<TimerWheel::Timer> & timers)
+{
+  std::vector<uint32_t> ids;
+
+  for (const TimerWheel::Timer & timer : timers)
+    {
+      ids.push_back(timer.Id);
+    }
+
+  return ids;
+}
+}
+
+TEST(TimerWheel, ExpiresTimersInOrderOfTicks)
+{
+  TimerWheel wheel;
+  wheel.Schedule(1, 30);
+  wheel.Schedule(2, 10);
+  wheel.Schedule(3, 20);
+  wheel.Schedule(4, 10);
+  ASSERT_EQ(wheel.Size(), 4u);
+
+  ASSERT_TRUE(wheel.Advance(9).empty());
+  ASSERT_EQ(Ids(wheel.Advance(20)), std::vector<uint32_t>({2, 4, 3}));
+  ASSERT_EQ(Ids(wheel.Advance(100)), std::vector<uint32_t>({1}));
+  ASSERT_TRUE(wheel.Empty());
+  ASSERT_EQ(wheel.GetCurrentTick(), 100u);
+}
+
+TEST(TimerWheel, CascadesDistantTimersToTheirTick)
+{
+  TimerWheel wheel;
+  const std::vector<uint64_t> ticks = {63, 64, 65, 4095, 4096, 4097, 300000, 16777216, 20000000};
+
+  for (uint32_t id = 0; id < ticks.size(); ++id)
+    {
+      wheel.Schedule(id, ticks[id]);
+    }
+
+  for (uint32_t id = 0; id < ticks.size(); ++id)
+    {
+      ASSERT_TRUE(wheel.Advance(ticks[id] - 1).empty()) << "tick " << ticks[id];
+
+      const std::vector<TimerWheel::Timer> expired = wheel.Advance(ticks[id]);
+      ASSERT_EQ(expired.size(), 1u) << "tick " << ticks[id];
+      ASSERT_EQ(expired[0].Id, id);
+      ASSERT_EQ(expired[0].Tick, ticks[id]);
+    }
+
+  ASSERT_TRUE(wheel.Empty());
+}
+
+TEST(TimerWheel, ExpiresPassedTicksAtNextTick)
+{
+  TimerWheel wheel;
+  wheel.Schedule(1, 5);
+  wheel.Advance(100);
+  wheel.Schedule(2, 50);
+
+  const std::vector<TimerWheel::Timer> expired = wheel.Advance(101);
+  ASSERT_EQ(Ids(expired), std::vector<uint32_t>({2}));
+  ASSERT_EQ(expired[0].Tick, 101u);
+}
+
+TEST(TimerWheel, NextExpirySkipsEmptySlots)
+{
+  TimerWheel wheel;
+  wheel.Schedule(1, 300000);
+  ASSERT_EQ(wheel.GetNextExpiry(), 300000u);
+
+  wheel.Schedule(2, 5000);
+  wheel.Schedule(3, 4200);
+  ASSERT_EQ(wheel.GetNextExpiry(), 4200u);
+
+  wheel.Schedule(4, 70);
+  ASSERT_EQ(wheel.GetNextExpiry(), 70u);
+
+  ASSERT_EQ(Ids(wheel.Advance(70)), std::vector<uint32_t>({4}));
+  ASSERT_EQ(wheel.GetNextExpiry(), 4200u);
+  ASSERT_EQ(Ids(wheel.Advance(4200)), std::vector<uint32_t>({3}));
+  ASSERT_EQ(wheel.GetNextExpiry(), 5000u);
+}